@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "itex/core/devices/bfc_allocator.h"
 
+#include <algorithm>
 #include <limits>
 
 #define SYSTEM_RESERVED_MEMORY \
@@ -129,9 +130,20 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   Chunk* chunk = ChunkFromHandle(h);
   // Mark the chunk as no longer in use.
   chunk->allocation_id = -1;
+  bytes_in_use_ -= chunk->size;
   InsertFreeChunkIntoBin(TryToCoalesce(h));
 }
 
+int64_t BFCAllocator::BytesInUse() const {
+  mutex_lock l(&lock_);
+  return bytes_in_use_;
+}
+
+int64_t BFCAllocator::PeakBytesInUse() const {
+  mutex_lock l(&lock_);
+  return peak_bytes_in_use_;
+}
+
 // static
 size_t BFCAllocator::RoundedBytes(size_t bytes) {
   size_t rounded_bytes =
@@ -175,6 +187,8 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         chunk->requested_size = num_bytes;
         // Currently do not track allocation id, use 0 mark this chunk in use.
         chunk->allocation_id = 0;
+        bytes_in_use_ += chunk->size;
+        peak_bytes_in_use_ = std::max(peak_bytes_in_use_, bytes_in_use_);
         return chunk->ptr;
       }
     }
@@ -42,6 +42,10 @@ class BFCAllocator : public Allocator {
   void DeallocateRaw(void* ptr) override;
   string Name() override { return "itex_device_bfc"; }
 
+  // Bytes of the chunks currently handed out, and the maximum ever reached.
+  int64_t BytesInUse() const TF_LOCKS_EXCLUDED(lock_);
+  int64_t PeakBytesInUse() const TF_LOCKS_EXCLUDED(lock_);
+
  private:
   ITEX_GPUDevice* device_;
   size_t memory_limit_;
@@ -394,6 +398,9 @@ class BFCAllocator : public Allocator {
   // The total number of allocated bytes by the allocator.
   size_t total_region_allocated_bytes_ = 0;
 
+  int64_t bytes_in_use_ TF_GUARDED_BY(lock_) = 0;
+  int64_t peak_bytes_in_use_ TF_GUARDED_BY(lock_) = 0;
+
   std::vector<Chunk> chunks_ TF_GUARDED_BY(lock_);
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 #pragma once
+#include <vector>
+
 #include "xpuautoshard/common/ref_base.h"
 namespace as {
 
@@ -33,9 +35,24 @@ struct HeuristicsConfig {
   int64_t getBatchGrainSize() const { return batch_grain_size_; }
   void setBatchGrainSize(int64_t grain_size) { batch_grain_size_ = grain_size; }
 
+  /**
+   * @brief Per-device weights multiplied to the device scores before they are
+   * normalized into batch split ratios. Empty means no adjustment. The HSP
+   * tuner searches them around the scores given by the cost model.
+   *
+   * @return const std::vector<float>&
+   */
+  const std::vector<float>& getSplitRatioWeights() const {
+    return split_ratio_weights_;
+  }
+  void setSplitRatioWeights(const std::vector<float>& weights) {
+    split_ratio_weights_ = weights;
+  }
+
  private:
   bool multi_stage_enabled_;
   int64_t batch_grain_size_;
+  std::vector<float> split_ratio_weights_;
 };
 
 struct ShardingConfig {
@@ -43,7 +60,8 @@ struct ShardingConfig {
       : strategy_kind_(StrategyKind::CPU_HOST),
         use_nccl_comm_backend_(false),
         use_multi_stage_join_(true),
-        need_dead_node_prune_(true) {}
+        need_dead_node_prune_(true),
+        tuning_num_threads_(0) {}
 
   HeuristicsConfig& getHeuristicsConfig() { return heuristics_config_; }
   const HeuristicsConfig& getHeuristicsConfig() const {
@@ -88,12 +106,25 @@ struct ShardingConfig {
    */
   bool isNeedDeadNodePrune() const { return need_dead_node_prune_; }
 
+  void setTuningNumThreads(size_t tuning_num_threads) {
+    tuning_num_threads_ = tuning_num_threads;
+  }
+
+  /**
+   * @brief The number of threads the HSP tuner evaluates candidate
+   * annotations with. 0 means the number of hardware threads.
+   *
+   * @return size_t
+   */
+  size_t getTuningNumThreads() const { return tuning_num_threads_; }
+
  private:
   HeuristicsConfig heuristics_config_;
   StrategyKind strategy_kind_;
   bool use_nccl_comm_backend_;
   bool use_multi_stage_join_;
   bool need_dead_node_prune_;
+  size_t tuning_num_threads_;
 };
 
 }  // namespace as
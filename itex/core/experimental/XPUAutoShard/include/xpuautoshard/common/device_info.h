@@ -20,6 +20,8 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "xpuautoshard/common/device_profile.h"
+
 namespace as {
 
 using DeviceId = size_t;
@@ -90,6 +92,7 @@ class Device {
   static constexpr DeviceId INVALID_DEVICE_ID = -1;
   static constexpr const char* CPU_HOST_NAME = "__cpu_host__";
   static constexpr const char* DEVICE_UNKNOWN = "__unknown__";
+  static constexpr int NO_NUMA_AFFINITY = -1;
 
   static Device getCpuHost(float score = 1.0f,
                            const std::string& host_name = "") {
@@ -100,7 +103,11 @@ class Device {
 
   Device(DeviceId id, const std::string& name = DEVICE_UNKNOWN,
          float score = -1.0f)
-      : id_(id), name_(name), score_(score), num_stages_(0) {}
+      : id_(id),
+        name_(name),
+        score_(score),
+        num_stages_(0),
+        numa_node_(NO_NUMA_AFFINITY) {}
 
   bool operator==(const Device& rhs) const;
   bool operator!=(const Device& rhs) const;
@@ -140,13 +147,38 @@ class Device {
 
   void setNumStages(size_t num_stages) { num_stages_ = num_stages; }
 
+  /**
+   * @brief NUMA node the device computes and allocates on. CPU shards of a
+   * multi-socket host are pinned to node i % #nodes, so that the framework
+   * runs them with node-local threads and memory. Shards on the same node
+   * share all its cores.
+   *
+   * @return int NUMA node or NO_NUMA_AFFINITY if the device is not pinned.
+   */
+  int getNumaNode() const { return numa_node_; }
+
+  void setNumaNode(int numa_node) { numa_node_ = numa_node; }
+
+  /**
+   * @brief Measured cost coefficients of the device. When calibrated, they
+   * take precedence over the score and the compute capability.
+   *
+   */
+  const DeviceProfile& getProfile() const { return profile_; }
+
+  void setProfile(const DeviceProfile& profile) { profile_ = profile; }
+
+  bool hasProfile() const { return profile_.isCalibrated(); }
+
  private:
   DeviceId id_;
   std::string name_;
   float score_;
   // TODO(itex): hard-code score temporarily, to be replaced with cost model.
   size_t num_stages_;
+  int numa_node_;
   DeviceComputeCapability device_comp_cap_;
+  DeviceProfile profile_;
 };
 
 class DeviceInfo {
@@ -203,6 +235,18 @@ class DeviceInfo {
   bool addDevice(const Device& device);
   const Device& getDevice(DeviceId id) const;
 
+  /**
+   * @brief Group the positions in `device_ids` by the NUMA node of their
+   * devices. Groups are in the order of first appearance, so the first group
+   * holds position 0. Devices without NUMA affinity are each in their own
+   * group.
+   *
+   * @param device_ids Devices, e.g. the placements of the shards of a value.
+   * @return std::vector<std::vector<size_t>> Positions of each group.
+   */
+  std::vector<std::vector<size_t>> groupByNumaNode(
+      const std::vector<DeviceId>& device_ids) const;
+
  private:
   DeviceMap device_map_;
   // TODO(itex): add inter-connectivity
@@ -0,0 +1,161 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace as {
+
+/**
+ * @brief Op kinds the device profile has measured coefficients for. Compute
+ * bound kinds measure multiply-add ops, memory bound kinds measure bytes.
+ *
+ */
+enum class ProfiledOpKind {
+  MATMUL = 0,
+  CONV,
+  ELEMENTWISE,
+  REDUCTION,
+  NUM_KINDS,
+};
+
+/**
+ * @brief Measured cost coefficients of a device. The time of a kernel of kind
+ * `k` with `work` ops or bytes is modeled as
+ *   overhead(k) + work / throughput(k)
+ * The coefficients are fitted from microbenchmarks by `calibrateCpuProfile`
+ * and persisted with `saveDeviceProfiles` so that later runs need not measure
+ * again. There is no calibration of XPU devices: their profile must be
+ * supplied in the file, e.g. fitted from kernel timings of a profiler.
+ *
+ */
+class DeviceProfile {
+ public:
+  struct Coefficients {
+    // Ops or bytes per second.
+    float throughput = 0.0f;
+    // Fixed cost in seconds paid by every kernel invocation.
+    float overhead = 0.0f;
+  };
+
+  DeviceProfile() = default;
+
+  /**
+   * @brief The profile has coefficients for all the op kinds.
+   *
+   * @return true
+   * @return false
+   */
+  bool isCalibrated() const;
+
+  const Coefficients& getCoefficients(ProfiledOpKind kind) const {
+    return coefficients_[static_cast<size_t>(kind)];
+  }
+
+  void setCoefficients(ProfiledOpKind kind, const Coefficients& coefficients) {
+    coefficients_[static_cast<size_t>(kind)] = coefficients;
+  }
+
+  /**
+   * @brief Time in seconds of one kernel of `kind` doing `work` ops or bytes.
+   *
+   * @param kind
+   * @param work
+   * @return float
+   */
+  float getTime(ProfiledOpKind kind, float work) const;
+
+  bool operator==(const DeviceProfile& rhs) const;
+  bool operator!=(const DeviceProfile& rhs) const { return !(*this == rhs); }
+
+ private:
+  std::array<Coefficients, static_cast<size_t>(ProfiledOpKind::NUM_KINDS)>
+      coefficients_;
+};
+
+/**
+ * @brief Device profiles keyed by device type, e.g., "CPU" or "XPU".
+ *
+ */
+using DeviceProfileMap = std::map<std::string, DeviceProfile>;
+
+/**
+ * @brief Compute bound kernels timed by `calibrateCpuProfile`. The profile
+ * has to reflect the kernels the framework runs, so they are provided by the
+ * caller, e.g. through its GEMM library. Each factory sets up the operands of
+ * one size and returns a function running the kernel once.
+ *
+ */
+struct CalibrationKernels {
+  // Multiplication of two n x n matrices.
+  std::function<std::function<void()>(size_t n)> matmul;
+  // 3x3 convolution with stride 1 and valid padding of a [1, hw, hw, channels]
+  // NHWC input to `channels` output channels.
+  std::function<std::function<void()>(size_t hw, size_t channels)> conv;
+};
+
+/**
+ * @brief Run microbenchmarks of matmul, conv, elementwise and reduction kernels
+ * at several sizes on the local CPU, and fit the coefficients of each op kind
+ * with least squares. Matmul and conv run `kernels`, elementwise and reduction
+ * run stream loops on `num_threads` threads.
+ *
+ * @param kernels
+ * @param num_threads
+ * @return DeviceProfile
+ */
+DeviceProfile calibrateCpuProfile(const CalibrationKernels& kernels,
+                                  size_t num_threads);
+
+/**
+ * @brief Fit time = overhead + work / throughput with least squares over
+ * (work, time) samples. If the samples show no fixed cost, e.g. all sizes fit
+ * in cache, the overhead is 0 and the throughput is the best observed one.
+ *
+ * @param samples
+ * @return DeviceProfile::Coefficients
+ */
+DeviceProfile::Coefficients fitCoefficients(
+    const std::vector<std::pair<float, float>>& samples);
+
+/**
+ * @brief Load device profiles from a text file written by
+ * `saveDeviceProfiles`.
+ *
+ * @param path
+ * @param profiles The loaded profiles are merged into it.
+ * @return true Profiles loaded successfully
+ * @return false The file cannot be read or is malformed
+ */
+bool loadDeviceProfiles(const std::string& path, DeviceProfileMap* profiles);
+
+/**
+ * @brief Save device profiles to a text file.
+ *
+ * @param path
+ * @param profiles
+ * @return true Profiles saved successfully
+ * @return false The file cannot be written
+ */
+bool saveDeviceProfiles(const std::string& path,
+                        const DeviceProfileMap& profiles);
+
+}  // namespace as
@@ -0,0 +1,174 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <any>
+#include <functional>
+#include <vector>
+
+#include "xpuautoshard/common/device_info.h"
+
+namespace as {
+
+enum class PipelinePhase {
+  FORWARD = 0,
+  BACKWARD,
+};
+
+/**
+ * @brief One step a pipeline stage runs: the forward or backward pass of a
+ * micro-batch.
+ *
+ */
+struct PipelineStep {
+  PipelinePhase phase;
+  size_t micro_batch;
+};
+
+/**
+ * @brief The ordered steps of each stage.
+ *
+ */
+using PipelineSchedule = std::vector<std::vector<PipelineStep>>;
+
+/**
+ * @brief Build the schedule of `num_stages` stages over `num_micro_batches`
+ * micro-batches. For training, the schedule is one-forward-one-backward
+ * (1F1B): stage `s` warms up with `num_stages - s - 1` forwards, then
+ * alternates a forward and a backward, and drains the remaining backwards.
+ * This bounds the in-flight activations of a stage by the number of stages
+ * instead of the number of micro-batches. For inference, every stage runs
+ * the forwards in order.
+ *
+ * @param num_stages
+ * @param num_micro_batches
+ * @param training
+ * @return PipelineSchedule
+ */
+PipelineSchedule buildPipelineSchedule(size_t num_stages,
+                                       size_t num_micro_batches,
+                                       bool training);
+
+/**
+ * @brief A stage of a stage-split graph.
+ *
+ */
+struct PipelineStage {
+  /**
+   * @brief Compute the stage on the input activation of a micro-batch and
+   * return the activation passed to the next stage.
+   *
+   */
+  std::function<std::any(size_t micro_batch, std::any input)> forward;
+
+  /**
+   * @brief Compute the gradient w.r.t. the stage input from the gradient
+   * w.r.t. the stage output. The last stage gets its own forward output as
+   * the gradient since the loss lives there. Only needed for training.
+   *
+   */
+  std::function<std::any(size_t micro_batch, std::any grad)> backward;
+
+  /**
+   * @brief The NUMA node the worker thread of the stage is bound to, usually
+   * `Device::getNumaNode()` of the CPU device the stage is placed on.
+   *
+   */
+  int numa_node = Device::NO_NUMA_AFFINITY;
+};
+
+/**
+ * @brief Statistics of a stage in the last run, times in seconds.
+ *
+ */
+struct PipelineStageStats {
+  // Time spent computing steps.
+  float busy_time = 0.0f;
+  // Time spent waiting for activations or gradients, or for room in a full
+  // queue, including the pipeline fill and drain bubbles.
+  float idle_time = 0.0f;
+  size_t num_steps = 0;
+
+  float getUtilization() const {
+    float total = busy_time + idle_time;
+    return total > 0 ? busy_time / total : 0.0f;
+  }
+};
+
+/**
+ * @brief Statistics of the last pipeline run.
+ *
+ */
+struct PipelineStats {
+  float wall_time = 0.0f;
+  std::vector<PipelineStageStats> stages;
+
+  /**
+   * @brief The share of stage time not spent computing.
+   *
+   * @return float
+   */
+  float getBubbleRatio() const;
+};
+
+/**
+ * @brief Run a stage-split graph over micro-batches with each stage on its own
+ * worker thread, so that stages work on different micro-batches at the same
+ * time. Adjacent stages exchange activations and gradients through bounded
+ * single-producer single-consumer lock-free queues.
+ *
+ */
+class PipelineScheduler {
+ public:
+  /**
+   * @brief Construct a new Pipeline Scheduler object
+   *
+   * @param stages
+   * @param queue_capacity The maximum number of activations buffered between
+   * two adjacent stages. 0 means the number of stages which is deadlock free
+   * for the 1F1B schedule.
+   */
+  explicit PipelineScheduler(const std::vector<PipelineStage>& stages,
+                             size_t queue_capacity = 0);
+
+  /**
+   * @brief Run the micro-batches through the pipeline. The exception thrown
+   * by any stage stops all stages and is rethrown.
+   *
+   * @param micro_batch_inputs The inputs of the first stage.
+   * @param training Run 1F1B with backward passes if true, otherwise forward
+   * passes only.
+   * @return std::vector<std::any> The outputs of the last stage forward per
+   * micro-batch for inference, or the outputs of the first stage backward per
+   * micro-batch for training.
+   */
+  std::vector<std::any> run(const std::vector<std::any>& micro_batch_inputs,
+                            bool training = false);
+
+  /**
+   * @brief Statistics of the last `run`.
+   *
+   * @return const PipelineStats&
+   */
+  const PipelineStats& getStats() const { return stats_; }
+
+ private:
+  std::vector<PipelineStage> stages_;
+  size_t queue_capacity_;
+  PipelineStats stats_;
+};
+
+}  // namespace as
@@ -61,6 +61,10 @@ QuantitativeComputeCharacteristics::operator+=(
   num_int8_ops_ += rhs.num_int8_ops_;
   memory_load_bytes_ += rhs.memory_load_bytes_;
   memory_store_bytes_ += rhs.memory_store_bytes_;
+  for (size_t i = 0; i < kNumKinds; i++) {
+    kernel_work_[i] += rhs.kernel_work_[i];
+    num_kernels_[i] += rhs.num_kernels_[i];
+  }
   return *this;
 }
 
@@ -102,6 +106,24 @@ QualitativeComputeCharacteristics::operator+=(
   return *this;
 }
 
+AnalyticCostModel::AnalyticCostModel(const DeviceProfile& profile)
+    : device_cap_(
+          // Only fp32 is measured, so the other data types assume the same.
+          profile.getCoefficients(ProfiledOpKind::MATMUL).throughput,
+          profile.getCoefficients(ProfiledOpKind::MATMUL).throughput,
+          profile.getCoefficients(ProfiledOpKind::MATMUL).throughput,
+          profile.getCoefficients(ProfiledOpKind::MATMUL).throughput,
+          profile.getCoefficients(ProfiledOpKind::ELEMENTWISE).throughput),
+      profile_(profile),
+      use_profile_(profile.isCalibrated()) {}
+
+Ref<AnalyticCostModel> AnalyticCostModel::create(const Device& device) {
+  if (device.hasProfile()) {
+    return makeRef<AnalyticCostModel>(device.getProfile());
+  }
+  return makeRef<AnalyticCostModel>(device.getComputeCapability());
+}
+
 ComputeCharacterizerRef AnalyticCostModel::createComputeCharacterizer() {
   return makeRef<AnalyticComputeCharacterizer, ComputeCharacterizer>();
 }
@@ -140,6 +162,9 @@ CostModel::TimeCost AnalyticCostModel::evaluateTime(
     auto&& quan_comp_ch =
         downcastRef<QuantitativeComputeCharacteristics>(comp_ch);
     assert(quan_comp_ch && "Expect QuantitativeComputeCharacteristics");
+    if (use_profile_) {
+      return evaluateTimeProfiled(quan_comp_ch);
+    }
     return (evaluateTimeFloat(quan_comp_ch) +
             evaluateTimeBfloat16(quan_comp_ch) +
             evaluateTimeFloat16(quan_comp_ch) + evaluateTimeInt8(quan_comp_ch) +
@@ -147,6 +172,18 @@ CostModel::TimeCost AnalyticCostModel::evaluateTime(
   }
 }
 
+CostModel::TimeCost AnalyticCostModel::evaluateTimeProfiled(
+    QuantitativeComputeCharacteristicsRef comp_ch) {
+  TimeCost time = 0;
+  for (size_t i = 0; i < static_cast<size_t>(ProfiledOpKind::NUM_KINDS); i++) {
+    auto kind = static_cast<ProfiledOpKind>(i);
+    auto&& coefficients = profile_.getCoefficients(kind);
+    time += comp_ch->getNumKernels(kind) * coefficients.overhead +
+            comp_ch->getKernelWork(kind) / coefficients.throughput;
+  }
+  return time;
+}
+
 CostModel::TimeCost AnalyticCostModel::evaluateTimeFloat(
     QuantitativeComputeCharacteristicsRef comp_ch) {
   return comp_ch->getNumFloatOps() / device_cap_.getFloatOPS();
@@ -214,13 +251,16 @@ ComputeCharacteristicsRef AnalyticComputeCharacterizer::characterize(
              op_desc->getName().find("tfg.", 0) !=
                  0  // not start with tfg namespace
   ) {
-    // zero
-    return makeRef<QuantitativeComputeCharacteristics>();
+    return characterizeZeroOp();
   } else {
     return characterizeMemoryOp(op_desc);
   }
 }
 
+ComputeCharacteristicsRef AnalyticComputeCharacterizer::characterizeZeroOp() {
+  return makeRef<QuantitativeComputeCharacteristics>();
+}
+
 ComputeCharacteristicsRef AnalyticComputeCharacterizer::characterizeMemoryOp(
     OpDescRef op_desc) {
   auto analytic_ch = makeRef<QuantitativeComputeCharacteristics>();
@@ -238,6 +278,14 @@ ComputeCharacteristicsRef AnalyticComputeCharacterizer::characterizeMemoryOp(
                    op_desc->getResult(i).getNumElements(), true);
     }
   }
+  auto&& name = op_desc->getName();
+  bool is_reduction = name == "tfg.Sum" || name == "tfg.Mean" ||
+                      name == "tfg.Max" || name == "tfg.Min" ||
+                      name == "tfg.Prod" || name == "tfg.ArgMax" ||
+                      name == "tfg.L2Loss";
+  analytic_ch->addKernel(
+      is_reduction ? ProfiledOpKind::REDUCTION : ProfiledOpKind::ELEMENTWISE,
+      analytic_ch->getMemoryLoadBytes() + analytic_ch->getMemoryStoreBytes());
   return analytic_ch;
 }
 
@@ -329,6 +377,7 @@ ComputeCharacteristicsRef AnalyticComputeCharacterizer::characterizeConvForward(
                   (rank > 4 ? op_desc->getResult(0).getDimSize(1) : 1)});
   auto analytic_ch = makeRef<QuantitativeComputeCharacteristics>();
   addMultiplyAddComputeOps(analytic_ch, dtype, ops);
+  analytic_ch->addKernel(ProfiledOpKind::CONV, ops);
   return analytic_ch;
 }
 
@@ -353,6 +402,7 @@ AnalyticComputeCharacterizer::characterizeConvBackwardData(OpDescRef op_desc) {
                   (rank > 4 ? op_desc->getResult(0).getDimSize(1) : 1)});
   auto analytic_ch = makeRef<QuantitativeComputeCharacteristics>();
   addMultiplyAddComputeOps(analytic_ch, dtype, ops);
+  analytic_ch->addKernel(ProfiledOpKind::CONV, ops);
   return analytic_ch;
 }
 
@@ -378,6 +428,7 @@ AnalyticComputeCharacterizer::characterizeConvBackwardWeight(
                   (rank > 4 ? op_desc->getOperand(2).getDimSize(1) : 1)});
   auto analytic_ch = makeRef<QuantitativeComputeCharacteristics>();
   addMultiplyAddComputeOps(analytic_ch, dtype, ops);
+  analytic_ch->addKernel(ProfiledOpKind::CONV, ops);
   return analytic_ch;
 }
 
@@ -390,8 +441,12 @@ ComputeCharacteristicsRef AnalyticComputeCharacterizer::characterizeMatMul(
   int64_t k_dim = op_desc->getAttrBool("transpose_a") ? 0 : 1;
   int64_t n_dim = op_desc->getAttrBool("transpose_b") ? 0 : 1;
   DataType dtype = op_desc->getOperand(0).getElementType();
+  float ops = 2.0f * op_desc->getOperand(0).getDimSize(m_dim) *
+              op_desc->getOperand(0).getDimSize(k_dim) *
+              op_desc->getOperand(1).getDimSize(n_dim);
   auto analytic_ch = makeRef<QuantitativeComputeCharacteristics>();
-  addMultiplyAddComputeOps(analytic_ch, dtype, 2.0f * m_dim * k_dim * n_dim);
+  addMultiplyAddComputeOps(analytic_ch, dtype, ops);
+  analytic_ch->addKernel(ProfiledOpKind::MATMUL, ops);
   return analytic_ch;
 }
 }  // namespace as
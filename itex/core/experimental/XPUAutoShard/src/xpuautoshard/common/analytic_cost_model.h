@@ -14,10 +14,12 @@ limitations under the License.
 ==============================================================================*/
 
 #pragma once
+#include <array>
 #include <vector>
 
 #include "xpuautoshard/common/cost_model.h"
 #include "xpuautoshard/common/device_info.h"
+#include "xpuautoshard/common/device_profile.h"
 
 namespace as {
 
@@ -39,7 +41,9 @@ class QuantitativeComputeCharacteristics : public ComputeCharacteristics {
         num_float16_ops_(0),
         num_int8_ops_(0),
         memory_load_bytes_(0),
-        memory_store_bytes_(0) {}
+        memory_store_bytes_(0),
+        kernel_work_{},
+        num_kernels_{} {}
 
   /**
    * @brief Sum up the compute characteristics in `rhs` to this.
@@ -104,13 +108,49 @@ class QuantitativeComputeCharacteristics : public ComputeCharacteristics {
 
   void setMemoryStoreBytes(float bytes) { memory_store_bytes_ = bytes; }
 
+  /**
+   * @brief Record a kernel of `kind` doing `work` multiply-add ops (compute
+   * bound kinds) or bytes (memory bound kinds), for the evaluation with a
+   * measured device profile.
+   *
+   * @param kind
+   * @param work
+   */
+  void addKernel(ProfiledOpKind kind, float work) {
+    kernel_work_[static_cast<size_t>(kind)] += work;
+    num_kernels_[static_cast<size_t>(kind)] += 1;
+  }
+
+  /**
+   * @brief Get the total work of the kernels of `kind`
+   *
+   * @return float
+   */
+  float getKernelWork(ProfiledOpKind kind) const {
+    return kernel_work_[static_cast<size_t>(kind)];
+  }
+
+  /**
+   * @brief Get the number of kernels of `kind`
+   *
+   * @return float
+   */
+  float getNumKernels(ProfiledOpKind kind) const {
+    return num_kernels_[static_cast<size_t>(kind)];
+  }
+
  private:
+  static constexpr size_t kNumKinds =
+      static_cast<size_t>(ProfiledOpKind::NUM_KINDS);
+
   float num_float_ops_;
   float num_bfloat16_ops_;
   float num_float16_ops_;
   float num_int8_ops_;
   float memory_load_bytes_;
   float memory_store_bytes_;
+  std::array<float, kNumKinds> kernel_work_;
+  std::array<float, kNumKinds> num_kernels_;
 };
 
 using QuantitativeComputeCharacteristicsRef =
@@ -233,6 +273,14 @@ class AnalyticComputeCharacterizer : public ComputeCharacterizer {
    */
   ComputeCharacteristicsRef characterizeMemoryOp(OpDescRef op_desc);
 
+  /**
+   * @brief Characterize an op with no compute or memory traffic of its own,
+   * e.g., ops reading the static shape.
+   *
+   * @return ComputeCharacteristicsRef
+   */
+  ComputeCharacteristicsRef characterizeZeroOp();
+
   /**
    * @brief Add memory ops to the `analytic_ch`
    *
@@ -272,11 +320,38 @@ class AnalyticCostModel : public CostModel {
   explicit AnalyticCostModel(const DeviceComputeCapability& device_cap)
       : device_cap_(device_cap) {}
 
+  /**
+   * @brief Evaluate with the measured coefficients of `profile` instead of the
+   * nominal compute capability. The time cost is in seconds.
+   *
+   * @param profile A calibrated device profile
+   */
+  explicit AnalyticCostModel(const DeviceProfile& profile);
+
+  /**
+   * @brief Create the cost model of `device`, from its measured profile if it
+   * has one, otherwise from its compute capability.
+   *
+   * @param device
+   * @return Ref<AnalyticCostModel>
+   */
+  static Ref<AnalyticCostModel> create(const Device& device);
+
   ComputeCharacterizerRef createComputeCharacterizer() override;
   TimeCost evaluateTime(ComputeCharacteristicsRef comp_ch) override;
 
  private:
   DeviceComputeCapability device_cap_;
+  DeviceProfile profile_;
+  bool use_profile_ = false;
+
+  /**
+   * @brief Evaluate the time with the measured per-kernel coefficients
+   *
+   * @param comp_ch
+   * @return TimeCost
+   */
+  TimeCost evaluateTimeProfiled(QuantitativeComputeCharacteristicsRef comp_ch);
 
   /**
    * @brief Evaluate time cost qualitatively.
@@ -52,9 +52,27 @@ const Device& DeviceInfo::getDevice(DeviceId id) const {
   }
 }
 
+std::vector<std::vector<size_t>> DeviceInfo::groupByNumaNode(
+    const std::vector<DeviceId>& device_ids) const {
+  std::vector<int> numa_nodes;
+  std::vector<std::vector<size_t>> groups;
+  for (size_t i = 0; i < device_ids.size(); i++) {
+    int numa_node = getDevice(device_ids[i]).getNumaNode();
+    auto iter = std::find(numa_nodes.begin(), numa_nodes.end(), numa_node);
+    if (numa_node == Device::NO_NUMA_AFFINITY || iter == numa_nodes.end()) {
+      numa_nodes.push_back(numa_node);
+      groups.push_back({i});
+    } else {
+      groups[iter - numa_nodes.begin()].push_back(i);
+    }
+  }
+  return groups;
+}
+
 bool Device::operator==(const Device& rhs) const {
   return getId() == rhs.getId() && getName() == rhs.getName() &&
-         getScore() == rhs.getScore();
+         getScore() == rhs.getScore() && getNumaNode() == rhs.getNumaNode() &&
+         getProfile() == rhs.getProfile();
 }
 
 bool Device::operator!=(const Device& rhs) const { return !(*this == rhs); }
@@ -0,0 +1,240 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xpuautoshard/common/device_profile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "xpuautoshard/common/parallel_for.h"
+
+namespace as {
+
+namespace {
+
+const char* const kOpKindNames[] = {"matmul", "conv", "elementwise",
+                                    "reduction"};
+static_assert(sizeof(kOpKindNames) / sizeof(kOpKindNames[0]) ==
+                  static_cast<size_t>(ProfiledOpKind::NUM_KINDS),
+              "Expect a name for each profiled op kind");
+
+constexpr int kRepeats = 3;
+
+/**
+ * @brief The best of `kRepeats` runs after a warm-up, in seconds.
+ *
+ */
+float measure(const std::function<void()>& fn) {
+  fn();
+  float best = std::numeric_limits<float>::max();
+  for (int i = 0; i < kRepeats; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<float> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+DeviceProfile::Coefficients calibrateMatMul(
+    const CalibrationKernels& kernels) {
+  std::vector<std::pair<float, float>> samples;
+  for (size_t n : {64, 128, 256, 384, 512}) {
+    samples.emplace_back(2.0f * n * n * n, measure(kernels.matmul(n)));
+  }
+  return fitCoefficients(samples);
+}
+
+DeviceProfile::Coefficients calibrateConv(const CalibrationKernels& kernels) {
+  constexpr size_t kKernel = 3;
+  std::vector<std::pair<float, float>> samples;
+  for (auto&& [hw, channels] : std::vector<std::pair<size_t, size_t>>{
+           {14, 32}, {28, 32}, {14, 64}, {28, 64}, {56, 32}}) {
+    size_t out_hw = hw - kKernel + 1;
+    samples.emplace_back(
+        2.0f * out_hw * out_hw * channels * channels * kKernel * kKernel,
+        measure(kernels.conv(hw, channels)));
+  }
+  return fitCoefficients(samples);
+}
+
+DeviceProfile::Coefficients calibrateElementwise(size_t num_threads) {
+  // Stream triad: a = b + s * c
+  std::vector<std::pair<float, float>> samples;
+  for (size_t n : {1 << 16, 1 << 18, 1 << 20, 1 << 22, 1 << 24}) {
+    std::vector<float> a(n), b(n, 1.0f), c(n, 2.0f);
+    float time = measure([&]() {
+      parallelFor(num_threads, n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          a[i] = b[i] + 0.5f * c[i];
+        }
+      });
+    });
+    samples.emplace_back(3.0f * sizeof(float) * n, time);
+  }
+  return fitCoefficients(samples);
+}
+
+DeviceProfile::Coefficients calibrateReduction(size_t num_threads) {
+  std::vector<std::pair<float, float>> samples;
+  for (size_t n : {1 << 16, 1 << 18, 1 << 20, 1 << 22, 1 << 24}) {
+    std::vector<float> a(n, 1.0f);
+    std::vector<float> partials(num_threads);
+    volatile float result = 0.0f;
+    float time = measure([&]() {
+      size_t block = (n + num_threads - 1) / num_threads;
+      parallelFor(num_threads, n, [&](size_t begin, size_t end) {
+        float sum = 0.0f;
+        for (size_t i = begin; i < end; i++) {
+          sum += a[i];
+        }
+        partials[begin / block] = sum;
+      });
+      float total = 0.0f;
+      for (float partial : partials) total += partial;
+      result = total;
+    });
+    (void)result;
+    samples.emplace_back(1.0f * sizeof(float) * n, time);
+  }
+  return fitCoefficients(samples);
+}
+
+}  // anonymous namespace
+
+bool DeviceProfile::isCalibrated() const {
+  for (auto&& coefficients : coefficients_) {
+    if (coefficients.throughput <= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+float DeviceProfile::getTime(ProfiledOpKind kind, float work) const {
+  auto&& coefficients = getCoefficients(kind);
+  return coefficients.overhead + work / coefficients.throughput;
+}
+
+bool DeviceProfile::operator==(const DeviceProfile& rhs) const {
+  for (size_t i = 0; i < coefficients_.size(); i++) {
+    if (coefficients_[i].throughput != rhs.coefficients_[i].throughput ||
+        coefficients_[i].overhead != rhs.coefficients_[i].overhead) {
+      return false;
+    }
+  }
+  return true;
+}
+
+DeviceProfile::Coefficients fitCoefficients(
+    const std::vector<std::pair<float, float>>& samples) {
+  double n = samples.size();
+  double sum_w = 0, sum_t = 0, sum_ww = 0, sum_wt = 0;
+  double best_rate = 0;
+  for (auto&& sample : samples) {
+    sum_w += sample.first;
+    sum_t += sample.second;
+    sum_ww += 1.0 * sample.first * sample.first;
+    sum_wt += 1.0 * sample.first * sample.second;
+    best_rate = std::max(best_rate, 1.0 * sample.first / sample.second);
+  }
+  double denominator = n * sum_ww - sum_w * sum_w;
+  double slope = denominator > 0 ? (n * sum_wt - sum_w * sum_t) / denominator
+                                 : 0.0;
+  DeviceProfile::Coefficients coefficients;
+  if (slope <= 0) {
+    // Noisy samples, e.g. all sizes fit in cache: no fixed cost observable.
+    coefficients.throughput = best_rate;
+    coefficients.overhead = 0.0f;
+  } else {
+    coefficients.throughput = 1.0 / slope;
+    coefficients.overhead = std::max(0.0, (sum_t - slope * sum_w) / n);
+  }
+  return coefficients;
+}
+
+DeviceProfile calibrateCpuProfile(const CalibrationKernels& kernels,
+                                  size_t num_threads) {
+  num_threads = std::max<size_t>(1, num_threads);
+  DeviceProfile profile;
+  profile.setCoefficients(ProfiledOpKind::MATMUL, calibrateMatMul(kernels));
+  profile.setCoefficients(ProfiledOpKind::CONV, calibrateConv(kernels));
+  profile.setCoefficients(ProfiledOpKind::ELEMENTWISE,
+                          calibrateElementwise(num_threads));
+  profile.setCoefficients(ProfiledOpKind::REDUCTION,
+                          calibrateReduction(num_threads));
+  return profile;
+}
+
+// The file has one line per device type and op kind:
+//   <device type> <op kind> <throughput> <overhead>
+bool loadDeviceProfiles(const std::string& path, DeviceProfileMap* profiles) {
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream fields(line);
+    std::string device_type, kind_name;
+    DeviceProfile::Coefficients coefficients;
+    if (!(fields >> device_type >> kind_name >> coefficients.throughput >>
+          coefficients.overhead)) {
+      return false;
+    }
+    auto kind_iter = std::find(std::begin(kOpKindNames),
+                               std::end(kOpKindNames), kind_name);
+    if (kind_iter == std::end(kOpKindNames)) {
+      return false;
+    }
+    (*profiles)[device_type].setCoefficients(
+        static_cast<ProfiledOpKind>(kind_iter - std::begin(kOpKindNames)),
+        coefficients);
+  }
+  return true;
+}
+
+bool saveDeviceProfiles(const std::string& path,
+                        const DeviceProfileMap& profiles) {
+  std::ofstream out(path);
+  if (!out) {
+    return false;
+  }
+  // Enough digits to load back the same floats.
+  out.precision(std::numeric_limits<float>::max_digits10);
+  out << "# <device type> <op kind> <throughput> <overhead seconds>\n";
+  for (auto&& [device_type, profile] : profiles) {
+    for (size_t i = 0; i < static_cast<size_t>(ProfiledOpKind::NUM_KINDS);
+         i++) {
+      auto&& coefficients =
+          profile.getCoefficients(static_cast<ProfiledOpKind>(i));
+      out << device_type << " " << kOpKindNames[i] << " "
+          << coefficients.throughput << " " << coefficients.overhead << "\n";
+    }
+  }
+  return static_cast<bool>(out);
+}
+
+}  // namespace as
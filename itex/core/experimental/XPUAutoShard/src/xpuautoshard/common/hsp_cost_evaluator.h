@@ -61,35 +61,60 @@ class HspCostEvaluator {
    */
   virtual ScoreRef evaluate(GraphRef graph,
                             HspAnnotationRef annotation = nullptr) = 0;
+
+  /**
+   * @brief Evaluate the score like `evaluate` but allow giving up early once
+   * the score is known to be lower than `bound`. A pruned evaluation returns
+   * a score lower than `bound` that is not necessarily the exact score. The
+   * default implementation never prunes. Implementations are expected to be
+   * safe to call concurrently from multiple threads.
+   *
+   * @param graph
+   * @param annotation
+   * @param bound
+   * @return ScoreRef
+   */
+  virtual ScoreRef evaluateWithBound(GraphRef graph,
+                                     HspAnnotationRef annotation,
+                                     const ScoreRef& bound) {
+    return evaluate(graph, annotation);
+  }
 };
 
 using HspCostEvaluatorRef = Ref<HspCostEvaluator>;
 
 /**
- * @brief A dummy cost model that always returns the minimal score
+ * @brief A score represented by a float
  *
  */
-class DummyHspCostEvaluator : public HspCostEvaluator {
- private:
-  class FloatScore : public Score {
-   public:
-    explicit FloatScore(float score = std::numeric_limits<float>::lowest())
-        : score_(score) {}
+class FloatScore : public Score {
+ public:
+  explicit FloatScore(float score = std::numeric_limits<float>::lowest())
+      : score_(score) {}
 
-    bool operator==(const Score& rhs) override {
-      const auto& float_rhs = dynamic_cast<const FloatScore&>(rhs);
-      return score_ == float_rhs.score_;
-    }
+  bool operator==(const Score& rhs) override {
+    const auto& float_rhs = dynamic_cast<const FloatScore&>(rhs);
+    return score_ == float_rhs.score_;
+  }
+
+  bool operator<(const Score& rhs) override {
+    const auto& float_rhs = dynamic_cast<const FloatScore&>(rhs);
+    return score_ < float_rhs.score_;
+  }
 
-    bool operator<(const Score& rhs) override {
-      const auto& float_rhs = dynamic_cast<const FloatScore&>(rhs);
-      return score_ < float_rhs.score_;
-    }
+  float getValue() const { return score_; }
+
+ private:
+  float score_;
+};
 
-   private:
-    float score_;
-  };
+using FloatScoreRef = Ref<FloatScore>;
 
+/**
+ * @brief A dummy cost model that always returns the minimal score
+ *
+ */
+class DummyHspCostEvaluator : public HspCostEvaluator {
  public:
   DummyHspCostEvaluator() {}
 
@@ -15,22 +15,60 @@ limitations under the License.
 
 #include "xpuautoshard/common/hsp_tuner.h"
 
+#include <algorithm>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "xpuautoshard/common/parallel_for.h"
+
 namespace as {
 
 HspAnnotationRef HspTuner::tune(GraphRef graph) {
   auto&& cost_model = getCostModel();
   auto&& best_score = cost_model->lowestScore();
   HspAnnotationRef best_annotation;
+  size_t num_threads = std::max<size_t>(1, getNumThreads());
+  bool parallel_annotate = isAnnotatorThreadSafe();
   do {
-    (void)nextState();
-    auto&& hsp_annotator = createAnnotator();
-    auto&& annot = hsp_annotator->annotate(graph);
-    auto&& score = cost_model->evaluate(graph, annot);
-    if (*best_score < *score) {
-      best_score = score;
-      best_annotation = annot;
+    auto&& states = nextStates(num_threads);
+    std::vector<HspAnnotationRef> annots(states.size());
+    std::vector<ScoreRef> scores(states.size());
+    if (!parallel_annotate) {
+      for (size_t i = 0; i < states.size(); i++) {
+        annots[i] = createAnnotator(states[i])->annotate(graph);
+      }
+    }
+    // The pruning bound is tightened as soon as any candidate finishes so
+    // that the remaining candidates can give up early against it.
+    std::mutex bound_mutex;
+    ScoreRef bound = best_score;
+    parallelFor(num_threads, states.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        if (parallel_annotate) {
+          annots[i] = createAnnotator(states[i])->annotate(graph);
+        }
+        ScoreRef current_bound;
+        {
+          std::lock_guard<std::mutex> lock(bound_mutex);
+          current_bound = bound;
+        }
+        scores[i] =
+            cost_model->evaluateWithBound(graph, annots[i], current_bound);
+        std::lock_guard<std::mutex> lock(bound_mutex);
+        if (*bound < *scores[i]) {
+          bound = scores[i];
+        }
+      }
+    });
+    // Pick the best in the order of the states to stay deterministic no
+    // matter how the candidates are scheduled on threads.
+    for (size_t i = 0; i < states.size(); i++) {
+      if (*best_score < *scores[i]) {
+        best_score = scores[i];
+        best_annotation = annots[i];
+      }
+      updateScore(scores[i], states[i]);
     }
-    updateScore(score);
   } while (!stopCriterionMet());
   return best_annotation;
 }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #pragma once
 #include <memory>
+#include <vector>
 
 #include "xpuautoshard/common/hsp_annotator.h"
 #include "xpuautoshard/common/hsp_cost_evaluator.h"
@@ -67,6 +68,36 @@ class HspTuner {
    */
   virtual TuningStateRef nextState() = 0;
 
+  /**
+   * @brief Identify up to `max_num_states` tuning states that can be
+   * evaluated independently of each other. The default implementation
+   * returns the single state of `nextState()`. Tuners that can enumerate
+   * candidates ahead of their scores override it so that `tune` evaluates
+   * them in parallel.
+   *
+   * @param max_num_states
+   * @return std::vector<TuningStateRef>
+   */
+  virtual std::vector<TuningStateRef> nextStates(size_t max_num_states) {
+    return {nextState()};
+  }
+
+  /**
+   * @brief The number of threads `tune` uses to evaluate tuning states.
+   *
+   * @return size_t
+   */
+  virtual size_t getNumThreads() { return 1; }
+
+  /**
+   * @brief Whether annotators created by this tuner may annotate the graph
+   * concurrently. Otherwise only the cost evaluation runs in parallel.
+   *
+   * @return true
+   * @return false
+   */
+  virtual bool isAnnotatorThreadSafe() { return false; }
+
   /**
    * @brief Update the score corresponding to the given `tuning_state`. If the
    * `tuning_state` is nullptr, the current tuning state is implied.
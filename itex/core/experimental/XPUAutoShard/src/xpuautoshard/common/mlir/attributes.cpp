@@ -142,7 +142,11 @@ void DeviceInfoAttr::print(::mlir::AsmPrinter& printer) const {
   llvm::raw_ostream& os = printer.getStream();
   for (auto device : info.getDevices()) {
     os << "[" << device.getId() << "]" << device.getName() << ":"
-       << device.getScore() << ",";
+       << device.getScore();
+    if (device.getNumaNode() != as::Device::NO_NUMA_AFFINITY) {
+      os << "@numa" << device.getNumaNode();
+    }
+    os << ",";
   }
   // TODO(itex) : finish this
 
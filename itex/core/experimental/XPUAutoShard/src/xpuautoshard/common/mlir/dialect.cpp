@@ -49,7 +49,7 @@ namespace llvm {
 
 ::llvm::hash_code hash_value(const as::Device& device) {
   return ::llvm::hash_combine(device.getId(), device.getName(),
-                              device.getScore());
+                              device.getScore(), device.getNumaNode());
 }
 
 ::llvm::hash_code hash_value(const as::DeviceInfo& info) {
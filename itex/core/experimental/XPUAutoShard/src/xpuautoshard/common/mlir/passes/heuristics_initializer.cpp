@@ -309,16 +309,22 @@ std::vector<float> HeuristicsInitializer::getSplitRatios(Operation* root_op) {
   float total_score = 0;
   for (auto device : device_info_.getDevices()) {
     float score = device.getScore();
-    if (score < 0) {
-      auto cost_model =
-          as::makeRef<as::AnalyticCostModel>(device.getComputeCapability());
+    // A measured profile overrides the configured score.
+    if (score < 0 || device.hasProfile()) {
+      auto cost_model = as::AnalyticCostModel::create(device);
       auto compute_characterizer = cost_model->createComputeCharacterizer();
       auto time_cost = cost_model->evaluateTime(
           compute_characterizer->characterize(mlirGraphToGraphHandle(root_op)));
       score = 1 / time_cost;
     }
     scores.push_back(score);
-    total_score += score;
+  }
+  auto&& weights = heuristics_config_.getSplitRatioWeights();
+  for (size_t i = 0; i < scores.size(); i++) {
+    if (weights.size() == scores.size()) {
+      scores[i] *= weights[i];
+    }
+    total_score += scores[i];
   }
   for (auto score : scores) {
     ratios.push_back(score / total_score);
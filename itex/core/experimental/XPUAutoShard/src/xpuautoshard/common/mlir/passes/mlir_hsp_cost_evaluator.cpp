@@ -0,0 +1,78 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xpuautoshard/common/mlir/passes/mlir_hsp_cost_evaluator.h"
+
+#include <map>
+
+#include "xpuautoshard/common/analytic_cost_model.h"
+#include "xpuautoshard/common/mlir/passes/mlir_hsp_annotator.h"
+#include "xpuautoshard/common/mlir/passes/pass_utils.h"
+
+namespace mlir {
+namespace hs {
+
+using as::AnalyticCostModel;
+using as::DeviceId;
+using as::ShardingPropertyRef;
+
+namespace {
+
+std::map<DeviceId, as::CostModelRef> createCostModels(
+    const as::DeviceInfo& device_info) {
+  std::map<DeviceId, as::CostModelRef> cost_models;
+  for (auto&& device : device_info.getDevices()) {
+    cost_models[device.getId()] = AnalyticCostModel::create(device);
+  }
+  return cost_models;
+}
+
+}  // anonymous namespace
+
+MLIRHspCostEvaluator::MLIRHspCostEvaluator(as::GraphRef graph,
+                                           const as::DeviceInfo& device_info)
+    : as::ProfiledHspCostEvaluator(createCostModels(device_info)),
+      mlir_graph_(as::downcastRef<MLIRGraph>(graph)) {
+  auto characterizer = as::makeRef<as::AnalyticComputeCharacterizer>();
+  Operation* root_op = mlir_graph_->getRoot();
+  for (Region& region : root_op->getRegions()) {
+    for (Block& block : region.getBlocks()) {
+      for (Operation& op : block.getOperations()) {
+        if (!isFrameworkOp(&op) || op.getNumResults() == 0) {
+          continue;
+        }
+        auto&& comp_ch = characterizer->characterize(mlirOpToOpDesc(&op));
+        if (as::isRef<as::UnknownComputeCharacteristics>(comp_ch)) {
+          continue;
+        }
+        ops_.push_back(&op);
+        addOp(comp_ch);
+      }
+    }
+  }
+}
+
+ShardingPropertyRef MLIRHspCostEvaluator::getResultHsp(
+    size_t op_index, as::HspAnnotationRef annotation) {
+  Operation* op = ops_[op_index];
+  auto&& mlir_annot = as::downcastRef<MLIRAnnotation>(annotation);
+  if (!mlir_annot) {
+    return getShardingPropertyForValue(op->getResult(0));
+  }
+  auto&& hsps = mlir_annot->getResultHsps(op);
+  return hsps.empty() ? nullptr : hsps[0];
+}
+
+}  // namespace hs
+}  // namespace mlir
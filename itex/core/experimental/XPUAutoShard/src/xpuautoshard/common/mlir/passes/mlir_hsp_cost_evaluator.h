@@ -0,0 +1,47 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#pragma once
+
+#include <vector>
+
+#include "xpuautoshard/common/device_info.h"
+#include "xpuautoshard/common/mlir/passes/mlir_graph.h"
+#include "xpuautoshard/common/profiled_hsp_cost_evaluator.h"
+
+namespace mlir {
+namespace hs {
+
+/**
+ * @brief Evaluate an HSP annotation of an MLIR graph with the analytic cost
+ * models of the devices, see `as::ProfiledHspCostEvaluator`. The framework ops
+ * are characterized up front so that evaluations only read the IR.
+ *
+ */
+class MLIRHspCostEvaluator : public as::ProfiledHspCostEvaluator {
+ public:
+  MLIRHspCostEvaluator(as::GraphRef graph, const as::DeviceInfo& device_info);
+
+ protected:
+  as::ShardingPropertyRef getResultHsp(
+      size_t op_index, as::HspAnnotationRef annotation) override;
+
+ private:
+  MLIRGraphRef mlir_graph_;
+  // Framework ops with known compute characteristics, in graph order.
+  std::vector<Operation*> ops_;
+};
+
+}  // namespace hs
+}  // namespace mlir
@@ -12,23 +12,55 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
-
 #include "xpuautoshard/common/mlir/passes/mlir_hsp_tuner.h"
 
 #include "xpuautoshard/common/mlir/passes/mlir_hsp_annotator.h"
+#include "xpuautoshard/common/mlir/passes/mlir_hsp_cost_evaluator.h"
 
 namespace mlir {
 namespace hs {
 
 using as::HspAnnotator;
 using as::HspAnnotatorRef;
+using as::HspCostEvaluator;
+using as::HspCostEvaluatorRef;
 using as::makeRef;
 using as::TuningStateRef;
 using ::mlir::hs::MLIRHspAnnotator;
 
+MLIRHspTuner::MLIRHspTuner(as::GraphRef graph,
+                           const as::DeviceInfo& device_info,
+                           const as::ShardingConfig& sharding_config)
+    : as::SplitRatioHspTuner(device_info, sharding_config), graph_(graph) {}
+
+HspCostEvaluatorRef MLIRHspTuner::getCostModel() {
+  if (!isTunable()) {
+    return makeRef<as::DummyHspCostEvaluator, HspCostEvaluator>();
+  }
+  return makeRef<MLIRHspCostEvaluator, HspCostEvaluator>(graph_,
+                                                         device_info_);
+}
+
+bool MLIRHspTuner::isAnnotatorThreadSafe() {
+  // Annotating may create attributes which is only safe with a multithreaded
+  // context.
+  return as::downcastRef<MLIRGraph>(graph_)
+      ->getRoot()
+      ->getContext()
+      ->isMultithreadingEnabled();
+}
+
 HspAnnotatorRef MLIRHspTuner::createAnnotator(TuningStateRef tuning_state) {
+  auto&& state = as::downcastRef<as::SplitRatioTuningState>(tuning_state);
+  if (!state) {
+    return makeRef<MLIRHspAnnotator, HspAnnotator>(graph_, device_info_,
+                                                   sharding_config_);
+  }
+  as::ShardingConfig sharding_config = sharding_config_;
+  sharding_config.getHeuristicsConfig().setSplitRatioWeights(
+      state->split_ratio_weights);
   return makeRef<MLIRHspAnnotator, HspAnnotator>(graph_, device_info_,
-                                                 sharding_config_);
+                                                 sharding_config);
 }
 
 }  // namespace hs
@@ -12,42 +12,34 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
-
 #pragma once
 
 #include "xpuautoshard/common/config.h"
 #include "xpuautoshard/common/device_info.h"
-#include "xpuautoshard/common/hsp_tuner.h"
+#include "xpuautoshard/common/split_ratio_hsp_tuner.h"
 
 namespace mlir {
 namespace hs {
 
-class MLIRHspTuner : public as::HspTuner {
+/**
+ * @brief The split ratio tuner on MLIR graphs: candidates are annotated by
+ * the MLIR HSP annotator and scored with the measured device profiles.
+ *
+ */
+class MLIRHspTuner : public as::SplitRatioHspTuner {
  public:
   MLIRHspTuner(as::GraphRef graph, const as::DeviceInfo& device_info,
-               const as::ShardingConfig& sharding_config)
-      : graph_(graph),
-        device_info_(device_info),
-        sharding_config_(sharding_config) {}
-
-  as::HspCostEvaluatorRef getCostModel() override {
-    return as::makeRef<as::DummyHspCostEvaluator, as::HspCostEvaluator>();
-  }
+               const as::ShardingConfig& sharding_config);
 
-  as::TuningStateRef nextState() override { return nullptr; }
+  as::HspCostEvaluatorRef getCostModel() override;
 
-  void updateScore(const as::ScoreRef& score,
-                   as::TuningStateRef tuning_state = nullptr) override {}
+  bool isAnnotatorThreadSafe() override;
 
   as::HspAnnotatorRef createAnnotator(
       as::TuningStateRef tuning_state = nullptr) override;
 
-  bool stopCriterionMet() override { return true; }
-
  private:
   as::GraphRef graph_;
-  as::DeviceInfo device_info_;
-  as::ShardingConfig sharding_config_;
 };
 
 }  // namespace hs
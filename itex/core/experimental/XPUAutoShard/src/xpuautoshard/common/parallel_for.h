@@ -0,0 +1,64 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace as {
+
+/**
+ * @brief Run `fn(begin, end)` over [0, `size`) split evenly among
+ * `num_threads` threads. The calling thread runs the first block. If `fn`
+ * throws, the first exception is rethrown once all the blocks are done.
+ *
+ */
+inline void parallelFor(size_t num_threads, size_t size,
+                        const std::function<void(size_t, size_t)>& fn) {
+  num_threads = std::max<size_t>(1, std::min(num_threads, size));
+  size_t block = (size + num_threads - 1) / num_threads;
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  auto run = [&](size_t begin, size_t end) {
+    try {
+      fn(begin, end);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    size_t begin = t * block;
+    size_t end = std::min(size, begin + block);
+    if (begin < end) threads.emplace_back(run, begin, end);
+  }
+  run(0, std::min(size, block));
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace as
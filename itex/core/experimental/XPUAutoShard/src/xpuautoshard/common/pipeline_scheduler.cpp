@@ -0,0 +1,260 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xpuautoshard/common/pipeline_scheduler.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
+#include <utility>
+
+#include "xpuautoshard/common/spsc_queue.h"
+
+namespace as {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+float secondsSince(Clock::time_point start) {
+  return std::chrono::duration<float>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Bind the calling thread to the CPUs of NUMA `node` as listed by
+ * sysfs. No-op if the node is unknown.
+ *
+ */
+void bindToNumaNode(int node) {
+#ifdef __linux__
+  std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) +
+                   "/cpulist");
+  std::string cpulist;
+  if (!std::getline(in, cpulist)) {
+    return;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  std::istringstream ranges(cpulist);
+  std::string range;
+  // The list looks like "0-15,32-47".
+  while (std::getline(ranges, range, ',')) {
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+      CPU_SET(cpu, &cpus);
+    }
+  }
+  if (CPU_COUNT(&cpus) > 0) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+  }
+#endif
+}
+
+struct PipelineMessage {
+  size_t micro_batch = 0;
+  std::any value;
+};
+
+using PipelineQueue = SpscQueue<PipelineMessage>;
+
+}  // anonymous namespace
+
+PipelineSchedule buildPipelineSchedule(size_t num_stages,
+                                       size_t num_micro_batches,
+                                       bool training) {
+  PipelineSchedule schedule(num_stages);
+  for (size_t s = 0; s < num_stages; s++) {
+    auto&& steps = schedule[s];
+    if (!training) {
+      for (size_t mb = 0; mb < num_micro_batches; mb++) {
+        steps.push_back({PipelinePhase::FORWARD, mb});
+      }
+      continue;
+    }
+    size_t num_warmup = std::min(num_stages - s - 1, num_micro_batches);
+    for (size_t mb = 0; mb < num_warmup; mb++) {
+      steps.push_back({PipelinePhase::FORWARD, mb});
+    }
+    for (size_t mb = 0; mb + num_warmup < num_micro_batches; mb++) {
+      steps.push_back({PipelinePhase::FORWARD, mb + num_warmup});
+      steps.push_back({PipelinePhase::BACKWARD, mb});
+    }
+    for (size_t mb = num_micro_batches - num_warmup; mb < num_micro_batches;
+         mb++) {
+      steps.push_back({PipelinePhase::BACKWARD, mb});
+    }
+  }
+  return schedule;
+}
+
+float PipelineStats::getBubbleRatio() const {
+  float busy = 0.0f;
+  float total = 0.0f;
+  for (auto&& stage : stages) {
+    busy += stage.busy_time;
+    total += stage.busy_time + stage.idle_time;
+  }
+  return total > 0 ? 1.0f - busy / total : 0.0f;
+}
+
+PipelineScheduler::PipelineScheduler(const std::vector<PipelineStage>& stages,
+                                     size_t queue_capacity)
+    : stages_(stages),
+      queue_capacity_(queue_capacity > 0
+                          ? queue_capacity
+                          : std::max<size_t>(1, stages.size())) {}
+
+std::vector<std::any> PipelineScheduler::run(
+    const std::vector<std::any>& micro_batch_inputs, bool training) {
+  size_t num_stages = stages_.size();
+  size_t num_micro_batches = micro_batch_inputs.size();
+  stats_ = PipelineStats();
+  stats_.stages.resize(num_stages);
+  if (num_stages == 0) {
+    return micro_batch_inputs;
+  }
+  auto&& schedule =
+      buildPipelineSchedule(num_stages, num_micro_batches, training);
+  // forward_queues[s] carries activations from stage s to stage s + 1 and
+  // backward_queues[s] carries gradients from stage s + 1 to stage s.
+  std::vector<std::unique_ptr<PipelineQueue>> forward_queues;
+  std::vector<std::unique_ptr<PipelineQueue>> backward_queues;
+  for (size_t s = 0; s + 1 < num_stages; s++) {
+    forward_queues.push_back(std::make_unique<PipelineQueue>(queue_capacity_));
+    backward_queues.push_back(
+        std::make_unique<PipelineQueue>(queue_capacity_));
+  }
+  std::vector<std::any> outputs(num_micro_batches);
+  std::atomic<bool> failed(false);
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  // Spin until the queue operation succeeds, unless another stage failed and
+  // the peer may never come.
+  auto wait_for = [&](const std::function<bool()>& try_op) {
+    while (!try_op()) {
+      if (failed.load(std::memory_order_relaxed)) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  };
+
+  auto run_stage = [&](size_t s) {
+    auto&& stage = stages_[s];
+    auto&& stats = stats_.stages[s];
+    bool is_last = s + 1 == num_stages;
+    if (stage.numa_node != Device::NO_NUMA_AFFINITY) {
+      bindToNumaNode(stage.numa_node);
+    }
+    // Forward outputs of the last stage waiting for their backward.
+    std::unordered_map<size_t, std::any> losses;
+    try {
+      for (auto&& step : schedule[s]) {
+        PipelineMessage message;
+        message.micro_batch = step.micro_batch;
+        if (step.phase == PipelinePhase::FORWARD) {
+          if (s == 0) {
+            message.value = micro_batch_inputs[step.micro_batch];
+          } else if (!wait_for([&]() {
+                       return forward_queues[s - 1]->tryPop(&message);
+                     })) {
+            return;
+          }
+          auto begin = Clock::now();
+          message.value =
+              stage.forward(message.micro_batch, std::move(message.value));
+          stats.busy_time += secondsSince(begin);
+          if (!is_last) {
+            if (!wait_for([&]() {
+                  return forward_queues[s]->tryPush(std::move(message));
+                })) {
+              return;
+            }
+          } else if (training) {
+            losses[message.micro_batch] = std::move(message.value);
+          } else {
+            outputs[message.micro_batch] = std::move(message.value);
+          }
+        } else {
+          if (is_last) {
+            message.value = std::move(losses[message.micro_batch]);
+            losses.erase(message.micro_batch);
+          } else if (!wait_for([&]() {
+                       return backward_queues[s]->tryPop(&message);
+                     })) {
+            return;
+          }
+          auto begin = Clock::now();
+          message.value =
+              stage.backward(message.micro_batch, std::move(message.value));
+          stats.busy_time += secondsSince(begin);
+          if (s > 0) {
+            if (!wait_for([&]() {
+                  return backward_queues[s - 1]->tryPush(std::move(message));
+                })) {
+              return;
+            }
+          } else {
+            outputs[message.micro_batch] = std::move(message.value);
+          }
+        }
+        stats.num_steps++;
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      failed.store(true, std::memory_order_relaxed);
+    }
+  };
+
+  auto start = Clock::now();
+  std::vector<std::thread> workers;
+  for (size_t s = 0; s < num_stages; s++) {
+    workers.emplace_back(run_stage, s);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  stats_.wall_time = secondsSince(start);
+  for (auto&& stats : stats_.stages) {
+    stats.idle_time = std::max(0.0f, stats_.wall_time - stats.busy_time);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  return outputs;
+}
+
+}  // namespace as
@@ -0,0 +1,100 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xpuautoshard/common/profiled_hsp_cost_evaluator.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace as {
+
+ProfiledHspCostEvaluator::ProfiledHspCostEvaluator(
+    const std::map<DeviceId, CostModelRef>& cost_models)
+    : cost_models_(cost_models) {}
+
+void ProfiledHspCostEvaluator::addOp(ComputeCharacteristicsRef comp_ch) {
+  ops_.push_back(comp_ch);
+  device_times_cache_.emplace_back();
+}
+
+ScoreRef ProfiledHspCostEvaluator::lowestScore() {
+  return makeRef<FloatScore, Score>();
+}
+
+ScoreRef ProfiledHspCostEvaluator::evaluate(GraphRef graph,
+                                            HspAnnotationRef annotation) {
+  return evaluateWithBound(graph, annotation, lowestScore());
+}
+
+ScoreRef ProfiledHspCostEvaluator::evaluateWithBound(
+    GraphRef graph, HspAnnotationRef annotation, const ScoreRef& bound) {
+  auto&& float_bound = downcastRef<FloatScore>(bound);
+  float max_makespan = float_bound ? -float_bound->getValue()
+                                   : std::numeric_limits<float>::max();
+  std::map<DeviceId, float> device_times;
+  float makespan = 0.0f;
+  for (size_t i = 0; i < ops_.size(); i++) {
+    auto&& hsp = getResultHsp(i, annotation);
+    if (!hsp || hsp->getNumDevices() == 0) {
+      continue;
+    }
+    for (auto&& [device_id, time] : getDeviceTimes(i, hsp)) {
+      float& device_time = device_times[device_id];
+      device_time += time;
+      makespan = std::max(makespan, device_time);
+    }
+    if (makespan > max_makespan) {
+      // Pruned: the remaining ops can only make it slower.
+      break;
+    }
+  }
+  return makeRef<FloatScore, Score>(-makespan);
+}
+
+ProfiledHspCostEvaluator::DeviceTimes ProfiledHspCostEvaluator::getDeviceTimes(
+    size_t op_index, const ShardingPropertyRef& hsp) {
+  auto&& cache = device_times_cache_[op_index];
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    for (auto&& [cached_hsp, times] : cache) {
+      if (cached_hsp == hsp || *cached_hsp == *hsp) {
+        return times;
+      }
+    }
+  }
+  // Share of the op on each device, replicated ops run in full on all.
+  std::map<DeviceId, float> device_ratios;
+  if (!hsp->isInitialized() || hsp->isSplitSingleOnly()) {
+    for (auto device_id : hsp->getDeviceIds()) {
+      device_ratios[device_id] = 1.0f;
+    }
+  } else {
+    for (auto&& shard_desc : hsp->getShardDescriptors()) {
+      device_ratios[shard_desc.getDeviceId()] += shard_desc.getRatio();
+    }
+  }
+  DeviceTimes times;
+  for (auto&& [device_id, ratio] : device_ratios) {
+    auto iter = cost_models_.find(device_id);
+    if (iter == cost_models_.end()) {
+      continue;
+    }
+    times[device_id] = ratio * iter->second->evaluateTime(ops_[op_index]);
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  cache.emplace_back(hsp, times);
+  return times;
+}
+
+}  // namespace as
@@ -0,0 +1,104 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#pragma once
+
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "xpuautoshard/common/cost_model.h"
+#include "xpuautoshard/common/device_info.h"
+#include "xpuautoshard/common/hsp_cost_evaluator.h"
+#include "xpuautoshard/common/sharding_property.h"
+
+namespace as {
+
+/**
+ * @brief Evaluate an HSP annotation with a cost model per device. Each
+ * framework op is characterized once, its time on each device is scaled by the
+ * share of the op the annotation places there, and the score is the negated
+ * time of the slowest device.
+ *
+ * The device times of an op are memoised by (op, HSP) so that the ops a tuning
+ * candidate leaves unchanged are not re-scored. Evaluations may run
+ * concurrently.
+ *
+ * Frameworks add the characterized ops and look up their HSPs in an
+ * annotation.
+ *
+ */
+class ProfiledHspCostEvaluator : public HspCostEvaluator {
+ public:
+  explicit ProfiledHspCostEvaluator(
+      const std::map<DeviceId, CostModelRef>& cost_models);
+
+  ScoreRef lowestScore() override;
+
+  ScoreRef evaluate(GraphRef graph,
+                    HspAnnotationRef annotation = nullptr) override;
+
+  /**
+   * @brief Evaluate the annotation and stop as soon as the accumulated time of
+   * any device exceeds the makespan `bound` stands for, since more ops only
+   * add time.
+   *
+   */
+  ScoreRef evaluateWithBound(GraphRef graph, HspAnnotationRef annotation,
+                             const ScoreRef& bound) override;
+
+ protected:
+  /**
+   * @brief Add the next op to evaluate, in graph order. Ops must be added
+   * before any evaluation.
+   *
+   * @param comp_ch
+   */
+  void addOp(ComputeCharacteristicsRef comp_ch);
+
+  /**
+   * @brief Get the HSP of the result of the `op_index`-th added op in
+   * `annotation`, or in the graph if there is no annotation. Returns null if
+   * the op has none.
+   *
+   * @param op_index
+   * @param annotation
+   * @return ShardingPropertyRef
+   */
+  virtual ShardingPropertyRef getResultHsp(size_t op_index,
+                                           HspAnnotationRef annotation) = 0;
+
+ private:
+  using DeviceTimes = std::map<DeviceId, float>;
+
+  /**
+   * @brief Get the time on each device of the `op_index`-th op given its
+   * result `hsp`, computed at most once per distinct HSP.
+   *
+   * @param op_index
+   * @param hsp
+   * @return DeviceTimes
+   */
+  DeviceTimes getDeviceTimes(size_t op_index, const ShardingPropertyRef& hsp);
+
+  std::map<DeviceId, CostModelRef> cost_models_;
+  std::vector<ComputeCharacteristicsRef> ops_;
+  std::mutex cache_mutex_;
+  // Device times of each op in `ops_` by the HSPs it has been evaluated with.
+  std::vector<std::vector<std::pair<ShardingPropertyRef, DeviceTimes>>>
+      device_times_cache_;
+};
+
+}  // namespace as
@@ -0,0 +1,120 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "xpuautoshard/common/split_ratio_hsp_tuner.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT(build/c++11)
+
+namespace as {
+
+namespace {
+constexpr size_t kMaxRounds = 8;
+constexpr float kInitialStep = 0.2f;
+constexpr float kMinStep = 0.02f;
+}  // anonymous namespace
+
+SplitRatioHspTuner::SplitRatioHspTuner(const DeviceInfo& device_info,
+                                       const ShardingConfig& sharding_config)
+    : device_info_(device_info),
+      sharding_config_(sharding_config),
+      step_(kInitialStep) {
+  size_t num_devices = device_info_.getNumDevices();
+  tunable_ = sharding_config_.getStrategyKind() == StrategyKind::HEURISTIC &&
+             num_devices > 1;
+  // Scores are only comparable if every device is measured the same way.
+  for (auto&& device : device_info_.getDevices()) {
+    tunable_ &= device.hasProfile();
+  }
+  if (tunable_) {
+    best_state_ = makeRef<SplitRatioTuningState>(
+        std::vector<float>(num_devices, 1.0f));
+    visited_.insert(best_state_->split_ratio_weights);
+    pending_.push_back(best_state_);
+    startRound();
+  }
+}
+
+TuningStateRef SplitRatioHspTuner::nextState() {
+  auto&& states = nextStates(1);
+  return states.empty() ? nullptr : states.front();
+}
+
+std::vector<TuningStateRef> SplitRatioHspTuner::nextStates(
+    size_t max_num_states) {
+  if (!tunable_) {
+    return {nullptr};
+  }
+  if (pending_.empty()) {
+    startRound();
+  }
+  std::vector<TuningStateRef> states;
+  while (!pending_.empty() && states.size() < max_num_states) {
+    states.push_back(pending_.front());
+    pending_.pop_front();
+  }
+  return states;
+}
+
+size_t SplitRatioHspTuner::getNumThreads() {
+  size_t num_threads = sharding_config_.getTuningNumThreads();
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  return std::max<size_t>(1, num_threads);
+}
+
+void SplitRatioHspTuner::updateScore(const ScoreRef& score,
+                                     TuningStateRef tuning_state) {
+  auto&& state = downcastRef<SplitRatioTuningState>(tuning_state);
+  if (!state) {
+    return;
+  }
+  if (!best_score_ || *best_score_ < *score) {
+    if (best_score_) improved_ = true;
+    best_score_ = score;
+    best_state_ = state;
+  }
+}
+
+bool SplitRatioHspTuner::stopCriterionMet() {
+  if (!tunable_) {
+    return true;
+  }
+  if (!pending_.empty()) {
+    return false;
+  }
+  float next_step = improved_ ? step_ : step_ / 2;
+  return round_ >= kMaxRounds || next_step < kMinStep;
+}
+
+void SplitRatioHspTuner::startRound() {
+  if (round_ > 0 && !improved_) {
+    step_ /= 2;
+  }
+  improved_ = false;
+  round_++;
+  auto&& weights = best_state_->split_ratio_weights;
+  for (size_t i = 0; i < weights.size(); i++) {
+    for (float scale : {1.0f + step_, 1.0f / (1.0f + step_)}) {
+      auto candidate = weights;
+      candidate[i] *= scale;
+      if (visited_.insert(candidate).second) {
+        pending_.push_back(makeRef<SplitRatioTuningState>(candidate));
+      }
+    }
+  }
+}
+
+}  // namespace as
@@ -0,0 +1,96 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#pragma once
+
+#include <deque>
+#include <set>
+#include <vector>
+
+#include "xpuautoshard/common/config.h"
+#include "xpuautoshard/common/device_info.h"
+#include "xpuautoshard/common/hsp_tuner.h"
+
+namespace as {
+
+/**
+ * @brief A tuning state holds the split ratio weights given to the heuristics
+ * initializer, one per device.
+ *
+ */
+struct SplitRatioTuningState : public TuningState {
+  explicit SplitRatioTuningState(const std::vector<float>& weights)
+      : split_ratio_weights(weights) {}
+
+  std::vector<float> split_ratio_weights;
+};
+
+/**
+ * @brief The tuner searches the split ratio weights of the heuristic strategy
+ * with a pattern search: each round evaluates the best weights found so far
+ * with the weight of one device scaled up or down by a step, and the step is
+ * halved after a round without improvement. Weights evaluated before are not
+ * evaluated again. The search only runs when every device has a measured
+ * profile since the scores are meaningless otherwise; then a single
+ * annotation is made with the null tuning state.
+ *
+ * Frameworks provide the annotator and the cost model.
+ *
+ */
+class SplitRatioHspTuner : public HspTuner {
+ public:
+  SplitRatioHspTuner(const DeviceInfo& device_info,
+                     const ShardingConfig& sharding_config);
+
+  TuningStateRef nextState() override;
+
+  std::vector<TuningStateRef> nextStates(size_t max_num_states) override;
+
+  size_t getNumThreads() override;
+
+  void updateScore(const ScoreRef& score,
+                   TuningStateRef tuning_state = nullptr) override;
+
+  bool stopCriterionMet() override;
+
+  /**
+   * @brief Whether the split ratio weights are searched.
+   *
+   * @return true
+   * @return false
+   */
+  bool isTunable() const { return tunable_; }
+
+ protected:
+  DeviceInfo device_info_;
+  ShardingConfig sharding_config_;
+
+ private:
+  /**
+   * @brief Queue the candidates of the next round around the best state.
+   *
+   */
+  void startRound();
+
+  bool tunable_;
+  size_t round_ = 0;
+  float step_;
+  bool improved_ = false;
+  std::deque<TuningStateRef> pending_;
+  std::set<std::vector<float>> visited_;
+  Ref<SplitRatioTuningState> best_state_;
+  ScoreRef best_score_;
+};
+
+}  // namespace as
@@ -0,0 +1,83 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace as {
+
+/**
+ * @brief A bounded lock-free queue with a single producer thread and a single
+ * consumer thread.
+ *
+ * @tparam T
+ */
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(size_t capacity) : slots_(capacity + 1) {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /**
+   * @brief Push `value` unless the queue is full. Only called by the producer.
+   *
+   * @param value
+   * @return true The value is pushed
+   * @return false The queue is full
+   */
+  bool tryPush(T&& value) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t next = (tail + 1) % slots_.size();
+    if (next == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    slots_[tail] = std::move(value);
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pop the oldest value into `value` unless the queue is empty. Only
+   * called by the consumer.
+   *
+   * @param value
+   * @return true A value is popped
+   * @return false The queue is empty
+   */
+  bool tryPop(T* value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = std::move(slots_[head]);
+    head_.store((head + 1) % slots_.size(), std::memory_order_release);
+    return true;
+  }
+
+ private:
+  // One slot is kept empty to tell a full queue from an empty one.
+  std::vector<T> slots_;
+  // Keep the indices on separate cache lines so the two threads do not
+  // invalidate each other's line on every operation.
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace as
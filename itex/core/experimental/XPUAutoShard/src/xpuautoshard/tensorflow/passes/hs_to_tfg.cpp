@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xpuautoshard/tensorflow/passes/hs_to_tfg.h"
 
+#include <algorithm>
 #include <queue>
 #include <string>
 #include <unordered_map>
@@ -1362,39 +1363,69 @@ HStoTFGConversion::addInterDeviceReducePostOp(
       }
     }
   } else {
-    Operation* inter_op = nullptr;
-    // By default, the reduce is performed on the first device.
-    std::string device_name = getDeviceName(prop->getDeviceIds()[0]);
     Type t = sharded_value[0].getType();
-    if (inter_op_name == "tfg.AddN") {
-      // The operand num of `inter_op_name` is N(>2)
-      // (Temporarily only contains AddN OP)
-      inter_op = buildTfgOp(
-          builder, loc, "tfg.AddN", &t, device_name,
-          [&](OperationState* op_state) -> void {
-            op_state->types.push_back(t);
-            for (auto operand : llvm::enumerate(sharded_value)) {
-              op_state->operands.push_back(operand.value());
-            }
-            op_state->addAttribute(
-                "N", builder->getI64IntegerAttr(sharded_value.size()));
-          });
-    } else {
-      // The operand num of inter_op_name is 2.
-      // Add `inter_op_name` OP two by two.
-      auto x_operand = *(sharded_value.begin());
-      for (auto i = 1; i < sharded_value.size(); i++) {
-        auto y_operand = sharded_value[i];
-        Type t = y_operand.getType();
-        inter_op = buildTfgOp(builder, loc, inter_op_name, &t, device_name,
-                              [&](OperationState* op_state) -> void {
-                                op_state->types.push_back(t);
-                                op_state->operands.push_back(x_operand);
-                                op_state->operands.push_back(y_operand);
-                              });
-        x_operand = inter_op->getResult(0);
+    auto build_reduce = [&](const ShardedValue& values,
+                            const std::string& device_name) -> Operation* {
+      Operation* reduce_op = nullptr;
+      if (inter_op_name == "tfg.AddN") {
+        // The operand num of `inter_op_name` is N(>2)
+        // (Temporarily only contains AddN OP)
+        reduce_op = buildTfgOp(
+            builder, loc, "tfg.AddN", &t, device_name,
+            [&](OperationState* op_state) -> void {
+              op_state->types.push_back(t);
+              for (auto operand : values) {
+                op_state->operands.push_back(operand);
+              }
+              op_state->addAttribute(
+                  "N", builder->getI64IntegerAttr(values.size()));
+            });
+      } else {
+        // The operand num of inter_op_name is 2.
+        // Add `inter_op_name` OP two by two.
+        auto x_operand = values[0];
+        for (size_t i = 1; i < values.size(); i++) {
+          auto y_operand = values[i];
+          Type t = y_operand.getType();
+          reduce_op = buildTfgOp(builder, loc, inter_op_name, &t, device_name,
+                                 [&](OperationState* op_state) -> void {
+                                   op_state->types.push_back(t);
+                                   op_state->operands.push_back(x_operand);
+                                   op_state->operands.push_back(y_operand);
+                                 });
+          x_operand = reduce_op->getResult(0);
+        }
+      }
+      return reduce_op;
+    };
+
+    // Group the shards by the NUMA node of their devices, the first group
+    // holds the first device.
+    const auto& device_ids = prop->getDeviceIds();
+    const std::vector<std::vector<size_t>> numa_groups =
+        current_device_info_.groupByNumaNode(device_ids);
+
+    // By default, the reduce is performed on the first device.
+    ShardedValue partials = sharded_value;
+    if (numa_groups.size() > 1 && numa_groups.size() < sharded_value.size()) {
+      // Several shards share a NUMA node: reduce them on their node first, so
+      // that only one partial per node crosses the socket interconnect.
+      partials.clear();
+      for (const auto& group : numa_groups) {
+        if (group.size() == 1) {
+          partials.push_back(sharded_value[group[0]]);
+          continue;
+        }
+        ShardedValue local_values;
+        for (size_t index : group) {
+          local_values.push_back(sharded_value[index]);
+        }
+        Operation* local_op =
+            build_reduce(local_values, getDeviceName(device_ids[group[0]]));
+        partials.push_back(local_op->getResult(0));
       }
     }
+    Operation* inter_op = build_reduce(partials, getDeviceName(device_ids[0]));
     // The result of reduce is passed to each stage on each device.
     for (auto indexed_value : llvm::enumerate(sharded_value)) {
       for (size_t j = 0;
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
@@ -612,6 +613,114 @@ DataTypeSet AllowedDataTypes(const OpDef& op_def, const TypeAttrId& t_attr_id) {
   return AllowedDataTypes(*attr_def);
 }
 
+// Max-flow/min-cut solver (Dinic) with int64 capacities.
+class MinCutGraph {
+ public:
+  static constexpr int64 kInfinity = std::numeric_limits<int64>::max() / 4;
+
+  explicit MinCutGraph(int num_nodes) : adj_(num_nodes) {}
+
+  int AddNode() {
+    adj_.emplace_back();
+    return adj_.size() - 1;
+  }
+
+  void AddEdge(int from, int to, int64 capacity) {
+    if (capacity <= 0 || from == to) return;
+    adj_[from].push_back(edges_.size());
+    edges_.push_back({to, capacity});
+    adj_[to].push_back(edges_.size());
+    edges_.push_back({from, 0});
+  }
+
+  // Cuts the graph between `source` and `sink` at minimum capacity. Returns
+  // the nodes on the sink side, which is kept as small as possible.
+  std::vector<bool> SinkSide(int source, int sink) {
+    while (BuildLevels(source, sink)) {
+      next_.assign(adj_.size(), 0);
+      Augment(source, sink);
+    }
+    // Nodes which can still reach the sink in the residual graph.
+    std::vector<bool> sink_side(adj_.size(), false);
+    std::vector<int> queue = {sink};
+    sink_side[sink] = true;
+    for (size_t i = 0; i < queue.size(); ++i) {
+      for (int e : adj_[queue[i]]) {
+        const int from = edges_[e].to;
+        if (!sink_side[from] && edges_[e ^ 1].capacity > 0) {
+          sink_side[from] = true;
+          queue.push_back(from);
+        }
+      }
+    }
+    return sink_side;
+  }
+
+ private:
+  struct Edge {
+    int to;
+    int64 capacity;
+  };
+
+  bool BuildLevels(int source, int sink) {
+    level_.assign(adj_.size(), -1);
+    std::vector<int> queue = {source};
+    level_[source] = 0;
+    for (size_t i = 0; i < queue.size(); ++i) {
+      for (int e : adj_[queue[i]]) {
+        const Edge& edge = edges_[e];
+        if (edge.capacity > 0 && level_[edge.to] < 0) {
+          level_[edge.to] = level_[queue[i]] + 1;
+          queue.push_back(edge.to);
+        }
+      }
+    }
+    return level_[sink] >= 0;
+  }
+
+  // Saturates the level graph with augmenting paths. The search is iterative
+  // since paths can be as long as the model graph is deep.
+  void Augment(int source, int sink) {
+    std::vector<int> path;
+    int node = source;
+    while (true) {
+      if (node == sink) {
+        int64 flow = kInfinity;
+        for (int e : path) flow = std::min(flow, edges_[e].capacity);
+        for (int e : path) {
+          edges_[e].capacity -= flow;
+          edges_[e ^ 1].capacity += flow;
+        }
+        path.clear();
+        node = source;
+        continue;
+      }
+      bool advanced = false;
+      for (; next_[node] < adj_[node].size(); ++next_[node]) {
+        const int e = adj_[node][next_[node]];
+        if (edges_[e].capacity > 0 &&
+            level_[edges_[e].to] == level_[node] + 1) {
+          path.push_back(e);
+          node = edges_[e].to;
+          advanced = true;
+          break;
+        }
+      }
+      if (advanced) continue;
+      if (node == source) break;
+      // Dead end, retreat and never come back.
+      level_[node] = -1;
+      node = edges_[path.back() ^ 1].to;
+      path.pop_back();
+    }
+  }
+
+  std::vector<Edge> edges_;
+  std::vector<std::vector<int>> adj_;
+  std::vector<int> level_;
+  std::vector<size_t> next_;
+};
+
 Status ValidateLists(const gtl::FlatSet<string>& allow_list,
                      const gtl::FlatSet<string>& deny_list,
                      const gtl::FlatSet<string>& infer_list,
@@ -639,12 +748,15 @@ Status ValidateLists(const gtl::FlatSet<string>& allow_list,
 // TODO(itex): after supporting virtual_placer_ and , please add them.
 class AutoMixedPrecisionImpl {
  public:
+  // Casts are minimized with a graph cut when `properties` are given.
   AutoMixedPrecisionImpl(const std::unordered_set<string>& nodes_to_preserve,
-                         GraphDef* graph, AutoMixedPrecisionMode mode)
+                         GraphDef* graph, AutoMixedPrecisionMode mode,
+                         const GraphProperties* properties = nullptr)
       : nodes_to_preserve_(nodes_to_preserve),
         graph_(graph),
         function_library_(*graph),
         graph_view_(graph),
+        properties_(properties),
         mode_(mode),
         target_dtype_((mode_ == AutoMixedPrecisionMode::GPU_FLOAT16 ||
                        mode_ == AutoMixedPrecisionMode::CPU_FLOAT16)
@@ -655,6 +767,20 @@ class AutoMixedPrecisionImpl {
 
  private:
   typedef absl::flat_hash_set<NodeTypeId> NodeTypeIdSet;
+  // An output which needs a Cast when its producer and some of its consumers
+  // are painted differently. Casts are shared by all consumers of an output.
+  struct CastCandidate {
+    int src;
+    std::vector<int> dsts;
+    int64 bytes;
+    // Casts the remapper folds into the producer afterwards.
+    bool folds_to_f16;
+    bool folds_to_f32;
+  };
+  struct CastStats {
+    int num_casts = 0;
+    int64 bytes = 0;
+  };
   std::unique_ptr<AutoMixedPrecisionLists> get_mixed_precision_lists() const {
     switch (mode_) {
       case AutoMixedPrecisionMode::GPU_FLOAT16:
@@ -706,6 +832,13 @@ class AutoMixedPrecisionImpl {
                                   absl::flat_hash_set<int>* allow_set) const;
   Status ForceColorMatchOnRecurrentEdges(
       absl::flat_hash_set<int>* allow_set) const;
+  int64 OutputBytes(const NodeDef& node, int port) const;
+  bool IsPaintable(const absl::flat_hash_set<int>& deny_set, int idx) const;
+  Status FindCastCandidates(std::vector<CastCandidate>* candidates) const;
+  CastStats GetCastStats(const std::vector<CastCandidate>& candidates,
+                         const absl::flat_hash_set<int>& allow_set) const;
+  Status MinimizeCastBytes(const absl::flat_hash_set<int>& deny_set,
+                           absl::flat_hash_set<int>* allow_set) const;
   void MakeCastsAllowIfAllOutputsAllow(
       absl::flat_hash_set<int>* allow_set) const;
   NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_f16,
@@ -719,6 +852,7 @@ class AutoMixedPrecisionImpl {
   MutableGraphView graph_view_;
   NodeTypeAttrMap node_type_map_;
   GraphTypeTopologyView graph_type_view_;
+  const GraphProperties* properties_;
   bool force_all_f16_;
   AutoMixedPrecisionMode mode_;
   gtl::FlatSet<string> f16_allowlist_;
@@ -1124,6 +1258,13 @@ Status AutoMixedPrecisionImpl::Optimize() {
   RemoveAllowsetWithFp32(&allow_set);
   ITEX_VLOG(2) << "Finished pass 6";
 
+  if (properties_ != nullptr) {
+    ITEX_VLOG(2) << "Beginning pass 7 to repaint clear and infer ops with "
+                    "minimum cast bytes";
+    TF_RETURN_IF_ERROR(MinimizeCastBytes(deny_set, &allow_set));
+    ITEX_VLOG(2) << "Finished pass 7";
+  }
+
   ITEX_VLOG(2) << "Forcing color match between data structure ops";
   for (const auto& cluster : tensor_list_clusters) {
     ForceColorMatchBetweenTensorListOps(cluster, &allow_set, &deny_set);
@@ -1497,6 +1638,168 @@ void AutoMixedPrecisionImpl::RemoveAllowsetWithFp32(
   }
 }
 
+// Returns the size of the fp32 output `port` of `node`, or an estimate if it's
+// unknown.
+int64 AutoMixedPrecisionImpl::OutputBytes(const NodeDef& node,
+                                          int port) const {
+  constexpr int64 kUnknownTensorBytes = 1 << 16;
+  std::vector<OpInfo_TensorProperties> props;
+  if (!properties_->GetOutputProperties(node.name(), &props).ok() ||
+      port >= static_cast<int>(props.size()))
+    return kUnknownTensorBytes;
+  const auto& shape = props[port].shape();
+  if (shape.unknown_rank()) return kUnknownTensorBytes;
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return kUnknownTensorBytes;
+    num_elements *= dim.size();
+  }
+  return num_elements * DataTypeSize(DT_FLOAT);
+}
+
+// Returns true iff the color of a node is free to choose, i.e. it isn't on
+// the allowlist and is numerically safe in f16.
+bool AutoMixedPrecisionImpl::IsPaintable(
+    const absl::flat_hash_set<int>& deny_set, int idx) const {
+  const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+  const string& op = item.node->op();
+  return !deny_set.count(idx) && ShouldProcess(*item.node) &&
+         IsFloat32(item) && SupportsF16(item) && !f16_allowlist_.count(op) &&
+         (f16_clearlist_.count(op) || f16_inferlist_.count(op)) &&
+         !NodeImplicitlyReadsNonResourceVariable(*item.node);
+}
+
+// Collects the outputs ChangeTypeAttrsAndAddCasts() may insert a Cast after.
+Status AutoMixedPrecisionImpl::FindCastCandidates(
+    std::vector<CastCandidate>* candidates) const {
+  for (int node_idx = 0; node_idx < graph_->node_size(); ++node_idx) {
+    NodeDef& node = *graph_->mutable_node(node_idx);
+    for (const TypeAttrId& type_attr : node_type_map_.GetTypeAttrs(node)) {
+      const absl::optional<int> maybe_node_type_idx =
+          graph_type_view_.GetNodeIndex(node.name(), type_attr);
+      if (!maybe_node_type_idx.has_value()) {
+        return errors::Internal("Type attribute ", type_attr.DebugString(),
+                                " of ", node.op(), " node ", node.name(),
+                                " not found in graph view");
+      }
+      const int node_type_idx = maybe_node_type_idx.value();
+      if (!IsFloat32(*graph_type_view_.GetNode(node_type_idx))) continue;
+      for (int output_port : node_type_map_.GetOutputPorts(node, type_attr)) {
+        MutableGraphView::OutputPort src(&node, output_port);
+        const auto& fanout = graph_view_.GetFanout(src);
+        CastCandidate candidate;
+        candidate.src = node_type_idx;
+        for (const MutableGraphView::InputPort& dst : fanout) {
+          TypeAttrId dst_type_attr =
+              node_type_map_.GetInputTypeAttr(*dst.node, dst.port_id);
+          const absl::optional<int> maybe_dst_type_idx =
+              graph_type_view_.GetNodeIndex(dst.node->name(), dst_type_attr);
+          if (maybe_dst_type_idx.has_value())
+            candidate.dsts.push_back(maybe_dst_type_idx.value());
+        }
+        if (candidate.dsts.empty()) continue;
+        candidate.bytes = OutputBytes(node, output_port);
+        // See FindConstWithCast() and FindBf16ContractionWithCastFp32() in
+        // the remapper.
+        candidate.folds_to_f16 = IsConstant(node);
+        candidate.folds_to_f32 = target_dtype_ == DT_BFLOAT16 &&
+                                 output_port == 0 && fanout.size() == 1 &&
+                                 (IsMatMul(node) || IsFusedMatmul(node)) &&
+                                 !MustPreserve(node);
+        candidates->push_back(std::move(candidate));
+      }
+    }
+  }
+  return Status::OK();
+}
+
+AutoMixedPrecisionImpl::CastStats AutoMixedPrecisionImpl::GetCastStats(
+    const std::vector<CastCandidate>& candidates,
+    const absl::flat_hash_set<int>& allow_set) const {
+  CastStats stats;
+  for (const CastCandidate& candidate : candidates) {
+    const bool src_is_allow = allow_set.count(candidate.src);
+    bool needs_cast = false;
+    for (int dst : candidate.dsts) {
+      needs_cast |= allow_set.count(dst) != src_is_allow;
+    }
+    if (!needs_cast) continue;
+    ++stats.num_casts;
+    if (!(src_is_allow ? candidate.folds_to_f32 : candidate.folds_to_f16))
+      stats.bytes += candidate.bytes;
+  }
+  return stats;
+}
+
+// Repaints clear and infer nodes so as to minimize the bytes converted by
+// Casts, as a minimum cut between the allow nodes (source side) and the other
+// fixed nodes (sink side). Allow and deny constraints are kept, and casts the
+// remapper folds into their producer are free. Among optimal cuts, the one
+// with the most allow nodes is picked.
+Status AutoMixedPrecisionImpl::MinimizeCastBytes(
+    const absl::flat_hash_set<int>& deny_set,
+    absl::flat_hash_set<int>* allow_set) const {
+  std::vector<CastCandidate> candidates;
+  TF_RETURN_IF_ERROR(FindCastCandidates(&candidates));
+  const CastStats before = GetCastStats(candidates, *allow_set);
+
+  const int num_nodes = graph_type_view_.num_nodes();
+  const int source = num_nodes;
+  const int sink = num_nodes + 1;
+  MinCutGraph graph(num_nodes + 2);
+  std::vector<int> paintable;
+  for (int idx = 0; idx < num_nodes; ++idx) {
+    if (IsPaintable(deny_set, idx)) {
+      paintable.push_back(idx);
+    } else if (allow_set->count(idx)) {
+      graph.AddEdge(source, idx, MinCutGraph::kInfinity);
+    } else {
+      graph.AddEdge(idx, sink, MinCutGraph::kInfinity);
+    }
+  }
+  if (paintable.empty()) return Status::OK();
+
+  for (const CastCandidate& candidate : candidates) {
+    // Cast to f16: paid if the source is on the sink side while any of the
+    // consumers is on the source side.
+    const int to_f16 = graph.AddNode();
+    for (int dst : candidate.dsts)
+      graph.AddEdge(dst, to_f16, MinCutGraph::kInfinity);
+    graph.AddEdge(to_f16, candidate.src,
+                  candidate.folds_to_f16 ? 0 : candidate.bytes);
+    // Cast to fp32: paid if the source is on the source side while any of the
+    // consumers is on the sink side.
+    const int to_f32 = graph.AddNode();
+    graph.AddEdge(candidate.src, to_f32,
+                  candidate.folds_to_f32 ? 0 : candidate.bytes);
+    for (int dst : candidate.dsts)
+      graph.AddEdge(to_f32, dst, MinCutGraph::kInfinity);
+  }
+
+  const std::vector<bool> sink_side = graph.SinkSide(source, sink);
+  for (int idx : paintable) {
+    const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+    if (!sink_side[idx]) {
+      if (allow_set->insert(idx).second) {
+        ITEX_VLOG(2) << "Painting type " << item.type_attr.DebugString()
+                     << " of " << item.node->op() << " node "
+                     << item.node->name() << " ALLOW";
+      }
+    } else if (allow_set->erase(idx)) {
+      ITEX_VLOG(2) << "UnPainting type " << item.type_attr.DebugString()
+                   << " of " << item.node->op() << " node "
+                   << item.node->name() << " ALLOW to save casts";
+    }
+  }
+
+  const CastStats after = GetCastStats(candidates, *allow_set);
+  ITEX_LOG(INFO) << "Min-cut painting changed casts from " << before.num_casts
+                 << " converting " << before.bytes << " bytes to "
+                 << after.num_casts << " converting " << after.bytes
+                 << " bytes (excluding casts folded by the remapper)";
+  return Status::OK();
+}
+
 // Forces NextIteration nodes and their output Merge node(s) to have the same
 // color. Specifically, it removes them all from allow_set if any of the Merge
 // nodes is not in allow_set, otherwise it adds the NextIteration node to
@@ -1757,8 +2060,27 @@ Status RunAutoMixedPrecision(OptimizerContext* opt_ctx,
 
   TF_RETURN_IF_ERROR(status);
 
+  // Paint with minimum cast bytes, which requires the tensor sizes.
+  bool min_cut = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("ITEX_AUTO_MIXED_PRECISION_MIN_CUT",
+                                        false, &min_cut));
+  const GraphProperties* properties = nullptr;
+  if (min_cut) {
+    GraphProperties& shared = GetSharedGraphProperties(opt_ctx, item);
+    if (!shared.IsInferred()) {
+      TF_RETURN_IF_ERROR(shared.InferStatically(
+          /*assume_valid_feeds=*/true,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/true,
+          /*include_output_tensor_values=*/true));
+    }
+    shared.Refresh(graph_def);
+    properties = &shared;
+  }
+
   // Optimize the output graph in-place.
-  AutoMixedPrecisionImpl optimizer(item.NodesToPreserve(), output, mode);
+  AutoMixedPrecisionImpl optimizer(item.NodesToPreserve(), output, mode,
+                                   properties);
   status = optimizer.Optimize();
   if (!status.ok()) {
     // Restore the original graph.
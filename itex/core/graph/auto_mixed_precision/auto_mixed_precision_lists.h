@@ -257,6 +257,7 @@ class AutoMixedPrecisionLists {
       "_FusedBatchNormEx",
       "_ITEXFusedBatchNormGradEx",
       "_ITEXFusedBinary",
+      "_ITEXFusedElementwise",
       "_ITEXFusedInstanceNorm",
       "_ITEXInstanceNorm",
       "_ITEXMish",
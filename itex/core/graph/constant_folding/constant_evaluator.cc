@@ -0,0 +1,528 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/constant_folding/constant_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/node_def_util.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+namespace graph {
+namespace {
+
+using UnaryFn = std::function<double(double)>;
+using BinaryFn = std::function<double(double, double)>;
+using IntegerBinaryFn = std::function<int64(int64, int64)>;
+
+const std::unordered_map<string, UnaryFn>& UnaryOps() {
+  static const auto* ops = new std::unordered_map<string, UnaryFn>({
+      {"Neg", [](double x) { return -x; }},
+      {"Sqrt", [](double x) { return std::sqrt(x); }},
+      {"Rsqrt", [](double x) { return 1.0 / std::sqrt(x); }},
+      {"Reciprocal", [](double x) { return 1.0 / x; }},
+      {"Inv", [](double x) { return 1.0 / x; }},
+      {"Square", [](double x) { return x * x; }},
+  });
+  return *ops;
+}
+
+const std::unordered_map<string, BinaryFn>& BinaryOps() {
+  static const auto* ops = new std::unordered_map<string, BinaryFn>({
+      {"Add", [](double x, double y) { return x + y; }},
+      {"AddV2", [](double x, double y) { return x + y; }},
+      {"Sub", [](double x, double y) { return x - y; }},
+      {"Mul", [](double x, double y) { return x * y; }},
+      {"RealDiv", [](double x, double y) { return x / y; }},
+      {"Maximum", [](double x, double y) { return std::max(x, y); }},
+      {"Minimum", [](double x, double y) { return std::min(x, y); }},
+  });
+  return *ops;
+}
+
+// Integers are evaluated natively. Additions and multiplications wrap around
+// like the kernels of TF, since they're computed modulo 2^64 and truncated to
+// the output type.
+const std::unordered_map<string, IntegerBinaryFn>& IntegerBinaryOps() {
+  static const auto* ops = new std::unordered_map<string, IntegerBinaryFn>({
+      {"Add",
+       [](int64 x, int64 y) {
+         return static_cast<int64>(static_cast<uint64>(x) +
+                                   static_cast<uint64>(y));
+       }},
+      {"AddV2",
+       [](int64 x, int64 y) {
+         return static_cast<int64>(static_cast<uint64>(x) +
+                                   static_cast<uint64>(y));
+       }},
+      {"Sub",
+       [](int64 x, int64 y) {
+         return static_cast<int64>(static_cast<uint64>(x) -
+                                   static_cast<uint64>(y));
+       }},
+      {"Mul",
+       [](int64 x, int64 y) {
+         return static_cast<int64>(static_cast<uint64>(x) *
+                                   static_cast<uint64>(y));
+       }},
+      {"Maximum", [](int64 x, int64 y) { return std::max(x, y); }},
+      {"Minimum", [](int64 x, int64 y) { return std::min(x, y); }},
+  });
+  return *ops;
+}
+
+// Ops only changing the shape or the order of their first input.
+bool IsDataMovement(const string& op) {
+  return op == "Identity" || op == "Snapshot" || op == "StopGradient" ||
+         op == "Reshape" || op == "ExpandDims" || op == "Squeeze" ||
+         op == "Transpose";
+}
+
+bool IsFloatingType(DataType type) {
+  return type == DT_FLOAT || type == DT_BFLOAT16 || type == DT_HALF;
+}
+
+bool IsIntegerType(DataType type) {
+  return type == DT_INT32 || type == DT_INT64;
+}
+
+bool IsNumericType(DataType type) {
+  return IsFloatingType(type) || IsIntegerType(type);
+}
+
+template <typename T>
+void ReadAs(const Tensor& tensor, std::vector<double>* values) {
+  const T* data = static_cast<const T*>(tensor.data());
+  values->resize(tensor.NumElements());
+  for (int64 i = 0; i < tensor.NumElements(); ++i) {
+    (*values)[i] = static_cast<double>(static_cast<float>(data[i]));
+  }
+}
+
+template <typename T>
+void ReadIntegersAs(const Tensor& tensor, std::vector<int64>* values) {
+  const T* data = static_cast<const T*>(tensor.data());
+  values->assign(data, data + tensor.NumElements());
+}
+
+Status Read(const Tensor& tensor, std::vector<double>* values) {
+  switch (tensor.dtype()) {
+    case DT_FLOAT:
+      ReadAs<float>(tensor, values);
+      break;
+    case DT_BFLOAT16:
+      ReadAs<Eigen::bfloat16>(tensor, values);
+      break;
+    case DT_HALF:
+      ReadAs<Eigen::half>(tensor, values);
+      break;
+    default:
+      return errors::Unimplemented("Unsupported type ",
+                                   DataTypeString(tensor.dtype()));
+  }
+  return Status::OK();
+}
+
+Status Read(const Tensor& tensor, std::vector<int64>* values) {
+  switch (tensor.dtype()) {
+    case DT_INT32:
+      ReadIntegersAs<int32>(tensor, values);
+      break;
+    case DT_INT64:
+      ReadIntegersAs<int64>(tensor, values);
+      break;
+    default:
+      return errors::Unimplemented("Unsupported type ",
+                                   DataTypeString(tensor.dtype()));
+  }
+  return Status::OK();
+}
+
+// Floating values are rounded to float first, like the kernels computing in
+// float. Integers are converted as by the Cast kernel.
+template <typename T, typename V>
+void WriteAs(const std::vector<V>& values, Tensor* tensor) {
+  T* data = static_cast<T*>(tensor->data());
+  for (size_t i = 0; i < values.size(); ++i) {
+    data[i] = static_cast<T>(static_cast<float>(values[i]));
+  }
+}
+
+template <typename T>
+void WriteIntegersAs(const std::vector<int64>& values, Tensor* tensor) {
+  T* data = static_cast<T*>(tensor->data());
+  for (size_t i = 0; i < values.size(); ++i) {
+    // Truncates int64 to int32 as two's complement.
+    data[i] = static_cast<T>(values[i]);
+  }
+}
+
+Status Write(const std::vector<double>& values, DataType type,
+             const TensorShape& shape, Tensor* tensor) {
+  *tensor = Tensor(type, shape);
+  switch (type) {
+    case DT_FLOAT:
+      WriteAs<float>(values, tensor);
+      break;
+    case DT_BFLOAT16:
+      WriteAs<Eigen::bfloat16>(values, tensor);
+      break;
+    case DT_HALF:
+      WriteAs<Eigen::half>(values, tensor);
+      break;
+    default:
+      return errors::Unimplemented("Unsupported type ", DataTypeString(type));
+  }
+  return Status::OK();
+}
+
+Status Write(const std::vector<int64>& values, DataType type,
+             const TensorShape& shape, Tensor* tensor) {
+  *tensor = Tensor(type, shape);
+  switch (type) {
+    case DT_FLOAT:
+      WriteAs<float>(values, tensor);
+      break;
+    case DT_BFLOAT16:
+      WriteAs<Eigen::bfloat16>(values, tensor);
+      break;
+    case DT_HALF:
+      WriteAs<Eigen::half>(values, tensor);
+      break;
+    case DT_INT32:
+      WriteIntegersAs<int32>(values, tensor);
+      break;
+    case DT_INT64:
+      WriteIntegersAs<int64>(values, tensor);
+      break;
+    default:
+      return errors::Unimplemented("Unsupported type ", DataTypeString(type));
+  }
+  return Status::OK();
+}
+
+Status ReadIndices(const Tensor& tensor, std::vector<int64>* indices) {
+  if (!IsIntegerType(tensor.dtype())) {
+    return errors::InvalidArgument("Indices must be integers");
+  }
+  return Read(tensor, indices);
+}
+
+// Truncates floating `values` to integers of `type`, as the Cast kernel does.
+// Values out of the range of `type` are undefined there, so they aren't
+// folded.
+Status TruncateToIntegers(const std::vector<double>& values, DataType type,
+                          std::vector<int64>* integers) {
+  const double min = type == DT_INT32 ? std::numeric_limits<int32>::min()
+                                      : std::numeric_limits<int64>::min();
+  // 2^31 and 2^63 are exact in double, unlike the max values.
+  const double limit = -min;
+  integers->resize(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    const double value = std::trunc(values[i]);
+    if (!(value >= min && value < limit)) {
+      return errors::Unimplemented("Cast of ", values[i], " out of range of ",
+                                   DataTypeString(type));
+    }
+    (*integers)[i] = static_cast<int64>(value);
+  }
+  return Status::OK();
+}
+
+// Computes the numpy style broadcast of `x` and `y`.
+Status BroadcastShape(const TensorShape& x, const TensorShape& y,
+                      TensorShape* out) {
+  const int rank = std::max(x.dims(), y.dims());
+  std::vector<int64> dims(rank);
+  for (int i = 0; i < rank; ++i) {
+    const int xi = i - (rank - x.dims());
+    const int yi = i - (rank - y.dims());
+    const int64 xd = xi >= 0 ? x.dim_size(xi) : 1;
+    const int64 yd = yi >= 0 ? y.dim_size(yi) : 1;
+    if (xd != yd && xd != 1 && yd != 1) {
+      return errors::InvalidArgument("Incompatible shapes ", x.DebugString(),
+                                     " and ", y.DebugString());
+    }
+    dims[i] = xd == 1 ? yd : xd;
+  }
+  *out = TensorShape(dims);
+  return Status::OK();
+}
+
+// Returns the strides to read `in` broadcast to `out`, 0 on broadcast dims.
+std::vector<int64> BroadcastStrides(const TensorShape& in,
+                                    const TensorShape& out) {
+  std::vector<int64> strides(out.dims(), 0);
+  int64 stride = 1;
+  for (int i = in.dims() - 1; i >= 0; --i) {
+    const int oi = i + out.dims() - in.dims();
+    strides[oi] = in.dim_size(i) == 1 ? 0 : stride;
+    stride *= in.dim_size(i);
+  }
+  return strides;
+}
+
+// Evaluates `fn` on values of type V, double for floating types and int64
+// for integers.
+template <typename V, typename Fn>
+Status EvaluateBinary(const Fn& fn, const Tensor& x, const Tensor& y,
+                      Tensor* output) {
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(BroadcastShape(x.shape(), y.shape(), &shape));
+  std::vector<V> xs, ys;
+  TF_RETURN_IF_ERROR(Read(x, &xs));
+  TF_RETURN_IF_ERROR(Read(y, &ys));
+
+  const std::vector<int64> x_strides = BroadcastStrides(x.shape(), shape);
+  const std::vector<int64> y_strides = BroadcastStrides(y.shape(), shape);
+  std::vector<V> values(shape.num_elements());
+  std::vector<int64> index(shape.dims(), 0);
+  for (int64 i = 0; i < shape.num_elements(); ++i) {
+    int64 xi = 0, yi = 0;
+    for (int d = 0; d < shape.dims(); ++d) {
+      xi += index[d] * x_strides[d];
+      yi += index[d] * y_strides[d];
+    }
+    values[i] = fn(xs[xi], ys[yi]);
+    for (int d = shape.dims() - 1; d >= 0; --d) {
+      if (++index[d] < shape.dim_size(d)) break;
+      index[d] = 0;
+    }
+  }
+  return Write(values, x.dtype(), shape, output);
+}
+
+Status EvaluateTranspose(const Tensor& x, const Tensor& perm_tensor,
+                         Tensor* output) {
+  std::vector<int64> perm;
+  TF_RETURN_IF_ERROR(ReadIndices(perm_tensor, &perm));
+  if (static_cast<int>(perm.size()) != x.dims()) {
+    return errors::InvalidArgument("Transpose permutation of wrong size");
+  }
+  std::vector<int64> in_strides(x.dims(), 1);
+  for (int d = x.dims() - 2; d >= 0; --d) {
+    in_strides[d] = in_strides[d + 1] * x.dim_size(d + 1);
+  }
+  std::vector<int64> dims;
+  for (int64 p : perm) {
+    if (p < 0 || p >= x.dims()) {
+      return errors::InvalidArgument("Invalid transpose permutation");
+    }
+    dims.push_back(x.dim_size(p));
+  }
+  TensorShape shape(dims);
+  *output = Tensor(x.dtype(), shape);
+
+  const size_t size = DataTypeSize(x.dtype());
+  const char* src = static_cast<const char*>(x.data());
+  char* dst = static_cast<char*>(output->data());
+  std::vector<int64> index(shape.dims(), 0);
+  for (int64 i = 0; i < shape.num_elements(); ++i) {
+    int64 offset = 0;
+    for (int d = 0; d < shape.dims(); ++d) {
+      offset += index[d] * in_strides[perm[d]];
+    }
+    std::memcpy(dst + i * size, src + offset * size, size);
+    for (int d = shape.dims() - 1; d >= 0; --d) {
+      if (++index[d] < shape.dim_size(d)) break;
+      index[d] = 0;
+    }
+  }
+  return Status::OK();
+}
+
+// Computes the output shape of the ops only changing the shape of input 0.
+Status ReshapedShape(const NodeDef& node, const std::vector<Tensor>& inputs,
+                     TensorShape* shape) {
+  const TensorShape& in = inputs[0].shape();
+  std::vector<int64> dims;
+  for (int d = 0; d < in.dims(); ++d) dims.push_back(in.dim_size(d));
+
+  if (node.op() == "Reshape") {
+    TF_RETURN_IF_ERROR(ReadIndices(inputs[1], &dims));
+    int64 known = 1;
+    int unknown = -1;
+    for (int d = 0; d < static_cast<int>(dims.size()); ++d) {
+      if (dims[d] == -1) {
+        unknown = d;
+      } else {
+        known *= dims[d];
+      }
+    }
+    if (unknown >= 0 && known > 0) dims[unknown] = in.num_elements() / known;
+  } else if (node.op() == "ExpandDims") {
+    std::vector<int64> axis;
+    TF_RETURN_IF_ERROR(ReadIndices(inputs[1], &axis));
+    if (axis.size() != 1) return errors::InvalidArgument("Invalid axis");
+    int64 a = axis[0] < 0 ? axis[0] + in.dims() + 1 : axis[0];
+    if (a < 0 || a > in.dims()) return errors::InvalidArgument("Invalid axis");
+    dims.insert(dims.begin() + a, 1);
+  } else if (node.op() == "Squeeze") {
+    std::vector<int32> squeeze_dims;
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(AttrSlice(node), "squeeze_dims", &squeeze_dims));
+    std::vector<int64> squeezed;
+    auto is_listed = [&](int d) {
+      if (squeeze_dims.empty()) return true;
+      for (int32 s : squeeze_dims) {
+        if ((s < 0 ? s + in.dims() : s) == d) return true;
+      }
+      return false;
+    };
+    for (int d = 0; d < in.dims(); ++d) {
+      if (!(is_listed(d) && in.dim_size(d) == 1)) {
+        squeezed.push_back(in.dim_size(d));
+      }
+    }
+    dims.swap(squeezed);
+  }
+
+  *shape = TensorShape(dims);
+  if (shape->num_elements() != in.num_elements()) {
+    return errors::InvalidArgument("Cannot reshape ", in.DebugString(), " to ",
+                                   shape->DebugString());
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+bool IsEvaluable(const NodeDef& node) {
+  const string& op = node.op();
+  // Only reads the shape of its input.
+  if (op == "Shape") return true;
+
+  DataType type = DT_INVALID;
+  // Data is moved by bytes, which is only valid for plain numeric types, e.g.
+  // not for strings.
+  if (IsDataMovement(op)) {
+    return GetNodeAttr(AttrSlice(node), "T", &type).ok() &&
+           IsNumericType(type);
+  }
+  if (op == "Cast") {
+    DataType src_type = DT_INVALID;
+    return GetNodeAttr(AttrSlice(node), "SrcT", &src_type).ok() &&
+           GetNodeAttr(AttrSlice(node), "DstT", &type).ok() &&
+           IsNumericType(src_type) && IsNumericType(type);
+  }
+  if (!GetNodeAttr(AttrSlice(node), "T", &type).ok() ||
+      !IsNumericType(type)) {
+    return false;
+  }
+  if (IsIntegerType(type)) return IntegerBinaryOps().count(op) > 0;
+  return BinaryOps().count(op) > 0 || UnaryOps().count(op) > 0;
+}
+
+Status EvaluateNode(const NodeDef& node, const std::vector<Tensor>& inputs,
+                    Tensor* output) {
+  const string& op = node.op();
+  if (inputs.empty()) {
+    return errors::InvalidArgument("No input to evaluate ", node.name());
+  }
+
+  if (IsDataMovement(op) && !IsNumericType(inputs[0].dtype())) {
+    return errors::Unimplemented("Cannot evaluate ", op, " on ",
+                                 DataTypeString(inputs[0].dtype()));
+  }
+
+  if (op == "Identity" || op == "Snapshot" || op == "StopGradient") {
+    *output = inputs[0];
+    return Status::OK();
+  }
+
+  if (op == "Transpose") {
+    if (inputs.size() != 2) return errors::InvalidArgument("Invalid Transpose");
+    return EvaluateTranspose(inputs[0], inputs[1], output);
+  }
+
+  if (IsDataMovement(op)) {
+    if (op != "Squeeze" && inputs.size() != 2) {
+      return errors::InvalidArgument("Invalid ", op);
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(ReshapedShape(node, inputs, &shape));
+    *output = Tensor(inputs[0].dtype(), shape);
+    std::memcpy(output->data(), inputs[0].data(), inputs[0].TotalBytes());
+    return Status::OK();
+  }
+
+  if (op == "Shape") {
+    DataType out_type = DT_INT32;
+    GetNodeAttr(AttrSlice(node), "out_type", &out_type).IgnoreError();
+    const TensorShape& in = inputs[0].shape();
+    std::vector<int64> dims;
+    for (int d = 0; d < in.dims(); ++d) dims.push_back(in.dim_size(d));
+    return Write(dims, out_type, TensorShape({in.dims()}), output);
+  }
+
+  if (op == "Cast") {
+    DataType type;
+    TF_RETURN_IF_ERROR(GetNodeAttr(AttrSlice(node), "DstT", &type));
+    std::vector<int64> integers;
+    if (IsIntegerType(inputs[0].dtype())) {
+      TF_RETURN_IF_ERROR(Read(inputs[0], &integers));
+      return Write(integers, type, inputs[0].shape(), output);
+    }
+    std::vector<double> values;
+    TF_RETURN_IF_ERROR(Read(inputs[0], &values));
+    if (IsFloatingType(type)) {
+      return Write(values, type, inputs[0].shape(), output);
+    }
+    TF_RETURN_IF_ERROR(TruncateToIntegers(values, type, &integers));
+    return Write(integers, type, inputs[0].shape(), output);
+  }
+
+  if (IsIntegerType(inputs[0].dtype())) {
+    auto binary = IntegerBinaryOps().find(op);
+    if (binary == IntegerBinaryOps().end()) {
+      return errors::Unimplemented("Cannot evaluate ", op, " on integers");
+    }
+    if (inputs.size() != 2 || inputs[0].dtype() != inputs[1].dtype()) {
+      return errors::InvalidArgument("Invalid inputs of ", op);
+    }
+    return EvaluateBinary<int64>(binary->second, inputs[0], inputs[1],
+                                 output);
+  }
+
+  auto unary = UnaryOps().find(op);
+  if (unary != UnaryOps().end()) {
+    std::vector<double> values;
+    TF_RETURN_IF_ERROR(Read(inputs[0], &values));
+    for (double& value : values) value = unary->second(value);
+    return Write(values, inputs[0].dtype(), inputs[0].shape(), output);
+  }
+
+  auto binary = BinaryOps().find(op);
+  if (binary != BinaryOps().end()) {
+    if (inputs.size() != 2 || inputs[0].dtype() != inputs[1].dtype()) {
+      return errors::InvalidArgument("Invalid inputs of ", op);
+    }
+    return EvaluateBinary<double>(binary->second, inputs[0], inputs[1],
+                                  output);
+  }
+
+  return errors::Unimplemented("Cannot evaluate ", op);
+}
+
+}  // namespace graph
+}  // namespace itex
@@ -0,0 +1,44 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_CONSTANT_FOLDING_CONSTANT_EVALUATOR_H_
+#define ITEX_CORE_GRAPH_CONSTANT_FOLDING_CONSTANT_EVALUATOR_H_
+
+#include <vector>
+
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/status.h"
+#include "protos/graph.pb.h"
+
+namespace itex {
+namespace graph {
+
+// Returns true if `node` can be evaluated by EvaluateNode once all its inputs
+// are constants. Quantization ops are never evaluated, so that Q/DQ patterns
+// reach oneDNN Graph and the INT8 fusions intact. Except for Shape, only
+// float, bfloat16, half, int32 and int64 tensors are evaluated.
+bool IsEvaluable(const NodeDef& node);
+
+// Evaluates the single output of `node` on host from its regular `inputs`.
+// Floating arithmetic is done in double precision and rounded once to the
+// output type, which matches the results of the float kernels. Integers are
+// evaluated natively and wrap around on overflow like the TF kernels.
+Status EvaluateNode(const NodeDef& node, const std::vector<Tensor>& inputs,
+                    Tensor* output);
+
+}  // namespace graph
+}  // namespace itex
+
+#endif  // ITEX_CORE_GRAPH_CONSTANT_FOLDING_CONSTANT_EVALUATOR_H_
@@ -0,0 +1,495 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/constant_folding/constant_folding.h"
+
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "itex/core/graph/constant_folding/constant_evaluator.h"
+#include "itex/core/graph/utils/op_types.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/node_def_util.h"
+#include "itex/core/utils/strcat.h"
+
+namespace itex {
+namespace graph {
+
+using utils::MutableNodeView;
+
+namespace {
+
+// Same default as the constant folding of TF.
+constexpr int64 kDefaultMaxConstantBytes = 10 * 1024 * 1024;
+
+bool IsInPreserveSet(const ConstantFoldingContext& ctx, const NodeDef* node) {
+  return ctx.nodes_to_preserve.count(node->name()) > 0;
+}
+
+// Returns the value of `node` if it's a constant without control inputs.
+bool GetConstValue(const MutableNodeView& node_view, Tensor* value) {
+  const NodeDef* node = node_view.node();
+  if (!IsAnyConst(*node) || node_view.NumControllingFanins() > 0) return false;
+  return value->FromProto(node->attr().at("value").tensor());
+}
+
+// Returns the fanin of `node_view` at `port`, if it's read from output 0.
+MutableNodeView* GetFaninAtPort0(const MutableNodeView& node_view, int port) {
+  if (port >= node_view.NumRegularFanins()) return nullptr;
+  const auto& fanin = node_view.GetRegularFanin(port);
+  return fanin.index() == 0 ? fanin.node_view() : nullptr;
+}
+
+// Returns true if `node_view` is only read once, through its output 0.
+bool HasSingleUse(const MutableNodeView& node_view) {
+  if (node_view.NumControlledFanouts() > 0) return false;
+  const auto& fanouts = node_view.GetRegularFanouts();
+  for (int port = 1; port < static_cast<int>(fanouts.size()); ++port) {
+    if (!fanouts[port].empty()) return false;
+  }
+  return !fanouts.empty() && fanouts[0].size() == 1;
+}
+
+NodeDef MakeConstNode(const string& name, const string& device,
+                      const Tensor& value) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("Const");
+  node.set_device(device);
+  AttrValue dtype;
+  dtype.set_type(value.dtype());
+  node.mutable_attr()->insert({"dtype", dtype});
+  AttrValue tensor;
+  value.AsProtoTensorContent(tensor.mutable_tensor());
+  node.mutable_attr()->insert({"value", tensor});
+  return node;
+}
+
+// Per-channel y = x * scale + offset applied to the output of a contraction.
+struct ContractionWithAffine {
+  int contraction = -1;
+  int bias_add = -1;
+  int root = -1;
+  // Rank of the output of the contraction.
+  int rank = 0;
+  Tensor weights;
+  std::vector<float> bias;
+  std::vector<float> scale;
+  std::vector<float> offset;
+};
+
+// Returns the number of output channels of a contraction with `weights`.
+int64 NumOutputChannels(const NodeDef& contraction, const Tensor& weights) {
+  if (IsMatMul(contraction)) {
+    bool transpose_b = false;
+    GetNodeAttr(AttrSlice(contraction), "transpose_b", &transpose_b)
+        .IgnoreError();
+    return weights.dim_size(transpose_b ? 0 : 1);
+  }
+  // Weights are HWIO for Conv2D and HWIM for DepthwiseConv2dNative.
+  if (IsDepthwiseConv2dNative(contraction)) {
+    return weights.dim_size(2) * weights.dim_size(3);
+  }
+  return weights.dim_size(3);
+}
+
+// Broadcasts a constant of a single value or of `channels` values along the
+// innermost dim. The constant must not broadcast the output of rank `rank` to
+// a higher one, and all its other dims must be 1.
+bool GetPerChannel(const Tensor& value, int64 channels, int rank,
+                   std::vector<float>* values) {
+  if (value.dtype() != DT_FLOAT || value.dims() > rank) return false;
+  for (int d = 0; d < value.dims() - 1; ++d) {
+    if (value.dim_size(d) != 1) return false;
+  }
+  const float* data = static_cast<const float*>(value.data());
+  if (value.NumElements() == 1) {
+    values->assign(channels, data[0]);
+    return true;
+  }
+  if (value.NumElements() != channels) return false;
+  values->assign(data, data + channels);
+  return true;
+}
+
+bool FindContraction(const ConstantFoldingContext& ctx,
+                     MutableNodeView* producer, ContractionWithAffine* matched,
+                     string* data_format) {
+  if (producer == nullptr || IsInPreserveSet(ctx, producer->node()) ||
+      !HasSingleUse(*producer) || producer->NumControllingFanins() > 0) {
+    return false;
+  }
+
+  MutableNodeView* contraction = producer;
+  Tensor bias;
+  if (IsBiasAdd(*producer->node())) {
+    if (!GetConstValue(*producer->GetRegularFanin(1).node_view(), &bias) ||
+        bias.dtype() != DT_FLOAT) {
+      return false;
+    }
+    contraction = GetFaninAtPort0(*producer, 0);
+    if (contraction == nullptr || IsInPreserveSet(ctx, contraction->node()) ||
+        !HasSingleUse(*contraction) ||
+        contraction->NumControllingFanins() > 0) {
+      return false;
+    }
+    matched->bias_add = producer->node_index();
+  }
+
+  const NodeDef* node = contraction->node();
+  if (!IsConv2D(*node) && !IsDepthwiseConv2dNative(*node) && !IsMatMul(*node))
+    return false;
+  if (GetDataTypeFromAttr(*node, "T") != DT_FLOAT) return false;
+  // Weights from Dequantize or FakeQuant aren't constants, which keeps Q/DQ.
+  if (!GetConstValue(*contraction->GetRegularFanin(1).node_view(),
+                     &matched->weights) ||
+      matched->weights.dtype() != DT_FLOAT) {
+    return false;
+  }
+  if (IsMatMul(*node)) {
+    if (matched->weights.dims() != 2) return false;
+    *data_format = "NHWC";
+  } else if (!GetNodeAttr(AttrSlice(*node), "data_format", data_format).ok() ||
+             matched->weights.dims() != 4) {
+    return false;
+  }
+  // The output has the rank of the weights.
+  matched->rank = matched->weights.dims();
+
+  const int64 channels = NumOutputChannels(*node, matched->weights);
+  matched->bias.assign(channels, 0.0f);
+  if (matched->bias_add >= 0 &&
+      !GetPerChannel(bias, channels, /*rank=*/1, &matched->bias)) {
+    return false;
+  }
+  matched->contraction = contraction->node_index();
+  return true;
+}
+
+bool FindContractionWithAffine(const ConstantFoldingContext& ctx, int index,
+                               ContractionWithAffine* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(index);
+  const NodeDef* node = node_view->node();
+  if (IsInPreserveSet(ctx, node) || node_view->NumControllingFanins() > 0 ||
+      GetDataTypeFromAttr(*node, "T") != DT_FLOAT) {
+    return false;
+  }
+
+  string data_format;
+  if (IsFusedBatchNorm(*node)) {
+    bool is_training = true;
+    float epsilon = 0.0001f;
+    GetNodeAttr(AttrSlice(*node), "is_training", &is_training).IgnoreError();
+    GetNodeAttr(AttrSlice(*node), "epsilon", &epsilon).IgnoreError();
+    if (is_training) return false;
+    // Only the normalized output may be used.
+    const auto& fanouts = node_view->GetRegularFanouts();
+    for (int port = 1; port < static_cast<int>(fanouts.size()); ++port) {
+      if (!fanouts[port].empty()) return false;
+    }
+
+    Tensor params[4];
+    for (int i = 0; i < 4; ++i) {
+      if (!GetConstValue(*node_view->GetRegularFanin(i + 1).node_view(),
+                         &params[i])) {
+        return false;
+      }
+    }
+    if (!FindContraction(ctx, GetFaninAtPort0(*node_view, 0), matched,
+                         &data_format)) {
+      return false;
+    }
+    string bn_format = "NHWC";
+    GetNodeAttr(AttrSlice(*node), "data_format", &bn_format).IgnoreError();
+    if (bn_format != data_format) return false;
+
+    const int64 channels = matched->bias.size();
+    std::vector<float> gamma, beta, mean, variance;
+    if (!GetPerChannel(params[0], channels, /*rank=*/1, &gamma) ||
+        !GetPerChannel(params[1], channels, /*rank=*/1, &beta) ||
+        !GetPerChannel(params[2], channels, /*rank=*/1, &mean) ||
+        !GetPerChannel(params[3], channels, /*rank=*/1, &variance)) {
+      return false;
+    }
+    matched->scale.resize(channels);
+    matched->offset.resize(channels);
+    for (int64 c = 0; c < channels; ++c) {
+      matched->scale[c] = gamma[c] / std::sqrt(variance[c] + epsilon);
+      matched->offset[c] = beta[c] - mean[c] * matched->scale[c];
+    }
+  } else if (IsMul(*node) || IsAdd(*node)) {
+    // The constant may be either operand.
+    Tensor value;
+    int data_port = 0;
+    if (GetConstValue(*node_view->GetRegularFanin(1).node_view(), &value)) {
+      data_port = 0;
+    } else if (GetConstValue(*node_view->GetRegularFanin(0).node_view(),
+                             &value)) {
+      data_port = 1;
+    } else {
+      return false;
+    }
+    if (!FindContraction(ctx, GetFaninAtPort0(*node_view, data_port), matched,
+                         &data_format)) {
+      return false;
+    }
+
+    const int64 channels = matched->bias.size();
+    // Only the innermost dim may be a channel, not the C of NCHW.
+    std::vector<float> values;
+    if ((data_format != "NHWC" && value.NumElements() != 1) ||
+        !GetPerChannel(value, channels, matched->rank, &values)) {
+      return false;
+    }
+    if (IsMul(*node)) {
+      matched->scale = std::move(values);
+      matched->offset.assign(channels, 0.0f);
+    } else {
+      matched->scale.assign(channels, 1.0f);
+      matched->offset = std::move(values);
+    }
+  } else {
+    return false;
+  }
+
+  matched->root = index;
+  return true;
+}
+
+Status AddFoldedContraction(ConstantFoldingContext* ctx,
+                            ContractionWithAffine* matched) {
+  auto* contraction_view = ctx->graph_view.GetNode(matched->contraction);
+  auto* weights_view = contraction_view->GetRegularFanin(1).node_view();
+  auto* root_view = ctx->graph_view.GetNode(matched->root);
+  const NodeDef* contraction = contraction_view->node();
+  const NodeDef* root = root_view->node();
+
+  const int64 channels = matched->scale.size();
+  bool transpose_b = false;
+  if (IsMatMul(*contraction)) {
+    GetNodeAttr(AttrSlice(*contraction), "transpose_b", &transpose_b)
+        .IgnoreError();
+  }
+  Tensor weights(DT_FLOAT, matched->weights.shape());
+  const float* src = static_cast<const float*>(matched->weights.data());
+  float* dst = static_cast<float*>(weights.data());
+  const int64 inner = matched->weights.NumElements() / channels;
+  for (int64 i = 0; i < weights.NumElements(); ++i) {
+    dst[i] = src[i] * matched->scale[transpose_b ? i / inner : i % channels];
+  }
+
+  Tensor bias(DT_FLOAT, TensorShape({channels}));
+  float* bias_data = static_cast<float*>(bias.data());
+  for (int64 c = 0; c < channels; ++c) {
+    bias_data[c] = matched->bias[c] * matched->scale[c] + matched->offset[c];
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  // Update the weights in place unless other nodes read them.
+  if (HasSingleUse(*weights_view) &&
+      !IsInPreserveSet(*ctx, weights_view->node())) {
+    AttrValue value;
+    weights.AsProtoTensorContent(value.mutable_tensor());
+    mutation->AddOrUpdateNodeAttr(weights_view, "value", value);
+  } else {
+    const string name = strings::StrCat(contraction->name(), "/folded_weights");
+    mutation->AddNode(MakeConstNode(name, weights_view->node()->device(),
+                                    weights),
+                      &status);
+    TF_RETURN_IF_ERROR(status);
+    mutation->AddOrUpdateRegularFanin(contraction_view, 1, {name, 0});
+  }
+
+  const string bias_name = strings::StrCat(root->name(), "/folded_bias");
+  mutation->AddNode(MakeConstNode(bias_name, root->device(), bias), &status);
+  TF_RETURN_IF_ERROR(status);
+
+  string data_format = "NHWC";
+  if (!IsMatMul(*contraction)) {
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(AttrSlice(*contraction), "data_format", &data_format));
+  }
+  NodeDef bias_add;
+  bias_add.set_name(root->name());
+  bias_add.set_op("BiasAdd");
+  bias_add.set_device(root->device());
+  bias_add.add_input(contraction->name());
+  bias_add.add_input(bias_name);
+  AttrValue type;
+  type.set_type(DT_FLOAT);
+  bias_add.mutable_attr()->insert({"T", type});
+  AttrValue format;
+  format.set_s(data_format);
+  bias_add.mutable_attr()->insert({"data_format", format});
+  mutation->AddNode(std::move(bias_add), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  if (matched->bias_add >= 0) ctx->nodes_to_delete[matched->bias_add] = true;
+  return Status::OK();
+}
+
+// Marks constants left without any use for deletion.
+void MarkUnusedConstants(ConstantFoldingContext* ctx) {
+  const int num_nodes = ctx->nodes_to_delete.size();
+  // Nodes to delete don't use their fanins anymore.
+  std::vector<int> num_uses(num_nodes, 0);
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto* node_view = ctx->graph_view.GetNode(i);
+    num_uses[i] = node_view->NumControlledFanouts();
+    for (const auto& fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : fanouts) {
+        if (fanout.node_index() >= num_nodes ||
+            !ctx->nodes_to_delete[fanout.node_index()]) {
+          ++num_uses[i];
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto* node_view = ctx->graph_view.GetNode(i);
+    if (num_uses[i] == 0 && IsAnyConst(*node_view->node()) &&
+        node_view->NumControllingFanins() == 0 &&
+        !IsInPreserveSet(*ctx, node_view->node())) {
+      ctx->nodes_to_delete[i] = true;
+    }
+  }
+}
+
+}  // namespace
+
+int FoldConstantNodes(ConstantFoldingContext* ctx) {
+  int num_folded = 0;
+  const int num_nodes = ctx->nodes_to_delete.size();
+  for (int i = 0; i < num_nodes; ++i) {
+    auto* node_view = ctx->graph_view.GetNode(i);
+    const NodeDef* node = node_view->node();
+    if (!IsEvaluable(*node) || IsInPreserveSet(*ctx, node) ||
+        node_view->NumControllingFanins() > 0 ||
+        node_view->NumRegularFanins() == 0) {
+      continue;
+    }
+
+    std::vector<Tensor> inputs;
+    bool all_const = true;
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      Tensor value;
+      if (!GetConstValue(*fanin.node_view(), &value)) {
+        all_const = false;
+        break;
+      }
+      inputs.push_back(std::move(value));
+    }
+    if (!all_const) continue;
+
+    Tensor output;
+    Status status = EvaluateNode(*node, inputs, &output);
+    if (!status.ok()) {
+      ITEX_VLOG(2) << "ConstantFolding: skip " << node->name() << ", "
+                   << status.error_message();
+      continue;
+    }
+    if (static_cast<int64>(output.TotalBytes()) > ctx->max_constant_bytes) {
+      ITEX_VLOG(2) << "ConstantFolding: skip " << node->name() << " of "
+                   << output.TotalBytes() << " bytes";
+      continue;
+    }
+
+    utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+    mutation->AddNode(MakeConstNode(node->name(), node->device(), output),
+                      &status);
+    if (status.ok()) status = mutation->Apply();
+    if (!status.ok()) {
+      ITEX_VLOG(2) << "ConstantFolding: failed to fold " << node->name()
+                   << ", " << status.error_message();
+      mutation->Reset();
+      continue;
+    }
+    ++num_folded;
+  }
+  return num_folded;
+}
+
+int FoldAffineIntoContraction(ConstantFoldingContext* ctx) {
+  int num_folded = 0;
+  const int num_nodes = ctx->nodes_to_delete.size();
+  for (int i = 0; i < num_nodes; ++i) {
+    ContractionWithAffine matched;
+    if (!FindContractionWithAffine(*ctx, i, &matched)) continue;
+
+    // Materializing a copy of shared weights must respect the budget.
+    auto* weights_view = ctx->graph_view.GetNode(matched.contraction)
+                             ->GetRegularFanin(1)
+                             .node_view();
+    if (!HasSingleUse(*weights_view) &&
+        static_cast<int64>(matched.weights.TotalBytes()) >
+            ctx->max_constant_bytes) {
+      continue;
+    }
+
+    const string name = ctx->graph_view.GetNode(i)->node()->name();
+    Status status = AddFoldedContraction(ctx, &matched);
+    if (!status.ok()) {
+      ITEX_VLOG(2) << "ConstantFolding: failed to fold " << name << ", "
+                   << status.error_message();
+      continue;
+    }
+    ITEX_VLOG(2) << "ConstantFolding: folded " << name << " into weights";
+    ++num_folded;
+  }
+  return num_folded;
+}
+
+Status RunConstantFolding(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                          const GraphDef& graph_def,
+                          GraphDef* optimized_graph) {
+  Status status;
+  GraphDef mutable_graph_def = graph_def;
+  ConstantFoldingContext ctx(item, &mutable_graph_def, &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("ITEX_CONSTANT_FOLDING_MAX_BYTES",
+                                         kDefaultMaxConstantBytes,
+                                         &ctx.max_constant_bytes));
+
+  // Evaluating in topological order folds whole constant subgraphs at once.
+  TF_RETURN_IF_ERROR(
+      ctx.graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+  ctx.nodes_to_delete.assign(ctx.graph_view.NumNodes(), false);
+
+  const int num_folded = FoldConstantNodes(&ctx);
+  const int num_affine = FoldAffineIntoContraction(&ctx);
+  ITEX_VLOG(1) << "ConstantFolding: folded " << num_folded
+               << " nodes into constants and " << num_affine
+               << " nodes into weights.";
+
+  MarkUnusedConstants(&ctx);
+  utils::Mutation* mutation = ctx.graph_view.GetMutationBuilder();
+  for (int i = 0; i < static_cast<int>(ctx.nodes_to_delete.size()); ++i) {
+    if (ctx.nodes_to_delete[i]) {
+      mutation->RemoveNode(ctx.graph_view.GetNode(i));
+    }
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  *optimized_graph = std::move(mutable_graph_def);
+  return Status::OK();
+}
+
+}  // namespace graph
+}  // namespace itex
@@ -0,0 +1,62 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_CONSTANT_FOLDING_CONSTANT_FOLDING_H_
+#define ITEX_CORE_GRAPH_CONSTANT_FOLDING_CONSTANT_FOLDING_H_
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "itex/core/graph/utils/graph_view.h"
+#include "itex/core/graph/utils/grappler_item.h"
+#include "itex/core/graph/utils/utils.h"
+#include "protos/graph.pb.h"
+
+namespace itex {
+namespace graph {
+
+struct ConstantFoldingContext {
+  explicit ConstantFoldingContext(const GrapplerItem& item, GraphDef* g_def,
+                                  Status* status)
+      : graph_view(g_def, status), nodes_to_preserve(item.NodesToPreserve()) {}
+
+  utils::MutableGraphView graph_view;
+  std::unordered_set<string> nodes_to_preserve;
+  // Folded constants larger than this are not materialized.
+  int64 max_constant_bytes = 0;
+  // Nodes left without any use by folding, removed at the end of the pass.
+  std::vector<bool> nodes_to_delete;
+};
+
+// Replaces nodes whose inputs are all constants with the constant they
+// evaluate to, see IsEvaluable() for the supported ops. Returns the number of
+// folded nodes.
+int FoldConstantNodes(ConstantFoldingContext* ctx);
+
+// Folds inference FusedBatchNorm, and Mul or Add by a per-channel constant,
+// following Conv2D, DepthwiseConv2dNative or MatMul with constant weights,
+// into the weights and a BiasAdd. Returns the number of folded nodes.
+int FoldAffineIntoContraction(ConstantFoldingContext* ctx);
+
+// Constant folding of ITEX, enabled by ITEX_CONSTANT_FOLDING. Unlike the one of
+// TF, it never evaluates quantization ops, so that INT8 patterns are kept.
+Status RunConstantFolding(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                          const GraphDef& graph_def, GraphDef* optimized_graph);
+
+}  // namespace graph
+}  // namespace itex
+
+#endif  // ITEX_CORE_GRAPH_CONSTANT_FOLDING_CONSTANT_FOLDING_H_
@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "itex/core/graph/generic_layout_optimizer/transpose_sinking.h"
 #include "itex/core/graph/remapper/remapper.h"
 #include "itex/core/graph/utils/op_types.h"
 #include "itex/core/graph/utils/utils.h"
@@ -226,15 +227,21 @@ inline Status EraseCancellableIdenityNodes(GenericLayoutContext* context) {
   return mutation->Apply();
 }
 
-Status GenericLayoutContext::InitializeContext(bool assume_valid_feeds,
+Status GenericLayoutContext::InitializeContext(OptimizerContext* opt_ctx,
                                                const GrapplerItem& item,
                                                const GraphDef& graph_def,
                                                GenericLayoutContext* context) {
   // DCHECK(context != nullptr);
   context->graph = graph_def;
-  context->graph_properties = std::make_unique<GraphProperties>(item);
-  TF_RETURN_IF_ERROR(
-      context->graph_properties->InferStatically(assume_valid_feeds));
+  context->graph_properties = &GetSharedGraphProperties(opt_ctx, item);
+  if (!context->graph_properties->IsInferred()) {
+    TF_RETURN_IF_ERROR(context->graph_properties->InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/true));
+  }
+  context->graph_properties->Refresh(graph_def);
   Status status;
   context->graph_view =
       std::make_unique<utils::MutableGraphView>(&context->graph, &status);
@@ -253,7 +260,7 @@ Status GenericLayoutOptimizer::Optimize(OptimizerContext* opt_ctx,
   GenericLayoutContext context;
   // needs to be checked
   TF_RETURN_IF_ERROR(GenericLayoutContext::InitializeContext(
-      /*assume_valid_feeds=*/false, item, graph_def, &context));
+      opt_ctx, item, graph_def, &context));
 
   ITEX_VLOG(3) << "Start to run GenericLayoutOptimizer pass";
   utils::MutableGraphView* graph_view = context.graph_view.get();
@@ -278,6 +285,10 @@ Status GenericLayoutOptimizer::Optimize(OptimizerContext* opt_ctx,
 
   // TF_RETURN_IF_ERROR(EraseCancellableIdenityNodes(&trans_context));
 
+  // Move the remaining transposes through layout-agnostic ops, so that they
+  // meet and cancel each other.
+  TF_RETURN_IF_ERROR(SinkTransposes(opt_ctx->device_name, &context));
+
   *optimized_graph = context.graph;
   return OkStatus();
 }
@@ -41,22 +41,17 @@ namespace graph {
 // the same GraphDef instance.
 struct GenericLayoutContext {
   // Initializes GenericLayoutContext with given GrapplerItem. Because
-  // initializing FrameMap and GraphProperties may return error, we initialize
+  // inferring GraphProperties may return error, we initialize
   // GenericLayoutContext outside constructor.
-  static Status InitializeContext(bool assume_valid_feeds,
+  static Status InitializeContext(OptimizerContext* opt_ctx,
                                   const GrapplerItem& item,
                                   const GraphDef& graph_def,
                                   GenericLayoutContext* context);
 
-  static Status InitializeContext(const GrapplerItem& item,
-                                  const GraphDef& graph_def,
-                                  GenericLayoutContext* context) {
-    return InitializeContext(false, item, graph_def, context);
-  }
-
   GraphDef graph;
   absl::flat_hash_set<string> nodes_to_preserve;
-  std::unique_ptr<GraphProperties> graph_properties;
+  // Shared with the other passes through the OptimizerContext.
+  GraphProperties* graph_properties = nullptr;
   std::unique_ptr<utils::MutableGraphView> graph_view;
 };
 
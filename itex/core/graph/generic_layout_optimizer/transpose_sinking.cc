@@ -0,0 +1,556 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/generic_layout_optimizer/transpose_sinking.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "itex/core/graph/utils/op_types.h"
+#include "itex/core/graph/utils/utils.h"
+#include "itex/core/utils/strcat.h"
+
+namespace itex {
+namespace graph {
+namespace {
+
+// Every sweep moves transposes at least one op further, so this bounds the
+// distance a transpose can travel.
+constexpr int kMaxSinkingSweeps = 32;
+
+bool IsLayoutAgnosticUnary(const NodeDef& node) {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "Abs",      "Cast",       "Ceil",    "Cos",      "Elu",
+      "Erf",      "Exp",        "Floor",   "IsFinite", "IsInf",
+      "IsNan",    "LeakyRelu",  "Log",     "Log1p",    "LogicalNot",
+      "Neg",      "Reciprocal", "Relu",    "Relu6",    "Round",
+      "Rsqrt",    "Selu",       "Sigmoid", "Sign",     "Sin",
+      "Softplus", "Softsign",   "Sqrt",    "Square",   "Tanh"};
+  return ops->contains(node.op());
+}
+
+bool IsLayoutAgnosticBinary(const NodeDef& node) {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "Add",          "AddV2",    "Div",       "DivNoNan",
+      "Equal",        "FloorDiv", "FloorMod",  "Greater",
+      "GreaterEqual", "Less",     "LessEqual", "LogicalAnd",
+      "LogicalOr",    "Maximum",  "Minimum",   "Mul",
+      "NotEqual",     "Pow",      "RealDiv",   "SquaredDifference",
+      "Sub"};
+  return ops->contains(node.op());
+}
+
+bool IsSinkableReduction(const NodeDef& node) {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "All", "Any", "Max", "Mean", "Min", "Prod", "Sum"};
+  return ops->contains(node.op());
+}
+
+DataType OutputType(const NodeDef& node) {
+  static const auto* bool_ops = new absl::flat_hash_set<string>{
+      "All",          "Any",       "Equal",      "Greater",
+      "GreaterEqual", "IsFinite",  "IsInf",      "IsNan",
+      "Less",         "LessEqual", "LogicalAnd", "LogicalNot",
+      "LogicalOr",    "NotEqual"};
+  if (IsCast(node)) return GetDataTypeFromAttr(node, "DstT");
+  if (bool_ops->contains(node.op())) return DT_BOOL;
+  return GetDataTypeFromAttr(node, "T");
+}
+
+bool IsIdentityPerm(const std::vector<int64>& perm) {
+  const int64 rank = perm.size();
+  for (int64 i = 0; i < rank; ++i) {
+    if (perm[i] != i) return false;
+  }
+  return true;
+}
+
+// Permutation of Transpose(Transpose(x, inner), outer).
+std::vector<int64> ComposePerm(const std::vector<int64>& inner,
+                               const std::vector<int64>& outer) {
+  std::vector<int64> perm(outer.size());
+  for (size_t i = 0; i < outer.size(); ++i) perm[i] = inner[outer[i]];
+  return perm;
+}
+
+// Returns true iff transposing `dims` by `perm` keeps the order of the dims
+// that are not known to be 1, i.e. the transpose doesn't move any data.
+bool IsReshapeLikePerm(const std::vector<int64>& dims,
+                       const std::vector<int64>& perm) {
+  int64 last = -1;
+  for (int64 d : perm) {
+    if (dims[d] == 1) continue;
+    if (d < last) return false;
+    last = d;
+  }
+  return true;
+}
+
+class TransposeSinker {
+ public:
+  TransposeSinker(const char* device_name, GenericLayoutContext* context)
+      : device_name_(device_name), context_(context) {}
+
+  Status Run() {
+    for (int sweep = 0; sweep < kMaxSinkingSweeps; ++sweep) {
+      if (!Sweep()) break;
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Applies every rewrite it can find without overlapping earlier ones.
+  // Returns true iff the graph changed.
+  bool Sweep() {
+    GraphDef* graph = &context_->graph;
+    node_map_ = std::make_unique<NodeMap>(graph);
+    bool changed = false;
+    const int num_nodes = graph->node_size();
+    for (int i = 0; i < num_nodes; ++i) {
+      NodeDef* node = graph->mutable_node(i);
+      if (!IsCandidate(*node)) continue;
+      if (IsTranspose(*node)) {
+        changed |= SimplifyTranspose(node);
+      } else if (IsLayoutAgnosticUnary(*node)) {
+        changed |= SinkThroughUnary(node);
+      } else if (IsLayoutAgnosticBinary(*node)) {
+        changed |= SinkThroughBinary(node);
+      } else if (IsSinkableReduction(*node)) {
+        changed |= SinkThroughReduction(node);
+      } else if (IsConcatV2(*node)) {
+        changed |= SinkThroughConcat(node);
+      } else if (IsSplit(*node)) {
+        changed |= SinkThroughSplit(node);
+      } else if (IsReshape(*node)) {
+        changed |= BypassTransposeBeforeReshape(node);
+      }
+    }
+
+    if (!to_delete_.empty()) {
+      GraphDef pruned;
+      for (auto& node : *graph->mutable_node()) {
+        if (!to_delete_.contains(node.name())) {
+          *pruned.add_node() = std::move(node);
+        }
+      }
+      graph->mutable_node()->Swap(pruned.mutable_node());
+    }
+    for (auto& node : new_nodes_) *graph->add_node() = std::move(node);
+    new_nodes_.clear();
+    to_delete_.clear();
+    touched_.clear();
+    return changed;
+  }
+
+  bool IsCandidate(const NodeDef& node) const {
+    return !touched_.contains(node.name()) &&
+           !to_delete_.contains(node.name()) &&
+           NodeIsOnDevice(device_name_, &node) &&
+           !context_->nodes_to_preserve.contains(node.name());
+  }
+
+  // Reads an int32/int64 Const node feeding `input`.
+  bool GetConstValues(const string& input, std::vector<int64>* values) const {
+    if (IsControlInput(input)) return false;
+    const NodeDef* node = node_map_->GetNode(input);
+    if (node == nullptr || !IsConstant(*node)) return false;
+    Tensor tensor;
+    if (!tensor.FromProto(node->attr().at("value").tensor())) return false;
+    values->clear();
+    for (int i = 0; i < tensor.NumElements(); ++i) {
+      if (tensor.dtype() == DT_INT32) {
+        values->push_back(tensor.flat<int32>()(i));
+      } else if (tensor.dtype() == DT_INT64) {
+        values->push_back(tensor.flat<int64>()(i));
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns true iff `input` is produced by a Transpose with a constant
+  // permutation that only feeds `consumer`, so it can be moved past it.
+  bool GetSinkablePerm(const string& input, const NodeDef& consumer,
+                       std::vector<int64>* perm) const {
+    if (IsControlInput(input)) return false;
+    const NodeDef* transpose = node_map_->GetNode(input);
+    if (transpose == nullptr || !IsTranspose(*transpose) ||
+        !IsCandidate(*transpose) || transpose->input_size() != 2 ||
+        IsControlInput(transpose->input(0)) ||
+        !GetConstValues(transpose->input(1), perm))
+      return false;
+
+    const auto& outputs = node_map_->GetOutputs(transpose->name());
+    if (outputs.size() != 1 || *outputs.begin() != &consumer) return false;
+    for (const string& consumer_input : consumer.input()) {
+      if (consumer_input == AsControlDependency(transpose->name()))
+        return false;
+    }
+    return true;
+  }
+
+  // Static dims of `tensor`, -1 for unknown ones.
+  bool GetShape(const string& tensor, std::vector<int64>* dims) const {
+    if (IsControlInput(tensor)) return false;
+    int port = 0;
+    const string name = ParseNodeName(tensor, &port);
+    if (stale_shapes_.contains(name)) return false;
+    std::vector<OpInfo_TensorProperties> props;
+    if (!context_->graph_properties->GetOutputProperties(name, &props).ok() ||
+        port >= static_cast<int>(props.size()) ||
+        props[port].shape().unknown_rank())
+      return false;
+    dims->clear();
+    for (const auto& dim : props[port].shape().dim()) {
+      dims->push_back(dim.size());
+    }
+    return true;
+  }
+
+  // Returns a new node name starting with `prefix`.
+  string UniqueName(const string& prefix) {
+    string name = prefix;
+    for (int i = 1; node_map_->NodeExists(name) || reserved_.contains(name);
+         ++i) {
+      name = strings::StrCat(prefix, "_", i);
+    }
+    reserved_.insert(name);
+    return name;
+  }
+
+  // Queues a new int Const node named after `prefix` and returns its name.
+  string AddConst(const string& prefix, const std::vector<int64>& values,
+                  bool scalar, DataType dtype, const string& device) {
+    const string name = UniqueName(prefix);
+
+    Tensor tensor(dtype, scalar ? TensorShape()
+                                : TensorShape({static_cast<int64>(
+                                      values.size())}));
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (dtype == DT_INT32) {
+        tensor.flat<int32>()(i) = static_cast<int32>(values[i]);
+      } else {
+        tensor.flat<int64>()(i) = values[i];
+      }
+    }
+
+    NodeDef const_node;
+    const_node.set_name(name);
+    const_node.set_op("Const");
+    const_node.set_device(device);
+    AttrValue attr_type;
+    attr_type.set_type(dtype);
+    AttrValue attr_tensor;
+    tensor.AsProtoTensorContent(attr_tensor.mutable_tensor());
+    const_node.mutable_attr()->insert({"dtype", attr_type});
+    const_node.mutable_attr()->insert({"value", attr_tensor});
+    new_nodes_.push_back(std::move(const_node));
+    return name;
+  }
+
+  DataType IndexType(const NodeDef& node, const string& attr) const {
+    return node.attr().count(attr) ? node.attr().at(attr).type() : DT_INT32;
+  }
+
+  // Rewrites op(..., Transpose(x_i, p), ...) into Transpose(op(..., x_i,
+  // ...), out_perm) for every input in `transposed`. The transpose takes the
+  // op's name, so consumers need no rewiring. The op gets a new name, as its
+  // output shapes differ from those of both old nodes.
+  void SinkThrough(NodeDef* op, const std::vector<int>& transposed,
+                   const std::vector<int64>& out_perm) {
+    const NodeDef* first = node_map_->GetNode(op->input(transposed[0]));
+    std::vector<int64> first_perm;
+    GetConstValues(first->input(1), &first_perm);
+
+    NodeDef new_op = *op;
+    for (int index : transposed) {
+      const NodeDef* transpose = node_map_->GetNode(op->input(index));
+      new_op.set_input(index, transpose->input(0));
+      to_delete_.insert(transpose->name());
+    }
+    new_op.set_name(UniqueName(AddPrefixToNodeName("sunk", op->name())));
+    new_op.mutable_attr()->erase("_output_shapes");
+
+    NodeDef new_transpose = *first;
+    new_transpose.set_name(op->name());
+    new_transpose.set_input(0, new_op.name());
+    if (out_perm != first_perm) {
+      new_transpose.set_input(
+          1, AddConst(AddPrefixToNodeName("perm", op->name()), out_perm,
+                      /*scalar=*/false, IndexType(*first, "Tperm"),
+                      first->device()));
+    }
+    SetAttrValue(OutputType(*op), &(*new_transpose.mutable_attr())["T"]);
+    new_transpose.mutable_attr()->erase("_output_shapes");
+
+    ITEX_VLOG(3) << "Sink Transpose " << first->name() << " through "
+                 << op->op() << " " << op->name();
+    touched_.insert(op->name());
+    stale_shapes_.insert(new_op.name());
+    new_nodes_.push_back(std::move(new_op));
+    *op = std::move(new_transpose);
+  }
+
+  bool SimplifyTranspose(NodeDef* node) {
+    std::vector<int64> perm;
+    if (node->input_size() < 2 || IsControlInput(node->input(1)) ||
+        !GetConstValues(node->input(1), &perm))
+      return false;
+
+    if (IsIdentityPerm(perm)) {
+      ITEX_VLOG(3) << "Remove identity Transpose " << node->name();
+      node->set_op("Identity");
+      node->mutable_attr()->erase("Tperm");
+      node->mutable_input()->DeleteSubrange(1, 1);
+      touched_.insert(node->name());
+      return true;
+    }
+
+    std::vector<int64> inner_perm;
+    if (GetSinkablePerm(node->input(0), *node, &inner_perm) &&
+        inner_perm.size() == perm.size()) {
+      const NodeDef* inner = node_map_->GetNode(node->input(0));
+      ITEX_VLOG(3) << "Merge Transpose " << inner->name() << " into "
+                   << node->name();
+      node->set_input(1, AddConst(AddPrefixToNodeName("perm", node->name()),
+                                  ComposePerm(inner_perm, perm),
+                                  /*scalar=*/false, IndexType(*node, "Tperm"),
+                                  node->device()));
+      node->set_input(0, inner->input(0));
+      to_delete_.insert(inner->name());
+      touched_.insert(node->name());
+      return true;
+    }
+
+    // A transpose that only moves size-1 dims is a reshape, which is free.
+    std::vector<int64> dims;
+    if (!GetShape(node->input(0), &dims) || dims.size() != perm.size() ||
+        !IsReshapeLikePerm(dims, perm))
+      return false;
+    std::vector<int64> out_dims;
+    for (int64 d : perm) {
+      if (dims[d] < 0) return false;
+      out_dims.push_back(dims[d]);
+    }
+    ITEX_VLOG(3) << "Replace Transpose " << node->name() << " with Reshape";
+    node->set_op("Reshape");
+    node->mutable_attr()->erase("Tperm");
+    SetAttrValue(DT_INT32, &(*node->mutable_attr())["Tshape"]);
+    node->set_input(1, AddConst(AddPrefixToNodeName("shape", node->name()),
+                                out_dims, /*scalar=*/false, DT_INT32,
+                                node->device()));
+    touched_.insert(node->name());
+    return true;
+  }
+
+  bool SinkThroughUnary(NodeDef* node) {
+    std::vector<int64> perm;
+    if (!GetSinkablePerm(node->input(0), *node, &perm)) return false;
+    SinkThrough(node, {0}, perm);
+    return true;
+  }
+
+  bool SinkThroughBinary(NodeDef* node) {
+    std::vector<int64> perm0, perm1, dims;
+    const bool sink0 = GetSinkablePerm(node->input(0), *node, &perm0);
+    const bool sink1 = GetSinkablePerm(node->input(1), *node, &perm1);
+    if (sink0 && sink1) {
+      // Same-rank broadcasting commutes with the permutation.
+      if (perm0 != perm1) return false;
+      SinkThrough(node, {0, 1}, perm0);
+      return true;
+    }
+    // The other side must be a scalar to broadcast the same way.
+    if (sink0 && GetShape(node->input(1), &dims) && dims.empty()) {
+      SinkThrough(node, {0}, perm0);
+      return true;
+    }
+    if (sink1 && GetShape(node->input(0), &dims) && dims.empty()) {
+      SinkThrough(node, {1}, perm1);
+      return true;
+    }
+    return false;
+  }
+
+  bool SinkThroughReduction(NodeDef* node) {
+    std::vector<int64> perm, axes;
+    if (!GetSinkablePerm(node->input(0), *node, &perm) ||
+        !GetConstValues(node->input(1), &axes))
+      return false;
+    const int rank = perm.size();
+    std::vector<bool> reduced(rank, false);
+    std::vector<int64> new_axes;
+    for (int64 axis : axes) {
+      if (axis < -rank || axis >= rank) return false;
+      if (axis < 0) axis += rank;
+      reduced[axis] = true;
+      new_axes.push_back(perm[axis]);
+    }
+
+    bool keep_dims = false;
+    TF_ABORT_IF_ERROR(GetNodeAttr(*node, "keep_dims", &keep_dims));
+    std::vector<int64> out_perm = perm;
+    if (!keep_dims) {
+      // Renumber the dims of x that survive the reduction.
+      std::vector<int64> kept;
+      for (int i = 0; i < rank; ++i) {
+        if (!reduced[i]) kept.push_back(perm[i]);
+      }
+      std::vector<int64> sorted = kept;
+      std::sort(sorted.begin(), sorted.end());
+      out_perm.clear();
+      for (int64 d : kept) {
+        out_perm.push_back(std::lower_bound(sorted.begin(), sorted.end(), d) -
+                           sorted.begin());
+      }
+    }
+
+    node->set_input(1, AddConst(AddPrefixToNodeName("axes", node->name()),
+                                new_axes, /*scalar=*/false,
+                                IndexType(*node, "Tidx"), node->device()));
+    SinkThrough(node, {0}, out_perm);
+    return true;
+  }
+
+  bool SinkThroughConcat(NodeDef* node) {
+    int64 num_values = 0;
+    TF_ABORT_IF_ERROR(GetNodeAttr(*node, "N", &num_values));
+    std::vector<int64> perm, axis;
+    std::vector<int> transposed;
+    for (int i = 0; i < num_values; ++i) {
+      std::vector<int64> input_perm;
+      if (!GetSinkablePerm(node->input(i), *node, &input_perm)) return false;
+      if (i > 0 && input_perm != perm) return false;
+      perm = input_perm;
+      transposed.push_back(i);
+    }
+    if (!GetConstValues(node->input(num_values), &axis) || axis.size() != 1)
+      return false;
+    const int rank = perm.size();
+    if (axis[0] < -rank || axis[0] >= rank) return false;
+    const int64 new_axis = perm[axis[0] < 0 ? axis[0] + rank : axis[0]];
+
+    node->set_input(num_values,
+                    AddConst(AddPrefixToNodeName("axis", node->name()),
+                             {new_axis}, /*scalar=*/true,
+                             IndexType(*node, "Tidx"), node->device()));
+    SinkThrough(node, transposed, perm);
+    return true;
+  }
+
+  // Split has several outputs, so instead of moving the transpose after it,
+  // it's merged into the transposes consuming every output. The Split is
+  // replaced by one with a new name, since its outputs are now permuted.
+  bool SinkThroughSplit(NodeDef* node) {
+    std::vector<int64> perm, axis;
+    if (!GetSinkablePerm(node->input(1), *node, &perm) ||
+        !GetConstValues(node->input(0), &axis) || axis.size() != 1)
+      return false;
+    const int rank = perm.size();
+    if (axis[0] < -rank || axis[0] >= rank) return false;
+
+    const auto consumers = node_map_->GetOutputsOrderedByNodeName(node->name());
+    if (consumers.empty()) return false;
+    std::vector<std::vector<int64>> consumer_perms;
+    for (NodeDef* consumer : consumers) {
+      std::vector<int64> consumer_perm;
+      if (!IsTranspose(*consumer) || !IsCandidate(*consumer) ||
+          consumer->input_size() < 2 ||
+          NodeName(consumer->input(0)) != node->name() ||
+          !GetConstValues(consumer->input(1), &consumer_perm) ||
+          static_cast<int>(consumer_perm.size()) != rank)
+        return false;
+      for (int i = 1; i < consumer->input_size(); ++i) {
+        if (NodeName(consumer->input(i)) == node->name()) return false;
+      }
+      consumer_perms.push_back(consumer_perm);
+    }
+
+    const NodeDef* transpose = node_map_->GetNode(node->input(1));
+    ITEX_VLOG(3) << "Merge Transpose " << transpose->name()
+                 << " into the consumers of Split " << node->name();
+    NodeDef new_split = *node;
+    new_split.set_name(UniqueName(AddPrefixToNodeName("sunk", node->name())));
+    new_split.set_input(
+        0, AddConst(AddPrefixToNodeName("axis", node->name()),
+                    {perm[axis[0] < 0 ? axis[0] + rank : axis[0]]},
+                    /*scalar=*/true, DT_INT32, node->device()));
+    new_split.set_input(1, transpose->input(0));
+    new_split.mutable_attr()->erase("_output_shapes");
+
+    for (size_t i = 0; i < consumers.size(); ++i) {
+      NodeDef* consumer = consumers[i];
+      int port = 0;
+      ParseNodeName(consumer->input(0), &port);
+      consumer->set_input(0, port == 0 ? new_split.name()
+                                       : strings::StrCat(new_split.name(),
+                                                         ":", port));
+      consumer->set_input(
+          1, AddConst(AddPrefixToNodeName("perm", consumer->name()),
+                      ComposePerm(perm, consumer_perms[i]),
+                      /*scalar=*/false, IndexType(*consumer, "Tperm"),
+                      consumer->device()));
+      touched_.insert(consumer->name());
+    }
+    to_delete_.insert(transpose->name());
+    to_delete_.insert(node->name());
+    stale_shapes_.insert(new_split.name());
+    new_nodes_.push_back(std::move(new_split));
+    return true;
+  }
+
+  // Reshape(Transpose(x, p)) == Reshape(x) when p doesn't move any data.
+  bool BypassTransposeBeforeReshape(NodeDef* node) {
+    std::vector<int64> perm, dims;
+    if (!GetSinkablePerm(node->input(0), *node, &perm)) return false;
+    const NodeDef* transpose = node_map_->GetNode(node->input(0));
+    if (!GetShape(transpose->input(0), &dims) || dims.size() != perm.size() ||
+        !IsReshapeLikePerm(dims, perm))
+      return false;
+    ITEX_VLOG(3) << "Remove Transpose " << transpose->name()
+                 << " before Reshape " << node->name();
+    node->set_input(0, transpose->input(0));
+    to_delete_.insert(transpose->name());
+    touched_.insert(node->name());
+    return true;
+  }
+
+  const char* device_name_;
+  GenericLayoutContext* context_;
+  std::unique_ptr<NodeMap> node_map_;
+  // Nodes rewritten in the current sweep. Their fanouts in `node_map_` are
+  // stale, so they are left alone until the next sweep.
+  absl::flat_hash_set<string> touched_;
+  absl::flat_hash_set<string> to_delete_;
+  absl::flat_hash_set<string> reserved_;
+  std::vector<NodeDef> new_nodes_;
+  // Nodes whose output shapes in the graph properties no longer hold.
+  absl::flat_hash_set<string> stale_shapes_;
+};
+
+}  // namespace
+
+Status SinkTransposes(const char* device_name, GenericLayoutContext* context) {
+  ITEX_VLOG(3) << "Start to run transpose sinking.";
+  TransposeSinker sinker(device_name, context);
+  return sinker.Run();
+}
+
+}  // namespace graph
+}  // namespace itex
@@ -0,0 +1,40 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_GENERIC_LAYOUT_OPTIMIZER_TRANSPOSE_SINKING_H_
+#define ITEX_CORE_GRAPH_GENERIC_LAYOUT_OPTIMIZER_TRANSPOSE_SINKING_H_
+
+#include "itex/core/graph/generic_layout_optimizer/generic_layout_optimizer.h"
+
+namespace itex {
+namespace graph {
+
+// Pushes Transpose nodes with constant permutations towards the outputs of
+// the graph, through layout-agnostic elementwise ops, reductions, ConcatV2
+// and Split, so that they meet and cancel each other:
+//
+//   Transpose(Transpose(x, p1), p2)  ->  Transpose(x, p1 o p2)
+//   Transpose(x, identity)           ->  Identity(x)
+//   Transpose only moving size-1 dims -> Reshape
+//   Op(Transpose(x, p), ...)         ->  Transpose(Op(x, ...), p')
+//
+// Works on `context->graph` in place. `context->graph_view` is stale
+// afterwards.
+Status SinkTransposes(const char* device_name, GenericLayoutContext* context);
+
+}  // namespace graph
+}  // namespace itex
+
+#endif  // ITEX_CORE_GRAPH_GENERIC_LAYOUT_OPTIMIZER_TRANSPOSE_SINKING_H_
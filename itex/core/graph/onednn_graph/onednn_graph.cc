@@ -20,6 +20,7 @@ limitations under the License.
 #include <limits>
 #include <map>
 #include <set>
+#include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -57,7 +58,7 @@ using TranslationMap =
 static const std::unordered_set<std::string> non_int8_candidate_set = {
     {"FusedBatchNormGradV3", "LayerNormGrad", "ITEXLayerNormGrad",
      "MaxPoolGrad", "ReluGrad", "GeluGrad", "ITEXGeluGrad", "ResizeBilinear",
-     "Select"}};
+     "ResizeNearestNeighbor", "Select"}};
 
 // Input and output index in LLGA op and TF op maybe different, e.g. diff_dst
 // input in TF BNGrad is 0, while in LLGA BNGrad is 1. Thus, we need to map the
@@ -86,10 +87,14 @@ static const std::unordered_map<std::string, std::vector<int>>
         {"QuantizeV2", {0}},
         {"ReluGrad", {1, 0}},
         {"Reshape", {0}},
+        {"ExpandDims", {0}},
+        {"Pow", {0}},
+        {"ClipByValue", {0}},
         {"Min", {0}},
         {"Max", {0}},
         {"Mean", {0}},
         {"ResizeBilinear", {0}},
+        {"ResizeNearestNeighbor", {0}},
         {"Sum", {0}},
         {"Transpose", {0}},
         {"Dequantize", {0}}};
@@ -321,6 +326,31 @@ void GetShapeFromConstDataNode(const NodeDef* node,
   return;
 }
 
+// Reads a scalar floating point constant, e.g. the bounds of ClipByValue.
+bool GetScalarFromConstNode(const NodeDef* node, float* value) {
+  if (!IsAnyConst(*node)) return false;
+
+  Tensor data_tensor;
+  if (!data_tensor.FromProto(node->attr().at("value").tensor()) ||
+      data_tensor.NumElements() != 1) {
+    return false;
+  }
+
+  switch (data_tensor.dtype()) {
+    case DT_FLOAT:
+      *value = data_tensor.flat<float>()(0);
+      return true;
+    case DT_BFLOAT16:
+      *value = static_cast<float>(data_tensor.flat<Eigen::bfloat16>()(0));
+      return true;
+    case DT_HALF:
+      *value = static_cast<float>(data_tensor.flat<Eigen::half>()(0));
+      return true;
+    default:
+      return false;
+  }
+}
+
 std::vector<int64_t> GetReshapeTargetShape(
     const utils::MutableNodeView* node_view) {
   if (node_view->node()->op() != "Pack") return {};
@@ -564,6 +594,7 @@ void SetStaticShapeAttr(const OneDnnGraphContext* ctx,
              node_def->op() == "Min" || node_def->op() == "Max" ||
              node_def->op() == "Reshape" ||
              node_def->op() == "ResizeBilinear" ||
+             node_def->op() == "ResizeNearestNeighbor" ||
              node_def->op() == "Transpose") {
     size_input_index = 1;
   } else if (node_def->op() == "ConcatV2") {
@@ -649,7 +680,8 @@ void SetStaticShapeAttr(const OneDnnGraphContext* ctx,
       (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::shape, size_value);
     } else if (node_def->op() == "Transpose") {
       (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::order, size_value);
-    } else if (node_def->op() == "ResizeBilinear") {
+    } else if (node_def->op() == "ResizeBilinear" ||
+               node_def->op() == "ResizeNearestNeighbor") {
       (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::sizes, size_value);
     } else if (node_def->op() == "ConcatV2") {
       (*onednn_graph_node)
@@ -1040,10 +1072,46 @@ Status TranslateTranspose(const OneDnnGraphContext* ctx, const int node_index,
   return Status::OK();
 }
 
-[[maybe_unused]] Status TranslateResize(const OneDnnGraphContext* ctx,
-                                        const int node_index,
-                                        const utils::MutableNodeView* node_view,
-                                        dnnl::graph::op** onednn_graph_node) {
+// Squeeze and ExpandDims only change the rank, so they are StaticReshape to
+// the inferred output shape.
+Status TranslateSqueeze(const OneDnnGraphContext* ctx, const int node_index,
+                        const utils::MutableNodeView* node_view,
+                        dnnl::graph::op** onednn_graph_node) {
+  if (IsOpOutputFolded(ctx, node_view)) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  auto* node_def = node_view->node();
+  std::vector<OpInfo_TensorProperties> props;
+  TF_ABORT_IF_ERROR(
+      ctx->graph_properties.GetOutputProperties(node_def->name(), &props));
+  if (props.size() != 1 || props[0].shape().unknown_rank() ||
+      IsScalar(props[0].shape())) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  std::vector<int64_t> shape_value;
+  for (const auto& dim : props[0].shape().dim()) {
+    shape_value.push_back(dim.size() < 0 ? -1 : dim.size());
+  }
+  // StaticReshape infers at most one unknown dimension.
+  if (std::count(shape_value.begin(), shape_value.end(), -1) > 1) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  *onednn_graph_node = new dnnl::graph::op(
+      node_index, dnnl::graph::op::kind::StaticReshape, node_def->name());
+  (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::shape, shape_value);
+  (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::special_zero, false);
+  return Status::OK();
+}
+
+Status TranslateResize(const OneDnnGraphContext* ctx, const int node_index,
+                       const utils::MutableNodeView* node_view,
+                       dnnl::graph::op** onednn_graph_node) {
   if (IsOpOutputFolded(ctx, node_view)) {
     onednn_graph_node = nullptr;
     return Status::OK();
@@ -1065,6 +1133,14 @@ Status TranslateTranspose(const OneDnnGraphContext* ctx, const int node_index,
     return Status::OK();
   }
 
+  // Nearest neighbor of TF only matches the rounding of oneDNN Graph with
+  // half pixel centers.
+  bool is_nearest = node_def->op() == "ResizeNearestNeighbor";
+  if (is_nearest && align_corners) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
   *onednn_graph_node = new dnnl::graph::op(
       node_index, dnnl::graph::op::kind::Interpolate, node_def->name());
 
@@ -1075,10 +1151,11 @@ Status TranslateTranspose(const OneDnnGraphContext* ctx, const int node_index,
     return Status::OK();
   }
 
-  SetStaticShapeAttr(ctx, node_view, onednn_graph_node);
-
   (*onednn_graph_node)
-      ->set_attr(dnnl::graph::op::attr::mode, std::string("bilinear"));
+      ->set_attr(dnnl::graph::op::attr::mode,
+                 std::string(is_nearest ? "nearest" : "bilinear"));
+  (*onednn_graph_node)
+      ->set_attr(dnnl::graph::op::attr::data_format, std::string("NXC"));
 
   if (half_pixel_centers) {
     (*onednn_graph_node)
@@ -1201,16 +1278,19 @@ Status TranslateEltwise(const OneDnnGraphContext* ctx, const int node_index,
 
   static std::map<std::string, kind> TF_LLGA_op_map = {
       {"Elu", kind::Elu},
+      {"Exp", kind::Exp},
       {"Gelu", kind::GELU},
       {"ITEXGelu", kind::GELU},
       {"GeluGrad", kind::GELUBackward},
       {"ITEXGeluGrad", kind::GELUBackward},
       {"LeakyRelu", kind::LeakyReLU},
+      {"Log", kind::Log},
       {"_ITEXMish", kind::Mish},
       {"Sigmoid", kind::Sigmoid},
       {"Relu", kind::ReLU},
       {"ReluGrad", kind::ReLUBackward},
       {"Relu6", kind::Clamp},
+      {"Round", kind::Round},
       // #ifndef ITEX_ONEDNN_3_0
       //       {"Rsqrt", kind::Rsqrt},
       // #endif
@@ -1240,6 +1320,55 @@ Status TranslateEltwise(const OneDnnGraphContext* ctx, const int node_index,
   }
 }
 
+// oneDNN Graph Pow takes the exponent as attribute, so only constant scalar
+// exponents are supported.
+Status TranslatePow(const OneDnnGraphContext* ctx, const int node_index,
+                    const utils::MutableNodeView* node_view,
+                    dnnl::graph::op** onednn_graph_node) {
+  if (IsOpOutputFolded(ctx, node_view)) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  auto* node_def = node_view->node();
+  float beta;
+  if (!GetScalarFromConstNode(
+          node_view->GetRegularFanin(1).node_view()->node(), &beta)) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  *onednn_graph_node = new dnnl::graph::op(
+      node_index, dnnl::graph::op::kind::Pow, node_def->name());
+  (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::beta, beta);
+  return Status::OK();
+}
+
+Status TranslateClip(const OneDnnGraphContext* ctx, const int node_index,
+                     const utils::MutableNodeView* node_view,
+                     dnnl::graph::op** onednn_graph_node) {
+  if (IsOpOutputFolded(ctx, node_view)) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  auto* node_def = node_view->node();
+  float min_value, max_value;
+  if (!GetScalarFromConstNode(
+          node_view->GetRegularFanin(1).node_view()->node(), &min_value) ||
+      !GetScalarFromConstNode(
+          node_view->GetRegularFanin(2).node_view()->node(), &max_value)) {
+    onednn_graph_node = nullptr;
+    return Status::OK();
+  }
+
+  *onednn_graph_node = new dnnl::graph::op(
+      node_index, dnnl::graph::op::kind::Clamp, node_def->name());
+  (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::min, min_value);
+  (*onednn_graph_node)->set_attr(dnnl::graph::op::attr::max, max_value);
+  return Status::OK();
+}
+
 Status TranslateSoftmax(const OneDnnGraphContext* ctx, const int node_index,
                         const utils::MutableNodeView* node_view,
                         dnnl::graph::op** onednn_graph_node) {
@@ -1292,7 +1421,10 @@ Status TranslateBinary(const OneDnnGraphContext* ctx, const int node_index,
   static std::map<std::string, kind> TF_LLGA_op_map = {
       {"Add", kind::Add},
       {"AddV2", kind::Add},
+      {"Maximum", kind::Maximum},
+      {"Minimum", kind::Minimum},
       {"Mul", kind::Multiply},
+      {"RealDiv", kind::Divide},
       {"SquaredDifference", kind::SquaredDifference},
       {"Sub", kind::Subtract}};
 
@@ -1796,8 +1928,15 @@ const TranslationMap& getTranslationMap() {
       {"GeluGrad", TranslateEltwise},
       {"ITEXGeluGrad", TranslateEltwise},
       {"_ITEXMish", TranslateEltwise},
+      {"Exp", TranslateEltwise},
+      {"Log", TranslateEltwise},
+      {"Round", TranslateEltwise},
+      {"Pow", TranslatePow},
+      {"ClipByValue", TranslateClip},
       {"Reshape", TranslateReshape},
       {"Transpose", TranslateTranspose},
+      {"Squeeze", TranslateSqueeze},
+      {"ExpandDims", TranslateSqueeze},
       {"Softmax", TranslateSoftmax},
       ////// binary
       {"Add", TranslateBinary},
@@ -1805,9 +1944,11 @@ const TranslationMap& getTranslationMap() {
       {"Sub", TranslateBinary},
       {"Mul", TranslateBinary},
       {"SquaredDifference", TranslateBinary},
-
-      // TODO(itex): enable the op mapping
-      // {"ResizeBilinear", TranslateResize},
+      {"RealDiv", TranslateBinary},
+      {"Maximum", TranslateBinary},
+      {"Minimum", TranslateBinary},
+      {"ResizeBilinear", TranslateResize},
+      {"ResizeNearestNeighbor", TranslateResize},
 
       {"AddN", TranslateAddN},
       {"BiasAdd", TranslateBiasAdd},
@@ -2022,6 +2163,8 @@ Status SelectNode(OneDnnGraphContext* ctx, int num_nodes,
       if (rewrite_nodes->find(f_node_def->name()) != rewrite_nodes->end())
         continue;
     }
+    if (is_wildcard) ctx->boundary_ops[f_node_def->op()]++;
+
     // Convert fw node to onednn graph node
     const std::function<Status(const OneDnnGraphContext* ctx,
                                const int node_index,
@@ -3240,6 +3383,9 @@ Status RunRewritePass(OneDnnGraphContext* ctx) {
   static int count = 0;
   LLGAEdgeManager edge_manager_tmp;
   for (auto& it : l_partition_list) {
+    ctx->partition_stats.push_back(
+        {it.get_ops_num(), it.get_input_ports().size(),
+         it.get_output_ports().size(), it.is_supported()});
     if (it.is_supported()) {
       count++;
       ITEX_VLOG(2) << "Number of Partitions = " << count;
@@ -3261,7 +3407,48 @@ Status RunRewritePass(OneDnnGraphContext* ctx) {
   return Status::OK();
 }
 
-void DumpLLGAGraph(const GraphDef& graph_def, const std::string prefix) {
+// Writes the size of every partition, and the framework ops at partition
+// boundaries, which break larger fusions.
+void WritePartitionReport(const OneDnnGraphContext& ctx, std::ostream* os) {
+  size_t num_supported = 0, num_supported_ops = 0, max_ops = 0;
+  size_t num_boundary_tensors = 0;
+  for (const auto& stats : ctx.partition_stats) {
+    if (!stats.is_supported) continue;
+    num_supported++;
+    num_supported_ops += stats.num_ops;
+    max_ops = std::max(max_ops, stats.num_ops);
+    num_boundary_tensors += stats.num_inputs + stats.num_outputs;
+  }
+
+  *os << "partitions: " << ctx.partition_stats.size()
+      << ", supported: " << num_supported
+      << ", ops in supported partitions: " << num_supported_ops
+      << ", largest: " << max_ops << ", average: "
+      << (num_supported == 0 ? 0.0f
+                             : static_cast<float>(num_supported_ops) /
+                                   num_supported)
+      << ", boundary tensors: " << num_boundary_tensors << "\n";
+
+  for (size_t i = 0; i < ctx.partition_stats.size(); ++i) {
+    const auto& stats = ctx.partition_stats[i];
+    *os << "partition " << i << ": ops " << stats.num_ops << ", inputs "
+        << stats.num_inputs << ", outputs " << stats.num_outputs
+        << (stats.is_supported ? "" : ", unsupported") << "\n";
+  }
+
+  std::vector<std::pair<int, string>> boundary_ops;
+  for (const auto& it : ctx.boundary_ops) {
+    boundary_ops.push_back({it.second, it.first});
+  }
+  std::sort(boundary_ops.rbegin(), boundary_ops.rend());
+  *os << "framework ops at partition boundaries:\n";
+  for (const auto& it : boundary_ops) {
+    *os << "  " << it.second << ": " << it.first << "\n";
+  }
+}
+
+void DumpLLGAGraph(const GraphDef& graph_def, const std::string prefix,
+                   const OneDnnGraphContext* ctx = nullptr) {
   // 1970-01-01 00:00:00
   const auto start = std::chrono::time_point<std::chrono::system_clock>{};
   const auto current = std::chrono::system_clock::now();
@@ -3272,10 +3459,17 @@ void DumpLLGAGraph(const GraphDef& graph_def, const std::string prefix) {
   dump_graph << graph_def.DebugString();
   dump_graph.close();
   ITEX_VLOG(4) << "Dump graph to: " << dump_file_name;
+
+  if (ctx == nullptr) return;
+  std::string report_file_name = prefix + hash_time + "_partitions.txt";
+  std::ofstream report(report_file_name);
+  WritePartitionReport(*ctx, &report);
+  report.close();
+  ITEX_VLOG(4) << "Dump partition report to: " << report_file_name;
 }
 
-Status RunOneDnnGraph(const GrapplerItem& item, const GraphDef& graph_def,
-                      GraphDef* optimized_graph) {
+Status RunOneDnnGraph(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                      const GraphDef& graph_def, GraphDef* optimized_graph) {
   // TODO(itex): Remove the lock, when LLGA modify their all thread unsafe
   // data structure, such as "pass_manager". Seems LLGA already fix the error
   mutex_lock m(&mu);
@@ -3304,7 +3498,7 @@ Status RunOneDnnGraph(const GrapplerItem& item, const GraphDef& graph_def,
 
   Status status;
   GraphDef multable_graph_def = graph_def;
-  OneDnnGraphContext ctx(item, &multable_graph_def, &status);
+  OneDnnGraphContext ctx(opt_ctx, item, &multable_graph_def, &status);
   TF_ABORT_IF_ERROR(std::move(status));
 
 #ifdef INTEL_CPU_ONLY
@@ -3334,14 +3528,14 @@ Status RunOneDnnGraph(const GrapplerItem& item, const GraphDef& graph_def,
   // TODO(itex): shape inference currently only used in verify scalar tensor
   // for LLGA Mul. Remove this shape inference function, once LLGA supports
   // scalar tensor.
-  if (!ctx.inferred_graph_properties) {
+  if (!ctx.graph_properties.IsInferred()) {
     TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
         /*assume_valid_feeds=*/true,
         /*aggressive_shape_inference=*/false,
         /*include_input_tensor_values=*/true,
-        /*include_output_tensor_values=*/false));
-    ctx.inferred_graph_properties = true;
+        /*include_output_tensor_values=*/true));
   }
+  ctx.graph_properties.Refresh(graph_def);
 
   TF_ABORT_IF_ERROR(ctx.graph_view.SortTopologically(false, {}));
   TF_ABORT_IF_ERROR(RunPrePass(&ctx));
@@ -3376,12 +3570,18 @@ Status RunOneDnnGraph(const GrapplerItem& item, const GraphDef& graph_def,
   TF_ABORT_IF_ERROR(ctx.graph_view.SortTopologically(false, {}));
   TF_ABORT_IF_ERROR(RemoveRetNode(&ctx));
 
+  if (ITEX_VLOG_IS_ON(2)) {
+    std::ostringstream report;
+    WritePartitionReport(ctx, &report);
+    ITEX_VLOG(2) << "oneDNN Graph partitions:\n" << report.str();
+  }
+
   *optimized_graph = std::move(multable_graph_def);
 
   if (ITEX_VLOG_IS_ON(4)) {
     ITEX_VLOG(4) << "graph node after LLGA: "
                  << ctx.graph_view.graph()->node_size();
-    DumpLLGAGraph(*optimized_graph, "graph_after_LLGA_");
+    DumpLLGAGraph(*optimized_graph, "graph_after_LLGA_", &ctx);
   }
   return Status::OK();
 }
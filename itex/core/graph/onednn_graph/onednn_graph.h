@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ITEX_CORE_GRAPH_ONEDNN_GRAPH_ONEDNN_GRAPH_H_
 #define ITEX_CORE_GRAPH_ONEDNN_GRAPH_ONEDNN_GRAPH_H_
 
+#include <map>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -30,26 +31,37 @@ limitations under the License.
 namespace itex {
 namespace graph {
 
+// Size of a oneDNN Graph partition and its boundary with framework ops.
+struct OneDnnGraphPartitionStats {
+  size_t num_ops;
+  size_t num_inputs;
+  size_t num_outputs;
+  bool is_supported;
+};
+
 struct OneDnnGraphContext {
-  explicit OneDnnGraphContext(const GrapplerItem& item, GraphDef* g_def,
+  explicit OneDnnGraphContext(OptimizerContext* opt_ctx,
+                              const GrapplerItem& item, GraphDef* g_def,
                               Status* status)
       : graph_view(g_def, status),
         fetch_tensors(item.fetch),
         nodes_to_preserve(item.NodesToPreserve()),
-        graph_properties(item),
-        inferred_graph_properties(false) {
+        graph_properties(GetSharedGraphProperties(opt_ctx, item)) {
     TF_ABORT_IF_ERROR(node_type_map.Init(*g_def));
   }
   utils::MutableGraphView graph_view;
   NodeTypeAttrMap node_type_map;
   std::vector<string> fetch_tensors;
   std::unordered_set<string> nodes_to_preserve;
-  GraphProperties graph_properties;
-  bool inferred_graph_properties;
+  GraphProperties& graph_properties;
+  // Collected by the rewrite pass, and reported when dumping the graph.
+  std::vector<OneDnnGraphPartitionStats> partition_stats;
+  // Framework ops feeding or consuming oneDNN Graph ops, by op type.
+  std::map<string, int> boundary_ops;
 };
 
-Status RunOneDnnGraph(const GrapplerItem& item, const GraphDef& graph_def,
-                      GraphDef* optimized_graph);
+Status RunOneDnnGraph(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                      const GraphDef& graph_def, GraphDef* optimized_graph);
 
 }  // namespace graph
 }  // namespace itex
@@ -16,7 +16,9 @@ limitations under the License.
 #include "itex/core/graph/onednn_layout/onednn_layout.h"
 
 #include <cstring>
+#include <functional>
 #include <utility>
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "itex/core/graph/utils/graph_properties.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "itex/core/graph/utils/op_types.h"
 #include "itex/core/graph/utils/utils.h"
 #include "itex/core/utils/attr_value_util.h"
+#include "itex/core/utils/env_var.h"
 #include "itex/core/utils/node_def_util.h"
 #include "itex/core/utils/onednn/onednn_post_op_util.h"
 #include "itex/core/utils/types.h"
@@ -774,26 +777,225 @@ Status MarkOneDnnGraphEndNode(OneDnnLayoutContext* ctx, const int node_index) {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-//              Run function for the pass
+//              Cost model for blocked layouts
 ///////////////////////////////////////////////////////////////////////////////
-Status RunOneDnnLayout(OptimizerContext* opt_ctx, const GrapplerItem& item,
-                       const GraphDef& graph_def, GraphDef* optimized_graph) {
-  Status status;
-  GraphDef multable_graph_def = graph_def;
-  OneDnnLayoutContext ctx(item, &multable_graph_def, &status);
+// Rewritten nodes connected by data edges form islands sharing blocked
+// tensors. Inside an island, oneDNN kernels skip the reorders they would do
+// on plain tensors; at its boundary, every blocked tensor consumed by a plain
+// op costs a _OneDnnToTf reorder. Islands where the conversions cost more
+// than the reorders they save are left in plain layout.
+
+namespace {
+
+// Reorder throughput, and the fixed cost of running a conversion node.
+constexpr double kReorderBytesPerUs = 8192.0;
+constexpr double kConversionOverheadUs = 2.0;
+
+// Ops whose oneDNN kernels work on blocked activations, so that their plain
+// versions reorder the activation and the result internally.
+bool PrefersBlockedLayout(const string& op_name) {
+  static const absl::flat_hash_set<string> ops = {
+      // Convolutions.
+      "Conv2D", "Conv2DBackpropFilter", "Conv2DBackpropInput", "Conv3D",
+      "Conv3DBackpropFilterV2", "Conv3DBackpropInputV2",
+      "DepthwiseConv2dNative", "DepthwiseConv2dNativeBackpropFilter",
+      "DepthwiseConv2dNativeBackpropInput", "_ITEXConv2DBackpropFilterWithBias",
+      "_ITEXConv2DBackpropInputWithSlice", "_ITEXConv3DBackpropFilterWithBias",
+      "_ITEXConv3DBackpropInputV2WithSlice", "_ITEXFusedConv2D",
+      "_ITEXFusedConv2DWithSum", "_ITEXFusedConv3D",
+      "_ITEXFusedDepthwiseConv2dNative", "_ITEXPadWithConv2D",
+      "_ITEXPadWithConv3D", "_ITEXPadWithFusedConv2D",
+      "_ITEXPadWithFusedConv3D",
+      // Quantized convolutions.
+      "QuantizedConv2D", "QuantizedConv2DAndRequantize",
+      "QuantizedConv2DWithBias", "QuantizedConv2DWithBiasAndRelu",
+      "QuantizedConv2DWithBiasAndReluAndRequantize",
+      "QuantizedConv2DWithBiasAndRequantize",
+      "QuantizedConv2DWithBiasSignedSumAndReluAndRequantize",
+      "QuantizedConv2DWithBiasSumAndRelu",
+      "QuantizedConv2DWithBiasSumAndReluAndRequantize",
+      "QuantizedDepthwiseConv2D", "QuantizedDepthwiseConv2DWithBias",
+      "QuantizedDepthwiseConv2DWithBiasAndRelu",
+      "QuantizedDepthwiseConv2DWithBiasAndReluAndRequantize",
+      "_ITEXQuantizeV2WithQuantizedConv2D", "_ITEXQuantizedConv2D",
+      "_ITEXQuantizedConv2DAndRequantize", "_ITEXQuantizedConv2DWithBias",
+      "_ITEXQuantizedConv2DWithBiasAndRelu",
+      "_ITEXQuantizedConv2DWithBiasAndReluAndRequantize",
+      "_ITEXQuantizedConv2DWithBiasAndRequantize",
+      "_ITEXQuantizedConv2DWithBiasSignedSumAndReluAndRequantize",
+      "_ITEXQuantizedConv2DWithBiasSumAndRelu",
+      "_ITEXQuantizedConv2DWithBiasSumAndReluAndRequantize",
+      "_ITEXQuantizedConv2DWithCast", "_ITEXQuantizedConv2DWithDequantize",
+      // Pooling.
+      "AvgPool", "AvgPool3D", "AvgPool3DGrad", "AvgPoolGrad", "MaxPool",
+      "MaxPool3D", "MaxPool3DGrad", "MaxPoolGrad", "QuantizedAvgPool",
+      "ITEXQuantizedAvgPool", "QuantizedMaxPool",
+      // Normalizations.
+      "FusedBatchNorm", "FusedBatchNormV2", "FusedBatchNormV3",
+      "FusedBatchNormGrad", "FusedBatchNormGradV2", "FusedBatchNormGradV3",
+      "_FusedBatchNormEx", "_ITEXFusedBatchNormGradEx", "_ITEXInstanceNorm",
+      "_ITEXFusedInstanceNorm"};
+  return ops.contains(op_name);
+}
+
+bool IsUnconditionalRewrite(const RewriteInfo& ri) {
+  using RewriteRule = bool (*)(const utils::MutableNodeView&);
+  const RewriteRule* rule = ri.rewrite_rule.target<RewriteRule>();
+  return rule != nullptr && *rule == AlwaysRewrite;
+}
+
+// Size in bytes of the output `tensor`, or -1 if it's not static.
+int64 TensorBytes(const GraphProperties& properties, const string& tensor) {
+  const TensorId id = ParseTensorName(tensor);
+  std::vector<OpInfo_TensorProperties> props;
+  if (!properties.GetOutputProperties(string(id.node()), &props).ok() ||
+      id.index() < 0 || id.index() >= static_cast<int>(props.size()))
+    return -1;
+  const auto& shape = props[id.index()].shape();
+  if (shape.unknown_rank()) return -1;
+  int64 num_elements = 1;
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return -1;
+    num_elements *= dim.size();
+  }
+  return num_elements * DataTypeSize(props[id.index()].dtype());
+}
+
+// Returns the nodes of the islands where the blocked layout doesn't pay off.
+// Islands with unconditionally rewritten nodes or tensors of unknown size
+// are kept as they are.
+absl::flat_hash_set<string> FindUnprofitableIslands(
+    const GraphDef& graph_def, const GraphProperties& properties,
+    const absl::flat_hash_set<string>& rewritten,
+    const absl::flat_hash_set<string>& mandatory) {
+  absl::flat_hash_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    if (rewritten.contains(node.name())) nodes[node.name()] = &node;
+  }
+
+  // Union-find over the data edges between rewritten nodes.
+  absl::flat_hash_map<string, string> parent;
+  for (const auto& it : nodes) parent[it.first] = it.first;
+  std::function<string(const string&)> find =
+      [&](const string& name) -> string {
+    const string& p = parent[name];
+    if (p == name) return name;
+    return parent[name] = find(p);
+  };
+  // Data consumers (node, producer port) of every rewritten node.
+  absl::flat_hash_map<string, std::vector<std::pair<const NodeDef*, int>>>
+      consumers;
+  for (const NodeDef& node : graph_def.node()) {
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) continue;
+      const TensorId id = ParseTensorName(input);
+      const string producer(id.node());
+      if (!nodes.contains(producer)) continue;
+      consumers[producer].push_back({&node, id.index()});
+      if (nodes.contains(node.name()))
+        parent[find(node.name())] = find(producer);
+    }
+  }
 
+  // A node produces a blocked tensor if its kernel prefers blocked layout or
+  // it propagates a blocked input.
+  absl::flat_hash_set<string> blocked;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (const auto& it : nodes) {
+      if (blocked.contains(it.first)) continue;
+      bool is_blocked = PrefersBlockedLayout(it.second->op());
+      for (const string& input : it.second->input()) {
+        if (IsControlInput(input)) continue;
+        is_blocked |= blocked.contains(NodeName(input));
+      }
+      if (is_blocked) {
+        blocked.insert(it.first);
+        changed = true;
+      }
+    }
+  }
+
+  struct Island {
+    double saved_us = 0;
+    double cost_us = 0;
+    bool has_blocked = false;
+    bool keep = false;
+    std::vector<string> members;
+  };
+  absl::flat_hash_map<string, Island> islands;
+  for (const auto& it : nodes) {
+    const NodeDef* node = it.second;
+    Island& island = islands[find(it.first)];
+    island.members.push_back(it.first);
+    if (mandatory.contains(it.first)) island.keep = true;
+    if (!blocked.contains(it.first)) continue;
+    island.has_blocked = true;
+
+    const int64 out_bytes = TensorBytes(properties, it.first);
+    if (out_bytes < 0) {
+      island.keep = true;
+      continue;
+    }
+    if (PrefersBlockedLayout(node->op())) {
+      // The plain kernel would reorder its result, and its activation if it
+      // comes blocked from the island.
+      island.saved_us += out_bytes / kReorderBytesPerUs;
+      const string producer = NodeName(node->input(0));
+      if (nodes.contains(producer) && blocked.contains(producer)) {
+        const int64 in_bytes = TensorBytes(properties, node->input(0));
+        if (in_bytes < 0)
+          island.keep = true;
+        else
+          island.saved_us += in_bytes / kReorderBytesPerUs;
+      }
+    }
+    for (const auto& consumer : consumers[it.first]) {
+      if (consumer.second != 0 || nodes.contains(consumer.first->name()))
+        continue;
+      island.cost_us += out_bytes / kReorderBytesPerUs + kConversionOverheadUs;
+    }
+  }
+
+  absl::flat_hash_set<string> unprofitable;
+  for (const auto& it : islands) {
+    const Island& island = it.second;
+    if (island.keep || !island.has_blocked ||
+        island.saved_us > island.cost_us)
+      continue;
+    ITEX_VLOG(2) << "OneDnnLayoutPass: keep " << island.members.size()
+                 << " nodes around " << it.first << " in plain layout, saved "
+                 << island.saved_us << "us vs conversions " << island.cost_us
+                 << "us.";
+    unprofitable.insert(island.members.begin(), island.members.end());
+  }
+  return unprofitable;
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+//              Run function for the pass
+///////////////////////////////////////////////////////////////////////////////
+// Rewrites every node with a matching rewrite rule, except the `skipped`
+// ones. Rewritten nodes are recorded in `rewritten`, and the unconditionally
+// rewritten ones in `mandatory` too.
+void RewriteNodes(OptimizerContext* opt_ctx, OneDnnLayoutContext* ctx,
+                  const absl::flat_hash_set<string>& skipped,
+                  absl::flat_hash_set<string>* rewritten,
+                  absl::flat_hash_set<string>* mandatory) {
   // Processing graph in reverse-topological sorted order allows to remap
   // longer chains of dependent ops in one pass.
   TF_ABORT_IF_ERROR(
-      ctx.graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+      ctx->graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
 
   // Skip nodes that were invalidated
-  int num_nodes = multable_graph_def.node_size();
+  int num_nodes = ctx->graph_view.graph()->node_size();
 
   ITEX_VLOG(1) << "OneDnnLayoutPass: Start to rewrite nodes.";
 
   for (int node_index = 0; node_index < num_nodes; ++node_index) {
-    const auto* node_view = ctx.graph_view.GetNode(node_index);
+    const auto* node_view = ctx->graph_view.GetNode(node_index);
     const auto* node_def = node_view->node();
 
     // Check if node can run on current optimizer device.
@@ -808,7 +1010,9 @@ Status RunOneDnnLayout(OptimizerContext* opt_ctx, const GrapplerItem& item,
     // Don't rewrite fetch node because layout will insert `OneDnnToTf` op
     // behind it and break the fetch node dependency.
     // TODO(itex): Rewrite fetch nodes if meeting performance regression.
-    if (ctx.nodes_to_preserve.count(node_def->name()) > 0) continue;
+    if (ctx->nodes_to_preserve.count(node_def->name()) > 0) continue;
+
+    if (skipped.contains(node_def->name())) continue;
 
     const RewriteInfo* ri = nullptr;
     // We will first search if node is to be rewritten.
@@ -819,16 +1023,54 @@ Status RunOneDnnLayout(OptimizerContext* opt_ctx, const GrapplerItem& item,
                    << " with OP " << op_name << " for rewrite using"
                    << " layout optimization.";
 
-      if (RewriteNode(&ctx, node_index, ri) == Status::OK()) {
+      if (RewriteNode(ctx, node_index, ri) == Status::OK()) {
         ITEX_VLOG(2) << "OneDnnLayoutPass: rewrote node " << node_name
                      << " with op " << op_name
                      << " for OneDNN layout optimization.";
+        rewritten->insert(node_name);
+        if (IsUnconditionalRewrite(*ri)) mandatory->insert(node_name);
       } else {
         ITEX_VLOG(2) << "OneDnnLayoutPass: found node " << node_name
                      << " with op " << op_name << " but rewrite failed.";
       }
     }
   }
+}
+
+Status RunOneDnnLayout(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                       const GraphDef& graph_def, GraphDef* optimized_graph) {
+  Status status;
+
+  // Rewrite a copy of the graph first to find the layout islands, then keep
+  // the unprofitable ones in plain layout.
+  absl::flat_hash_set<string> skipped;
+  bool enable_cost_model = true;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("ITEX_ONEDNN_LAYOUT_COST_MODEL",
+                                        true, &enable_cost_model));
+  if (enable_cost_model) {
+    GraphDef trial_graph_def = graph_def;
+    OneDnnLayoutContext trial_ctx(item, &trial_graph_def, &status);
+    TF_RETURN_IF_ERROR(status);
+    absl::flat_hash_set<string> rewritten, mandatory;
+    RewriteNodes(opt_ctx, &trial_ctx, skipped, &rewritten, &mandatory);
+
+    GraphProperties& properties = GetSharedGraphProperties(opt_ctx, item);
+    if (!properties.IsInferred()) {
+      TF_RETURN_IF_ERROR(properties.InferStatically(
+          /*assume_valid_feeds=*/true,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/true,
+          /*include_output_tensor_values=*/true));
+    }
+    properties.Refresh(graph_def);
+    skipped =
+        FindUnprofitableIslands(graph_def, properties, rewritten, mandatory);
+  }
+
+  GraphDef multable_graph_def = graph_def;
+  OneDnnLayoutContext ctx(item, &multable_graph_def, &status);
+  absl::flat_hash_set<string> rewritten, mandatory;
+  RewriteNodes(opt_ctx, &ctx, skipped, &rewritten, &mandatory);
 
 #define RUN_LAYOUT_FUNC(ctx, func)                                      \
   do {                                                                  \
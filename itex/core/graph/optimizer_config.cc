@@ -48,9 +48,12 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
   bool onednn_graph_compiler_backend_flag;
   bool onednn_graph_dnnl_backend_flag;
   bool tf_constant_folding_flag;
+  bool constant_folding_flag;
+  bool segment_fusion_flag;
   bool optimize_aggressive_flag;
   bool remapper_flag;
   bool auto_mixed_precision_flag;
+  bool shape_bucketing_flag;
   bool layout_opt_flag;
   bool test_mode_flag;
 
@@ -131,6 +134,14 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
                                          enable_itex_tf_constant_folding,
                                          &tf_constant_folding_flag));
 
+  ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_CONSTANT_FOLDING",
+                                         enable_itex_constant_folding,
+                                         &constant_folding_flag));
+
+  ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_SEGMENT_FUSION",
+                                         enable_itex_segment_fusion,
+                                         &segment_fusion_flag));
+
   ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("_ITEX_OPTIMIZE_AGGRESSIVE",
                                          enable_itex_optimize_aggressive,
                                          &optimize_aggressive_flag));
@@ -146,6 +157,10 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
                                            &auto_mixed_precision_flag));
   }
 
+  ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_SHAPE_BUCKETING",
+                                         enable_itex_shape_bucketing,
+                                         &shape_bucketing_flag));
+
   ITEX_CHECK_OK(itex::ReadBoolFromEnvVar(
       "_ITEX_TEST_MODE", enable_itex_test_mode, &test_mode_flag));
 
@@ -162,9 +177,12 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
   opt_config_flags->enable_onednn_graph_dnnl_backend =
       onednn_graph_dnnl_backend_flag;
   opt_config_flags->enable_tf_constant_folding = tf_constant_folding_flag;
+  opt_config_flags->enable_constant_folding = constant_folding_flag;
+  opt_config_flags->enable_segment_fusion = segment_fusion_flag;
   opt_config_flags->enable_optimize_aggressive = optimize_aggressive_flag;
   opt_config_flags->enable_remapper = remapper_flag;
   opt_config_flags->enable_auto_mixed_precision = auto_mixed_precision_flag;
+  opt_config_flags->enable_shape_bucketing = shape_bucketing_flag;
   opt_config_flags->enable_layout_opt = layout_opt_flag;
   opt_config_flags->enable_test_mode = test_mode_flag;
   opt_config_flags->remapper_run_pass = remapper_run_pass;
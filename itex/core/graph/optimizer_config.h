@@ -25,9 +25,12 @@ constexpr static bool enable_itex_onednn_graph_all_type = false;
 constexpr static bool enable_itex_onednn_graph_compiler_backend = false;
 constexpr static bool enable_itex_onednn_graph_dnnl_backend = true;
 constexpr static bool enable_itex_tf_constant_folding = true;
+constexpr static bool enable_itex_constant_folding = false;
+constexpr static bool enable_itex_segment_fusion = false;
 constexpr static bool enable_itex_optimize_aggressive = false;
 constexpr static bool enable_itex_remapper = true;
 constexpr static bool enable_itex_auto_mixed_precision = false;
+constexpr static bool enable_itex_shape_bucketing = false;
 constexpr static bool enable_itex_layout_opt = true;
 constexpr static bool enable_itex_test_mode = false;
 constexpr static int32_t remapper_run_pass = 2;
@@ -39,9 +42,12 @@ typedef struct _OptimizerConfigFlags {
   bool enable_onednn_graph_compiler_backend;
   bool enable_onednn_graph_dnnl_backend;
   bool enable_tf_constant_folding;
+  bool enable_constant_folding;
+  bool enable_segment_fusion;
   bool enable_optimize_aggressive;
   bool enable_remapper;
   bool enable_auto_mixed_precision;
+  bool enable_shape_bucketing;
   // TODO(itex): To integrate DOC & GraphOptions
   bool enable_layout_opt;
   bool enable_test_mode;
@@ -59,6 +59,10 @@ class CastBf16FusedMatMulCast32 : public Fusion {
     ret = FillProperties(&graph_view, graph_view.GetNode(node_index), pattern_);
     if (ret.Empty()) return ret;
 
+    // Generic post op chains carry Binary operands besides the bias.
+    NodeDef* matmul_node_def = graph_view.GetNode(ret.map.at("matmul"))->node();
+    if (HasPostOpChain(*matmul_node_def)) return ret.ToEmpty();
+
     NodeDef* cast1_node_def =
         graph_view.GetNode(ret.map.at("bf16scr1"))->node();
     NodeDef* cast2_node_def =
@@ -34,7 +34,11 @@ constexpr char kBatchMatMulV2[] = "BatchMatMulV2";
 constexpr char kBiasAdd[] = "BiasAdd";
 constexpr char kBiasAddGrad[] = "BiasAddGrad";
 constexpr char kBinaryAdd[] = "BinaryAdd";
+constexpr char kBinaryDiv[] = "BinaryDiv";
+constexpr char kBinaryMax[] = "BinaryMax";
+constexpr char kBinaryMin[] = "BinaryMin";
 constexpr char kBinaryMul[] = "BinaryMul";
+constexpr char kBinarySub[] = "BinarySub";
 constexpr char kCast[] = "Cast";
 constexpr char kConcatV2[] = "ConcatV2";
 constexpr char kConst[] = "Const";
@@ -101,6 +105,7 @@ constexpr char kFusedBatchMatMul[] = "_ITEXFusedBatchMatMulV2";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_ITEXFusedBatchNormGradEx";
 constexpr char kFusedBinary[] = "_ITEXFusedBinary";
+constexpr char kFusedElementwise[] = "_ITEXFusedElementwise";
 constexpr char kFusedConv2D[] = "_ITEXFusedConv2D";
 constexpr char kFusedConv2DWithSum[] = "_ITEXFusedConv2DWithSum";
 constexpr char kFusedConv3D[] = "_ITEXFusedConv3D";
@@ -111,6 +116,7 @@ constexpr char kFusedMatMulWithSum[] = "_ITEXFusedMatMulWithSum";
 constexpr char kFusedMatMulGrad[] = "_ITEXFusedMatMulGrad";
 constexpr char kFusedInstanceNorm[] = "_ITEXFusedInstanceNorm";
 constexpr char kFusedRandom[] = "_ITEXFusedRandom";
+constexpr char kFusedRandomBitMask[] = "_ITEXFusedRandomBitMask";
 constexpr char kFusedResourceApplyAdam[] = "_ITEXFusedResourceApplyAdam";
 constexpr char kFusedResourceApplyAdamWithWeightDecay[] =
     "_ITEXFusedResourceApplyAdamWithWeightDecay";
@@ -118,6 +124,7 @@ constexpr char kFusedResourceApplyMomentum[] =
     "_ITEXFusedResourceApplyMomentum";
 constexpr char kInstanceNorm[] = "_ITEXInstanceNorm";
 constexpr char kLayerNorm[] = "ITEXLayerNorm";
+constexpr char kPackedDropout[] = "_ITEXPackedDropout";
 constexpr char kPadWithConv2D[] = "_ITEXPadWithConv2D";
 constexpr char kPadWithConv3D[] = "_ITEXPadWithConv3D";
 constexpr char kPadWithDepthwiseConv2D[] = "_ITEXPadWithDepthwiseConv2dNative";
@@ -16,12 +16,17 @@ limitations under the License.
 #include "itex/core/graph/remapper/fusion.h"
 
 #include <algorithm>
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "itex/core/graph/utils/pattern_utils.h"
 #include "itex/core/graph/utils/utils.h"
+#include "itex/core/utils/env.h"
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/threadpool.h"
 
 namespace itex {
 namespace graph {
@@ -37,6 +42,14 @@ static int NumNodesHelper(const OpTypePattern& pattern) {
   return count;
 }
 
+static int DepthHelper(const OpTypePattern& pattern) {
+  int depth = 0;
+  for (auto const& child : pattern.children) {
+    depth = std::max(depth, DepthHelper(child));
+  }
+  return depth + 1;
+}
+
 static Fusion::Labels FilterLabels(const OpTypePattern& pattern,
                                    const NodeStatus status) {
   Fusion::Labels labels;
@@ -56,10 +69,14 @@ Fusion::InternalPattern::InternalPattern(OpTypePattern&& pattern) {
   info = std::move(pattern);
   labels_of_replace = FilterLabels(info, NodeStatus::kReplace);
   num_nodes = NumNodesHelper(info);
+  depth = DepthHelper(info);
+  utils::ResolveOpTypeIds(&info);
 }
 
 int Fusion::NumNodes() const { return pattern_.num_nodes; }
 
+int Fusion::Depth() const { return pattern_.depth; }
+
 std::string Fusion::Key() { return pattern_.info.op; }
 
 FusionMgr& FusionMgr::GetInstance() {
@@ -68,7 +85,7 @@ FusionMgr& FusionMgr::GetInstance() {
 }
 
 void FusionMgr::Sort() {
-  for (auto& [key, value] : map_) {
+  for (auto& value : fusions_by_op_) {
     std::sort(value.begin(), value.end(),
               [](const Fusion* left, const Fusion* right) {
                 return left->NumNodes() > right->NumNodes();
@@ -77,18 +94,151 @@ void FusionMgr::Sort() {
 }
 
 void FusionMgr::AddFusion(const std::string& key, Fusion* fusion) {
-  map_[key].push_back(fusion);
+  const OpTypeId id = GetOpTypeId(key);
+  if (id >= static_cast<OpTypeId>(fusions_by_op_.size())) {
+    fusions_by_op_.resize(id + 1);
+  }
+  fusions_by_op_[id].push_back(fusion);
 }
 
 std::vector<Fusion*>& FusionMgr::GetFusions(const std::string& key) {
-  if (map_.count(key) != 0) {
-    return map_[key];
+  return GetFusions(GetOpTypeId(key));
+}
+
+std::vector<Fusion*>& FusionMgr::GetFusions(OpTypeId key) {
+  if (key >= 0 && key < static_cast<OpTypeId>(fusions_by_op_.size())) {
+    return fusions_by_op_[key];
   }
 
   static auto empty_vector = std::vector<Fusion*>();
   return empty_vector;
 }
 
+int FusionMgr::MaxDepth() const {
+  int depth = 0;
+  for (auto const& value : fusions_by_op_) {
+    for (const Fusion* fusion : value) {
+      depth = std::max(depth, fusion->Depth());
+    }
+  }
+  return depth;
+}
+
+// Invalidating more nodes than this is slower than dropping the whole cache.
+constexpr int kMaxInvalidatedNodes = 1 << 14;
+
+PatternMatchCache::PatternMatchCache(RemapperContext* ctx, bool is_full,
+                                     int num_threads,
+                                     std::function<bool(int)> find,
+                                     int find_depth)
+    : find_(std::move(find)),
+      radius_(std::max(FusionMgr::GetInstance().MaxDepth(), find_depth) + 1) {
+  utils::MutableGraphView* graph_view = &ctx->graph_view;
+  const int num_nodes = graph_view->NumNodes();
+  first_match_.assign(num_nodes, kUnknown);
+  may_find_.assign(num_nodes, true);
+
+  auto match = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const OpTypeId op_type = graph_view->GetNode(i)->GetOpTypeId();
+      const auto& fusions = FusionMgr::GetInstance().GetFusions(op_type);
+      int pos = 0;
+      for (; pos < static_cast<int>(fusions.size()); ++pos) {
+        if (!is_full && !fusions[pos]->IsPartial()) continue;
+        if (!fusions[pos]->Check(ctx, i).Empty()) break;
+      }
+      first_match_[i] = pos;
+      may_find_[i] = find_(i);
+    }
+  };
+
+  thread::ThreadPool pool(Env::Default(), "RemapperMatch", num_threads);
+  pool.ParallelFor(num_nodes, /*cost_per_unit=*/10000, match);
+  ITEX_VLOG(1) << "RemapperPass: Matched " << num_nodes << " nodes with "
+               << pool.NumThreads() << " threads.";
+}
+
+int PatternMatchCache::Lookup(int index) const {
+  // New nodes are never cached.
+  if (index >= static_cast<int>(first_match_.size())) return 0;
+  return std::max(first_match_[index], 0);
+}
+
+bool PatternMatchCache::MayFind(int index) const {
+  if (index >= static_cast<int>(may_find_.size())) return true;
+  return may_find_[index];
+}
+
+void PatternMatchCache::Invalidate(RemapperContext* ctx, int root) {
+  utils::MutableGraphView* graph_view = &ctx->graph_view;
+  // A fusion only changes nodes among the inputs of its root, and the fanouts
+  // of their inputs. Any pattern containing one of them is rooted at one of
+  // their outputs.
+  absl::flat_hash_set<int> affected = {root};
+  std::vector<int> frontier = {root};
+  for (int depth = 0; depth < radius_ && !frontier.empty(); ++depth) {
+    std::vector<int> next;
+    for (int index : frontier) {
+      for (auto const& fanin :
+           graph_view->GetNode(index)->GetRegularFanins()) {
+        if (affected.insert(fanin.node_index()).second) {
+          next.push_back(fanin.node_index());
+        }
+      }
+    }
+    frontier.swap(next);
+  }
+
+  frontier.assign(affected.begin(), affected.end());
+  for (int depth = 0; depth < radius_ && !frontier.empty(); ++depth) {
+    std::vector<int> next;
+    for (int index : frontier) {
+      for (auto const& fanouts :
+           graph_view->GetNode(index)->GetRegularFanouts()) {
+        for (auto const& fanout : fanouts) {
+          if (affected.insert(fanout.node_index()).second) {
+            next.push_back(fanout.node_index());
+          }
+        }
+      }
+    }
+    if (affected.size() > kMaxInvalidatedNodes) {
+      std::fill(first_match_.begin(), first_match_.end(), kUnknown);
+      std::fill(may_find_.begin(), may_find_.end(), true);
+      return;
+    }
+    frontier.swap(next);
+  }
+
+  for (int index : affected) {
+    if (index < static_cast<int>(first_match_.size())) {
+      first_match_[index] = kUnknown;
+      may_find_[index] = true;
+    }
+  }
+}
+
+Status PatternMatchCache::Verify(RemapperContext* ctx, int index,
+                                 bool is_full) const {
+  const utils::MutableNodeView* node_view = ctx->graph_view.GetNode(index);
+  const auto& fusions =
+      FusionMgr::GetInstance().GetFusions(node_view->GetOpTypeId());
+  const int start = std::min(Lookup(index), static_cast<int>(fusions.size()));
+  for (int pos = 0; pos < start; ++pos) {
+    if (!is_full && !fusions[pos]->IsPartial()) continue;
+    if (!fusions[pos]->Check(ctx, index).Empty()) {
+      return errors::Internal("PatternMatchCache skipped fusion ",
+                              fusions[pos]->Name(), " matching node ",
+                              node_view->GetName());
+    }
+  }
+  if (!MayFind(index) && find_(index)) {
+    return errors::Internal("PatternMatchCache skipped a Find* matcher ",
+                            "matching node ", node_view->GetName());
+  }
+  return Status::OK();
+}
+
 MatchedProperties FillProperties(utils::MutableGraphView* graph_view,
                                  utils::MutableNodeView* node_view,
                                  const Fusion::InternalPattern& pattern,
@@ -126,10 +276,14 @@ std::vector<OpInfo_TensorProperties> GetOutputProperties(RemapperContext* ctx,
 
 Status LaunchPatternMatcher(RemapperContext* ctx, int index,
                             std::vector<bool>* invalidated,
-                            std::vector<bool>* deleted, bool is_full) {
-  auto* node = ctx->graph_view.GetNode(index)->node();
-
-  for (auto const& fusion : FusionMgr::GetInstance().GetFusions(node->op())) {
+                            std::vector<bool>* deleted, bool is_full,
+                            const PatternMatchCache* cache) {
+  const OpTypeId op_type = ctx->graph_view.GetNode(index)->GetOpTypeId();
+  auto const& fusions = FusionMgr::GetInstance().GetFusions(op_type);
+  const int start = cache ? cache->Lookup(index) : 0;
+
+  for (int pos = start; pos < static_cast<int>(fusions.size()); ++pos) {
+    Fusion* fusion = fusions[pos];
     if (!is_full && !fusion->IsPartial()) continue;
     ITEX_VLOG(3) << "Start to run fusion pass: " << fusion->Name();
     auto properties = fusion->Check(ctx, index);
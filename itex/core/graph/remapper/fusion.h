@@ -16,10 +16,10 @@ limitations under the License.
 #ifndef ITEX_CORE_GRAPH_REMAPPER_FUSION_H_
 #define ITEX_CORE_GRAPH_REMAPPER_FUSION_H_
 
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "itex/core/graph/remapper/remapper.h"
@@ -83,6 +83,8 @@ class Fusion {
     // This two members come from `info` and will be used very often.
     Labels labels_of_replace;
     int num_nodes;
+    // Number of nodes on the longest path from the output node to an input.
+    int depth;
   };
 
   Fusion() {}
@@ -105,6 +107,9 @@ class Fusion {
   // The nodes number in graph, including Any node.
   int NumNodes() const;
 
+  // The depth of pattern graph, including Any node.
+  int Depth() const;
+
   inline bool IsPartial() const { return is_partial_; }
 
  protected:
@@ -133,12 +138,20 @@ class FusionMgr {
   // Based on the node op, get all relevant fusions.
   std::vector<Fusion*>& GetFusions(const std::string& key);
 
+  // Same as above, keyed by the interned op type, see
+  // NodeViewInternal::GetOpTypeId(). Preferred on hot paths.
+  std::vector<Fusion*>& GetFusions(OpTypeId key);
+
+  // The max depth of all registered fusions.
+  int MaxDepth() const;
+
  private:
   FusionMgr() {}
 
-  // Main structure of FusionManager. The key is pattern graph's output node op
-  // (not label). And the value will be multiple fusions.
-  std::unordered_map<std::string, std::vector<Fusion*>> map_;
+  // Main structure of FusionManager. The index is the interned op type of
+  // pattern graph's output node (not label). And the value will be multiple
+  // fusions.
+  std::vector<std::vector<Fusion*>> fusions_by_op_;
 };
 
 template <typename T>
@@ -167,6 +180,56 @@ class FusionRegistrar {
 #define REGISTER_FUSION_UNIQ_HELP(ctr, klass) \
   static FusionRegistrar<klass> const fusion_##ctr;
 
+// Result of matching all registered fusions against every node of a graph
+// before the remapper loop starts. Fusion::Check only reads the graph, so it
+// runs concurrently on a thread pool here, while Update still runs serially
+// in the loop. The same is done for the hand written Find* matchers of the
+// loop, given as `find`.
+//
+// For each node it keeps the position of the first fusion whose Check passed,
+// so the loop skips fusions known to fail, and whether `find` matched, so the
+// loop skips the Find* matchers if not. Every Update changes the graph around
+// its root, so Invalidate must be called with the root of each applied
+// fusion: the nodes whose patterns may reach the changed nodes fall back to
+// running all matchers. A cached match is still checked again before the
+// graph is changed, so a stale entry can only miss a fusion, never apply a
+// wrong one.
+class PatternMatchCache {
+ public:
+  // `find_depth` is the max number of edges between the root and any other
+  // node of the patterns matched by `find`.
+  PatternMatchCache(RemapperContext* ctx, bool is_full, int num_threads,
+                    std::function<bool(int)> find, int find_depth);
+
+  // Returns the position in FusionMgr::GetFusions to start matching from.
+  int Lookup(int index) const;
+
+  // Returns false if `find` is known not to match node `index`.
+  bool MayFind(int index) const;
+
+  // Drops the entries of nodes close enough to `root` to be affected by a
+  // fusion rooted at it.
+  void Invalidate(RemapperContext* ctx, int root);
+
+  // Returns an error if one of the fusions skipped for node `index`, or the
+  // skipped `find`, matches it, i.e. if the serial matcher would apply a
+  // fusion the cache misses. Enabled by ITEX_REMAPPER_VERIFY_MATCH_CACHE, for
+  // testing.
+  Status Verify(RemapperContext* ctx, int index, bool is_full) const;
+
+ private:
+  // Positions of first matched fusion, or `kUnknown` if it must be rechecked.
+  std::vector<int> first_match_;
+  // Whether `find_` may match, per node. Not std::vector<bool>, since the
+  // matching threads write neighbouring entries concurrently.
+  std::vector<char> may_find_;
+  std::function<bool(int)> find_;
+  // Max number of edges between a changed node and an affected node.
+  int radius_;
+
+  static constexpr int kUnknown = -1;
+};
+
 // Helper function to compatiable with existing SubGraphMatcher.
 MatchedProperties FillProperties(utils::MutableGraphView* graph_view,
                                  utils::MutableNodeView* node_view,
@@ -180,9 +243,11 @@ std::vector<OpInfo_TensorProperties> GetOutputProperties(RemapperContext* ctx,
 // Helper function to compatiable current remapper for loop.
 // Will change the content of invalidated and deleted.
 // Use the pointer output instead of reference to make cpplint happy.
+// Fusions known to fail are skipped if `cache` is given.
 Status LaunchPatternMatcher(RemapperContext* ctx, int index,
                             std::vector<bool>* invalidated,
-                            std::vector<bool>* deleted, bool is_full = true);
+                            std::vector<bool>* deleted, bool is_full = true,
+                            const PatternMatchCache* cache = nullptr);
 
 }  // namespace graph
 }  // namespace itex
@@ -17,7 +17,10 @@ limitations under the License.
 
 #include "itex/core/graph/remapper/remapper.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <string>
@@ -35,6 +38,8 @@ limitations under the License.
 #include "itex/core/graph/utils/op_types.h"
 #include "itex/core/graph/utils/pattern_utils.h"
 #include "itex/core/graph/utils/symbolic_shapes.h"
+#include "itex/core/utils/cpu_info.h"
+#include "itex/core/utils/env_var.h"
 #include "itex/core/utils/op_kernel.h"
 
 namespace itex {
@@ -46,6 +51,11 @@ bool HasDataType(const NodeDef* node, const DataType& expected,
   return dtype == expected;
 }
 
+bool HasDataType(const utils::MutableNodeView* node,
+                 const DataType& expected) {
+  return node->GetDataType() == expected;
+}
+
 void SetFusedOpAttributes(NodeDef* fused,
                           const absl::Span<const absl::string_view> fused_ops,
                           int num_args = 1) {
@@ -159,6 +169,17 @@ struct RandomWithComparisonAndCast {
   int direction = -1;
 };
 
+// Random op + Comparison + cast whose mask is only consumed by same-shape Mul
+// ops, i.e. dropout forward/backward. The mask is kept as 1 bit per element.
+struct PackedDropout {
+  PackedDropout() = default;
+
+  RandomWithComparisonAndCast mask;
+  std::vector<int> muls;
+  // Index of the data (non-mask) input of each Mul in `muls`.
+  std::vector<int> data_ports;
+};
+
 // Mul + Maximum pattern. will substitute Mul + Maximum with LeakyRelu.
 struct MulWithMaximum {
   MulWithMaximum() = default;
@@ -462,6 +483,14 @@ struct FusedBinary {
   int num_ = kMissingIndex;
 };
 
+// A cluster of elementwise ops rooted at `root_`. `nodes_` holds the cluster
+// in topological order, so the root is the last one.
+struct FusedElementwise {
+  FusedElementwise() = default;
+  int root_ = kMissingIndex;
+  std::vector<int> nodes_;
+};
+
 struct Dropout {
   Dropout() = default;
 
@@ -571,6 +600,21 @@ struct ContractionWithReshapeAndBiasAddGrad {
   int biasaddgrad_ = kMissingIndex;
 };
 
+// MatMul + (optional BiasAdd) followed by a chain of eltwise and Binary ops,
+// which are all fused as oneDNN post ops.
+struct ContractionWithPostOps {
+  ContractionWithPostOps() = default;
+
+  int contraction = kMissingIndex;
+  int bias_add = kMissingIndex;
+  int bias_port = 1;
+  // Post ops ordered from the contraction to the root of the pattern.
+  std::vector<int> post_ops;
+  // Input port of the chain for each post op. The other input of a Binary op
+  // is its broadcast operand.
+  std::vector<int> chain_ports;
+};
+
 bool IsAddWithNoBroadcast(const RemapperContext& ctx, const NodeDef& node) {
   if (!IsAdd(node)) return false;
 
@@ -597,7 +641,7 @@ bool IsBiasSemanticAdd(const RemapperContext& ctx,
                        const utils::MutableNodeView& node_view,
                        int* bias_port) {
   const auto* node_def = node_view.node();
-  if (!IsAdd(*node_def) || node_view.NumRegularFanins() != 2) return false;
+  if (!IsAdd(node_view) || node_view.NumRegularFanins() != 2) return false;
 
   std::vector<OpInfo_TensorProperties> props;
   TF_ABORT_IF_ERROR(
@@ -613,18 +657,19 @@ bool IsBiasSemanticAdd(const RemapperContext& ctx,
   const auto* node_def_1 = node_view_1->node();
 
   // Currently supported data formats are NHWC and NDHWC.
-  auto is_channel_last_format = [](const NodeDef& node) -> bool {
-    if (node.attr().contains("data_format")) {
-      const string data_format = node.attr().at("data_format").s();
-      return (data_format == "NHWC" || data_format == "NDHWC");
-    }
-    return true;
+  auto is_channel_last_format =
+      [](const utils::MutableNodeView& node) -> bool {
+    using utils::internal::NodeDataFormat;
+    const NodeDataFormat data_format = node.GetDataFormat();
+    return data_format == NodeDataFormat::kNone ||
+           data_format == NodeDataFormat::kNHWC ||
+           data_format == NodeDataFormat::kNDHWC;
   };
 
-  if (IsConvOrMatMul(*node_def_0) && is_channel_last_format(*node_def_0)) {
+  if (IsConvOrMatMul(*node_def_0) && is_channel_last_format(*node_view_0)) {
     *bias_port = 1;
   } else if (IsConvOrMatMul(*node_def_1) &&
-             is_channel_last_format(*node_def_1)) {
+             is_channel_last_format(*node_view_1)) {
     *bias_port = 0;
   } else {
     return false;
@@ -908,7 +953,8 @@ bool FindKerasDenseLayerFwd(const RemapperContext& ctx, int node_index,
   int activation_index = kMissingIndex;
   int shape_index = kMissingIndex;
   const auto* reshape = node_view->node();
-  if (!reshape || !IsReshape(*reshape) || HasControlFaninOrFanout(*node_view) ||
+  if (!reshape || !IsReshape(*node_view) ||
+      HasControlFaninOrFanout(*node_view) ||
       IsInPreserveSet(ctx, node_view->node()))
     return false;
 
@@ -1064,7 +1110,8 @@ bool FindMatmulReshapeBiasadd(const RemapperContext& ctx, int node_index,
   int bias_index = kMissingIndex;
   int activation_index = kMissingIndex;
   const auto* reshape = node_view->node();
-  if (!reshape || !IsReshape(*reshape) || HasControlFaninOrFanout(*node_view) ||
+  if (!reshape || !IsReshape(*node_view) ||
+      HasControlFaninOrFanout(*node_view) ||
       IsInPreserveSet(ctx, node_view->node()))
     return false;
 
@@ -1129,12 +1176,12 @@ bool FindAddV2(const RemapperContext& ctx, int node_index, int* matched_index) {
   // Root of the pattern must be a AddN.
   const auto* addN = node_view->node();
   if (IsInPreserveSet(ctx, addN)) return false;
-  if (!addN || !IsAddN(*addN)) return false;
+  if (!addN || !IsAddN(*node_view)) return false;
 
   int num = addN->attr().at("N").i();
   if (num != 2) return false;
-  if (!HasDataType(addN, DT_FLOAT) && !HasDataType(addN, DT_HALF) &&
-      !HasDataType(addN, DT_BFLOAT16))
+  if (!HasDataType(node_view, DT_FLOAT) && !HasDataType(node_view, DT_HALF) &&
+      !HasDataType(node_view, DT_BFLOAT16))
     return false;  // AddN may have dtype DT_VARIANT
   *matched_index = node_index;
   return true;
@@ -1160,7 +1207,7 @@ bool FindSum(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* sum = node_view->node();
 
-  if (!IsSum(*sum) || HasControlFaninOrFanout(*node_view)) return false;
+  if (!IsSum(*node_view) || HasControlFaninOrFanout(*node_view)) return false;
 
   // Only find Sum generated by AddGrad with BroadcastGradientArgs, or a Sum
   // with const indices inputs followed by a Reshape (for tf2.15 and later).
@@ -1301,13 +1348,13 @@ bool FindFusedAddN(const RemapperContext& ctx, int node_index,
   if (HasControlFaninOrFanout(*node_view)) return false;
 
   const auto* addN = node_view->node();
-  if (!addN || !(IsAddN(*addN) || IsAddV2(*addN))) return false;
+  if (!addN || !(IsAddN(*node_view) || IsAddV2(*node_view))) return false;
 
   // TODO(itex): only support AddN+L2Loss fusion on GPU for now, will remove
   // this limitation once supported
-  if (!NodeIsOnGpu(addN)) return false;
+  if (!NodeIsOnGpu(*node_view)) return false;
   int num = 2;
-  if (IsAddN(*addN)) num = addN->attr().at("N").i();
+  if (IsAddN(*node_view)) num = addN->attr().at("N").i();
   std::vector<int> inputs;
   for (int i = 0; i < num; ++i) {
     const auto* l2loss = node_view->GetRegularFanin(i).node_view();
@@ -1334,7 +1381,7 @@ bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
 
   const auto* node_def = node_view->node();
   int bias_port = 1;
-  if (!IsBiasAdd(*node_def) && !IsBiasSemanticAdd(ctx, *node_view, &bias_port))
+  if (!IsBiasAdd(*node_view) && !IsBiasSemanticAdd(ctx, *node_view, &bias_port))
     return false;
 
   // Input to the BiasAdd must be a Conv2D or a MatMul.
@@ -1347,7 +1394,7 @@ bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
   if (HasControlFanout(*contraction_node_view)) return false;
 
   if (IsAccMatMul(*contraction_node_def) &&
-      GetDataTypeFromAttr(*node_def, "T") == DT_FLOAT &&
+      node_view->GetDataType() == DT_FLOAT &&
       HasAtMostOneFanoutAtPort0(*contraction_node_view) &&
       !IsInPreserveSet(ctx, contraction_node_def)) {
     const ContractionWithBiasAdd pattern{contraction_node_view->node_index(),
@@ -1392,18 +1439,19 @@ bool FindContractionWithBiasAddGrad(const RemapperContext& ctx, int node_index,
 
   // Need use BiasAddGrad to find the MatMulGradFilter
   const auto* node_def = node_view->node();
-  if (!IsBiasAddGrad(*node_def)) return false;
+  if (!IsBiasAddGrad(*node_view)) return false;
 
   // FP16 is not supported by oneDNN backward primitive.
-  if (!(HasDataType(node_def, DT_FLOAT) || HasDataType(node_def, DT_BFLOAT16)))
+  if (!(HasDataType(node_view, DT_FLOAT) ||
+        HasDataType(node_view, DT_BFLOAT16)))
     return false;
 
   // Don't do this fusion on GPU since OneDNN impl has a poor performance.
-  if (NodeIsOnGpu(node_def)) return false;
+  if (NodeIsOnGpu(*node_view)) return false;
 
   // Don't do FP32 fusion on CPU since it has lower perf.
   // TODO(itex): Remove this limitation once oneDNN fixes it.
-  if (NodeIsOnCpu(node_def) && HasDataType(node_def, DT_FLOAT)) return false;
+  if (NodeIsOnCpu(*node_view) && HasDataType(node_view, DT_FLOAT)) return false;
 
   // BiasAddGrad, MatMulGradFilter and MatMulGradInput use the same input.
   //
@@ -1504,9 +1552,10 @@ bool FindConvContractionWithBiasAddGrad(const RemapperContext& ctx,
 
   // Need use BiasAddGrad to find the ContractionBackpropFilter.
   const auto* node_def = node_view->node();
-  if (!IsBiasAddGrad(*node_def)) return false;
+  if (!IsBiasAddGrad(*node_view)) return false;
 
-  if (!(HasDataType(node_def, DT_FLOAT) || HasDataType(node_def, DT_BFLOAT16)))
+  if (!(HasDataType(node_view, DT_FLOAT) ||
+        HasDataType(node_view, DT_BFLOAT16)))
     return false;
 
   const auto* dz = node_view->GetRegularFanin(0).node_view();
@@ -1596,10 +1645,12 @@ bool FindContractionWithBiasAddAndAdd(const RemapperContext& ctx,
   // (no broadcasting).
   const auto* node_def = node_view->node();
 
-  if (!IsAddN(*node_def) && !IsAddWithNoBroadcast(ctx, *node_def)) return false;
+  if (!IsAddN(*node_view) && !IsAddWithNoBroadcast(ctx, *node_def))
+    return false;
 
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   ContractionWithBiasAdd base;
@@ -1646,7 +1697,7 @@ bool FindContractionWithBiasAndActivation(
                                /*check_device_compatible=*/false) ||
       !HasAtMostOneFanoutAtPort0(*bias_add_node_view) ||
       (!HaveSameDataType(node_def, bias_add_node_def) &&
-       !(GetDataTypeFromAttr(*node_def, "T") == DT_FLOAT &&
+       !(node_view->GetDataType() == DT_FLOAT &&
          IsFusedAccMatMul(*bias_add_node_def))) ||
       IsInPreserveSet(ctx, bias_add_node_def))
     return false;
@@ -1696,8 +1747,9 @@ bool FindContractionWithBiasAndAddActivation(
 
   // OneDnn activation op only supports float, float16 and bfloat16 data types
   // on GPU.
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   // And input to activation must match ContractionWithBiasAddAndAdd pattern.
@@ -1737,7 +1789,7 @@ bool FindConv2DWithBatchNorm(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
   // Root of the pattern must be a FusedBatchNorm.
-  if (!IsFusedBatchNorm(*node_def) && !IsITEXFusedBatchNorm(*node_def))
+  if (!IsFusedBatchNorm(*node_view) && !IsITEXFusedBatchNorm(*node_view))
     return false;
 
   if (node_view->GetOp() != "FusedBatchNorm" &&
@@ -1828,8 +1880,9 @@ bool FindConv2DWithBatchNormAndAddV2AndActivation(
 
   // OneDnn activation op only supports float, float16 and bfloat16 data types
   // on GPU.
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   // And input to activation must match ContractionWithBiasAddAndAdd pattern.
@@ -1899,11 +1952,12 @@ bool FindContractionWithBiasAndActivationAdd(
 
   // Root of the pattern must be an activation node.
   const auto* node_def = node_view->node();
-  if (!IsAdd(*node_def)) return false;
+  if (!IsAdd(*node_view)) return false;
   // OneDnn activation op only supports float, float16 and bfloat16 data types
   // on GPU.
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   ContractionWithBiasAddAndActivation base;
@@ -1938,29 +1992,222 @@ bool FindContractionWithBiasAndActivationAdd(
   return true;
 }
 
+// oneDNN limits the length of a post op chain.
+constexpr int kMaxPostOpChainLength = 32;
+
+bool IsPostOpChainBinary(const NodeDef& node) {
+  return IsAdd(node) || IsMul(node) || IsSub(node) || IsRealDiv(node) ||
+         IsMaximum(node) || IsMinimum(node);
+}
+
+// Reads a scalar float/bfloat16/half Const.
+bool GetScalarConstValue(const utils::MutableNodeView& node_view,
+                         float* value) {
+  const auto* node_def = node_view.node();
+  if (!IsConstant(*node_def)) return false;
+
+  Tensor const_tensor;
+  if (!GetTensorFromConstant(node_def, &const_tensor).ok() ||
+      const_tensor.NumElements() != 1)
+    return false;
+
+  DataType const_dtype = GetDataTypeFromAttr(*node_def, "dtype");
+  if (const_dtype == DT_BFLOAT16) {
+    *value = static_cast<float>(const_tensor.flat<Eigen::bfloat16>()(0));
+  } else if (const_dtype == DT_HALF) {
+    *value = static_cast<float>(const_tensor.flat<Eigen::half>()(0));
+  } else if (const_dtype == DT_FLOAT) {
+    *value = const_tensor.flat<float>()(0);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the name of `node_view` in `fused_ops` of a post op chain, or an
+// empty string if it can't be fused. `alpha` and `beta` are set to the params
+// of the post op, NaN to keep its default.
+string GetChainPostOpName(const utils::MutableNodeView& node_view,
+                          float* alpha, float* beta) {
+  const auto* node_def = node_view.node();
+  *alpha = NAN;
+  *beta = NAN;
+
+  if (IsAdd(*node_def)) return kBinaryAdd;
+  if (IsMul(*node_def)) return kBinaryMul;
+  if (IsSub(*node_def)) return kBinarySub;
+  if (IsRealDiv(*node_def)) return kBinaryDiv;
+  if (IsMaximum(*node_def)) return kBinaryMax;
+  if (IsMinimum(*node_def)) return kBinaryMin;
+
+  // Clip is only fused with constant bounds, they become post op params.
+  if (node_def->op() == "ClipByValue") {
+    if (node_view.NumRegularFanins() != 3) return "";
+    if (!GetScalarConstValue(*node_view.GetRegularFanin(1).node_view(),
+                             alpha) ||
+        !GetScalarConstValue(*node_view.GetRegularFanin(2).node_view(), beta))
+      return "";
+    return "Clip";
+  }
+  if (node_def->op() == "Round") return "Round";
+
+  if (IsLeakyRelu(*node_def)) {
+    *alpha = node_def->attr().at("alpha").f();
+    return node_def->op();
+  }
+  if (IsGelu(*node_def)) {
+    return node_def->attr().at("approximate").b() ? "GeluApproximate"
+                                                  : "GeluExact";
+  }
+  if (node_def->op() == kSwish) {
+    if (HasNodeAttr(*node_def, "alpha"))
+      *alpha = node_def->attr().at("alpha").f();
+    return node_def->op();
+  }
+  if (IsSupportedActivation(*node_def)) return node_def->op();
+
+  return "";
+}
+
+// Returns true if `operand` broadcasts to `output` without broadcasting
+// `output` itself, so oneDNN can read it as the source of a Binary post op.
+bool IsPostOpBroadcastable(const TensorShapeProto& operand,
+                           const TensorShapeProto& output) {
+  if (operand.unknown_rank() || output.unknown_rank()) return false;
+  const int offset = output.dim_size() - operand.dim_size();
+  if (offset < 0) return false;
+
+  for (int i = 0; i < operand.dim_size(); ++i) {
+    const auto& operand_dim = operand.dim(i);
+    const auto& output_dim = output.dim(i + offset);
+    if (operand_dim.size() == 1) continue;
+    if (IsUnknown(operand_dim) || IsUnknown(output_dim) ||
+        operand_dim.size() != output_dim.size())
+      return false;
+  }
+  return true;
+}
+
+// Returns the input port of `binary` which continues the chain towards the
+// contraction, or -1 if no input qualifies.
+int GetPostOpChainPort(const RemapperContext& ctx,
+                       const utils::MutableNodeView& binary) {
+  const auto* node_def = binary.node();
+  if (binary.NumRegularFanins() != 2) return -1;
+
+  std::vector<OpInfo_TensorProperties> props;
+  TF_ABORT_IF_ERROR(
+      ctx.graph_properties.GetInputProperties(node_def->name(), &props));
+  if (props.size() != 2) return -1;
+
+  // The chain is used by `binary` only, while the other input, e.g. residual
+  // of a skip connection, usually has other users.
+  const auto is_chain_port = [&](int port) -> bool {
+    const auto* fanin = binary.GetRegularFanin(port).node_view();
+    if (IsConstant(*fanin->node()) || !HasAtMostOneFanoutAtPort0(*fanin))
+      return false;
+    return IsPostOpBroadcastable(props[1 - port].shape(), props[port].shape());
+  };
+
+  // Only `x - y` and `x / y` are supported by oneDNN, where `x` is the chain.
+  if (is_chain_port(0)) return 0;
+  if (IsSub(*node_def) || IsRealDiv(*node_def)) return -1;
+  if (is_chain_port(1)) return 1;
+  return -1;
+}
+
+bool FindContractionWithPostOps(const RemapperContext& ctx, int node_index,
+                                ContractionWithPostOps* matched) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  // verify the output node has control fanin edge or not.
+  if (HasControlFanin(*node_view)) return false;
+
+  float alpha, beta;
+  if (GetChainPostOpName(*node_view, &alpha, &beta).empty()) return false;
+
+  // Walk up from the root until reaching the contraction. All nodes except the
+  // root must be used by the chain only.
+  ContractionWithPostOps pattern;
+  const auto* current = node_view;
+  while (true) {
+    const auto* current_def = current->node();
+    if (current != node_view &&
+        (!HasAtMostOneFanoutAtPort0(*current) ||
+         HasControlFaninOrFanout(*current) ||
+         IsInPreserveSet(ctx, current_def) ||
+         current_def->device() != node_def->device()))
+      return false;
+
+    if (IsMatMul(*current_def)) {
+      pattern.contraction = current->node_index();
+      break;
+    }
+
+    if (current->NumRegularFanins() < 1) return false;
+    if (IsBiasAdd(*current_def)) {
+      // BiasAdd is fused into the primitive, so it must follow MatMul.
+      const auto* fanin = current->GetRegularFanin(0).node_view();
+      if (!IsMatMul(*fanin->node())) return false;
+      pattern.bias_add = current->node_index();
+      current = fanin;
+      continue;
+    }
+
+    if (GetChainPostOpName(*current, &alpha, &beta).empty() ||
+        !HaveSameDataType(node_def, current_def))
+      return false;
+
+    int chain_port = 0;
+    if (IsPostOpChainBinary(*current_def)) {
+      chain_port = GetPostOpChainPort(ctx, *current);
+      if (chain_port < 0) return false;
+    }
+    pattern.post_ops.push_back(current->node_index());
+    pattern.chain_ports.push_back(chain_port);
+    if (static_cast<int>(pattern.post_ops.size()) > kMaxPostOpChainLength)
+      return false;
+
+    current = current->GetRegularFanin(chain_port).node_view();
+  }
+
+  const auto* contraction_def = current->node();
+  if (!HaveSameDataType(node_def, contraction_def) ||
+      !(HasDataType(contraction_def, DT_FLOAT) ||
+        HasDataType(contraction_def, DT_BFLOAT16) ||
+        HasDataType(contraction_def, DT_HALF)))
+    return false;
+
+  std::reverse(pattern.post_ops.begin(), pattern.post_ops.end());
+  std::reverse(pattern.chain_ports.begin(), pattern.chain_ports.end());
+  *matched = pattern;
+
+  return true;
+}
+
 bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
                           FusedBatchNormEx* matched) {
   // Root of the pattern must be a Relu.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
-  if (!IsRelu(*node_def)) return false;
+  if (!IsRelu(*node_view)) return false;
 
   // Returns true iff the node is a compatible FusedBatchNorm node.
   const auto valid_batch_norm =
       [&](const utils::MutableNodeView& fused_batch_norm) -> bool {
     const auto* fused_batch_norm_node_def = fused_batch_norm.node();
-    if (!IsFusedBatchNorm(*fused_batch_norm_node_def)) return false;
+    if (!IsFusedBatchNorm(fused_batch_norm)) return false;
 
-    DataType t_dtype = GetDataTypeFromAttr(*fused_batch_norm_node_def, "T");
+    DataType t_dtype = fused_batch_norm.GetDataType();
 
     // GPU supports float and bfloat16.
     if (t_dtype != DT_FLOAT && t_dtype != DT_BFLOAT16) return false;
 
-    string data_format;
-    if (!GetNodeAttr(*fused_batch_norm_node_def, kDataFormat, &data_format)
-             .ok())
+    const auto data_format = fused_batch_norm.GetDataFormat();
+    if (data_format != utils::internal::NodeDataFormat::kNHWC &&
+        data_format != utils::internal::NodeDataFormat::kNCHW)
       return false;
-    if (data_format != "NHWC" && data_format != "NCHW") return false;
 
     // FusedBatchNormV2 and V3 have an extra type parameter.
     if ((fused_batch_norm_node_def->op() != "FusedBatchNorm") &&
@@ -1989,10 +2236,10 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
   }
 
   // Input to a Relu can be an Add node with FusedBatchNorm as one of the inputs
-  if (IsAdd(*relu_fanin_0_node_def)) {
+  if (IsAdd(*relu_fanin_0_node_view)) {
     // Currently no CPU implementation for "FusedBatchNorm + SideInput +
     // <Activation>""
-    if (!NodeIsOnGpu(node_def)) return false;
+    if (!NodeIsOnGpu(*node_view)) return false;
 
     // Check that only Relu node consumes the output of an Add node.
     if (HasControlFaninOrFanout(*relu_fanin_0_node_view) ||
@@ -2039,7 +2286,7 @@ bool FindDequantizeWithShape(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
 
-  if (!IsShape(*node_def)) return false;
+  if (!IsShape(*node_view)) return false;
   auto* dequantize_node_view = node_view->GetRegularFanin(0).node_view();
   auto* dequantize_node_def = dequantize_node_view->node();
 
@@ -2065,9 +2312,9 @@ bool FindDequantizeWithReshape(const RemapperContext& ctx, int node_index,
 
   // TODO(itex): only support DequantizeWithReshape fusion on GPU for now, will
   // remove this limitation once supported
-  if (!NodeIsOnGpu(node_def)) return false;
+  if (!NodeIsOnGpu(*node_view)) return false;
 
-  if (!IsReshape(*node_def)) return false;
+  if (!IsReshape(*node_view)) return false;
   auto* dequantize_node_view = node_view->GetRegularFanin(0).node_view();
   auto* dequantize_node_def = dequantize_node_view->node();
 
@@ -2127,9 +2374,9 @@ bool FindAddV2WithSoftmax(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
   if (HasControlFaninOrFanout(*node_view)) return false;
-  if (!NodeIsOnGpu(node_def)) return false;
+  if (!NodeIsOnGpu(*node_view)) return false;
 
-  if (!IsSoftmax(*node_def)) return false;
+  if (!IsSoftmax(*node_view)) return false;
   auto* addv2_node_view = node_view->GetRegularFanin(0).node_view();
   auto* addv2_node_def = addv2_node_view->node();
 
@@ -2183,9 +2430,9 @@ bool FindQuantizedConv2DWithDequantize(const RemapperContext& ctx,
 
   // TODO(itex): only support this fusion on GPU for now, will
   // remove this limitation once supported
-  if (!NodeIsOnGpu(node_def)) return false;
+  if (!NodeIsOnGpu(*node_view)) return false;
 
-  if (!IsDequantize(*node_def)) {
+  if (!IsDequantize(*node_view)) {
     return false;
   }
   auto* conv2d_node_view = node_view->GetRegularFanin(0).node_view();
@@ -2212,9 +2459,9 @@ bool FindQuantizedConv2DWithCast(const RemapperContext& ctx, int node_index,
 
   // TODO(itex): only support this fusion on GPU for now, will
   // remove this limitation once supported
-  if (!NodeIsOnGpu(node_def)) return false;
+  if (!NodeIsOnGpu(*node_view)) return false;
 
-  if (!IsCast(*node_def)) return false;
+  if (!IsCast(*node_view)) return false;
   auto* conv2d_node_view = node_view->GetRegularFanin(0).node_view();
   auto* conv2d_node_def = conv2d_node_view->node();
   if (!IsQuantizedConv2DWithDequantize(*conv2d_node_def)) {
@@ -2355,7 +2602,7 @@ bool FindPadWithTransposeConv(const RemapperContext& ctx, int node_index,
       node_view->NumRegularFanouts() != 1 || IsInPreserveSet(ctx, node_def))
     return false;
 
-  if (!IsTranspose(*node_def) || node_view->NumRegularFanins() != 2)
+  if (!IsTranspose(*node_view) || node_view->NumRegularFanins() != 2)
     return false;
 
   const auto* const_node_view = node_view->GetRegularFanin(1).node_view();
@@ -2450,9 +2697,9 @@ bool FindPadWithContraction(const RemapperContext& ctx, int node_index,
   // Root node must be Conv2D/_FusedITEXConv2D/DepthwiseConv2DNative.
   const auto* node_def = node_view->node();
   // May cover more conv op in future, such as FusedDepthwiseConv2D
-  const bool is_conv = IsConv2D(*node_def) || node_def->op() == kFusedConv2D ||
-                       IsConv3D(*node_def) || node_def->op() == kFusedConv3D ||
-                       IsDepthwiseConv2dNative(*node_def);
+  const bool is_conv = IsConv2D(*node_view) || node_def->op() == kFusedConv2D ||
+                       IsConv3D(*node_view) || node_def->op() == kFusedConv3D ||
+                       IsDepthwiseConv2dNative(*node_view);
   if (!is_conv) {
     return false;
   }
@@ -2512,7 +2759,7 @@ bool FindConvBackpropInputWithSlice(const RemapperContext& ctx, int node_index,
   if (HasControlFaninOrFanout(*node_view)) return false;
 
   const auto* node_def = node_view->node();
-  if (!IsSlice(*node_def)) return false;
+  if (!IsSlice(*node_view)) return false;
 
   const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
   const auto* conv_node_view = regular_fanin_0.node_view();
@@ -2562,7 +2809,7 @@ bool FindConv2DBackpropInputWithSliceLLGA(const RemapperContext& ctx,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
 
   const auto* node_def = node_view->node();
-  if (!IsSlice(*node_def)) return false;
+  if (!IsSlice(*node_view)) return false;
 
   const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
   const auto* conv_node_view = regular_fanin_0.node_view();
@@ -2673,10 +2920,10 @@ bool FindFusedTrainingOp(const RemapperContext& ctx, int node_index,
 
   // Only GPU supports this fusion.
   // TODO(itex): Remove this limitation once it's supported.
-  if (!NodeIsOnGpu(node_def)) return false;
+  if (!NodeIsOnGpu(*node_view)) return false;
 
   int input_index = -1;
-  if (IsApplyMomentum(*node_def) || IsResourceApplyMomentum(*node_def)) {
+  if (IsApplyMomentum(*node_view) || IsResourceApplyMomentum(*node_view)) {
     // Input: var, accum, lr, grad, momentum
     if (node_view->NumRegularFanins() != 5) return false;
     input_index = 3;
@@ -2774,7 +3021,7 @@ bool FindFusedTrainingOp(const RemapperContext& ctx, int node_index,
   } else if (IsMul(*input_node_def)) {
     // Currently, we don't implement Mul + Momemtum fusion. Only Mul + AddN +
     // Momemtum is supported.
-    if (IsApplyMomentum(*node_def) || IsResourceApplyMomentum(*node_def))
+    if (IsApplyMomentum(*node_view) || IsResourceApplyMomentum(*node_view))
       return false;
 
     // Mul has two inputs, at least one input should be scalar
@@ -2804,7 +3051,7 @@ bool FindContractionWithMul(const RemapperContext& ctx, int node_index,
   if (HasControlFaninOrFanout(*node_view)) return false;
 
   const auto* node_def = node_view->node();
-  if (!IsAnyMul(*node_def)) return false;
+  if (!IsAnyMul(*node_view)) return false;
 
   // Mul has two inputs, one input should be scalar
   int scalar_input_index = GetMulScalarInputIndex(ctx, *node_def);
@@ -2824,8 +3071,8 @@ bool FindContractionWithMul(const RemapperContext& ctx, int node_index,
 
   bool hasValidType = false;
   hasValidType =
-      (HasDataType(node_def, DT_FLOAT) || HasDataType(node_def, DT_BFLOAT16) ||
-       HasDataType(node_def, DT_HALF));
+      (HasDataType(node_view, DT_FLOAT) ||
+       HasDataType(node_view, DT_BFLOAT16) || HasDataType(node_view, DT_HALF));
 
   if (!hasValidType) return false;
 
@@ -2851,7 +3098,7 @@ bool FindBf16ContractionGradWithCastFp32(
   if (HasControlFaninOrFanout(*node_view)) return false;
 
   const auto* node_def = node_view->node();
-  if (!IsCast(*node_def)) return false;
+  if (!IsCast(*node_view)) return false;
 
   DataType dst_dtype = GetDataTypeFromAttr(*node_def, "DstT");
   DataType src_dtype = GetDataTypeFromAttr(*node_def, "SrcT");
@@ -2890,7 +3137,7 @@ bool FindBf16ContractionWithCastFp32(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
 
-  if (!IsCast(*node_def) || HasControlFaninOrFanout(*node_view)) return false;
+  if (!IsCast(*node_view) || HasControlFaninOrFanout(*node_view)) return false;
 
   if (node_view->NumRegularFanins() != 1) return false;
   const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
@@ -2898,6 +3145,8 @@ bool FindBf16ContractionWithCastFp32(const RemapperContext& ctx, int node_index,
   const auto* contraction_node_def = contraction->node();
   if (!IsMatMul(*contraction_node_def) && !IsFusedMatmul(*contraction_node_def))
     return false;
+  // Generic post op chains have Binary operands in the type of the MatMul.
+  if (HasPostOpChain(*contraction_node_def)) return false;
 
   DataType contraction_dtype = GetDataTypeFromAttr(*contraction_node_def, "T");
   DataType dst_dtype = GetDataTypeFromAttr(*node_def, "DstT");
@@ -2948,7 +3197,7 @@ bool FindComparisonWithCast(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
 
-  if (!IsCast(*node_def) || HasControlFaninOrFanout(*node_view)) return false;
+  if (!IsCast(*node_view) || HasControlFaninOrFanout(*node_view)) return false;
 
   if (node_view->NumRegularFanins() != 1) return false;
   const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
@@ -3038,6 +3287,64 @@ bool FindRandomWithComparisonAndCast(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Random op + Comparison + cast + Mul(s) on CPU, found from the cast. All
+// consumers of the full-width mask must be Mul ops whose other input has the
+// same static shape as the mask, so the mask can be stored bit-packed.
+bool FindPackedDropout(const RemapperContext& ctx, int node_index,
+                       PackedDropout* matched) {
+  const auto* cast_view = ctx.graph_view.GetNode(node_index);
+  if (!NodeIsOnCpu(*cast_view)) return false;
+
+  RandomWithComparisonAndCast mask;
+  if (!FindRandomWithComparisonAndCast(ctx, node_index, &mask)) return false;
+
+  const auto* random_def = ctx.graph_view.GetNode(mask.random)->node();
+  std::vector<OpInfo_TensorProperties> random_props;
+  if (!ctx.graph_properties
+           .GetOutputProperties(random_def->name(), &random_props)
+           .ok() ||
+      random_props.empty() ||
+      !ShapeIsSymbolicallyDefined(random_props[0].shape()))
+    return false;
+
+  const auto& fanouts = cast_view->GetRegularFanout(0);
+  if (fanouts.empty()) return false;
+
+  std::vector<int> muls;
+  std::vector<int> data_ports;
+  for (const auto& fanout : fanouts) {
+    const auto* mul_view = fanout.node_view();
+    const auto* mul_def = mul_view->node();
+    if (!IsMul(*mul_def) || HasControlFaninOrFanout(*mul_view) ||
+        mul_view->NumRegularFanins() != 2)
+      return false;
+
+    const int data_port = 1 - fanout.index();
+    const auto& data_fanin = mul_view->GetRegularFanin(data_port);
+    // Square of the mask can't be expressed with a single packed mask.
+    if (data_fanin.node_index() == node_index) return false;
+
+    std::vector<OpInfo_TensorProperties> data_props;
+    const auto* data_def = data_fanin.node_view()->node();
+    if (!ctx.graph_properties.GetOutputProperties(data_def->name(), &data_props)
+             .ok() ||
+        data_fanin.index() < 0 ||
+        data_fanin.index() >= static_cast<int>(data_props.size()))
+      return false;
+    if (!ShapesSymbolicallyEqual(data_props[data_fanin.index()].shape(),
+                                 random_props[0].shape()))
+      return false;
+
+    muls.push_back(fanout.node_index());
+    data_ports.push_back(data_port);
+  }
+
+  matched->mask = mask;
+  matched->muls = std::move(muls);
+  matched->data_ports = std::move(data_ports);
+  return true;
+}
+
 // Fuse Mul and Maximum into LeakyRelu
 /*
        maximum
@@ -3119,7 +3426,7 @@ bool FindConstWithCast(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
 
-  if (!IsCast(*node_def) || HasControlFaninOrFanout(*node_view)) return false;
+  if (!IsCast(*node_view) || HasControlFaninOrFanout(*node_view)) return false;
 
   if (node_view->NumRegularFanins() != 1) return false;
   const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
@@ -3175,7 +3482,7 @@ bool FindPadConvFwdBwd(const RemapperContext& ctx, int node_index,
                        PadConvFwdBwd* matched) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
-  if (!IsConv2DBackpropFilter(*node_def) || HasControlFanin(*node_view))
+  if (!IsConv2DBackpropFilter(*node_view) || HasControlFanin(*node_view))
     return false;
 
   matched->conv2d_bwd_filter = node_view->node_index();
@@ -3239,10 +3546,12 @@ bool FindFusedBinary(const RemapperContext& ctx, int node_index,
   if (HasControlFanin(*node_view)) return false;
 
   // Only support Add/Mul/Sub now because they satisfy the commutative law.
-  if (!IsAdd(*node_def) && !IsMul(*node_def) && !IsSub(*node_def)) return false;
+  if (!IsAdd(*node_view) && !IsMul(*node_view) && !IsSub(*node_view))
+    return false;
 
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   // Returns true iff all the nodes have valid shape.
@@ -3260,7 +3569,7 @@ bool FindFusedBinary(const RemapperContext& ctx, int node_index,
     if (!(same_input || has_scalar)) return false;
     // Disable scalar fusion on CPU due to performance issue.
     // TODO(itex): Support scalar fusion on CPU.
-    if (has_scalar && NodeIsOnCpu(binary_def)) return false;
+    if (has_scalar && NodeIsOnCpu(binary)) return false;
     return true;
   };
 
@@ -3286,13 +3595,13 @@ bool FindFusedBinary(const RemapperContext& ctx, int node_index,
       const auto* input_node_view = regular_fanin.node_view();
       const auto* input_node_def = input_node_view->node();
 
-      if (!IsAdd(*input_node_def) && !IsMul(*input_node_def) &&
-          !IsSub(*input_node_def))
+      if (!IsAdd(*input_node_view) && !IsMul(*input_node_view) &&
+          !IsSub(*input_node_view))
         continue;
 
-      if (!HasDataType(input_node_def, DT_FLOAT) &&
-          !HasDataType(input_node_def, DT_BFLOAT16) &&
-          !HasDataType(input_node_def, DT_HALF))
+      if (!HasDataType(input_node_view, DT_FLOAT) &&
+          !HasDataType(input_node_view, DT_BFLOAT16) &&
+          !HasDataType(input_node_view, DT_HALF))
         continue;
 
       if (HasControlFaninOrFanout(*input_node_view) ||
@@ -3317,16 +3626,172 @@ bool FindFusedBinary(const RemapperContext& ctx, int node_index,
   return matched->num_ > 1;
 }
 
+// Returns true iff `node` can be evaluated by _ITEXFusedElementwise. Must be
+// kept in sync with the op table of the CPU kernel.
+bool IsFusableElementwise(const NodeDef& node) {
+  static const std::unordered_set<string> ops = {
+      "Abs",
+      "Add",
+      "AddV2",
+      "Cast",
+      "Equal",
+      "Exp",
+      "Greater",
+      "GreaterEqual",
+      "Less",
+      "LessEqual",
+      "Log",
+      "LogicalAnd",
+      "LogicalNot",
+      "LogicalOr",
+      "Maximum",
+      "Minimum",
+      "Mul",
+      "Neg",
+      "NotEqual",
+      "RealDiv",
+      "Reciprocal",
+      "Relu",
+      "Relu6",
+      "Rsqrt",
+      "Sigmoid",
+      "Sqrt",
+      "Square",
+      "SquaredDifference",
+      "Sub",
+      "Tanh",
+      "_ITEXEqualWithCast",
+      "_ITEXGreaterEqualWithCast",
+      "_ITEXGreaterWithCast",
+      "_ITEXLessEqualWithCast",
+      "_ITEXLessWithCast",
+      "_ITEXNotEqualWithCast"};
+  return ops.count(node.op()) > 0;
+}
+
+// Type of the regular inputs and of the output of a fusable elementwise op.
+DataType ElementwiseInputType(const NodeDef& node) {
+  if (IsCast(node)) return GetDataTypeFromAttr(node, "SrcT");
+  if (IsLogicalAnd(node) || IsLogicalOr(node) || IsLogicalNot(node))
+    return DT_BOOL;
+  return GetDataTypeFromAttr(node, "T");
+}
+
+DataType ElementwiseOutputType(const NodeDef& node) {
+  if (IsCast(node)) return GetDataTypeFromAttr(node, "DstT");
+  if (IsComparison(node) || IsLogicalAnd(node) || IsLogicalOr(node) ||
+      IsLogicalNot(node))
+    return DT_BOOL;
+  return GetDataTypeFromAttr(node, "T");
+}
+
+// Find a DAG of elementwise ops on CPU, including activations, casts and
+// comparisons. Inner values may be booleans, but the inputs and the output of
+// the cluster must have the root's type. Inputs are broadcast by the kernel.
+bool FindFusedElementwise(const RemapperContext& ctx, int node_index,
+                          FusedElementwise* matched) {
+  const size_t kMaxFusedElementwiseOps = 16;
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+
+  if (!NodeIsOnCpu(*node_view) || HasControlFanin(*node_view) ||
+      !IsFusableElementwise(*node_def))
+    return false;
+
+  const DataType dtype = ElementwiseOutputType(*node_def);
+  if (dtype != DT_FLOAT && dtype != DT_BFLOAT16) return false;
+
+  // Returns true iff a node only deals with `dtype` and booleans. Booleans are
+  // computed as 0/1 values of `dtype`, so Cast only works towards `dtype`.
+  const auto valid_type = [&](const NodeDef& node) -> bool {
+    DataType in = ElementwiseInputType(node);
+    DataType out = ElementwiseOutputType(node);
+    if (IsCast(node)) return (in == dtype || in == DT_BOOL) && out == dtype;
+    return (in == dtype || in == DT_BOOL) && (out == dtype || out == DT_BOOL);
+  };
+  if (!valid_type(*node_def)) return false;
+
+  // Grow the cluster until no more producers can be absorbed. A producer is
+  // absorbed only once all of its consumers are in the cluster.
+  std::set<int> cluster = {node_index};
+  bool changed = true;
+  while (changed && cluster.size() < kMaxFusedElementwiseOps) {
+    changed = false;
+    const std::vector<int> members(cluster.begin(), cluster.end());
+    for (int member : members) {
+      if (cluster.size() >= kMaxFusedElementwiseOps) break;
+      const auto* member_view = ctx.graph_view.GetNode(member);
+      for (int i = 0; i < member_view->NumRegularFanins(); ++i) {
+        const auto& regular_fanin = member_view->GetRegularFanin(i);
+        const int fanin_index = regular_fanin.node_index();
+        if (cluster.count(fanin_index) || regular_fanin.index() != 0) continue;
+
+        const auto* fanin_view = regular_fanin.node_view();
+        const auto* fanin_def = fanin_view->node();
+        if (!IsFusableElementwise(*fanin_def) ||
+            fanin_def->device() != node_def->device() ||
+            HasControlFaninOrFanout(*fanin_view) ||
+            IsInPreserveSet(ctx, fanin_def) || !valid_type(*fanin_def))
+          continue;
+
+        bool all_consumers_fused = true;
+        for (const auto& fanout : fanin_view->GetRegularFanout(0)) {
+          if (!cluster.count(fanout.node_index())) all_consumers_fused = false;
+        }
+        if (!all_consumers_fused) continue;
+
+        cluster.insert(fanin_index);
+        changed = true;
+        if (cluster.size() >= kMaxFusedElementwiseOps) break;
+      }
+    }
+  }
+  if (cluster.size() < 2) return false;
+
+  // Values entering the cluster must have the cluster's type.
+  for (int member : cluster) {
+    const auto* member_view = ctx.graph_view.GetNode(member);
+    for (int i = 0; i < member_view->NumRegularFanins(); ++i) {
+      if (cluster.count(member_view->GetRegularFanin(i).node_index())) continue;
+      if (ElementwiseInputType(*member_view->node()) != dtype) return false;
+    }
+  }
+
+  // Order the cluster topologically. Node indices can't be used directly,
+  // since nodes added by previous fusions are appended to the graph.
+  matched->root_ = node_index;
+  matched->nodes_.clear();
+  std::set<int> pending = cluster;
+  while (!pending.empty()) {
+    for (auto it = pending.begin(); it != pending.end();) {
+      const auto* member_view = ctx.graph_view.GetNode(*it);
+      bool ready = true;
+      for (int i = 0; i < member_view->NumRegularFanins(); ++i) {
+        if (pending.count(member_view->GetRegularFanin(i).node_index()))
+          ready = false;
+      }
+      if (ready) {
+        matched->nodes_.push_back(*it);
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  return true;
+}
+
 // Find dropout pattern in TF2.11 and remaper to TF2.10 to reuse the optimzaiton
 // in TF2.10.
 bool FindDropout(const RemapperContext& ctx, int node_index, Dropout* matched) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
 
-  if (!IsSelect(*node_def) || HasControlFanin(*node_view)) return false;
+  if (!IsSelect(*node_view) || HasControlFanin(*node_view)) return false;
 
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   // SelectOp has 3 input, condition, t and e
@@ -3455,11 +3920,12 @@ bool FindStridedSliceGrad(const RemapperContext& ctx, int node_index,
   const auto* node_view = ctx.graph_view.GetNode(node_index);
   const auto* node_def = node_view->node();
 
-  if (!IsStridedSliceGrad(*node_def) || HasControlFanin(*node_view))
+  if (!IsStridedSliceGrad(*node_view) || HasControlFanin(*node_view))
     return false;
 
-  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_BFLOAT16) &&
-      !HasDataType(node_def, DT_HALF))
+  if (!HasDataType(node_view, DT_FLOAT) &&
+      !HasDataType(node_view, DT_BFLOAT16) &&
+      !HasDataType(node_view, DT_HALF))
     return false;
 
   if (node_view->NumRegularFanins() != 5) return false;
@@ -3760,8 +4226,8 @@ bool FindDilatedContraction(const RemapperContext& ctx, int node_index,
 
   if (contraction_node_view->NumRegularFanouts() != 1) return false;
 
-  bool is_valid_contraction = IsConv2D(*contraction_node_def) ||
-                              IsDepthwiseConv2dNative(*contraction_node_def);
+  bool is_valid_contraction = IsConv2D(*contraction_node_view) ||
+                              IsDepthwiseConv2dNative(*contraction_node_view);
 
   if (!is_valid_contraction ||
       !HaveSameDataType(btos_node_def, contraction_node_def) ||
@@ -3770,11 +4236,10 @@ bool FindDilatedContraction(const RemapperContext& ctx, int node_index,
       IsInPreserveSet(ctx, contraction_node_def))
     return false;
 
-  string data_format;
-  TF_ABORT_IF_ERROR(
-      GetNodeAttr(*contraction_node_def, "data_format", &data_format));
   // TODO(itex): Support NCHW in the future.
-  if (data_format != "NHWC") return false;
+  if (contraction_node_view->GetDataFormat() !=
+      utils::internal::NodeDataFormat::kNHWC)
+    return false;
 
   // In dilated Conv pattern from API, the padding type must be VALID and each
   // element of dilations must be 1.
@@ -3845,7 +4310,7 @@ bool FindContractionWithReshapeAndBiasAddGrad(
   // BiasAddGrad should have 1 input
   const auto* bias_add_grad = node_view->node();
 
-  if (!bias_add_grad || !IsBiasAddGrad(*bias_add_grad) ||
+  if (!bias_add_grad || !IsBiasAddGrad(*node_view) ||
       HasControlFaninOrFanout(*node_view) ||
       IsInPreserveSet(ctx, node_view->node()) ||
       node_view->NumRegularFanins() != 1)
@@ -4975,6 +5440,76 @@ Status AddFusedContractionNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+// MatMul + (optional BiasAdd) + chain of eltwise and Binary ops.
+Status AddFusedContractionNode(RemapperContext* ctx,
+                               const ContractionWithPostOps& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& contraction = graph->node(matched.contraction);
+  const NodeDef& root = graph->node(matched.post_ops.back());
+  ITEX_VLOG(2) << "Fuse " << contraction.op() << " with "
+               << matched.post_ops.size() << " post ops:"
+               << " root=" << root.name()
+               << " contraction=" << contraction.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_device(contraction.device());
+  fused_op.add_input(contraction.input(0));  // 0: input
+  fused_op.add_input(contraction.input(1));  // 1: filter
+  fused_op.set_op(kFusedMatMul);
+
+  // `alphas` and `betas` are aligned with `fused_ops`.
+  std::vector<string> fused_ops;
+  std::vector<float> alphas, betas;
+  if (matched.bias_add != kMissingIndex) {
+    const NodeDef& bias_add = graph->node(matched.bias_add);
+    fused_op.add_input(bias_add.input(matched.bias_port));  // 2: bias
+    fused_ops.push_back(kBiasAdd);
+    alphas.push_back(NAN);
+    betas.push_back(NAN);
+  }
+
+  // Binary operands follow the bias, in the order of the chain.
+  for (size_t i = 0; i < matched.post_ops.size(); ++i) {
+    const auto* post_op_view = ctx->graph_view.GetNode(matched.post_ops[i]);
+    const NodeDef* post_op = post_op_view->node();
+    float alpha, beta;
+    fused_ops.push_back(GetChainPostOpName(*post_op_view, &alpha, &beta));
+    alphas.push_back(alpha);
+    betas.push_back(beta);
+    if (IsPostOpChainBinary(*post_op)) {
+      fused_op.add_input(post_op->input(1 - matched.chain_ports[i]));
+    }
+    if (IsLeakyRelu(*post_op)) {
+      AddNodeAttr("leakyrelu_alpha", post_op->attr().at("alpha"), &fused_op);
+    }
+  }
+
+  CopyAllAttrs(contraction, &fused_op);
+  std::vector<absl::string_view> fused_ops_view(fused_ops.begin(),
+                                                fused_ops.end());
+  SetFusedOpAttributes(&fused_op, fused_ops_view, fused_op.input_size() - 2);
+  AddNodeAttr("post_op_alphas", alphas, &fused_op);
+  AddNodeAttr("post_op_betas", betas, &fused_op);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_ABORT_IF_ERROR(status);
+  TF_ABORT_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.post_ops.back()] = true;
+  (*nodes_to_delete)[matched.contraction] = true;
+  if (matched.bias_add != kMissingIndex)
+    (*nodes_to_delete)[matched.bias_add] = true;
+  for (size_t i = 0; i + 1 < matched.post_ops.size(); ++i)
+    (*nodes_to_delete)[matched.post_ops[i]] = true;
+
+  return Status::OK();
+}
+
 Status AddFusedBatchNormExNode(RemapperContext* ctx,
                                const FusedBatchNormEx& matched,
                                std::vector<bool>* invalidated_nodes,
@@ -5127,8 +5662,8 @@ bool FindPadWithContractionFwdBwd(const RemapperContext& ctx, int node_index,
   if (HasControlFanin(*node_view)) return false;
 
   const auto* node_def = node_view->node();
-  bool is_ok = IsConv2D(*node_def) || node_def->op() == kFusedConv2D ||
-               IsConv3D(*node_def) || node_def->op() == kFusedConv3D;
+  bool is_ok = IsConv2D(*node_view) || node_def->op() == kFusedConv2D ||
+               IsConv3D(*node_view) || node_def->op() == kFusedConv3D;
   if (!is_ok) {
     return false;
   }
@@ -5176,11 +5711,11 @@ bool FindPadWithContractionFwdBwd(const RemapperContext& ctx, int node_index,
   const auto* node_bwd_def = node_bwd_view->node();
 
   is_ok =
-      (node_bwd_def->op() == kConv2DBackpropFilter && IsConv2D(*node_def)) ||
+      (node_bwd_def->op() == kConv2DBackpropFilter && IsConv2D(*node_view)) ||
       (node_def->op() == kFusedConv2D &&
        node_bwd_def->op() == kConv2DBackpropFilterWithBias) ||
-      (node_bwd_def->op() == kConv3DBackpropFilter && IsConv3D(*node_def)) ||
-      (node_bwd_def->op() == kConv3DBackpropFilterV2 && IsConv3D(*node_def)) ||
+      (node_bwd_def->op() == kConv3DBackpropFilter && IsConv3D(*node_view)) ||
+      (node_bwd_def->op() == kConv3DBackpropFilterV2 && IsConv3D(*node_view)) ||
       (node_bwd_def->op() == kConv3DBackpropFilterWithBias &&
        node_def->op() == kFusedConv3D);
 
@@ -6140,6 +6675,72 @@ Status AddRandomWithComparisonAndCastNode(
   return Status::OK();
 }
 
+// Random op + Comparison + cast + Mul(s)
+Status AddPackedDropoutNode(RemapperContext* ctx, const PackedDropout& matched,
+                            std::vector<bool>* invalidated_nodes,
+                            std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& random = graph->node(matched.mask.random);
+  const NodeDef& comparison = graph->node(matched.mask.comparison);
+  const NodeDef& cast = graph->node(matched.mask.cast);
+
+  ITEX_VLOG(2) << "Fuse " << cast.op()
+               << " and " + comparison.op() + " with " + random.op() + " to "
+               << kFusedRandomBitMask << ": "
+               << " cast=" << cast.name()
+               << " consumers=" << matched.muls.size();
+
+  // Replace Random, Comparison and Cast with a bit-packed mask generator.
+  NodeDef bit_mask;
+  bit_mask.set_op(kFusedRandomBitMask);
+  bit_mask.set_name(cast.name());
+  bit_mask.set_device(comparison.device());
+
+  bit_mask.add_input(random.input(0));
+  bit_mask.add_input(comparison.input(1 - matched.mask.direction));
+  auto* attrs = bit_mask.mutable_attr();
+
+  (*attrs)["T"] = random.attr().at("T");
+  (*attrs)["DstT"] = comparison.attr().at("T");
+  (*attrs)["seed"] = random.attr().at("seed");
+  (*attrs)["seed2"] = random.attr().at("seed2");
+  SetAttrValue(
+      absl::Span<const absl::string_view>{
+          {random.op(), comparison.op(), cast.op()}},
+      &(*attrs)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(bit_mask), &status);
+  TF_ABORT_IF_ERROR(status);
+
+  // Replace every Mul consumer with a dropout that reads the packed mask.
+  for (size_t i = 0; i < matched.muls.size(); ++i) {
+    const NodeDef& mul = graph->node(matched.muls[i]);
+
+    NodeDef dropout;
+    dropout.set_op(kPackedDropout);
+    dropout.set_name(mul.name());
+    dropout.set_device(mul.device());
+    dropout.add_input(mul.input(matched.data_ports[i]));
+    dropout.add_input(cast.name());
+    (*dropout.mutable_attr())["T"] = mul.attr().at("T");
+
+    mutation->AddNode(std::move(dropout), &status);
+    TF_ABORT_IF_ERROR(status);
+  }
+  TF_ABORT_IF_ERROR(mutation->Apply());
+
+  (*nodes_to_delete)[matched.mask.random] = true;
+  (*nodes_to_delete)[matched.mask.comparison] = true;
+  (*invalidated_nodes)[matched.mask.cast] = true;
+  for (int index : matched.muls) {
+    (*invalidated_nodes)[index] = true;
+  }
+
+  return Status::OK();
+}
+
 Status AddPadConvFwdBwd(RemapperContext* ctx, const PadConvFwdBwd& matched,
                         std::vector<bool>* invalidated_nodes,
                         std::vector<bool>* nodes_to_delete) {
@@ -6607,6 +7208,79 @@ Status AddFusedBinaryNode(RemapperContext* ctx, const FusedBinary& matched,
   return Status::OK();
 }
 
+// Replace an elementwise cluster with a single _ITEXFusedElementwise op.
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwise& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root_def = graph->node(matched.root_);
+
+  ITEX_VLOG(2) << "Fuse " << matched.nodes_.size() << " elementwise ops into "
+               << root_def.name();
+
+  NodeDef new_node_def;
+  new_node_def.set_op(kFusedElementwise);
+  new_node_def.set_name(root_def.name());
+  new_node_def.set_device(root_def.device());
+
+  // Values are numbered as the external inputs first, then the result of
+  // every fused op in program order.
+  std::set<int> cluster(matched.nodes_.begin(), matched.nodes_.end());
+  std::map<string, int> arg_value;
+  for (int index : matched.nodes_) {
+    const auto* node_view = ctx->graph_view.GetNode(index);
+    const NodeDef& node_def = graph->node(index);
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      if (cluster.count(node_view->GetRegularFanin(i).node_index())) continue;
+      const string& input = node_def.input(i);
+      if (arg_value.count(input)) continue;
+      arg_value.emplace(input, new_node_def.input_size());
+      new_node_def.add_input(input);
+    }
+  }
+
+  const int num_args = new_node_def.input_size();
+  std::map<int, int> node_value;
+  std::vector<string> fused_ops;
+  std::vector<int> operands;
+  for (size_t k = 0; k < matched.nodes_.size(); ++k) {
+    const int index = matched.nodes_[k];
+    const auto* node_view = ctx->graph_view.GetNode(index);
+    const NodeDef& node_def = graph->node(index);
+    fused_ops.push_back(node_def.op());
+    for (int i = 0; i < 2; ++i) {
+      if (i >= node_view->NumRegularFanins()) {
+        operands.push_back(-1);
+        continue;
+      }
+      const int fanin_index = node_view->GetRegularFanin(i).node_index();
+      operands.push_back(cluster.count(fanin_index)
+                             ? node_value.at(fanin_index)
+                             : arg_value.at(node_def.input(i)));
+    }
+    node_value[index] = num_args + k;
+  }
+
+  auto* attr = new_node_def.mutable_attr();
+  SetAttrValue(ElementwiseOutputType(root_def), &(*attr)["T"]);
+  AddNodeAttr("num_args", num_args, &new_node_def);
+  AddNodeAttr("fused_ops", fused_ops, &new_node_def);
+  AddNodeAttr("operands", operands, &new_node_def);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(new_node_def), &status);
+  TF_ABORT_IF_ERROR(status);
+  TF_ABORT_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.root_] = true;
+  for (int index : matched.nodes_) {
+    if (index != matched.root_) (*nodes_to_delete)[index] = true;
+  }
+  return Status::OK();
+}
+
 // Remap TF2.11 dropout select to TF2.10 cast+mul.
 Status AddDropout(RemapperContext* ctx, const Dropout& matched,
                   std::vector<bool>* invalidated_nodes,
@@ -6857,6 +7531,142 @@ Status AddDilatedContractionNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+// Graphs with fewer nodes are matched faster than a thread pool is created.
+constexpr int kMinNodesForParallelMatch = 4096;
+
+// Max number of edges between the root and another node of the patterns of
+// the Find* matchers, reached by the clusters of FindFusedElementwise.
+constexpr int kMaxFindPatternDepth = 16;
+
+// Returns true if one of the Find* matchers of the RunRemapper loop matches
+// node `index`. They only read the graph, so PatternMatchCache runs this on
+// all nodes in parallel. The level and LayoutOPT conditions are left to the
+// loop, so this may return true for a pattern the loop then ignores.
+bool FindAnyPattern(RemapperContext* ctx, int index, bool is_full) {
+  const RemapperContext& cctx = *ctx;
+
+  int AddN_index;
+  Dropout dropout;
+  std::map<string, int> matched_nodes_map;
+  std::set<int> remove_node_indices;
+  bool is_gelu_approximate = false;
+  MulWithMaximum mul_with_maximum;
+  MatmulReshapeBiasadd matmul_reshape_biasadd;
+  DilatedContraction dilated_contraction;
+  ReplaceableSum sum;
+  ContractionWithReshapeAndBiasAddGrad contraction_reshape_bias_grad;
+  KerasDenseLayerFwd keras_dense_layer_fwd;
+  if (FindAddV2(cctx, index, &AddN_index) ||
+      FindDropout(cctx, index, &dropout) ||
+      FindGelu(ctx, index, &matched_nodes_map, &remove_node_indices,
+               &is_gelu_approximate) ||
+      FindMulWithMaximum(cctx, index, &mul_with_maximum) ||
+      FindMatmulReshapeBiasadd(cctx, index, &matmul_reshape_biasadd) ||
+      FindDilatedContraction(cctx, index, &dilated_contraction) ||
+      FindSum(cctx, index, &sum) ||
+      FindContractionWithReshapeAndBiasAddGrad(
+          cctx, index, &contraction_reshape_bias_grad) ||
+      FindKerasDenseLayerFwd(cctx, index, &keras_dense_layer_fwd)) {
+    return true;
+  }
+
+  if (!is_full) {
+    ConvBackpropInputWithSlice conv_with_slice;
+    PadConvFwdBwd pad_conv_fwd_bwd;
+    return FindConv2DBackpropInputWithSliceLLGA(cctx, index,
+                                                &conv_with_slice) ||
+           FindPadConvFwdBwd(cctx, index, &pad_conv_fwd_bwd);
+  }
+
+  ContractionWithBiasAndActivationAdd contract_with_bias_and_activation_add;
+  GroupConv2DBlock group_conv;
+  ContractionWithBiasAndAddActivation contract_with_bias_and_add_activation;
+  ContractionWithBiasAddAndAdd contract_with_bias_and_add;
+  ContractionWithBiasAdd contract_with_bias;
+  ContractionWithBiasAddGrad contract_with_bias_grad;
+  ContractionWithBiasAddGrad conv_contract_with_bias_grad;
+  ContractionWithBiasAddAndActivation contract_with_bias_and_activation;
+  ContractionWithBatchNormAndAddV2AndActivation
+      contract_with_batch_norm_and_addv2_and_activation;
+  ContractionWithBatchNormAndActivation contract_with_batch_norm_and_activation;
+  ContractionWithBatchNorm contract_with_batch_norm;
+  FusedBatchNormEx fused_batch_norm_ex;
+  FusedBatchNormGradEx fused_batch_norm_grad_ex;
+  PadWithTransposeConv pad_with_transpose_conv;
+  PadWithContractionFwdBwd pad_with_contract_fwd_bwd;
+  PadWithContraction pad_with_contract;
+  ConvBackpropInputWithSlice conv_with_slice;
+  FusedTrainingOp fused_training_op;
+  ContractionWithMul contract_with_mul;
+  ContractionWithPostOps contract_with_post_ops;
+  DequantizeWithShape dequantize_with_shape;
+  DequantizeWithReshape dequantize_with_reshape;
+  QuantizeV2WithQuantizedConv2D quantizev2_with_quantizedconv;
+  QuantizedConv2DWithDequantize conv2d_with_dequantize;
+  QuantizedConv2DWithCast conv2d_with_cast;
+  FusedAddN fused_addn;
+  AddV2WithSoftmax fused_addv2_with_softmax;
+  Bf16ContractionWithCastFp32 contraction_with_cast;
+  PackedDropout packed_dropout;
+  RandomWithComparisonAndCast random_with_compare_and_cast;
+  Bf16ContractionGradWithCastFp32 contraction_grad_with_cast;
+  ComparisonWithCast comparison_with_cast;
+  ConstWithCast const_with_cast;
+  FusedElementwise fused_elementwise;
+  FusedBinary seq_binary;
+  StridedSliceGrad strided_slice_grad;
+  return FindContractionWithBiasAndActivationAdd(
+             cctx, index, &contract_with_bias_and_activation_add) ||
+         FindResNeXtGroupConv2DBlock(cctx, index, &group_conv) ||
+         FindContractionWithBiasAndAddActivation(
+             cctx, index, &contract_with_bias_and_add_activation) ||
+         FindContractionWithBiasAddAndAdd(cctx, index,
+                                          &contract_with_bias_and_add) ||
+         FindContractionWithBias(cctx, index, &contract_with_bias) ||
+         FindContractionWithBiasAddGrad(cctx, index,
+                                        &contract_with_bias_grad) ||
+         FindConvContractionWithBiasAddGrad(cctx, index,
+                                            &conv_contract_with_bias_grad) ||
+         FindContractionWithBiasAndActivation(
+             cctx, index, &contract_with_bias_and_activation) ||
+         FindConv2DWithBatchNormAndAddV2AndActivation(
+             cctx, index, &contract_with_batch_norm_and_addv2_and_activation) ||
+         FindConv2DWithBatchNormAndActivation(
+             cctx, index, &contract_with_batch_norm_and_activation) ||
+         FindConv2DWithBatchNorm(cctx, index, &contract_with_batch_norm) ||
+         FindFusedBatchNormEx(cctx, index, &fused_batch_norm_ex) ||
+         FindFusedBatchNormGradEx(cctx, index, &fused_batch_norm_grad_ex) ||
+         FindPadWithTransposeConv(cctx, index, &pad_with_transpose_conv) ||
+         FindPadWithContractionFwdBwd(cctx, index,
+                                      &pad_with_contract_fwd_bwd) ||
+         FindPadWithContraction(cctx, index, &pad_with_contract) ||
+         FindConvBackpropInputWithSlice(cctx, index, &conv_with_slice) ||
+         FindFusedTrainingOp(cctx, index, &fused_training_op) ||
+         FindContractionWithMul(cctx, index, &contract_with_mul) ||
+         FindContractionWithPostOps(cctx, index, &contract_with_post_ops) ||
+         FindDequantizeWithShape(cctx, index, &dequantize_with_shape) ||
+         FindDequantizeWithReshape(cctx, index, &dequantize_with_reshape) ||
+         FindQuantizeV2WithQuantizedConv2D(cctx, index,
+                                           &quantizev2_with_quantizedconv) ||
+         FindQuantizedConv2DWithDequantize(cctx, index,
+                                           &conv2d_with_dequantize) ||
+         FindQuantizedConv2DWithCast(cctx, index, &conv2d_with_cast) ||
+         FindFusedAddN(cctx, index, &fused_addn) ||
+         FindAddV2WithSoftmax(cctx, index, &fused_addv2_with_softmax) ||
+         FindBf16ContractionWithCastFp32(cctx, index,
+                                         &contraction_with_cast) ||
+         FindPackedDropout(cctx, index, &packed_dropout) ||
+         FindRandomWithComparisonAndCast(cctx, index,
+                                         &random_with_compare_and_cast) ||
+         FindBf16ContractionGradWithCastFp32(cctx, index,
+                                             &contraction_grad_with_cast) ||
+         FindComparisonWithCast(cctx, index, &comparison_with_cast) ||
+         FindConstWithCast(cctx, index, &const_with_cast) ||
+         FindFusedElementwise(cctx, index, &fused_elementwise) ||
+         FindFusedBinary(cctx, index, &seq_binary) ||
+         FindStridedSliceGrad(cctx, index, &strided_slice_grad);
+}
+
 }  // namespace
 
 // `is_full` is true by default. It will be set as false if this pass runs
@@ -6873,7 +7683,7 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
 
   Status status;
   GraphDef multable_graph_def = graph_def;
-  RemapperContext ctx(item, &multable_graph_def, &status, level);
+  RemapperContext ctx(opt_ctx, item, &multable_graph_def, &status, level);
   // TODO(itex): Currently some fusions will be disabled when LayoutOPT is off,
   //       remove this dependency once all plain fusions are supported.
   bool is_layout_opt = GetOptimizerConfigFlags().enable_layout_opt;
@@ -6905,11 +7715,42 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
   // Infer statically first and only once.
   ctx.GetGraphProperties();
 
+  // Match registered fusions of large graphs on all cores in advance.
+  std::unique_ptr<PatternMatchCache> match_cache;
+  bool parallel_match = true;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("ITEX_REMAPPER_PARALLEL_MATCH",
+                                        true, &parallel_match));
+  if (parallel_match && num_nodes >= kMinNodesForParallelMatch &&
+      port::MaxParallelism() > 1) {
+    match_cache = std::make_unique<PatternMatchCache>(
+        &ctx, is_full, port::MaxParallelism(),
+        [&ctx, is_full](int index) {
+          return FindAnyPattern(&ctx, index, is_full);
+        },
+        kMaxFindPatternDepth);
+  }
+  bool verify_match_cache = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("ITEX_REMAPPER_VERIFY_MATCH_CACHE",
+                                        false, &verify_match_cache));
+  int num_mutations = ctx.graph_view.num_mutations();
+  int last_root = num_nodes - 1;
+  // Drops the cached matches around `last_root` if it was fused.
+  auto invalidate_match_cache = [&]() {
+    if (match_cache && num_mutations != ctx.graph_view.num_mutations()) {
+      match_cache->Invalidate(&ctx, last_root);
+      num_mutations = ctx.graph_view.num_mutations();
+    }
+  };
+
   bool is_visited = false;
   string last_op;
   for (int i = num_nodes - 1; i >= 0;) {
     NodeDef* node_def = (ctx.graph_view.GetNode(i))->node();
 
+    // The previous iteration may have fused nodes around `last_root`.
+    invalidate_match_cache();
+    last_root = i;
+
     // IMPORTANT: Always keep this dynamic check in the start.
     // Dynamic check node status:
     //   1. Do normal fusion check when current node is visited first time
@@ -6935,8 +7776,8 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
     }
 
     // Check if node is fp16 and supported on device.
-    if (NodeIsOnCpu(node_def) &&
-        GetDataTypeFromAttr(*node_def, "T") == DT_HALF &&
+    const auto* node_view = ctx.graph_view.GetNode(i);
+    if (node_view->GetDataType() == DT_HALF && NodeIsOnCpu(*node_view) &&
         !port::HasCpuFP16Support()) {
       ctx.nodes_to_preserve.insert(node_def->name());
       continue;
@@ -6961,9 +7802,13 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
       continue;
     }
 
+    if (match_cache && verify_match_cache) {
+      TF_RETURN_IF_ERROR(match_cache->Verify(&ctx, i, is_full));
+    }
+
     // Put the fusions that always need to be enabled here no matter `is_full`
     // is true or false.
-    {
+    if (!match_cache || match_cache->MayFind(i)) {
       // Use AddV2 for AddN when N=2
       int AddN_index;
       if (FindAddV2(ctx, i, &AddN_index)) {
@@ -7060,7 +7905,14 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
 
     // The entry of pattern matcher. It will iterate all fusion registered.
     TF_ABORT_IF_ERROR(LaunchPatternMatcher(&ctx, i, &invalidated_nodes,
-                                           &nodes_to_delete, is_full));
+                                           &nodes_to_delete, is_full,
+                                           match_cache.get()));
+
+    // None of the Find* matchers below matches unless the node was fused.
+    invalidate_match_cache();
+    if (match_cache && !match_cache->MayFind(i)) {
+      continue;
+    }
 
     if (is_full) {
       // Remap Conv2D+BiasAdd+Activation+Add into the _ITEXFusedConv2D.
@@ -7237,6 +8089,17 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
         continue;
       }
 
+      // Remap MatMul+(BiasAdd)+{eltwise,Binary}* into the _ITEXFusedMatMul.
+      // The fixed patterns above are tried first, since they are also
+      // supported by the blocked layout kernels.
+      ContractionWithPostOps contract_with_post_ops;
+      if (FindContractionWithPostOps(ctx, i, &contract_with_post_ops)) {
+        TF_ABORT_IF_ERROR(AddFusedContractionNode(&ctx, contract_with_post_ops,
+                                                  &invalidated_nodes,
+                                                  &nodes_to_delete));
+        continue;
+      }
+
       // delete dequantize node if it finds dequantize_with_shape pattern
       DequantizeWithShape dequantize_with_shape;
       if (level == RemapperLevel::BASIC &&
@@ -7309,6 +8172,15 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
         continue;
       }
 
+      // Remap dropout Random+Comparison+Cast+Mul into bit-packed mask ops.
+      PackedDropout packed_dropout;
+      if (level == RemapperLevel::BASIC &&
+          FindPackedDropout(ctx, i, &packed_dropout)) {
+        TF_ABORT_IF_ERROR(AddPackedDropoutNode(
+            &ctx, packed_dropout, &invalidated_nodes, &nodes_to_delete));
+        continue;
+      }
+
       // Remap Random Comparison+Cast into the RandomWithComparisonAndCast.
       RandomWithComparisonAndCast random_with_compare_and_cast;
       if (level == RemapperLevel::BASIC &&
@@ -7349,6 +8221,16 @@ Status RunRemapper(OptimizerContext* opt_ctx, const GrapplerItem& item,
         continue;
       }
 
+      // Remap elementwise clusters on CPU into the _ITEXFusedElementwise op.
+      // It's disabled in the 1st remapper for the same reason as below.
+      FusedElementwise fused_elementwise;
+      if (level != RemapperLevel::BASIC &&
+          FindFusedElementwise(ctx, i, &fused_elementwise)) {
+        TF_ABORT_IF_ERROR(AddFusedElementwiseNode(
+            &ctx, fused_elementwise, &invalidated_nodes, &nodes_to_delete));
+        continue;
+      }
+
       // Remap sequatial Binary ops into the _ITEXFusedBinary op.
       // Disable it in 1st remapper since it may break other high priority
       // fusions.
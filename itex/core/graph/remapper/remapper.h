@@ -42,31 +42,36 @@ namespace graph {
 enum RemapperLevel : int { BASIC = 0, ADVANCED };
 
 struct RemapperContext {
-  explicit RemapperContext(const GrapplerItem& item, GraphDef* g_def,
-                           Status* status, RemapperLevel level)
+  explicit RemapperContext(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                           GraphDef* g_def, Status* status, RemapperLevel level)
       : nodes_to_preserve(item.NodesToPreserve()),
         graph_view(g_def, status),
-        graph_properties(item),
+        graph_properties(GetSharedGraphProperties(opt_ctx, item)),
         inferred_graph_properties(false),
         remap_level(level) {}
 
   std::unordered_set<string> nodes_to_preserve;
   utils::MutableGraphView graph_view;
-  GraphProperties graph_properties;
+  GraphProperties& graph_properties;
   bool inferred_graph_properties;
   RemapperLevel remap_level;
 
   GraphProperties& GetGraphProperties() {
     if (!inferred_graph_properties) {
-      Status s = graph_properties.InferStatically(
-          /*assume_valid_feeds=*/true,
-          /*aggressive_shape_inference=*/false,
-          /*include_input_tensor_values=*/true,
-          /*include_output_tensor_values=*/true);
-
-      // TODO(itex) Is there any case that InferStatically will return an
-      // unsuccessful state?
-      TF_ABORT_IF_ERROR(s);
+      if (!graph_properties.IsInferred()) {
+        Status s = graph_properties.InferStatically(
+            /*assume_valid_feeds=*/true,
+            /*aggressive_shape_inference=*/false,
+            /*include_input_tensor_values=*/true,
+            /*include_output_tensor_values=*/true);
+
+        // TODO(itex) Is there any case that InferStatically will return an
+        // unsuccessful state?
+        TF_ABORT_IF_ERROR(s);
+      }
+      // The properties are shared with earlier passes, so only catch up with
+      // the nodes they rewrote instead of inferring the whole graph again.
+      graph_properties.Refresh(*graph_view.graph());
       inferred_graph_properties = true;
     }
 
@@ -126,6 +131,9 @@ inline bool HasAtMostOneFanoutAtPort0(const utils::MutableNodeView& node_view) {
 bool HasDataType(const NodeDef* node, const DataType& expected,
                  const string& type_attr = "T");
 
+// Same as above for attribute "T", read from the attribute cache of the view.
+bool HasDataType(const utils::MutableNodeView* node, const DataType& expected);
+
 void SetFusedOpAttributes(NodeDef* fused,
                           const absl::Span<const absl::string_view> fused_ops,
                           int num_args);
@@ -0,0 +1,395 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/segment_fusion/segment_fusion.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "itex/core/graph/utils/op_types.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/node_def_util.h"
+
+namespace itex {
+namespace graph {
+
+using utils::MutableNodeView;
+
+namespace {
+
+constexpr char kSegmentExecutor[] = "_ITEXSegmentExecutor";
+
+// Large enough for the MLP layers of recommendation models at serving batch
+// sizes, small enough that oneDNN would not win on the op alone.
+constexpr int64 kDefaultMaxElements = 65536;
+constexpr size_t kMaxSegmentOps = 64;
+// Segments with fewer ops, not counting Reshape and Identity, save too little
+// dispatch cost to give up the oneDNN kernels.
+constexpr int kMinSegmentOps = 2;
+
+bool IsInPreserveSet(const SegmentFusionContext& ctx, const NodeDef* node) {
+  return ctx.nodes_to_preserve.count(node->name()) > 0;
+}
+
+// Ops run by the CPU kernel of _ITEXSegmentExecutor. Must be kept in sync with
+// its `kSegmentOps`.
+bool IsSegmentOp(const NodeDef& node) {
+  static const std::set<string> ops = {
+      "Add",
+      "AddV2",
+      "BiasAdd",
+      "ConcatV2",
+      "Exp",
+      "Identity",
+      "MatMul",
+      "Maximum",
+      "Minimum",
+      "Mul",
+      "Neg",
+      "Relu",
+      "Relu6",
+      "Reshape",
+      "Sigmoid",
+      "Square",
+      "Sub",
+      "Tanh"};
+  return ops.count(node.op()) > 0;
+}
+
+bool IsView(const NodeDef& node) { return IsReshape(node) || IsIdentity(node); }
+
+// Number of leading regular inputs read by the kernel. The shape of Reshape
+// and the axis of ConcatV2 are encoded in attributes instead.
+int NumDataInputs(const MutableNodeView& node_view) {
+  const NodeDef* node = node_view.node();
+  if (IsReshape(*node)) return 1;
+  if (IsConcatV2(*node)) return node_view.NumRegularFanins() - 1;
+  return node_view.NumRegularFanins();
+}
+
+bool GetStaticShape(const OpInfo_TensorProperties& props,
+                    std::vector<int64>* dims) {
+  const TensorShapeProto& shape = props.shape();
+  if (shape.unknown_rank()) return false;
+  dims->clear();
+  for (const auto& dim : shape.dim()) {
+    if (dim.size() < 0) return false;
+    dims->push_back(dim.size());
+  }
+  return true;
+}
+
+// Reads the axis of a ConcatV2 from its constant input, normalized to
+// [0, rank).
+bool GetConcatAxis(const MutableNodeView& node_view, int rank, int64* axis) {
+  const auto& axis_fanin =
+      node_view.GetRegularFanin(node_view.NumRegularFanins() - 1);
+  const NodeDef* axis_node = axis_fanin.node_view()->node();
+  Tensor axis_tensor;
+  if (!IsAnyConst(*axis_node) ||
+      !GetTensorFromConstant(axis_node, &axis_tensor).ok() ||
+      axis_tensor.NumElements() != 1) {
+    return false;
+  }
+  *axis = axis_tensor.dtype() == DT_INT64 ? axis_tensor.flat<int64>()(0)
+                                          : axis_tensor.flat<int32>()(0);
+  if (*axis < 0) *axis += rank;
+  return *axis >= 0 && *axis < rank;
+}
+
+// Returns true if the kernel can run the node: a supported float op on CPU
+// whose inputs and result have static shapes, and whose result is small.
+bool IsSegmentable(const SegmentFusionContext& ctx,
+                   const MutableNodeView& node_view) {
+  const NodeDef* node = node_view.node();
+  if (!IsSegmentOp(*node) || !NodeIsOnCpu(node) ||
+      GetDataTypeFromAttr(*node, "T") != DT_FLOAT) {
+    return false;
+  }
+  if (IsBiasAdd(*node) && HasNodeAttr(*node, "data_format") &&
+      node->attr().at("data_format").s() != "NHWC") {
+    return false;
+  }
+
+  std::vector<OpInfo_TensorProperties> props;
+  std::vector<int64> dims;
+  if (!ctx.graph_properties.GetOutputProperties(node->name(), &props).ok() ||
+      props.size() != 1 || !GetStaticShape(props[0], &dims)) {
+    return false;
+  }
+  int64 num_elements = 1;
+  for (int64 dim : dims) num_elements *= dim;
+  if (num_elements == 0 || num_elements > ctx.max_elements) return false;
+
+  int64 axis;
+  if (IsConcatV2(*node) && !GetConcatAxis(node_view, dims.size(), &axis)) {
+    return false;
+  }
+
+  if (!ctx.graph_properties.GetInputProperties(node->name(), &props).ok() ||
+      static_cast<int>(props.size()) < NumDataInputs(node_view)) {
+    return false;
+  }
+  for (int i = 0; i < NumDataInputs(node_view); ++i) {
+    if (!GetStaticShape(props[i], &dims)) return false;
+  }
+  return true;
+}
+
+void AppendShape(const std::vector<int64>& dims, std::vector<int64>* encoded) {
+  encoded->push_back(dims.size());
+  encoded->insert(encoded->end(), dims.begin(), dims.end());
+}
+
+}  // namespace
+
+bool FindSegment(const SegmentFusionContext& ctx, int node_index,
+                 const std::vector<bool>& claimed, Segment* segment) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (claimed[node_index] || !IsSegmentable(ctx, *node_view)) return false;
+
+  // Grow the segment until no more producers can be absorbed. A producer is
+  // absorbed only once all of its consumers are in the segment, so that only
+  // the root's result leaves it.
+  std::set<int> cluster = {node_index};
+  bool changed = true;
+  while (changed && cluster.size() < kMaxSegmentOps) {
+    changed = false;
+    const std::vector<int> members(cluster.begin(), cluster.end());
+    for (int member : members) {
+      if (cluster.size() >= kMaxSegmentOps) break;
+      const auto* member_view = ctx.graph_view.GetNode(member);
+      for (int i = 0; i < NumDataInputs(*member_view); ++i) {
+        const auto& regular_fanin = member_view->GetRegularFanin(i);
+        const int fanin_index = regular_fanin.node_index();
+        if (cluster.count(fanin_index) || claimed[fanin_index] ||
+            regular_fanin.index() != 0) {
+          continue;
+        }
+
+        const auto* fanin_view = regular_fanin.node_view();
+        const auto* fanin_def = fanin_view->node();
+        if (fanin_def->device() != node_def->device() ||
+            fanin_view->NumControllingFanins() > 0 ||
+            fanin_view->NumControlledFanouts() > 0 ||
+            IsInPreserveSet(ctx, fanin_def) ||
+            !IsSegmentable(ctx, *fanin_view)) {
+          continue;
+        }
+
+        bool all_consumers_fused = true;
+        for (const auto& fanout : fanin_view->GetRegularFanout(0)) {
+          if (!cluster.count(fanout.node_index())) all_consumers_fused = false;
+        }
+        if (!all_consumers_fused) continue;
+
+        cluster.insert(fanin_index);
+        changed = true;
+        if (cluster.size() >= kMaxSegmentOps) break;
+      }
+    }
+  }
+
+  int num_ops = 0;
+  for (int member : cluster) {
+    if (!IsView(*ctx.graph_view.GetNode(member)->node())) ++num_ops;
+  }
+  if (num_ops < kMinSegmentOps) return false;
+
+  // The graph was sorted topologically before any rewrite, and rewritten
+  // roots keep their index, so indices give a topological order.
+  segment->nodes.assign(cluster.begin(), cluster.end());
+  return true;
+}
+
+Status AddSegmentExecutorNode(SegmentFusionContext* ctx,
+                              const Segment& segment) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const int root = segment.nodes.back();
+  const NodeDef& root_def = graph->node(root);
+
+  ITEX_VLOG(2) << "Batch " << segment.nodes.size() << " ops into "
+               << root_def.name();
+
+  NodeDef new_node_def;
+  new_node_def.set_op(kSegmentExecutor);
+  new_node_def.set_name(root_def.name());
+  new_node_def.set_device(root_def.device());
+
+  // Values are numbered as the external inputs first, then the result of
+  // every op in segment order.
+  std::set<int> members(segment.nodes.begin(), segment.nodes.end());
+  std::map<string, int> arg_value;
+  std::vector<int64> input_shapes;
+  std::vector<OpInfo_TensorProperties> props;
+  std::vector<int64> dims;
+  for (int index : segment.nodes) {
+    const auto* node_view = ctx->graph_view.GetNode(index);
+    const NodeDef& node_def = graph->node(index);
+    TF_RETURN_IF_ERROR(
+        ctx->graph_properties.GetInputProperties(node_def.name(), &props));
+    for (int i = 0; i < NumDataInputs(*node_view); ++i) {
+      if (members.count(node_view->GetRegularFanin(i).node_index())) continue;
+      const string& input = node_def.input(i);
+      if (arg_value.count(input)) continue;
+      arg_value.emplace(input, new_node_def.input_size());
+      new_node_def.add_input(input);
+      GetStaticShape(props[i], &dims);
+      AppendShape(dims, &input_shapes);
+    }
+  }
+
+  const int num_args = new_node_def.input_size();
+  std::map<int, int> node_value;
+  std::vector<string> segment_ops;
+  std::vector<int64> operands, params, shapes;
+  for (size_t k = 0; k < segment.nodes.size(); ++k) {
+    const int index = segment.nodes[k];
+    const auto* node_view = ctx->graph_view.GetNode(index);
+    const NodeDef& node_def = graph->node(index);
+    segment_ops.push_back(node_def.op());
+
+    operands.push_back(NumDataInputs(*node_view));
+    for (int i = 0; i < NumDataInputs(*node_view); ++i) {
+      const int fanin_index = node_view->GetRegularFanin(i).node_index();
+      operands.push_back(members.count(fanin_index)
+                             ? node_value.at(fanin_index)
+                             : arg_value.at(node_def.input(i)));
+    }
+    node_value[index] = num_args + k;
+
+    TF_RETURN_IF_ERROR(
+        ctx->graph_properties.GetOutputProperties(node_def.name(), &props));
+    GetStaticShape(props[0], &dims);
+    AppendShape(dims, &shapes);
+
+    int64 param = 0;
+    if (IsMatMul(node_def)) {
+      bool transpose_a = false, transpose_b = false;
+      TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "transpose_a", &transpose_a));
+      TF_RETURN_IF_ERROR(GetNodeAttr(node_def, "transpose_b", &transpose_b));
+      param = (transpose_a ? 1 : 0) | (transpose_b ? 2 : 0);
+    } else if (IsConcatV2(node_def)) {
+      GetConcatAxis(*node_view, dims.size(), &param);
+    }
+    params.push_back(param);
+  }
+
+  // The root keeps its control dependencies.
+  for (const string& input : root_def.input()) {
+    if (IsControlInput(input)) new_node_def.add_input(input);
+  }
+
+  AddNodeAttr("T", DT_FLOAT, &new_node_def);
+  AddNodeAttr("N", num_args, &new_node_def);
+  AddNodeAttr("segment_ops", segment_ops, &new_node_def);
+  AddNodeAttr("operands", operands, &new_node_def);
+  AddNodeAttr("params", params, &new_node_def);
+  AddNodeAttr("shapes", shapes, &new_node_def);
+  AddNodeAttr("input_shapes", input_shapes, &new_node_def);
+
+  for (int index : segment.nodes) {
+    const auto* node_view = ctx->graph_view.GetNode(index);
+    for (int i = NumDataInputs(*node_view); i < node_view->NumRegularFanins();
+         ++i) {
+      ctx->nodes_to_delete_if_unused.push_back(
+          node_view->GetRegularFanin(i).node_index());
+    }
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(new_node_def), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  for (int index : segment.nodes) {
+    if (index != root) ctx->nodes_to_delete[index] = true;
+  }
+  return Status::OK();
+}
+
+Status RunSegmentFusion(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                        const GraphDef& graph_def, GraphDef* optimized_graph) {
+  Status status;
+  GraphDef mutable_graph_def = graph_def;
+  SegmentFusionContext ctx(opt_ctx, item, &mutable_graph_def, &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("ITEX_SEGMENT_MAX_ELEMENTS",
+                                         kDefaultMaxElements,
+                                         &ctx.max_elements));
+
+  TF_RETURN_IF_ERROR(
+      ctx.graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
+  if (!ctx.graph_properties.IsInferred()) {
+    TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/true));
+  }
+  ctx.graph_properties.Refresh(mutable_graph_def);
+
+  // Grow segments from the sinks, so that each one covers as much of its DAG
+  // as possible.
+  const int num_nodes = ctx.graph_view.NumNodes();
+  ctx.nodes_to_delete.assign(num_nodes, false);
+  std::vector<bool> claimed(num_nodes, false);
+  int num_segments = 0;
+  for (int i = num_nodes - 1; i >= 0; --i) {
+    Segment segment;
+    if (!FindSegment(ctx, i, claimed, &segment)) continue;
+    TF_RETURN_IF_ERROR(AddSegmentExecutorNode(&ctx, segment));
+    for (int index : segment.nodes) claimed[index] = true;
+    ++num_segments;
+  }
+  ITEX_VLOG(1) << "SegmentFusion: created " << num_segments << " segments.";
+
+  for (int index : ctx.nodes_to_delete_if_unused) {
+    const auto* node_view = ctx.graph_view.GetNode(index);
+    if (ctx.nodes_to_delete[index] || !IsAnyConst(*node_view->node()) ||
+        node_view->NumControllingFanins() > 0 ||
+        node_view->NumControlledFanouts() > 0 ||
+        IsInPreserveSet(ctx, node_view->node())) {
+      continue;
+    }
+    bool used = false;
+    for (const auto& fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : fanouts) {
+        if (!ctx.nodes_to_delete[fanout.node_index()]) used = true;
+      }
+    }
+    if (!used) ctx.nodes_to_delete[index] = true;
+  }
+
+  utils::Mutation* mutation = ctx.graph_view.GetMutationBuilder();
+  for (int i = 0; i < num_nodes; ++i) {
+    if (ctx.nodes_to_delete[i]) {
+      mutation->RemoveNode(ctx.graph_view.GetNode(i));
+    }
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  *optimized_graph = std::move(mutable_graph_def);
+  return Status::OK();
+}
+
+}  // namespace graph
+}  // namespace itex
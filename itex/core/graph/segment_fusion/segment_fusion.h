@@ -0,0 +1,78 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_SEGMENT_FUSION_SEGMENT_FUSION_H_
+#define ITEX_CORE_GRAPH_SEGMENT_FUSION_SEGMENT_FUSION_H_
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "itex/core/graph/utils/graph_properties.h"
+#include "itex/core/graph/utils/graph_view.h"
+#include "itex/core/graph/utils/grappler_item.h"
+#include "itex/core/graph/utils/utils.h"
+#include "protos/graph.pb.h"
+
+namespace itex {
+namespace graph {
+
+struct SegmentFusionContext {
+  explicit SegmentFusionContext(OptimizerContext* opt_ctx,
+                                const GrapplerItem& item, GraphDef* g_def,
+                                Status* status)
+      : graph_view(g_def, status),
+        nodes_to_preserve(item.NodesToPreserve()),
+        graph_properties(GetSharedGraphProperties(opt_ctx, item)) {}
+
+  utils::MutableGraphView graph_view;
+  std::unordered_set<string> nodes_to_preserve;
+  GraphProperties& graph_properties;
+  // Ops with larger results are left to the oneDNN kernels.
+  int64 max_elements = 0;
+  // Nodes replaced by a segment, removed at the end of the pass.
+  std::vector<bool> nodes_to_delete;
+  // Constant shapes and axes read by segments, removed at the end of the pass
+  // if nothing else reads them.
+  std::vector<int> nodes_to_delete_if_unused;
+};
+
+// A DAG of ops in topological order, so that `nodes.back()` is the root whose
+// result leaves the segment.
+struct Segment {
+  std::vector<int> nodes;
+};
+
+// Grows a segment from the CPU op at `node_index` by absorbing producers whose
+// consumers are all in the segment. Nodes in `claimed` belong to other
+// segments. Returns false if the segment is too small to be worth it.
+bool FindSegment(const SegmentFusionContext& ctx, int node_index,
+                 const std::vector<bool>& claimed, Segment* segment);
+
+// Replaces the segment with an _ITEXSegmentExecutor named after its root.
+Status AddSegmentExecutorNode(SegmentFusionContext* ctx,
+                              const Segment& segment);
+
+// Batches chains and DAGs of small CPU ops with static shapes into
+// _ITEXSegmentExecutor, enabled by ITEX_SEGMENT_FUSION. On small graphs, e.g.
+// the MLPs of recommendation models served with small batches, the executor
+// and kernel dispatch cost of every op is larger than its compute.
+Status RunSegmentFusion(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                        const GraphDef& graph_def, GraphDef* optimized_graph);
+
+}  // namespace graph
+}  // namespace itex
+
+#endif  // ITEX_CORE_GRAPH_SEGMENT_FUSION_SEGMENT_FUSION_H_
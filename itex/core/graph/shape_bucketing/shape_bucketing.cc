@@ -0,0 +1,391 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/shape_bucketing/shape_bucketing.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "itex/core/graph/utils/op_types.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/node_def_util.h"
+#include "itex/core/utils/numbers.h"
+#include "itex/core/utils/str_util.h"
+#include "itex/core/utils/strcat.h"
+
+namespace itex {
+namespace graph {
+
+using utils::MutableNodeView;
+
+namespace {
+
+constexpr char kBucketPad[] = "_ITEXBucketPad";
+constexpr char kBucketSlice[] = "_ITEXBucketSlice";
+constexpr char kFusedBatchMatMulV2[] = "_ITEXFusedBatchMatMulV2";
+constexpr char kFusedMatMul[] = "_ITEXFusedMatMul";
+constexpr char kAttention[] = "ScaledDotProductAttentionInference";
+
+// Common sequence lengths of NLP models. Every bucket costs one set of
+// primitives per op, while the gaps between buckets cost padded compute.
+constexpr char kDefaultBuckets[] = "64,128,256,384,512";
+
+bool IsInPreserveSet(const ShapeBucketingContext& ctx, const NodeDef* node) {
+  return ctx.nodes_to_preserve.count(node->name()) > 0;
+}
+
+bool IsBucketedMatMul(const NodeDef& node) {
+  return IsMatMul(node) || node.op() == kFusedMatMul;
+}
+
+bool IsBucketedBatchMatMul(const NodeDef& node) {
+  return IsAnyBatchMatMul(node) || node.op() == kFusedBatchMatMulV2;
+}
+
+bool IsBucketedLayerNorm(const NodeDef& node) {
+  static const std::set<string> ops = {"ITEXLayerNorm", "LayerNorm",
+                                       "_MklLayerNorm"};
+  return ops.count(node.op()) > 0;
+}
+
+bool IsAttention(const NodeDef& node) { return node.op() == kAttention; }
+
+// Returns the dimensions of a tensor of known rank. Dynamic ones are negative:
+// -1 if unknown, otherwise a symbolic id shared by dimensions known to be
+// equal.
+bool GetDims(const OpInfo_TensorProperties& props, std::vector<int64>* dims) {
+  const TensorShapeProto& shape = props.shape();
+  if (shape.unknown_rank()) return false;
+  dims->clear();
+  for (const auto& dim : shape.dim()) dims->push_back(dim.size());
+  return true;
+}
+
+// Pads the axes of a fused operand that broadcast along padded axes of the
+// output. An operand with a static size along such an axis cannot follow the
+// padding, while an axis of size 1 is broadcast and kept as it is.
+bool PlanBroadcastInput(const OpInfo_TensorProperties& props, int input,
+                        int rank, BucketPlan* plan) {
+  std::vector<int64> dims;
+  if (!GetDims(props, &dims) || static_cast<int>(dims.size()) > rank) {
+    return false;
+  }
+  BucketPlan::PadInput pad{input};
+  const int offset = rank - dims.size();
+  for (const auto& slice : plan->slices) {
+    const int axis = slice.axis - offset;
+    if (axis < 0 || dims[axis] == 1) continue;
+    if (dims[axis] >= 0) return false;
+    pad.axes.push_back(axis);
+  }
+  if (!pad.axes.empty()) plan->pads.push_back(std::move(pad));
+  return true;
+}
+
+// Zero padding of the rows of `a` or the columns of `b` only adds rows or
+// columns to the output, and zero padding of the contracted dimension on both
+// sides adds nothing to it. Batch dimensions are never padded, since they may
+// broadcast.
+bool PlanMatMul(const NodeDef& node,
+                const std::vector<OpInfo_TensorProperties>& props,
+                BucketPlan* plan) {
+  const bool is_batch = IsBucketedBatchMatMul(node);
+  bool transpose_a = false, transpose_b = false;
+  if (!GetNodeAttr(node, is_batch ? "adj_x" : "transpose_a", &transpose_a)
+           .ok() ||
+      !GetNodeAttr(node, is_batch ? "adj_y" : "transpose_b", &transpose_b)
+           .ok()) {
+    return false;
+  }
+
+  std::vector<int64> a, b;
+  if (props.size() < 2 || !GetDims(props[0], &a) || !GetDims(props[1], &b)) {
+    return false;
+  }
+  const int rank_a = a.size();
+  const int rank_b = b.size();
+  if (rank_a < 2 || rank_b < 2 || (!is_batch && (rank_a != 2 || rank_b != 2))) {
+    return false;
+  }
+
+  const int m_axis = transpose_a ? rank_a - 1 : rank_a - 2;
+  const int k_axis_a = transpose_a ? rank_a - 2 : rank_a - 1;
+  const int k_axis_b = transpose_b ? rank_b - 1 : rank_b - 2;
+  const int n_axis = transpose_b ? rank_b - 2 : rank_b - 1;
+  const int rank = std::max(rank_a, rank_b);
+
+  BucketPlan::PadInput pad_a{0}, pad_b{1};
+  if (a[m_axis] < 0) {
+    pad_a.axes.push_back(m_axis);
+    plan->slices.push_back({rank - 2, 0, m_axis});
+  }
+  if (a[k_axis_a] < 0 && b[k_axis_b] < 0) {
+    pad_a.axes.push_back(k_axis_a);
+    pad_b.axes.push_back(k_axis_b);
+  }
+  if (b[n_axis] < 0) {
+    pad_b.axes.push_back(n_axis);
+    plan->slices.push_back({rank - 1, 1, n_axis});
+  }
+  if (!pad_a.axes.empty()) plan->pads.push_back(std::move(pad_a));
+  if (!pad_b.axes.empty()) plan->pads.push_back(std::move(pad_b));
+
+  // Fused operands, e.g. the bias or the attention mask added to the output.
+  for (size_t i = 2; i < props.size(); ++i) {
+    if (!PlanBroadcastInput(props[i], i, rank, plan)) return false;
+  }
+  return !plan->pads.empty();
+}
+
+// Rows are normalized independently, so padded rows are simply dropped. Only
+// the axis next to the normalized one is padded, i.e. the sequence of
+// [batch, seq_len, hidden] or the tokens of [tokens, hidden], so that a small
+// batch is not padded to a bucket as well. The mean and variance outputs are
+// not sliced, so they must be unused.
+bool PlanLayerNorm(const ShapeBucketingContext& ctx,
+                   const MutableNodeView& node_view,
+                   const std::vector<OpInfo_TensorProperties>& props,
+                   BucketPlan* plan) {
+  const NodeDef* node = node_view.node();
+  if (HasNodeAttr(*node, "data_format") &&
+      node->attr().at("data_format").s() != "NHWC") {
+    return false;
+  }
+  if (IsInPreserveSet(ctx, node)) return false;
+  for (int port = 1; port < 3; ++port) {
+    if (!node_view.GetRegularFanout(port).empty()) return false;
+  }
+
+  std::vector<int64> dims;
+  if (props.empty() || !GetDims(props[0], &dims) || dims.size() < 2) {
+    return false;
+  }
+  const int64 axis = dims.size() - 2;
+  if (dims[axis] >= 0) return false;
+  plan->pads.push_back({0, {axis}});
+  plan->slices.push_back({axis, 0, axis});
+  return true;
+}
+
+// Padded queries only add rows to the output. Padded keys and values are
+// masked out by padding the additive mask with the lowest value, so they need
+// a mask. The causal mask is aligned to the last key, so padding would move
+// it.
+bool PlanAttention(const NodeDef& node,
+                   const std::vector<OpInfo_TensorProperties>& props,
+                   BucketPlan* plan) {
+  bool use_mask = false, use_causal = false;
+  if (!GetNodeAttr(node, "use_mask", &use_mask).ok() ||
+      !GetNodeAttr(node, "use_causal", &use_causal).ok() || use_causal) {
+    return false;
+  }
+
+  std::vector<int64> query, key, value, mask;
+  if (props.size() < 4 || !GetDims(props[0], &query) ||
+      !GetDims(props[1], &key) || !GetDims(props[2], &value) ||
+      query.size() != 4 || key.size() != 4 || value.size() != 4) {
+    return false;
+  }
+  if (use_mask && (!GetDims(props[3], &mask) || mask.size() != 4)) {
+    return false;
+  }
+
+  BucketPlan::PadInput pad_mask{3, {}, "lowest"};
+  // Query [batch, heads, q_seq_len, head_size], output
+  // [batch, q_seq_len, heads, head_size]. The mask has a row per query unless
+  // it broadcasts along them.
+  bool pad_queries = query[2] < 0;
+  if (pad_queries && use_mask) {
+    if (mask[2] < 0) {
+      pad_mask.axes.push_back(2);
+    } else if (mask[2] != 1) {
+      pad_queries = false;
+    }
+  }
+  if (pad_queries) {
+    plan->pads.push_back({0, {2}});
+    plan->slices.push_back({1, 0, 2});
+  }
+
+  // Key and value [batch, heads, k_seq_len, head_size], mask
+  // [batch, heads, q_seq_len, k_seq_len]. A mask broadcasting along the keys
+  // has a k_seq_len of 1, which the pad keeps, leaving padded keys unmasked.
+  // So the mask must have the same symbolic k_seq_len as the keys.
+  if (use_mask && key[2] < -1 && value[2] < 0 && mask[3] == key[2]) {
+    plan->pads.push_back({1, {2}});
+    plan->pads.push_back({2, {2}});
+    pad_mask.axes.push_back(3);
+  }
+  if (!pad_mask.axes.empty()) plan->pads.push_back(std::move(pad_mask));
+  return !plan->pads.empty();
+}
+
+Status ReadBuckets(std::vector<int64>* buckets) {
+  string value;
+  TF_RETURN_IF_ERROR(
+      ReadStringFromEnvVar("ITEX_SHAPE_BUCKETS", kDefaultBuckets, &value));
+  buckets->clear();
+  for (const string& field : str_util::Split(value, ',')) {
+    int64 bucket;
+    if (!strings::safe_strto64(field, &bucket) || bucket <= 0) {
+      return errors::InvalidArgument(
+          "ITEX_SHAPE_BUCKETS must be a list of positive sizes, got \"", value,
+          "\"");
+    }
+    buckets->push_back(bucket);
+  }
+  if (buckets->empty()) {
+    return errors::InvalidArgument("ITEX_SHAPE_BUCKETS must not be empty");
+  }
+  std::sort(buckets->begin(), buckets->end());
+  buckets->erase(std::unique(buckets->begin(), buckets->end()),
+                 buckets->end());
+  return Status::OK();
+}
+
+}  // namespace
+
+bool PlanBucketing(const ShapeBucketingContext& ctx, int node_index,
+                   BucketPlan* plan) {
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const NodeDef* node = node_view->node();
+  const bool is_matmul =
+      IsBucketedMatMul(*node) || IsBucketedBatchMatMul(*node);
+  if ((!is_matmul && !IsBucketedLayerNorm(*node) && !IsAttention(*node)) ||
+      !NodeIsOnCpu(node)) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node, "T");
+  if (dtype != DT_FLOAT && dtype != DT_BFLOAT16 && dtype != DT_HALF) {
+    return false;
+  }
+
+  std::vector<OpInfo_TensorProperties> props;
+  if (!ctx.graph_properties.GetInputProperties(node->name(), &props).ok()) {
+    return false;
+  }
+  if (is_matmul) return PlanMatMul(*node, props, plan);
+  if (IsAttention(*node)) return PlanAttention(*node, props, plan);
+  return PlanLayerNorm(ctx, *node_view, props, plan);
+}
+
+Status AddBucketNodes(ShapeBucketingContext* ctx, int node_index,
+                      const BucketPlan& plan) {
+  const NodeDef& node_def = ctx->graph_view.graph()->node(node_index);
+  const string name = node_def.name();
+  const DataType dtype = GetDataTypeFromAttr(node_def, "T");
+
+  // Without sliced axes the output keeps its shape, e.g. when only the
+  // contracted dimension is padded, and the op keeps its name.
+  NodeDef bucketed_def = node_def;
+  if (!plan.slices.empty()) {
+    bucketed_def.set_name(strings::StrCat(name, "/bucketed"));
+  }
+  std::vector<NodeDef> new_nodes;
+  for (const auto& pad : plan.pads) {
+    NodeDef pad_def;
+    pad_def.set_op(kBucketPad);
+    pad_def.set_name(strings::StrCat(name, "/bucket_pad_", pad.input));
+    pad_def.set_device(node_def.device());
+    pad_def.add_input(node_def.input(pad.input));
+    AddNodeAttr("T", dtype, &pad_def);
+    AddNodeAttr("axes", pad.axes, &pad_def);
+    AddNodeAttr("buckets", ctx->buckets, &pad_def);
+    AddNodeAttr("padding", pad.padding, &pad_def);
+    bucketed_def.set_input(pad.input, pad_def.name());
+    new_nodes.push_back(std::move(pad_def));
+  }
+  for (const NodeDef& new_node : new_nodes) {
+    if (ctx->graph_view.GetNode(new_node.name()) != nullptr) {
+      return Status::OK();
+    }
+  }
+  if (!plan.slices.empty() &&
+      ctx->graph_view.GetNode(bucketed_def.name()) != nullptr) {
+    return Status::OK();
+  }
+
+  ITEX_VLOG(2) << "Pad " << plan.pads.size() << " inputs of " << name
+               << " to shape buckets";
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  if (!plan.slices.empty()) {
+    NodeDef slice_def;
+    slice_def.set_op(kBucketSlice);
+    slice_def.set_name(name);
+    slice_def.set_device(node_def.device());
+    slice_def.add_input(bucketed_def.name());
+    std::vector<int64> axes, like_axes;
+    for (const auto& slice : plan.slices) {
+      slice_def.add_input(node_def.input(slice.like_input));
+      axes.push_back(slice.axis);
+      like_axes.push_back(slice.like_axis);
+    }
+    AddNodeAttr("T", dtype, &slice_def);
+    AddNodeAttr("N", static_cast<int>(plan.slices.size()), &slice_def);
+    AddNodeAttr("axes", axes, &slice_def);
+    AddNodeAttr("like_axes", like_axes, &slice_def);
+    // Replaces the op in place, so that its consumers read the slice.
+    mutation->AddNode(std::move(slice_def), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  mutation->AddNode(std::move(bucketed_def), &status);
+  TF_RETURN_IF_ERROR(status);
+  for (NodeDef& new_node : new_nodes) {
+    mutation->AddNode(std::move(new_node), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  return mutation->Apply();
+}
+
+Status RunShapeBucketing(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                         const GraphDef& graph_def, GraphDef* optimized_graph) {
+  Status status;
+  GraphDef mutable_graph_def = graph_def;
+  ShapeBucketingContext ctx(opt_ctx, item, &mutable_graph_def, &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(ReadBuckets(&ctx.buckets));
+
+  if (!ctx.graph_properties.IsInferred()) {
+    TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/true));
+  }
+  ctx.graph_properties.Refresh(mutable_graph_def);
+
+  // New nodes are appended to the graph, so only the original ones are
+  // visited.
+  const int num_nodes = ctx.graph_view.NumNodes();
+  int num_bucketed = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    BucketPlan plan;
+    if (!PlanBucketing(ctx, i, &plan)) continue;
+    TF_RETURN_IF_ERROR(AddBucketNodes(&ctx, i, plan));
+    ++num_bucketed;
+  }
+  ITEX_VLOG(1) << "ShapeBucketing: padded the inputs of " << num_bucketed
+               << " ops.";
+
+  *optimized_graph = std::move(mutable_graph_def);
+  return Status::OK();
+}
+
+}  // namespace graph
+}  // namespace itex
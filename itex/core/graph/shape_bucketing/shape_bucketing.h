@@ -0,0 +1,89 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_SHAPE_BUCKETING_SHAPE_BUCKETING_H_
+#define ITEX_CORE_GRAPH_SHAPE_BUCKETING_SHAPE_BUCKETING_H_
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "itex/core/graph/utils/graph_properties.h"
+#include "itex/core/graph/utils/graph_view.h"
+#include "itex/core/graph/utils/grappler_item.h"
+#include "itex/core/graph/utils/utils.h"
+#include "protos/graph.pb.h"
+
+namespace itex {
+namespace graph {
+
+struct ShapeBucketingContext {
+  explicit ShapeBucketingContext(OptimizerContext* opt_ctx,
+                                 const GrapplerItem& item, GraphDef* g_def,
+                                 Status* status)
+      : graph_view(g_def, status),
+        nodes_to_preserve(item.NodesToPreserve()),
+        graph_properties(GetSharedGraphProperties(opt_ctx, item)) {}
+
+  utils::MutableGraphView graph_view;
+  std::unordered_set<string> nodes_to_preserve;
+  GraphProperties& graph_properties;
+  // Sorted sizes that dynamic dimensions are padded to.
+  std::vector<int64> buckets;
+};
+
+// How an op is rewritten to read bucket-padded inputs.
+struct BucketPlan {
+  // Input `input` is padded along `axes`, with zeros or with the lowest value
+  // of its type.
+  struct PadInput {
+    int input;
+    std::vector<int64> axes;
+    string padding = "zero";
+  };
+  // Axis `axis` of the output is sliced back to the size of axis `like_axis`
+  // of the unpadded input `like_input`.
+  struct SliceAxis {
+    int64 axis;
+    int like_input;
+    int64 like_axis;
+  };
+  std::vector<PadInput> pads;
+  std::vector<SliceAxis> slices;
+};
+
+// Plans the padding of the dynamic dimensions of a CPU MatMul, BatchMatMul,
+// LayerNorm or ScaledDotProductAttentionInference, such that slicing the
+// output gives the result of the unpadded op. Returns false if there is
+// nothing to pad or the op cannot be padded exactly.
+bool PlanBucketing(const ShapeBucketingContext& ctx, int node_index,
+                   BucketPlan* plan);
+
+// Feeds the op from _ITEXBucketPad nodes and renames it, so that the
+// _ITEXBucketSlice of its output takes over its name and consumers.
+Status AddBucketNodes(ShapeBucketingContext* ctx, int node_index,
+                      const BucketPlan& plan);
+
+// Pads dynamic dimensions, e.g. the sequence length of NLP models served with
+// inputs of any length, up to one of ITEX_SHAPE_BUCKETS, enabled by
+// ITEX_SHAPE_BUCKETING. Kernels then see a few distinct shapes and reuse their
+// oneDNN primitives and FMHA tuning instead of creating them for every length.
+Status RunShapeBucketing(OptimizerContext* opt_ctx, const GrapplerItem& item,
+                         const GraphDef& graph_def, GraphDef* optimized_graph);
+
+}  // namespace graph
+}  // namespace itex
+
+#endif  // ITEX_CORE_GRAPH_SHAPE_BUCKETING_SHAPE_BUCKETING_H_
@@ -18,6 +18,7 @@ limitations under the License.
 #include "itex/core/graph/tfg_optimizer_hook/tfg_optimizer_hook.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -36,8 +37,11 @@ limitations under the License.
 #include "itex/core/ir/importexport/graphdef_import.h"
 #include "itex/core/ir/ops.h"
 #include "itex/core/ir/tf_op_registry.h"
+#include "itex/core/utils/cpu_info.h"
 #include "itex/core/utils/env_var.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/numa.h"
+#include "itex/core/utils/threadpool.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
@@ -53,6 +57,8 @@ limitations under the License.
 #include "mlir/Transforms/LocationSnapshot.h"  // from @llvm-project
 #include "protos/graph_debug_info.pb.h"
 #include "protos/versions.pb.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "xpuautoshard/common/device_profile.h"
 #include "xpuautoshard/common/mlir/dialect.h"
 #include "xpuautoshard/tensorflow/interface_mlir.h"
 
@@ -92,6 +98,48 @@ struct AutoShardContext {
     return graph_properties;
   }
 };
+
+// Kernels timed by the calibration of the CPU device profile. They run the
+// Eigen contractions of the CPU MatMul and Conv2D kernels on `device`.
+as::CalibrationKernels EigenCalibrationKernels(
+    const Eigen::ThreadPoolDevice* device) {
+  using Matrix = Eigen::Tensor<float, 2, Eigen::RowMajor>;
+  using Image = Eigen::Tensor<float, 4, Eigen::RowMajor>;
+  using Index = Eigen::Index;
+  const Eigen::array<Eigen::IndexPair<Index>, 1> contract_dims = {
+      Eigen::IndexPair<Index>(1, 0)};
+  as::CalibrationKernels kernels;
+  kernels.matmul = [device, contract_dims](size_t n) {
+    auto a = std::make_shared<Matrix>(n, n);
+    auto b = std::make_shared<Matrix>(n, n);
+    auto c = std::make_shared<Matrix>(n, n);
+    a->setConstant(1.0f);
+    b->setConstant(0.5f);
+    return std::function<void()>(
+        [=]() { c->device(*device) = a->contract(*b, contract_dims); });
+  };
+  kernels.conv = [device, contract_dims](size_t hw, size_t channels) {
+    constexpr Index kKernel = 3;
+    Index out_hw = hw - kKernel + 1;
+    Index patch_size = kKernel * kKernel * static_cast<Index>(channels);
+    Eigen::array<Index, 2> patches_shape = {out_hw * out_hw, patch_size};
+    auto input = std::make_shared<Image>(1, hw, hw, channels);
+    auto filter = std::make_shared<Matrix>(patch_size, channels);
+    auto output = std::make_shared<Matrix>(out_hw * out_hw, channels);
+    input->setConstant(1.0f);
+    filter->setConstant(0.5f);
+    // Im2col followed by a GEMM, like the Eigen spatial convolution.
+    return std::function<void()>([=]() {
+      output->device(*device) =
+          input
+              ->extract_image_patches(kKernel, kKernel, 1, 1, 1, 1,
+                                      Eigen::PADDING_VALID)
+              .reshape(patches_shape)
+              .contract(*filter, contract_dims);
+    });
+  };
+  return kernels;
+}
 }  // namespace graph
 }  // namespace itex
 
@@ -209,6 +257,7 @@ Status RunAutoShard(itex::graph::OptimizerContext* opt_ctx,
     itex::int64 itex_gpu_bs = -1;
     itex::int64 itex_cpu_steps = 1;
     itex::int64 itex_gpu_steps = 1;
+    bool itex_cpu_numa = false;
 
     auto configs = itex::itex_get_config().graph_options().sharding_config();
     if (configs.auto_mode())
@@ -228,6 +277,8 @@ Status RunAutoShard(itex::graph::OptimizerContext* opt_ctx,
       ITEX_CHECK_OK(itex::ReadInt64FromEnvVar("ITEX_SHARDING_GPU_STAGE_NUM", 1,
                                               &itex_gpu_steps));
     }
+    ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_SHARDING_CPU_NUMA", false,
+                                           &itex_cpu_numa));
 
     for (auto cfg : configs.devices()) {
       if (absl::AsciiStrToLower(cfg.device_type().c_str()) == "gpu") {
@@ -247,22 +298,79 @@ Status RunAutoShard(itex::graph::OptimizerContext* opt_ctx,
     ITEX_VLOG(1) << "AutoShard pass, itex_num_gpus: " << itex_num_gpus;
     ITEX_VLOG(1) << "AutoShard pass, itex_cpu_bs: " << itex_cpu_bs;
     ITEX_VLOG(1) << "AutoShard pass, itex_gpu_bs: " << itex_gpu_bs;
+    // With NUMA sharding, CPU shard i is pinned to NUMA node i % #nodes, and
+    // shards beyond the node count share the cores of their node. The
+    // mapping matches the CPU devices TF creates when the session sets
+    // `device_count["CPU"]` and `experimental.use_numa_affinity`: CPU:i gets
+    // node-local intra-op threads and allocator of node i % #nodes.
+    const int num_numa_nodes = itex::port::NUMANumNodes();
+    if (itex_cpu_numa && itex_num_cpus == 0) itex_num_cpus = num_numa_nodes;
     ITEX_VLOG(1) << "AutoShard pass, itex_cpu_steps: " << itex_cpu_steps;
+    ITEX_VLOG(1) << "AutoShard pass, itex_cpu_numa: " << itex_cpu_numa
+                 << ", numa nodes: " << num_numa_nodes;
     ITEX_VLOG(1) << "AutoShard pass, itex_gpu_steps: " << itex_gpu_steps;
 
     float gpu_score = itex_gpu_bs * itex_gpu_steps;
     float cpu_score = itex_cpu_bs * itex_cpu_steps;
 
+    // Measured device profiles replace the configured scores when every
+    // sharded device type has one. ITEX_SHARDING_CALIBRATE measures the CPU
+    // and stores the result in ITEX_SHARDING_DEVICE_PROFILE for later runs.
+    // XPUs are not calibrated, their profile must be supplied in the file.
+    std::string profile_path;
+    bool calibrate = false;
+    ITEX_CHECK_OK(itex::ReadStringFromEnvVar("ITEX_SHARDING_DEVICE_PROFILE",
+                                             "", &profile_path));
+    ITEX_CHECK_OK(
+        itex::ReadBoolFromEnvVar("ITEX_SHARDING_CALIBRATE", false, &calibrate));
+    as::DeviceProfileMap profiles;
+    if (!profile_path.empty() &&
+        !as::loadDeviceProfiles(profile_path, &profiles)) {
+      ITEX_LOG(WARNING) << "Failed to load device profiles from "
+                        << profile_path;
+    }
+    if (calibrate && itex_num_cpus > 0 && !profiles["CPU"].isCalibrated()) {
+      // Each CPU shard gets its share of the cores.
+      size_t num_threads =
+          std::max<itex::int64>(1, itex::port::NumSchedulableCPUs() /
+                                       itex_num_cpus);
+      itex::thread::ThreadPool pool(itex::Env::Default(),
+                                    "itex_sharding_calibration", num_threads);
+      Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), num_threads);
+      profiles["CPU"] = as::calibrateCpuProfile(
+          itex::graph::EigenCalibrationKernels(&device), num_threads);
+      ITEX_LOG(INFO) << "Calibrated CPU device profile with " << num_threads
+                     << " threads";
+      if (!profile_path.empty() &&
+          !as::saveDeviceProfiles(profile_path, profiles)) {
+        ITEX_LOG(WARNING) << "Failed to save device profiles to "
+                          << profile_path;
+      }
+    }
+    if (calibrate && itex_num_gpus > 0 && !profiles["XPU"].isCalibrated()) {
+      ITEX_LOG(WARNING) << "Only the CPU is calibrated, supply the XPU "
+                        << "profile in ITEX_SHARDING_DEVICE_PROFILE to use "
+                        << "measured device profiles";
+    }
+    bool use_profiles =
+        (itex_num_gpus == 0 || profiles["XPU"].isCalibrated()) &&
+        (itex_num_cpus == 0 || profiles["CPU"].isCalibrated());
+    ITEX_VLOG(1) << "AutoShard pass, use measured device profiles: "
+                 << use_profiles;
+
     as::DeviceInfo device_info(/*add_cpu_host=*/false);
     for (int i = 0; i < itex_num_gpus; i++) {
       as::Device gpu(i + 1, "XPU:" + std::to_string(i), gpu_score);
       gpu.setNumStages(itex_gpu_steps);
+      if (use_profiles) gpu.setProfile(profiles["XPU"]);
       device_info.addDevice(gpu);
     }
     for (int i = 0; i < itex_num_cpus; i++) {
       as::Device cpu(i + itex_num_gpus + 1, "CPU:" + std::to_string(i),
                      cpu_score);
       cpu.setNumStages(itex_cpu_steps);
+      if (itex_cpu_numa) cpu.setNumaNode(i % num_numa_nodes);
+      if (use_profiles) cpu.setProfile(profiles["CPU"]);
       device_info.addDevice(cpu);
     }
 
@@ -274,6 +382,10 @@ Status RunAutoShard(itex::graph::OptimizerContext* opt_ctx,
     config.getHeuristicsConfig().setMultiStageEnabled((itex_gpu_steps != 1) ||
                                                       (itex_cpu_steps != 1));
     config.setNeedDeadNodePrune(model_prune);
+    itex::int64 tuning_threads = 0;
+    ITEX_CHECK_OK(itex::ReadInt64FromEnvVar("ITEX_SHARDING_TUNING_THREADS", 0,
+                                            &tuning_threads));
+    config.setTuningNumThreads(std::max<itex::int64>(0, tuning_threads));
     as::tensorflow::auto_sharding_pass_mlir(impl->GetContext(), &module, config,
                                             device_info,
                                             &(ctx.graph_properties));
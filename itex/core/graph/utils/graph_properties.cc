@@ -15,13 +15,216 @@ limitations under the License.
 
 #include "itex/core/graph/utils/graph_properties.h"
 
+#include <unordered_set>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/function.h"
+#include "itex/core/utils/node_def_util.h"
+#include "itex/core/utils/strcat.h"
+#include "itex/core/utils/tensor_id.h"
 #include "itex/core/utils/tf_buffer.h"
 #include "protos/op_performance_data.pb.h"
 
 namespace itex {
 namespace graph {
 
+namespace {
+// ITEX ops whose shape function is `unchanged_shape_fn`, so output 0 has the
+// shape and dtype of input 0. Checked against the registered shape functions
+// by test/tensorflow/python/grappler/graph_properties_test.py.
+const std::unordered_set<string>& UnchangedShapeOps() {
+  static const std::unordered_set<string> ops = {
+      "Gelu",        "ITEXGelu",   "_ITEXElu",          "_ITEXLeakyRelu",
+      "_ITEXMish",   "_ITEXSwish", "_ITEXPackedDropout", "_ITEXSoftmax"};
+  return ops;
+}
+
+string NodeSignature(const NodeDef& node) {
+  return strings::StrCat(node.op(), "(", absl::StrJoin(node.input(), ","),
+                         ")");
+}
+
+absl::string_view SignatureOp(absl::string_view signature) {
+  return signature.substr(0, signature.find('('));
+}
+
+// Outputs of `node` as far as its op def tells: the dtypes, with unknown
+// shapes.
+Status OutputsFromOpDef(const NodeDef& node,
+                        std::vector<OpInfo_TensorProperties>* outputs) {
+  static FunctionLibraryDefinition function_lib =
+      FunctionLibraryDefinition(GraphDef());
+  OpDef op_def;
+  TF_RETURN_IF_ERROR(function_lib.LookUpOpDef(node.op(), &op_def));
+  DataTypeVector types;
+  TF_RETURN_IF_ERROR(OutputTypesForNode(node, op_def, &types));
+  outputs->resize(types.size());
+  for (size_t i = 0; i < types.size(); ++i) {
+    (*outputs)[i].set_dtype(types[i]);
+    (*outputs)[i].mutable_shape()->set_unknown_rank(true);
+  }
+  return Status::OK();
+}
+
+bool SameDtypes(const std::vector<OpInfo_TensorProperties>& a,
+                const std::vector<OpInfo_TensorProperties>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].dtype() != b[i].dtype()) return false;
+  }
+  return true;
+}
+
+// Returns true iff `a` and `b` have the same shapes, and the same values where
+// both are known. Dtypes are only compared if `compare_dtypes`.
+bool SameProperties(const std::vector<OpInfo_TensorProperties>& a,
+                    const std::vector<OpInfo_TensorProperties>& b,
+                    bool compare_dtypes) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (compare_dtypes && a[i].dtype() != b[i].dtype()) return false;
+    if (a[i].shape().SerializeAsString() != b[i].shape().SerializeAsString())
+      return false;
+    if (a[i].has_value() && b[i].has_value() &&
+        a[i].value().SerializeAsString() != b[i].value().SerializeAsString())
+      return false;
+  }
+  return true;
+}
+
+void DropShapes(std::vector<OpInfo_TensorProperties>* props) {
+  for (auto& prop : *props) {
+    prop.clear_shape();
+    prop.mutable_shape()->set_unknown_rank(true);
+    prop.clear_value();
+  }
+}
+
+bool GetIntValues(const OpInfo_TensorProperties& prop,
+                  std::vector<int64>* values) {
+  Tensor tensor;
+  if (!prop.has_value() || !tensor.FromProto(prop.value())) return false;
+  values->clear();
+  for (int64 i = 0; i < tensor.NumElements(); ++i) {
+    if (tensor.dtype() == DT_INT32) {
+      values->push_back(tensor.flat<int32>()(i));
+    } else if (tensor.dtype() == DT_INT64) {
+      values->push_back(tensor.flat<int64>()(i));
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Infers the outputs of the few ops whose shape function is simple enough to
+// be replayed here, from their inputs (null if unknown). Returns false for
+// every other op.
+bool InferOutputs(const NodeDef& node,
+                  const std::vector<OpInfo_TensorProperties>* inputs,
+                  std::vector<OpInfo_TensorProperties>* outputs) {
+  if (node.op() == "Const") {
+    auto it = node.attr().find("value");
+    if (it == node.attr().end()) return false;
+    const TensorProto& value = it->second.tensor();
+    outputs->resize(1);
+    (*outputs)[0].set_dtype(value.dtype());
+    *(*outputs)[0].mutable_shape() = value.tensor_shape();
+    *(*outputs)[0].mutable_value() = value;
+    return true;
+  }
+  if (inputs == nullptr || inputs->empty()) return false;
+  const OpInfo_TensorProperties& x = (*inputs)[0];
+
+  if (UnchangedShapeOps().count(node.op()) || node.op() == "Identity") {
+    *outputs = {x};
+    return true;
+  }
+  if (node.op() == "Cast") {
+    DataType dtype;
+    if (!GetNodeAttr(node, "DstT", &dtype).ok()) return false;
+    *outputs = {x};
+    (*outputs)[0].set_dtype(dtype);
+    (*outputs)[0].clear_value();
+    return true;
+  }
+
+  std::vector<int64> values;
+  if (node.op() == "Transpose") {
+    if (inputs->size() != 2 || x.shape().unknown_rank() ||
+        !GetIntValues((*inputs)[1], &values) ||
+        static_cast<int>(values.size()) != x.shape().dim_size())
+      return false;
+    outputs->assign(1, OpInfo_TensorProperties());
+    (*outputs)[0].set_dtype(x.dtype());
+    for (int64 d : values) {
+      if (d < 0 || d >= x.shape().dim_size()) return false;
+      *(*outputs)[0].mutable_shape()->add_dim() = x.shape().dim(d);
+    }
+    return true;
+  }
+  if (node.op() == "Split") {
+    // Split(axis, value).
+    int64 num_split = 0;
+    if (inputs->size() != 2 || (*inputs)[1].shape().unknown_rank() ||
+        !GetIntValues(x, &values) || values.size() != 1 ||
+        !GetNodeAttr(node, "num_split", &num_split).ok() || num_split <= 0)
+      return false;
+    const TensorShapeProto& shape = (*inputs)[1].shape();
+    const int64 rank = shape.dim_size();
+    const int64 axis = values[0] < 0 ? values[0] + rank : values[0];
+    if (axis < 0 || axis >= rank) return false;
+    OpInfo_TensorProperties output;
+    output.set_dtype((*inputs)[1].dtype());
+    *output.mutable_shape() = shape;
+    const int64 size = shape.dim(axis).size();
+    output.mutable_shape()->mutable_dim(axis)->set_size(
+        size < 0 ? -1 : size / num_split);
+    outputs->assign(num_split, output);
+    return true;
+  }
+  return false;
+}
+
+// Order in which Refresh() visits the nodes of `graph_def`: fanins before
+// fanouts, then the nodes of cycles in graph order.
+std::vector<int> FaninsFirstOrder(const GraphDef& graph_def) {
+  const int num_nodes = graph_def.node_size();
+  absl::flat_hash_map<absl::string_view, int> indices;
+  indices.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    indices.emplace(graph_def.node(i).name(), i);
+  }
+  std::vector<std::vector<int>> fanouts(num_nodes);
+  std::vector<int> num_fanins(num_nodes, 0);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const string& input : graph_def.node(i).input()) {
+      auto it = indices.find(ParseTensorName(input).node());
+      if (it == indices.end()) continue;
+      fanouts[it->second].push_back(i);
+      ++num_fanins[i];
+    }
+  }
+
+  std::vector<int> order;
+  order.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    if (num_fanins[i] == 0) order.push_back(i);
+  }
+  for (size_t head = 0; head < order.size(); ++head) {
+    for (int fanout : fanouts[order[head]]) {
+      if (--num_fanins[fanout] == 0) order.push_back(fanout);
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    if (num_fanins[i] > 0) order.push_back(i);
+  }
+  return order;
+}
+}  // namespace
+
 GraphProperties::GraphProperties(const GrapplerItem& item) {
   graph_prop_ = TF_NewGraphProperties(item.GetTfGrapplerItem());
 }
@@ -39,6 +242,12 @@ Status GraphProperties::InferStatically(bool assume_valid_feeds,
                      tf_status);
   Status status = StatusFromTF_Status(tf_status);
   TF_DeleteStatus(tf_status);
+  if (status.ok()) {
+    inferred_ = true;
+    mutex_lock lock(&mu_);
+    input_props_.clear();
+    output_props_.clear();
+  }
   return status;
 }
 
@@ -76,20 +285,158 @@ static Status GetProperties(TF_GraphProperties* graph_prop,
   return status;
 }
 
+Status GraphProperties::GetCachedProperties(
+    const string& node_name, bool is_input,
+    std::vector<OpInfo_TensorProperties>* props) const {
+  auto* cache = is_input ? &input_props_ : &output_props_;
+  {
+    mutex_lock lock(&mu_);
+    auto it = cache->find(node_name);
+    if (it != cache->end()) {
+      *props = it->second;
+      return Status::OK();
+    }
+  }
+
+  TF_RETURN_IF_ERROR(
+      is_input ? GetProperties(graph_prop_, node_name, props,
+                               TF_GetInputPropertiesListSize,
+                               TF_GetInputPropertiesList)
+               : GetProperties(graph_prop_, node_name, props,
+                               TF_GetOutputPropertiesListSize,
+                               TF_GetOutputPropertiesList));
+  mutex_lock lock(&mu_);
+  cache->emplace(node_name, *props);
+  return Status::OK();
+}
+
 Status GraphProperties::GetInputProperties(
     const string& node_name,
     std::vector<OpInfo_TensorProperties>* input_props) const {
-  return GetProperties(graph_prop_, node_name, input_props,
-                       TF_GetInputPropertiesListSize,
-                       TF_GetInputPropertiesList);
+  return GetCachedProperties(node_name, /*is_input=*/true, input_props);
 }
 
 Status GraphProperties::GetOutputProperties(
     const string& node_name,
     std::vector<OpInfo_TensorProperties>* output_props) const {
-  return GetProperties(graph_prop_, node_name, output_props,
-                       TF_GetOutputPropertiesListSize,
-                       TF_GetOutputPropertiesList);
+  return GetCachedProperties(node_name, /*is_input=*/false, output_props);
+}
+
+void GraphProperties::SetBaseGraph(const GraphDef& graph_def) {
+  node_signatures_.clear();
+  node_signatures_.reserve(graph_def.node_size());
+  for (const NodeDef& node : graph_def.node()) {
+    node_signatures_.emplace(node.name(), NodeSignature(node));
+  }
+}
+
+bool GraphProperties::UpdateNode(const NodeDef& node, bool op_changed,
+                                 bool* outputs_changed) {
+  *outputs_changed = false;
+  std::vector<OpInfo_TensorProperties> inputs;
+  bool inputs_known = true;
+  for (const string& input : node.input()) {
+    if (IsControlInput(input)) break;
+    const TensorId tensor = ParseTensorName(input);
+    std::vector<OpInfo_TensorProperties> fanin_outputs;
+    if (!GetOutputProperties(string(tensor.node()), &fanin_outputs).ok() ||
+        tensor.index() < 0 ||
+        tensor.index() >= static_cast<int>(fanin_outputs.size())) {
+      // Unknown fanin, keep whatever TF reports for this name.
+      inputs_known = false;
+      break;
+    }
+    inputs.push_back(fanin_outputs[tensor.index()]);
+  }
+
+  std::vector<OpInfo_TensorProperties> outputs, old_outputs;
+  const bool has_old_outputs =
+      GetOutputProperties(node.name(), &old_outputs).ok();
+  bool update_outputs = false;
+  if (InferOutputs(node, inputs_known ? &inputs : nullptr, &outputs)) {
+    update_outputs = true;
+  } else if (op_changed) {
+    // The name now belongs to another op. Its old outputs are only kept if
+    // they still match in number and dtypes, as for a fusion named after the
+    // last node of its pattern; otherwise, e.g. for _ITEXFusedRandomBitMask
+    // taking over the name of a Cast, only the op def is known.
+    if (OutputsFromOpDef(node, &outputs).ok()) {
+      update_outputs = !has_old_outputs || !SameDtypes(outputs, old_outputs);
+    }
+  } else {
+    // Same op on other inputs, e.g. a Split fed by a permuted tensor. Its old
+    // outputs only hold while the input shapes do; if just the dtypes
+    // changed, as after auto mixed precision, the op def gives the new ones.
+    std::vector<OpInfo_TensorProperties> old_inputs;
+    const bool same_shapes =
+        inputs_known && GetInputProperties(node.name(), &old_inputs).ok() &&
+        SameProperties(inputs, old_inputs, /*compare_dtypes=*/false);
+    if (!OutputsFromOpDef(node, &outputs).ok()) {
+      outputs = old_outputs;
+      if (!same_shapes) DropShapes(&outputs);
+    } else if (same_shapes && has_old_outputs &&
+               outputs.size() == old_outputs.size()) {
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        const DataType dtype = outputs[i].dtype();
+        outputs[i] = old_outputs[i];
+        if (outputs[i].dtype() != dtype) {
+          outputs[i].set_dtype(dtype);
+          outputs[i].clear_value();
+        }
+      }
+    }
+    update_outputs = true;
+  }
+
+  if (update_outputs) {
+    *outputs_changed =
+        !has_old_outputs ||
+        !SameProperties(outputs, old_outputs, /*compare_dtypes=*/true);
+  }
+  if (!inputs_known && !update_outputs) return false;
+  mutex_lock lock(&mu_);
+  if (update_outputs) output_props_[node.name()] = std::move(outputs);
+  if (inputs_known) input_props_[node.name()] = std::move(inputs);
+  return true;
+}
+
+void GraphProperties::Refresh(const GraphDef& graph_def) {
+  int num_updated = 0;
+  // Nodes whose outputs changed, so their fanouts are refreshed as well.
+  absl::flat_hash_set<string> changed;
+  for (int index : FaninsFirstOrder(graph_def)) {
+    const NodeDef& node = graph_def.node(index);
+    string signature = NodeSignature(node);
+    auto it = node_signatures_.find(node.name());
+    const bool rewritten =
+        it == node_signatures_.end() || it->second != signature;
+    bool fanin_changed = false;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) break;
+      if (changed.contains(ParseTensorName(input).node())) {
+        fanin_changed = true;
+        break;
+      }
+    }
+    if (!rewritten && !fanin_changed) continue;
+
+    const bool op_changed = it == node_signatures_.end() ||
+                            SignatureOp(it->second) != node.op();
+    bool outputs_changed = false;
+    if (UpdateNode(node, op_changed, &outputs_changed)) ++num_updated;
+    if (outputs_changed) changed.insert(node.name());
+    node_signatures_[node.name()] = std::move(signature);
+  }
+  ITEX_VLOG(2) << "GraphProperties: refreshed " << num_updated
+               << " rewritten nodes.";
+}
+
+GraphProperties& GetSharedGraphProperties(OptimizerContext* opt_ctx,
+                                          const GrapplerItem& item) {
+  if (opt_ctx->graph_properties == nullptr) {
+    opt_ctx->graph_properties = std::make_shared<GraphProperties>(item);
+  }
+  return *opt_ctx->graph_properties;
 }
 
 }  // namespace graph
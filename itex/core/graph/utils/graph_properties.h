@@ -18,11 +18,16 @@ limitations under the License.
 #ifndef ITEX_CORE_GRAPH_UTILS_GRAPH_PROPERTIES_H_
 #define ITEX_CORE_GRAPH_UTILS_GRAPH_PROPERTIES_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "itex/core/graph/utils/grappler_item.h"
+#include "itex/core/graph/utils/utils.h"
+#include "itex/core/utils/mutex.h"
 #include "itex/core/utils/status.h"
+#include "protos/graph.pb.h"
 #include "protos/op_performance_data.pb.h"
 
 namespace itex {
@@ -73,10 +78,57 @@ class GraphProperties {
       const string& node_name,
       std::vector<OpInfo_TensorProperties>* output_props) const;
 
+  bool IsInferred() const { return inferred_; }
+
+  // Records the graph that TF inferred the properties on. Must be the graph
+  // owned by the GrapplerItem, before any ITEX pass rewrites it.
+  void SetBaseGraph(const GraphDef& graph_def);
+
+  // Incrementally refreshes the properties of nodes that were added or
+  // rewritten since the base graph (or the last refresh), without going
+  // through TF again. Input properties are rebuilt from the fanins' output
+  // properties. Output properties are inferred for Const, Identity, Cast,
+  // Transpose, Split and element-wise ITEX ops. Otherwise:
+  // - nodes whose op changed keep their outputs by name, which matches how
+  //   fusions name the fused node after the last node of the pattern, but
+  //   only if the op def gives the same number and dtypes of outputs;
+  // - nodes with the same op keep the shapes of their outputs only while the
+  //   shapes of their inputs are unchanged.
+  // Outputs that can't be kept get the op def dtypes and unknown shapes.
+  // Fanins are refreshed before their fanouts, and nodes whose outputs
+  // changed get their fanouts refreshed too.
+  void Refresh(const GraphDef& graph_def);
+
  private:
+  Status GetCachedProperties(
+      const string& node_name, bool is_input,
+      std::vector<OpInfo_TensorProperties>* props) const;
+  // Returns true iff the properties of `node` were updated, and sets
+  // `outputs_changed` if its output properties differ from the old ones.
+  bool UpdateNode(const NodeDef& node, bool op_changed, bool* outputs_changed);
+
   TF_GraphProperties* graph_prop_;
+  bool inferred_ = false;
+
+  // Per-node properties, either fetched from TF or computed by Refresh().
+  // Fetching from TF serializes protos through the C API, so results are
+  // memoized for the lifetime of this object. Lookups may come from several
+  // threads, e.g. the parallel matching of the remapper.
+  mutable mutex mu_;
+  mutable absl::flat_hash_map<string, std::vector<OpInfo_TensorProperties>>
+      input_props_ TF_GUARDED_BY(mu_);
+  mutable absl::flat_hash_map<string, std::vector<OpInfo_TensorProperties>>
+      output_props_ TF_GUARDED_BY(mu_);
+  // Op and inputs of every node the cached properties correspond to.
+  absl::flat_hash_map<string, string> node_signatures_;
 };
 
+// Returns the properties shared by every pass of one Optimizer_Optimize call,
+// creating them on first use. Callers still infer them once and Refresh() them
+// for the graph they are about to rewrite.
+GraphProperties& GetSharedGraphProperties(OptimizerContext* opt_ctx,
+                                          const GrapplerItem& item);
+
 }  // namespace graph
 }  // namespace itex
 
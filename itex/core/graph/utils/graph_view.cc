@@ -33,6 +33,46 @@ namespace itex {
 namespace graph {
 namespace utils {
 
+namespace internal {
+
+NodeAttrCache ComputeNodeAttrCache(const NodeDef& node) {
+  NodeAttrCache cache;
+  cache.op_type_id = GetOpTypeId(node.op());
+
+  auto it = node.attr().find("T");
+  if (it != node.attr().end()) cache.dtype = it->second.type();
+
+  it = node.attr().find("data_format");
+  if (it != node.attr().end()) {
+    const string& format = it->second.s();
+    if (format == "NHWC") {
+      cache.data_format = NodeDataFormat::kNHWC;
+    } else if (format == "NCHW") {
+      cache.data_format = NodeDataFormat::kNCHW;
+    } else if (format == "NDHWC") {
+      cache.data_format = NodeDataFormat::kNDHWC;
+    } else if (format == "NCDHW") {
+      cache.data_format = NodeDataFormat::kNCDHW;
+    } else {
+      cache.data_format = NodeDataFormat::kOther;
+    }
+  }
+
+  // Unplaced nodes are common, skip the device name parsing for them.
+  if (!node.device().empty()) {
+    if (NodeIsOnCpu(&node)) {
+      cache.device_type = NodeDeviceType::kCPU;
+    } else if (NodeIsOnGpu(&node)) {
+      cache.device_type = NodeDeviceType::kGPU;
+    } else if (NodeIsOnXpu(&node)) {
+      cache.device_type = NodeDeviceType::kXPU;
+    }
+  }
+  return cache;
+}
+
+}  // namespace internal
+
 FaninView::FaninView(NodeView* node_view, int index)
     : NodeIndexAndPortIndex(node_view->graph_view_, node_view->node_index_,
                             index) {}
@@ -961,6 +1001,7 @@ void MutableGraphView::AddNewNodes(
       node_def->mutable_device()->swap(*new_node.node.mutable_device());
       node_def->mutable_input()->Clear();
       node_def->mutable_attr()->swap(*new_node.node.mutable_attr());
+      node_view.RefreshAttrCache();
       mutation_.removed_nodes_.erase(node_index);
     } else {
       // New node.
@@ -1210,6 +1251,7 @@ void MutableGraphView::ApplyNodeUpdates() {
       node_def->set_device(diff.device);
     }
     node_def->mutable_attr()->swap((*diff.processed_attrs));
+    node_view.RefreshAttrCache();
 
     // Updated fanins. Only one of `regular_inputs_to_remove_` or
     // `regular_inputs_to_add_` can be set.
@@ -1704,5 +1746,202 @@ Status MutableGraphView::ApplyMutationInternal() {
 }
 
 }  // namespace utils
+
+bool IsAdd(const utils::MutableNodeView& node) {
+  static const OpTypeId kAdd = GetOpTypeId("Add");
+  static const OpTypeId kAddV2 = GetOpTypeId("AddV2");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kAddV2 || (id == kAdd && node.GetDataType() != DT_STRING);
+}
+
+bool IsAddN(const utils::MutableNodeView& node) {
+  static const OpTypeId kAddN = GetOpTypeId("AddN");
+  return node.GetOpTypeId() == kAddN;
+}
+
+bool IsAddV2(const utils::MutableNodeView& node) {
+  static const OpTypeId kAddV2 = GetOpTypeId("AddV2");
+  return node.GetOpTypeId() == kAddV2;
+}
+
+bool IsAnyMul(const utils::MutableNodeView& node) {
+  static const OpTypeId kMul = GetOpTypeId("Mul");
+  static const OpTypeId kMulNoNan = GetOpTypeId("MulNoNan");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kMul || id == kMulNoNan;
+}
+
+bool IsApplyMomentum(const utils::MutableNodeView& node) {
+  static const OpTypeId kApplyMomentum = GetOpTypeId("ApplyMomentum");
+  return node.GetOpTypeId() == kApplyMomentum;
+}
+
+bool IsBatchToSpaceND(const utils::MutableNodeView& node) {
+  static const OpTypeId kBatchToSpaceND = GetOpTypeId("BatchToSpaceND");
+  return node.GetOpTypeId() == kBatchToSpaceND;
+}
+
+bool IsBiasAdd(const utils::MutableNodeView& node) {
+  static const OpTypeId kBiasAdd = GetOpTypeId("BiasAdd");
+  static const OpTypeId kBiasAddV1 = GetOpTypeId("BiasAddV1");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kBiasAdd || id == kBiasAddV1;
+}
+
+bool IsBiasAddGrad(const utils::MutableNodeView& node) {
+  static const OpTypeId kBiasAddGrad = GetOpTypeId("BiasAddGrad");
+  return node.GetOpTypeId() == kBiasAddGrad;
+}
+
+bool IsCast(const utils::MutableNodeView& node) {
+  static const OpTypeId kCast = GetOpTypeId("Cast");
+  return node.GetOpTypeId() == kCast;
+}
+
+bool IsConcatV2(const utils::MutableNodeView& node) {
+  static const OpTypeId kConcatV2 = GetOpTypeId("ConcatV2");
+  return node.GetOpTypeId() == kConcatV2;
+}
+
+bool IsConv2D(const utils::MutableNodeView& node) {
+  static const OpTypeId kConv2D = GetOpTypeId("Conv2D");
+  return node.GetOpTypeId() == kConv2D;
+}
+
+bool IsConv2DBackpropFilter(const utils::MutableNodeView& node) {
+  static const OpTypeId kConv2DBackpropFilter =
+      GetOpTypeId("Conv2DBackpropFilter");
+  return node.GetOpTypeId() == kConv2DBackpropFilter;
+}
+
+bool IsConv3D(const utils::MutableNodeView& node) {
+  static const OpTypeId kConv3D = GetOpTypeId("Conv3D");
+  return node.GetOpTypeId() == kConv3D;
+}
+
+bool IsDepthwiseConv2dNative(const utils::MutableNodeView& node) {
+  static const OpTypeId kDepthwiseConv2dNative =
+      GetOpTypeId("DepthwiseConv2dNative");
+  return node.GetOpTypeId() == kDepthwiseConv2dNative;
+}
+
+bool IsDequantize(const utils::MutableNodeView& node) {
+  static const OpTypeId kDequantize = GetOpTypeId("Dequantize");
+  return node.GetOpTypeId() == kDequantize;
+}
+
+bool IsFusedBatchNorm(const utils::MutableNodeView& node) {
+  static const OpTypeId kFusedBatchNorm = GetOpTypeId("FusedBatchNorm");
+  static const OpTypeId kFusedBatchNormV2 = GetOpTypeId("FusedBatchNormV2");
+  static const OpTypeId kFusedBatchNormV3 = GetOpTypeId("FusedBatchNormV3");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kFusedBatchNorm || id == kFusedBatchNormV2 ||
+         id == kFusedBatchNormV3;
+}
+
+bool IsFusedBatchNormGrad(const utils::MutableNodeView& node) {
+  static const OpTypeId kFusedBatchNormGrad = GetOpTypeId("FusedBatchNormGrad");
+  static const OpTypeId kFusedBatchNormGradV2 =
+      GetOpTypeId("FusedBatchNormGradV2");
+  static const OpTypeId kFusedBatchNormGradV3 =
+      GetOpTypeId("FusedBatchNormGradV3");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kFusedBatchNormGrad || id == kFusedBatchNormGradV2 ||
+         id == kFusedBatchNormGradV3;
+}
+
+bool IsGreaterEqual(const utils::MutableNodeView& node) {
+  static const OpTypeId kGreaterEqual = GetOpTypeId("GreaterEqual");
+  return node.GetOpTypeId() == kGreaterEqual;
+}
+
+bool IsITEXFusedBatchNorm(const utils::MutableNodeView& node) {
+  static const OpTypeId kItexFusedBatchNorm =
+      GetOpTypeId("_ITEXFusedBatchNorm");
+  static const OpTypeId kItexFusedBatchNormV2 =
+      GetOpTypeId("_ITEXFusedBatchNormV2");
+  static const OpTypeId kItexFusedBatchNormV3 =
+      GetOpTypeId("_ITEXFusedBatchNormV3");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kItexFusedBatchNorm || id == kItexFusedBatchNormV2 ||
+         id == kItexFusedBatchNormV3;
+}
+
+bool IsMaximum(const utils::MutableNodeView& node) {
+  static const OpTypeId kMaximum = GetOpTypeId("Maximum");
+  return node.GetOpTypeId() == kMaximum;
+}
+
+bool IsMul(const utils::MutableNodeView& node) {
+  static const OpTypeId kMul = GetOpTypeId("Mul");
+  return node.GetOpTypeId() == kMul;
+}
+
+bool IsRelu(const utils::MutableNodeView& node) {
+  static const OpTypeId kRelu = GetOpTypeId("Relu");
+  return node.GetOpTypeId() == kRelu;
+}
+
+bool IsReshape(const utils::MutableNodeView& node) {
+  static const OpTypeId kReshape = GetOpTypeId("Reshape");
+  return node.GetOpTypeId() == kReshape;
+}
+
+bool IsResourceApplyMomentum(const utils::MutableNodeView& node) {
+  static const OpTypeId kResourceApplyMomentum =
+      GetOpTypeId("ResourceApplyMomentum");
+  return node.GetOpTypeId() == kResourceApplyMomentum;
+}
+
+bool IsSelect(const utils::MutableNodeView& node) {
+  static const OpTypeId kSelect = GetOpTypeId("Select");
+  static const OpTypeId kSelectV2 = GetOpTypeId("SelectV2");
+  const OpTypeId id = node.GetOpTypeId();
+  return id == kSelect || id == kSelectV2;
+}
+
+bool IsShape(const utils::MutableNodeView& node) {
+  static const OpTypeId kShape = GetOpTypeId("Shape");
+  return node.GetOpTypeId() == kShape;
+}
+
+bool IsSlice(const utils::MutableNodeView& node) {
+  static const OpTypeId kSlice = GetOpTypeId("Slice");
+  return node.GetOpTypeId() == kSlice;
+}
+
+bool IsSoftmax(const utils::MutableNodeView& node) {
+  static const OpTypeId kSoftmax = GetOpTypeId("Softmax");
+  return node.GetOpTypeId() == kSoftmax;
+}
+
+bool IsStridedSliceGrad(const utils::MutableNodeView& node) {
+  static const OpTypeId kStridedSliceGrad = GetOpTypeId("StridedSliceGrad");
+  return node.GetOpTypeId() == kStridedSliceGrad;
+}
+
+bool IsSub(const utils::MutableNodeView& node) {
+  static const OpTypeId kSub = GetOpTypeId("Sub");
+  return node.GetOpTypeId() == kSub;
+}
+
+bool IsSum(const utils::MutableNodeView& node) {
+  static const OpTypeId kSum = GetOpTypeId("Sum");
+  return node.GetOpTypeId() == kSum;
+}
+
+bool IsTranspose(const utils::MutableNodeView& node) {
+  static const OpTypeId kTranspose = GetOpTypeId("Transpose");
+  return node.GetOpTypeId() == kTranspose;
+}
+
+bool NodeIsOnCpu(const utils::MutableNodeView& node) {
+  return node.GetDeviceType() == utils::internal::NodeDeviceType::kCPU;
+}
+
+bool NodeIsOnGpu(const utils::MutableNodeView& node) {
+  return node.GetDeviceType() == utils::internal::NodeDeviceType::kGPU;
+}
+
 }  // namespace graph
 }  // namespace itex
@@ -392,6 +392,9 @@ class MutableGraphView
   // Returns a Mutation (builder) that can be used to modify MutableGraphView.
   Mutation* GetMutationBuilder();
 
+  // Returns the number of mutations applied so far.
+  int num_mutations() const { return mutation_.mutation_counter_; }
+
   // Helper class representing an extra dependency for topological sorting.
   class TopologicalDependency {
    public:
@@ -540,6 +543,46 @@ class MutableGraphView
 };
 
 }  // namespace utils
+
+// Node view overloads of the op_types.h predicates used by the hottest
+// matchers. They compare the interned op type id and the cached attributes
+// of the view instead of the op string and the NodeDef attribute map.
+bool IsAdd(const utils::MutableNodeView& node);
+bool IsAddN(const utils::MutableNodeView& node);
+bool IsAddV2(const utils::MutableNodeView& node);
+bool IsAnyMul(const utils::MutableNodeView& node);
+bool IsApplyMomentum(const utils::MutableNodeView& node);
+bool IsBatchToSpaceND(const utils::MutableNodeView& node);
+bool IsBiasAdd(const utils::MutableNodeView& node);
+bool IsBiasAddGrad(const utils::MutableNodeView& node);
+bool IsCast(const utils::MutableNodeView& node);
+bool IsConcatV2(const utils::MutableNodeView& node);
+bool IsConv2D(const utils::MutableNodeView& node);
+bool IsConv2DBackpropFilter(const utils::MutableNodeView& node);
+bool IsConv3D(const utils::MutableNodeView& node);
+bool IsDepthwiseConv2dNative(const utils::MutableNodeView& node);
+bool IsDequantize(const utils::MutableNodeView& node);
+bool IsFusedBatchNorm(const utils::MutableNodeView& node);
+bool IsFusedBatchNormGrad(const utils::MutableNodeView& node);
+bool IsGreaterEqual(const utils::MutableNodeView& node);
+bool IsITEXFusedBatchNorm(const utils::MutableNodeView& node);
+bool IsMaximum(const utils::MutableNodeView& node);
+bool IsMul(const utils::MutableNodeView& node);
+bool IsRelu(const utils::MutableNodeView& node);
+bool IsReshape(const utils::MutableNodeView& node);
+bool IsResourceApplyMomentum(const utils::MutableNodeView& node);
+bool IsSelect(const utils::MutableNodeView& node);
+bool IsShape(const utils::MutableNodeView& node);
+bool IsSlice(const utils::MutableNodeView& node);
+bool IsSoftmax(const utils::MutableNodeView& node);
+bool IsStridedSliceGrad(const utils::MutableNodeView& node);
+bool IsSub(const utils::MutableNodeView& node);
+bool IsSum(const utils::MutableNodeView& node);
+bool IsTranspose(const utils::MutableNodeView& node);
+
+bool NodeIsOnCpu(const utils::MutableNodeView& node);
+bool NodeIsOnGpu(const utils::MutableNodeView& node);
+
 }  // namespace graph
 }  // namespace itex
 
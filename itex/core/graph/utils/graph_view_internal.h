@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
+#include "itex/core/graph/utils/op_types.h"
 #include "itex/core/utils/gtl/map_util.h"
 #include "itex/core/utils/node_def_util.h"
 #include "itex/core/utils/status.h"
@@ -45,6 +46,32 @@ constexpr int kMissingSlot = -2;
 constexpr int kMissingIndex = -1;
 constexpr int kNodeNamePresent = -1;
 
+enum class NodeDeviceType : int8 { kUnknown, kCPU, kGPU, kXPU };
+
+enum class NodeDataFormat : int8 {
+  kNone,
+  kNHWC,
+  kNCHW,
+  kNDHWC,
+  kNCDHW,
+  kOther
+};
+
+// Attributes read by most graph passes, precomputed once per node so that
+// they are plain loads instead of protobuf map lookups and string compares.
+// Mutations refresh it when they rewrite the node; the op, "T",
+// "data_format" and device must not be changed through node() directly.
+struct NodeAttrCache {
+  OpTypeId op_type_id = -1;
+  // Attribute "T", DT_INVALID if the node has none.
+  DataType dtype = DT_INVALID;
+  NodeDataFormat data_format = NodeDataFormat::kNone;
+  NodeDeviceType device_type = NodeDeviceType::kUnknown;
+};
+
+// Defined in graph_view.cc.
+NodeAttrCache ComputeNodeAttrCache(const NodeDef& node);
+
 // NodeIndexAndPortIndex is a helper class that represents fanins and fanouts
 // of a node.
 template <typename NodeViewT, typename GraphViewT>
@@ -138,7 +165,8 @@ class NodeViewInternal {
   explicit NodeViewInternal(GraphViewT* graph_view, int node_index)
       : graph_view_(graph_view),
         node_index_(node_index),
-        attrs_(AttrSlice(graph_view->graph()->node(node_index))) {}
+        attrs_(AttrSlice(graph_view->graph()->node(node_index))),
+        cache_(ComputeNodeAttrCache(graph_view->graph()->node(node_index))) {}
 
   NodeViewInternal()
       : graph_view_(nullptr), node_index_(kMissingIndex), attrs_(AttrSlice()) {}
@@ -172,6 +200,18 @@ class NodeViewInternal {
   // Returns the device set for the node.
   const string& GetDevice() const { return node()->device(); }
 
+  // Returns the interned id of the op of the node, see GetOpTypeId().
+  OpTypeId GetOpTypeId() const { return cache_.op_type_id; }
+
+  // Returns attribute "T" of the node, or DT_INVALID if it is not set.
+  DataType GetDataType() const { return cache_.dtype; }
+
+  // Returns attribute "data_format" of the node.
+  NodeDataFormat GetDataFormat() const { return cache_.data_format; }
+
+  // Returns the device type the node is placed on.
+  NodeDeviceType GetDeviceType() const { return cache_.device_type; }
+
   // Returns all regular fanins, based on ordering in the node.
   const std::vector<FanoutViewT>& GetRegularFanins() const {
     return regular_fanins_;
@@ -257,9 +297,13 @@ class NodeViewInternal {
   int num_regular_fanouts_ = 0;
   std::vector<FaninViewT> controlled_fanouts_;
 
+  // Recomputes the cached attributes after the NodeDef has been mutated.
+  void RefreshAttrCache() { cache_ = ComputeNodeAttrCache(*node()); }
+
   GraphViewT* graph_view_;
   int node_index_;
   AttrSlice attrs_;
+  NodeAttrCache cache_;
 };
 
 // GraphViewInternal is a helper class to simplify graph traversal. It creates
@@ -229,6 +229,10 @@ bool RewriteOneDnnFusedConv(const utils::MutableNodeView& node_view) {
 bool RewriteMatMul(const utils::MutableNodeView& node_view) {
   const NodeDef& node_def = *(node_view.node());
 
+  // Generic post op chains from remapper carry per op params and Binary
+  // operands, which are only handled by the plain layout kernel.
+  if (HasPostOpChain(node_def)) return false;
+
   // Temporarily rewrite MatMul-like ops for CPU unconditionally.
   // TODO(itex): Remove this condition once MatMul blocked format is
   // supported on CPU.
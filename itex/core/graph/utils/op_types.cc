@@ -20,8 +20,10 @@ limitations under the License.
 #include <algorithm>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "itex/core/utils/gtl/flatset.h"
 #include "itex/core/utils/logging.h"
+#include "itex/core/utils/mutex.h"
 #include "itex/core/utils/str_util.h"
 #include "protos/attr_value.pb.h"
 #include "tensorflow/c/c_api_experimental.h"
@@ -31,6 +33,34 @@ namespace graph {
 
 using string = std::string;
 
+namespace {
+
+struct OpTypeTable {
+  mutex mu;
+  absl::flat_hash_map<string, OpTypeId> ids;
+};
+
+OpTypeTable* GetOpTypeTable() {
+  static OpTypeTable* table = new OpTypeTable();
+  return table;
+}
+
+}  // namespace
+
+OpTypeId GetOpTypeId(absl::string_view op) {
+  OpTypeTable* table = GetOpTypeTable();
+  {
+    // Op types are interned by the first graph, later ones only read them.
+    tf_shared_lock l(&table->mu);
+    auto it = table->ids.find(op);
+    if (it != table->ids.end()) return it->second;
+  }
+  mutex_lock l(&table->mu);
+  // Interns `op` unless another thread did since the lookup above.
+  return table->ids.emplace(op, static_cast<OpTypeId>(table->ids.size()))
+      .first->second;
+}
+
 bool IsAdd(const NodeDef& node) {
   if (node.op() == "AddV2") {
     return true;
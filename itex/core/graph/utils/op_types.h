@@ -18,11 +18,23 @@ limitations under the License.
 #ifndef ITEX_CORE_GRAPH_UTILS_OP_TYPES_H_
 #define ITEX_CORE_GRAPH_UTILS_OP_TYPES_H_
 
+#include <string>
+
+#include "absl/strings/string_view.h"
 #include "itex/core/utils/status.h"
 #include "protos/node_def.pb.h"
 
 namespace itex {
 namespace graph {
+
+// Dense id of an interned op type. Ids are process-wide and stable, so that
+// graph passes can compare op types of node views as integers instead of
+// strings. See NodeViewInternal::GetOpTypeId().
+using OpTypeId = int32;
+
+// Returns the id of `op`, interning it on first use. Thread-safe.
+OpTypeId GetOpTypeId(absl::string_view op);
+
 bool IsAccMatMul(const NodeDef& node);
 bool IsAdd(const NodeDef& node);
 bool IsAddN(const NodeDef& node);
@@ -23,24 +23,32 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_split.h"
 
 namespace itex {
 namespace graph {
 namespace utils {
 
-inline const bool IsCommutativeOp(const string& op) {
+inline const bool IsCommutativeOp(const OpTypePattern& pattern) {
   // TODO(itex): Add more ops to this list if needed.
+  if (pattern.op_type_ids.size() == 1) {
+    static const OpTypeId kAddId = GetOpTypeId("Add");
+    static const OpTypeId kAddV2Id = GetOpTypeId("AddV2");
+    static const OpTypeId kMulId = GetOpTypeId("Mul");
+    const OpTypeId id = pattern.op_type_ids[0];
+    return id == kAddId || id == kAddV2Id || id == kMulId;
+  }
   static const auto commutative_ops =
       absl::flat_hash_set<string>({"Add", "AddV2", "Mul"});
-  return commutative_ops.contains(op);
+  return commutative_ops.contains(pattern.op);
 }
 
 // `expected` are op names in the pattern and they could be wildcard `*` or
 // some registered op in tensorflow. `input` are real op names in the
 // computation graph.
 // Look further if any input is wildcard `*`.
-inline bool NeedSwap(string input_0, string expected_0, string input_1,
-                     string expected_1) {
+inline bool NeedSwap(const string& input_0, const string& expected_0,
+                     const string& input_1, const string& expected_1) {
   // Do not swap if the original order can be matched.
   // TODO(itex): Continue swapping even it's matched for further optimization.
   if (input_0 == expected_0 && input_1 == expected_1) return false;
@@ -125,7 +133,15 @@ bool SubGraphMatcher<MatchingDirection::kFollowInputs>::DoesOpTypePatternMatch(
                << "]";
 
   bool op_type_matched = false;
-  if (pattern.op == "*") {
+  if (!pattern.op_type_ids.empty()) {
+    const OpTypeId node_op_id = node_view->GetOpTypeId();
+    for (OpTypeId id : pattern.op_type_ids) {
+      if (id == node_op_id) {
+        op_type_matched = true;
+        break;
+      }
+    }
+  } else if (pattern.op == "*") {
     op_type_matched = true;
   } else {
     // The op field string of current pattern might express an op among multiple
@@ -225,8 +241,7 @@ bool SubGraphMatcher<MatchingDirection::kFollowInputs>::DoesOpTypePatternMatch(
       std::vector<int> pattern_child_indices =
           GetChildrenIndices(pattern, num_children);
 
-      string op_name = pattern.op;
-      if (IsCommutativeOp(op_name) && num_children == 2) {
+      if (IsCommutativeOp(pattern) && num_children == 2) {
         MutableNodeView* graph_child0_node_view =
             graph_view_->GetNode(graph_children[0].node_index());
         MutableNodeView* graph_child1_node_view =
@@ -322,6 +337,19 @@ static std::string DumpPatternHelper(const OpTypePattern& pattern) {
   return record;
 }
 
+void ResolveOpTypeIds(OpTypePattern* pattern) {
+  pattern->op_type_ids.clear();
+  if (pattern->op != "*") {
+    for (absl::string_view op : absl::StrSplit(pattern->op, '|')) {
+      if (absl::EndsWith(op, "*")) op.remove_suffix(1);
+      pattern->op_type_ids.push_back(GetOpTypeId(op));
+    }
+  }
+  for (OpTypePattern& child : pattern->children) {
+    ResolveOpTypeIds(&child);
+  }
+}
+
 void DumpPattern(const OpTypePattern& pattern, std::string path) {
   std::string header = "digraph Pattern {\n";
   header.append("rankdir=BT\n");
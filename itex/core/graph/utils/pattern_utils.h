@@ -139,6 +139,10 @@ struct OpTypePattern {
   string label;
   NodeStatus node_status;
   std::vector<OpTypePattern> children;
+  // Interned ids of the '|' separated op types in `op`, filled by
+  // ResolveOpTypeIds(). Empty if not resolved or if `op` is a wildcard, in
+  // which case the matcher compares op strings.
+  std::vector<OpTypeId> op_type_ids;
 
   OpTypePattern& AddInput(const OpTypePattern& parent) {
     children.push_back(parent);
@@ -174,6 +178,11 @@ struct OpTypePattern {
 
 void DumpPattern(const OpTypePattern& pattern, std::string path);
 
+// Interns the op types of `pattern` and all its children, so that matching
+// it compares integers. Patterns that live across many matches, such as the
+// ones of registered fusions, should be resolved once after construction.
+void ResolveOpTypeIds(OpTypePattern* pattern);
+
 // This is a helpful recursive structure that keeps one-to-one mapping of
 // pattern syntax to the matched nodes. User can call DebugString to see what
 // has been matched so far and where is the failing point.
@@ -414,6 +414,11 @@ DataType GetDataTypeFromAttr(const NodeDef& node, const string& type_attr) {
   return attr.type();
 }
 
+bool HasPostOpChain(const NodeDef& node) {
+  auto it = node.attr().find("post_op_alphas");
+  return it != node.attr().end() && it->second.list().f_size() > 0;
+}
+
 NodeDef* GetTailOfChain(const NodeDef& source, const NodeMap& node_map,
                         bool follow_control_input,
                         const std::function<bool(const NodeDef&)>& pred_fn) {
@@ -21,6 +21,7 @@ limitations under the License.
 #include <algorithm>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
@@ -45,6 +46,8 @@ limitations under the License.
 namespace itex {
 namespace graph {
 
+class GraphProperties;
+
 struct OptimizerContext {
   explicit OptimizerContext(const char* device_name)
       : device_name(device_name),
@@ -54,6 +57,9 @@ struct OptimizerContext {
   bool is_compute_intensive;
   bool enable_complete_opt;
   bool is_quantization_graph;
+  // Inferred once per optimization and shared by passes, see
+  // GetSharedGraphProperties() in graph_properties.h.
+  std::shared_ptr<GraphProperties> graph_properties;
 };
 
 // Check whether current graph contains compute-intensive ops or not.
@@ -407,6 +413,11 @@ Status CheckAttrsExist(const NodeDef& node, absl::Span<const string> keys);
 // doesn't exist, returns DT_INVALID.
 DataType GetDataTypeFromAttr(const NodeDef& node, const string& type_attr);
 
+// Returns true if `node` is a contraction fused by remapper with a generic
+// post op chain, i.e. with per op params and Binary operands. The attribute
+// itself may be present but empty on any _FusedMatMul, since it has a default.
+bool HasPostOpChain(const NodeDef& node);
+
 // Returns the last node in the simple chain starting at source and traversing
 // through the input(0) edge from each node as long as the next node satisfies
 // the predicate given in pred_fn. If no nodes satisfy the predicate, &source
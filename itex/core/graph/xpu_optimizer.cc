@@ -15,6 +15,7 @@ limitations under the License.
 #include <string>
 
 #include "itex/core/graph/auto_mixed_precision/auto_mixed_precision.h"
+#include "itex/core/graph/constant_folding/constant_folding.h"
 #include "itex/core/graph/generic_layout_optimizer/generic_layout_optimizer.h"
 #include "itex/core/graph/memory_opt_pass/memory_opt_pass.h"
 #include "itex/core/graph/native_layout/native_layout.h"
@@ -24,8 +25,13 @@ limitations under the License.
 #include "itex/core/graph/onednn_layout/onednn_layout.h"
 #include "itex/core/graph/optimizer_config.h"
 #include "itex/core/graph/remapper/remapper.h"
+#include "itex/core/graph/segment_fusion/segment_fusion.h"
+#include "itex/core/graph/shape_bucketing/shape_bucketing.h"
+#include "itex/core/graph/utils/graph_properties.h"
 #include "itex/core/graph/utils/utils.h"
+#include "itex/core/utils/env_time.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/metrics.h"
 #include "itex/core/utils/op_kernel.h"
 #include "tensorflow/c/experimental/grappler/grappler.h"
 
@@ -35,6 +41,25 @@ limitations under the License.
 
 namespace itex {
 namespace graph {
+namespace {
+
+// Records the time spent in a graph pass until the end of its scope.
+class ScopedPassTimer {
+ public:
+  explicit ScopedPassTimer(const char* pass)
+      : pass_(pass), start_(metrics::IsEnabled() ? EnvTime::NowMicros() : 0) {}
+  ~ScopedPassTimer() {
+    if (metrics::IsEnabled()) {
+      metrics::RecordGraphPassTime(pass_, EnvTime::NowMicros() - start_);
+    }
+  }
+
+ private:
+  const char* pass_;
+  const uint64 start_;
+};
+
+}  // namespace
 
 void* Optimizer_CPU_Create() {
   auto* optimizer = new Optimizer;
@@ -86,6 +111,10 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
   GraphDef optimized_graph_def = graph_def;
   auto config = GetOptimizerConfigFlags();
 
+  // Shape inference runs on the graph owned by `item`, i.e. `graph_def` here.
+  // Passes share the result and refresh only the nodes they rewrite.
+  GetSharedGraphProperties(&opt_ctx, item).SetBaseGraph(graph_def);
+
   opt_ctx.is_compute_intensive = HaveComputeIntensiveNode(graph_def);
   opt_ctx.is_quantization_graph = HaveQuantizeDequantizeNode(graph_def);
 #ifndef INTEL_CPU_ONLY
@@ -148,79 +177,147 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
       (opt_ctx.is_quantization_graph || config.enable_onednn_graph_all_type);
 
   optimized_graph_def.Swap(&graph_def);
-  GenericLayoutOptimizer generic_layout_opt;
-  SET_STATUS_IF_ERROR(tf_status,
-                      generic_layout_opt.Optimize(&opt_ctx, item, graph_def,
-                                                  &optimized_graph_def));
+  {
+    ScopedPassTimer timer("generic_layout");
+    GenericLayoutOptimizer generic_layout_opt;
+    SET_STATUS_IF_ERROR(tf_status,
+                        generic_layout_opt.Optimize(&opt_ctx, item, graph_def,
+                                                    &optimized_graph_def));
+  }
+
+  // Fold constants before remapper, so that folded BatchNorm and scales don't
+  // block contraction fusions.
+  if (config.enable_constant_folding && opt_ctx.enable_complete_opt) {
+    optimized_graph_def.Swap(&graph_def);
+    {
+      ScopedPassTimer timer("constant_folding");
+      SET_STATUS_IF_ERROR(tf_status,
+                          RunConstantFolding(&opt_ctx, item, graph_def,
+                                             &optimized_graph_def));
+    }
+  }
+
+  // Batch chains of small CPU ops before remapper, which would otherwise fuse
+  // them into separate oneDNN primitives.
+  if (config.enable_segment_fusion && opt_ctx.enable_complete_opt) {
+    optimized_graph_def.Swap(&graph_def);
+    {
+      ScopedPassTimer timer("segment_fusion");
+      SET_STATUS_IF_ERROR(tf_status,
+                          RunSegmentFusion(&opt_ctx, item, graph_def,
+                                           &optimized_graph_def));
+    }
+  }
 
   if (config.enable_remapper && opt_ctx.enable_complete_opt) {
     if (onednn_graph_optimize) {
       // We don't want full scope remapper here if oneDNN graph is enabled.
       optimized_graph_def.Swap(&graph_def);
-      SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
-                                                 &optimized_graph_def, false));
+      {
+        ScopedPassTimer timer("remapper");
+        SET_STATUS_IF_ERROR(
+            tf_status, RunRemapper(&opt_ctx, item, graph_def,
+                                   &optimized_graph_def, false));
+      }
     } else {
       // Run remapper twice for full scope fusions if oneDNN graph is disabled.
       for (int i = 0; i < config.remapper_run_pass; ++i) {
         optimized_graph_def.Swap(&graph_def);
-        SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
-                                                   &optimized_graph_def, true,
-                                                   RemapperLevel(i)));
+        {
+          ScopedPassTimer timer("remapper");
+          SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
+                                                     &optimized_graph_def, true,
+                                                     RemapperLevel(i)));
+        }
       }
     }
   }
 
   if (config.enable_auto_mixed_precision && opt_ctx.enable_complete_opt) {
     optimized_graph_def.Swap(&graph_def);
-    SET_STATUS_IF_ERROR(
-        tf_status,
-        RunAutoMixedPrecision(&opt_ctx, item, graph_def, &optimized_graph_def));
+    {
+      ScopedPassTimer timer("auto_mixed_precision");
+      SET_STATUS_IF_ERROR(tf_status,
+                          RunAutoMixedPrecision(&opt_ctx, item, graph_def,
+                                                &optimized_graph_def));
+    }
     // Because after running auto_mixed_precision, it will insert Cast op
     // before Const op. So run remapper Const + Cast fusion will remove
     // these overhead.
     // We don't want ITEX remapper pass change graph before LLGA pass
     if (config.enable_remapper && !onednn_graph_optimize) {
       optimized_graph_def.Swap(&graph_def);
-      SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
-                                                 &optimized_graph_def));
+      {
+        ScopedPassTimer timer("remapper");
+        SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
+                                                   &optimized_graph_def));
+      }
     }
   }
 
 #ifdef ITEX_ONEDNN_GRAPH
   if (onednn_graph_optimize && opt_ctx.enable_complete_opt) {
     optimized_graph_def.Swap(&graph_def);
-    SET_STATUS_IF_ERROR(tf_status,
-                        RunOneDnnGraph(item, graph_def, &optimized_graph_def));
+    {
+      ScopedPassTimer timer("onednn_graph");
+      SET_STATUS_IF_ERROR(
+          tf_status, RunOneDnnGraph(&opt_ctx, item, graph_def,
+                                    &optimized_graph_def));
+    }
 
     // Run the full scope remapper here since only got partial remapper before
     // if oneDNN graph is enabled.
     if (config.enable_remapper) {
       for (int i = 0; i < config.remapper_run_pass; ++i) {
         optimized_graph_def.Swap(&graph_def);
-        SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
-                                                   &optimized_graph_def, true,
-                                                   RemapperLevel(i)));
+        {
+          ScopedPassTimer timer("remapper");
+          SET_STATUS_IF_ERROR(tf_status, RunRemapper(&opt_ctx, item, graph_def,
+                                                     &optimized_graph_def, true,
+                                                     RemapperLevel(i)));
+        }
       }
     }
   }
 #endif  // ITEX_ONEDNN_GRAPH
 
+  // Runs after the remapper, so that fused ops are bucketed as a whole, and
+  // before the layout passes rewrite them to oneDNN ops.
+  if (config.enable_shape_bucketing && opt_ctx.enable_complete_opt) {
+    optimized_graph_def.Swap(&graph_def);
+    {
+      ScopedPassTimer timer("shape_bucketing");
+      SET_STATUS_IF_ERROR(
+          tf_status, RunShapeBucketing(&opt_ctx, item, graph_def,
+                                       &optimized_graph_def));
+    }
+  }
+
   if (config.enable_layout_opt && opt_ctx.enable_complete_opt) {
     optimized_graph_def.Swap(&graph_def);
-    SET_STATUS_IF_ERROR(tf_status, RunOneDnnLayout(&opt_ctx, item, graph_def,
-                                                   &optimized_graph_def));
+    {
+      ScopedPassTimer timer("onednn_layout");
+      SET_STATUS_IF_ERROR(tf_status, RunOneDnnLayout(&opt_ctx, item, graph_def,
+                                                     &optimized_graph_def));
+    }
   }
 
   // Put post Native Format rewrite pass for better co-working with oneDNN
   // layout.
   optimized_graph_def.Swap(&graph_def);
-  SET_STATUS_IF_ERROR(tf_status, RunNativeLayout(&opt_ctx, item, graph_def,
-                                                 &optimized_graph_def));
+  {
+    ScopedPassTimer timer("native_layout");
+    SET_STATUS_IF_ERROR(tf_status, RunNativeLayout(&opt_ctx, item, graph_def,
+                                                   &optimized_graph_def));
+  }
 
   // Memory Optimization
   optimized_graph_def.Swap(&graph_def);
-  SET_STATUS_IF_ERROR(tf_status, RunMemoryOptPass(&opt_ctx, item, graph_def,
-                                                  &optimized_graph_def));
+  {
+    ScopedPassTimer timer("memory_opt");
+    SET_STATUS_IF_ERROR(tf_status, RunMemoryOptPass(&opt_ctx, item, graph_def,
+                                                    &optimized_graph_def));
+  }
 
   if (IsVerboseEnabled()) {
     end = std::chrono::steady_clock::now();
@@ -265,9 +265,13 @@ class BatchMatMulOp : public OpKernel {
   }
 
   void InitOrSetMemory(OpKernelContext* context) {
-    if (!(enable_cache_ && is_init_ &&
-          context->is_input_same(kSrcIndex_, input_dims_) &&
-          context->is_input_same(kWeightIndex_, weights_dims_))) {
+    const bool hit = enable_cache_ && is_init_ &&
+                     context->is_input_same(kSrcIndex_, input_dims_) &&
+                     context->is_input_same(kWeightIndex_, weights_dims_);
+    if (enable_cache_ && metrics::IsEnabled()) {
+      metrics::RecordPrimitiveCacheLookup(string(this->type()), hit);
+    }
+    if (!hit) {
       Init(context);
       return;
     }
@@ -26,6 +26,7 @@ limitations under the License.
 #include "itex/core/utils/bounds_check.h"
 #include "itex/core/utils/common_shape_fns.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/metrics.h"
 #include "itex/core/utils/onednn/onednn_layout_util.h"
 #include "itex/core/utils/onednn/onednn_post_op_util.h"
 #include "itex/core/utils/onednn/onednn_util.h"
@@ -716,8 +717,14 @@ class ConvOpBase : public OpKernel {
   }
 
   void InitOrSetMemory(OpKernelContext* context) {
-    if (!(enable_cache_ && is_init_ && context->is_input_same(0, input_dims_) &&
-          context->is_input_same(1, filter_dims_) && !is_format_reordered_)) {
+    const bool hit = enable_cache_ && is_init_ &&
+                     context->is_input_same(0, input_dims_) &&
+                     context->is_input_same(1, filter_dims_) &&
+                     !is_format_reordered_;
+    if (enable_cache_ && metrics::IsEnabled()) {
+      metrics::RecordPrimitiveCacheLookup(string(this->type()), hit);
+    }
+    if (!hit) {
       Init(context);
       return;
     }
@@ -764,12 +771,11 @@ class ConvOpBase : public OpKernel {
     }
 
     // Reallocate scratchpad memory.
-    OP_REQUIRES_OK(context,
-                   context->allocate_temp(DataTypeToEnum<Tinput>::v(),
-                                          TensorShape({scratchpad_size_}),
-                                          scratchpad_tensor_.get()));
-    scratchpad_mem_.set_data_handle(
-        GetTensorBuffer<Tinput>(scratchpad_tensor_.get()));
+    void* scratchpad_data = nullptr;
+    OP_REQUIRES_OK(context, AllocateScratchpad<Tinput>(
+                                context, scratchpad_size_,
+                                scratchpad_tensor_.get(), &scratchpad_data));
+    scratchpad_mem_.set_data_handle(scratchpad_data);
 
     Tensor dst_tensor_opt;
     AllocateOutputTensor(context, fwd_pd_, dst_dims_onednn_, dst_tensor_shape_,
@@ -788,6 +794,7 @@ class ConvOpBase : public OpKernel {
     // onednn_stream has thread safety issue, need create a new one in
     // every compute.
     onednn_stream_ = CreateDnnlStream(*context, onednn_engine_);
+    ScratchpadArena::Scope scratchpad_scope;
     scratchpad_tensor_ = std::make_shared<Tensor>();
     InitOrSetMemory(context);
 
@@ -1010,13 +1017,12 @@ class ConvOpBase : public OpKernel {
       AllocateOutputTensor(context, fwd_pd_, dst_dims_onednn_,
                            dst_tensor_shape_, &dst_tensor_, &dst_tensor_opt);
       scratchpad_size_ = fwd_pd_.scratchpad_desc().get_size() / sizeof(Tinput);
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(DataTypeToEnum<Tinput>::v(),
-                                            TensorShape({scratchpad_size_}),
-                                            scratchpad_tensor_.get()));
-      scratchpad_mem_ =
-          dnnl::memory(fwd_pd_.scratchpad_desc(), onednn_engine_,
-                       GetTensorBuffer<Tinput>(scratchpad_tensor_.get()));
+      void* scratchpad_data = nullptr;
+      OP_REQUIRES_OK(context, AllocateScratchpad<Tinput>(
+                                  context, scratchpad_size_,
+                                  scratchpad_tensor_.get(), &scratchpad_data));
+      scratchpad_mem_ = dnnl::memory(fwd_pd_.scratchpad_desc(), onednn_engine_,
+                                     scratchpad_data);
 
       fwd_primitive_ = convolution_forward(fwd_pd_);
 
@@ -716,6 +716,167 @@ struct EinsumHelper {
     }
     return Status::OK();
   }
+
+  // Contracts two operands with a single oneDNN matmul whose memory
+  // descriptors address the inputs and the output through strides, so no
+  // transposed or reduced copies are materialized. E.g. 'bhqd,bhkd->bhqk' and
+  // 'bqhd,bkhd->bhqk' map to [b,h,q,d] x [b,h,d,k] with permuted strides.
+  // Applies when every label is a batch, free or contract label appearing at
+  // most once per tensor, and the labels of each group are contiguous in the
+  // same order in every tensor holding them. Leaves `*done` false if the
+  // equation can't be expressed this way, so callers fall back to the
+  // transpose path.
+  template <typename Device, typename T>
+  static Status StridedContraction(
+      OpKernelContext* ctx, const OpInputList& inputs,
+      const OperandLabels& input_labels, const Labels& output_labels,
+      const std::vector<DimensionType>& label_types,
+      const LabelToDimSizes& label_to_dim_sizes, bool* done) {
+    *done = false;
+    if (inputs.size() != 2) return Status::OK();
+
+    const int num_labels = label_types.size();
+    for (int label = 0; label < num_labels; ++label) {
+      if (label_types[label] == kBroadcasting ||
+          label_types[label] == kReduce || label_to_dim_sizes[label] == 0)
+        return Status::OK();
+    }
+
+    // Axis of every label and row-major strides of inputs 0, 1 and output.
+    const Labels* tensor_labels[3] = {&input_labels[0], &input_labels[1],
+                                      &output_labels};
+    std::vector<int> axis[3];
+    ShapeVec strides[3];
+    for (int t = 0; t < 3; ++t) {
+      const Labels& labels = *tensor_labels[t];
+      axis[t].assign(num_labels, -1);
+      strides[t].resize(labels.size());
+      int64 stride = 1;
+      for (int i = labels.size() - 1; i >= 0; --i) {
+        const int label = labels[i];
+        if (label < 0 || label >= num_labels || axis[t][label] != -1)
+          return Status::OK();
+        axis[t][label] = i;
+        strides[t][i] = stride;
+        stride *= label_to_dim_sizes[label];
+      }
+    }
+
+    // Group the labels; batch and free labels follow the output order, so the
+    // output never needs a transpose.
+    Labels batch, free_x, free_y, contract;
+    for (int label : output_labels) {
+      if (label_types[label] == kBatch)
+        batch.push_back(label);
+      else
+        (axis[0][label] != -1 ? free_x : free_y).push_back(label);
+    }
+    for (int label : input_labels[0]) {
+      if (label_types[label] == kContract) contract.push_back(label);
+    }
+    if (batch.size() + 2 > DNNL_MAX_NDIMS) return Status::OK();
+
+    // Returns the (size, stride) of `group` collapsed to one dimension of
+    // tensor `t`, or stride -1 if the group isn't contiguous there.
+    auto collapse = [&](const Labels& group, int t) -> std::pair<int64, int64> {
+      int64 size = 1;
+      for (int label : group) size *= label_to_dim_sizes[label];
+      if (group.empty()) return {size, 1};
+      for (size_t i = 0; i + 1 < group.size(); ++i) {
+        const int64 outer = strides[t][axis[t][group[i]]];
+        const int64 inner = strides[t][axis[t][group[i + 1]]];
+        if (outer != inner * label_to_dim_sizes[group[i + 1]])
+          return {size, -1};
+      }
+      return {size, strides[t][axis[t][group.back()]]};
+    };
+
+    memory::dims a_dims, a_strides, b_dims, b_strides, c_dims, c_strides;
+    for (int label : batch) {
+      const int64 dim = label_to_dim_sizes[label];
+      a_dims.push_back(dim);
+      b_dims.push_back(dim);
+      c_dims.push_back(dim);
+      a_strides.push_back(strides[0][axis[0][label]]);
+      b_strides.push_back(strides[1][axis[1][label]]);
+      c_strides.push_back(strides[2][axis[2][label]]);
+    }
+    const std::pair<int64, int64> groups[] = {
+        collapse(free_x, 0),   collapse(contract, 0), collapse(contract, 1),
+        collapse(free_y, 1),   collapse(free_x, 2),   collapse(free_y, 2)};
+    for (const auto& group : groups) {
+      if (group.second == -1) return Status::OK();
+    }
+    a_dims.insert(a_dims.end(), {groups[0].first, groups[1].first});
+    a_strides.insert(a_strides.end(), {groups[0].second, groups[1].second});
+    b_dims.insert(b_dims.end(), {groups[2].first, groups[3].first});
+    b_strides.insert(b_strides.end(), {groups[2].second, groups[3].second});
+    c_dims.insert(c_dims.end(), {groups[4].first, groups[5].first});
+    c_strides.insert(c_strides.end(), {groups[4].second, groups[5].second});
+
+    try {
+      auto src_md = memory::desc(a_dims, OneDnnType<T>(), a_strides);
+      auto weights_md = memory::desc(b_dims, OneDnnType<T>(), b_strides);
+      auto dst_md = memory::desc(c_dims, OneDnnType<T>(), c_strides);
+
+      auto dnnl_engine = CreateDnnlEngine<Device>(*ctx);
+      dnnl::primitive_attr post_ops_attr;
+      post_ops_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+      dnnl::matmul::primitive_desc matmul_pd;
+      try {
+        matmul_pd = dnnl::matmul::primitive_desc(dnnl_engine, src_md,
+                                                 weights_md, dst_md,
+                                                 post_ops_attr);
+      } catch (dnnl::error& e) {
+        // The strides are not supported by any implementation.
+        return Status::OK();
+      }
+      // A reference kernel is slower than transposing the operands.
+      if (string(matmul_pd.impl_info_str()).find("ref") != string::npos)
+        return Status::OK();
+
+      TensorShape output_shape;
+      for (int label : output_labels) {
+        output_shape.AddDim(label_to_dim_sizes[label]);
+      }
+      Tensor* output = nullptr;
+      TF_RETURN_IF_ERROR(ctx->allocate_output(0, output_shape, &output));
+
+      Tensor scratchpad_tensor;
+      int64 scratchpad_size =
+          matmul_pd.scratchpad_desc().get_size() / sizeof(T);
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::v(),
+                                            TensorShape({scratchpad_size}),
+                                            &scratchpad_tensor));
+      auto scratchpad_mem =
+          dnnl::memory(matmul_pd.scratchpad_desc(), dnnl_engine,
+                       GetTensorBuffer<T>(&scratchpad_tensor));
+
+      auto src_mem = CreateDnnlMemory(
+          src_md, dnnl_engine,
+          static_cast<void*>(const_cast<T*>(inputs[0].flat<T>().data())));
+      auto weights_mem = CreateDnnlMemory(
+          weights_md, dnnl_engine,
+          static_cast<void*>(const_cast<T*>(inputs[1].flat<T>().data())));
+      auto dst_mem = CreateDnnlMemory(
+          dst_md, dnnl_engine, static_cast<void*>(output->flat<T>().data()));
+
+      auto dnnl_stream = CreateDnnlStream(*ctx, dnnl_engine);
+      std::unordered_map<int, memory> fwd_primitive_args = {
+          {DNNL_ARG_SRC, src_mem},
+          {DNNL_ARG_WEIGHTS, weights_mem},
+          {DNNL_ARG_DST, dst_mem},
+          {DNNL_ARG_SCRATCHPAD, scratchpad_mem}};
+      dnnl::matmul(matmul_pd).execute(dnnl_stream, fwd_primitive_args);
+    } catch (dnnl::error& e) {
+      string error_msg = "Status: " + std::to_string(e.status) +
+                         ", message: " + string(e.message) + ", in file " +
+                         string(__FILE__) + ":" + std::to_string(__LINE__);
+      return Status(TF_INTERNAL, error_msg);
+    }
+    *done = true;
+    return Status::OK();
+  }
 };
 
 template <typename Device, typename T,
@@ -756,6 +917,15 @@ class EinsumOp : public OpKernel {
         return;
     }
 
+    // Contract with strided matmul descriptors without intermediate copies.
+    if constexpr (std::is_same_v<Device, CPUDevice>) {
+      bool done = false;
+      OP_REQUIRES_OK(ctx, EinsumHelper::StridedContraction<Device, T>(
+                              ctx, inputs, input_labels, output_labels,
+                              label_types, label_to_dim_sizes, &done));
+      if (done) return;
+    }
+
     // The reduction phase (a) sums across reduction dimensions, (b) takes
     // generalized diagonals, and (c) reshapes it into shape
     //   [(broadcasting) batch shape] + [F,C]
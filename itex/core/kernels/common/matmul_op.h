@@ -27,6 +27,7 @@ limitations under the License.
 #include "itex/core/kernels/common/host_data_cache.h"
 #include "itex/core/utils/bcast.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/metrics.h"
 #include "itex/core/utils/onednn/onednn_layout_util.h"
 #include "itex/core/utils/onednn/onednn_post_op_util.h"
 #include "itex/core/utils/onednn/onednn_util.h"
@@ -253,6 +254,23 @@ class MatMulOp : public OpKernel {
         OP_REQUIRES_OK(context, context->GetAttr("leakyrelu_alpha", &alpha));
         post_op_util_.SetLeakyReluAlpha(alpha);
       }
+
+      // Per op params of generic post op chains, e.g. the bounds of `Clip`.
+      if (context->HasAttr("post_op_alphas")) {
+        std::vector<float> alphas, betas;
+        OP_REQUIRES_OK(context, context->GetAttr("post_op_alphas", &alphas));
+        OP_REQUIRES_OK(context, context->GetAttr("post_op_betas", &betas));
+        if (!alphas.empty() || !betas.empty()) {
+          OP_REQUIRES(context, post_op_util_.SetPostOpParams(alphas, betas),
+                      errors::InvalidArgument(
+                          "post_op_alphas and post_op_betas must have the ",
+                          "same size as fused_ops in Fused MatMul."));
+        }
+      }
+
+      // Binary operands follow bias and add inputs.
+      binary_start_index_ = kBiasIndex_ + (post_op_util_.HasBias() ? 1 : 0) +
+                            (post_op_util_.HasAdd() ? 1 : 0);
     }
 
     if (context->HasAttr("inplace_sum")) {
@@ -289,8 +307,13 @@ class MatMulOp : public OpKernel {
   }
 
   void InitOrSetMemory(OpKernelContext* context) {
-    if (!(enable_cache_ && is_init_ && context->is_input_same(0, input_dims_) &&
-          context->is_input_same(1, weights_dims_))) {
+    const bool hit = enable_cache_ && is_init_ &&
+                     context->is_input_same(0, input_dims_) &&
+                     context->is_input_same(1, weights_dims_);
+    if (enable_cache_ && metrics::IsEnabled()) {
+      metrics::RecordPrimitiveCacheLookup(string(this->type()), hit);
+    }
+    if (!hit) {
       Init(context);
       return;
     }
@@ -319,12 +342,16 @@ class MatMulOp : public OpKernel {
       bias_mem_.set_data_handle(context->tensor_data(kBiasIndex_));
     }
 
-    OP_REQUIRES_OK(context,
-                   context->allocate_temp(DataTypeToEnum<T>::v(),
-                                          TensorShape({scratchpad_size_}),
-                                          scratchpad_tensor_.get()));
-    scratchpad_mem_.set_data_handle(
-        GetTensorBuffer<T>(scratchpad_tensor_.get()));
+    for (size_t i = 0; i < binary_mem_.size(); ++i) {
+      binary_mem_[i].set_data_handle(
+          context->tensor_data(binary_start_index_ + i));
+    }
+
+    void* scratchpad_data = nullptr;
+    OP_REQUIRES_OK(context, AllocateScratchpad<T>(context, scratchpad_size_,
+                                                  scratchpad_tensor_.get(),
+                                                  &scratchpad_data));
+    scratchpad_mem_.set_data_handle(scratchpad_data);
 
     if (post_op_util_.HasAdd()) {
       int is_forward_success = kUnsuccess_;
@@ -489,8 +516,28 @@ class MatMulOp : public OpKernel {
       if (std::is_same<T, float>::value) {
         post_ops_attr.set_fpmath_mode(fp32_math_mode_);
       }
+      // Binary operands are broadcast to dst, so align them to the right of
+      // dst dims, e.g. [N] -> [1, N].
+      std::vector<memory::desc> binary_md_list;
+      const int dst_ndims = params->c_dims.size();
+      for (int i = 0; i < post_op_util_.GetBinaryNum(); ++i) {
+        const Tensor& binary_tensor = context->input(binary_start_index_ + i);
+        const int binary_ndims = binary_tensor.dims();
+        OP_REQUIRES(context, binary_ndims <= dst_ndims,
+                    errors::InvalidArgument(
+                        "Binary post op input can't be broadcast to output: ",
+                        binary_tensor.shape().DebugString(), " vs. ",
+                        dst_shape_.DebugString()));
+        memory::dims binary_dims(dst_ndims, 1);
+        for (int d = 0; d < binary_ndims; ++d) {
+          binary_dims[dst_ndims - binary_ndims + d] = binary_tensor.dim_size(d);
+        }
+        binary_md_list.push_back(memory::desc(binary_dims, OneDnnType<Tpost>(),
+                                              CalculateTFStrides(binary_dims)));
+      }
+
       // Set post ops attr after handling all fusions.
-      post_op_util_.SetPostOpAttr(&post_ops_attr);
+      post_op_util_.SetPostOpAttr(&post_ops_attr, binary_md_list);
 
       if (post_op_util_.HasBias()) {
         // bias use same dims as dst
@@ -592,13 +639,12 @@ class MatMulOp : public OpKernel {
         weights_mem_ = weights_mem_input_;
       }
       scratchpad_size_ = matmul_pd.scratchpad_desc().get_size() / sizeof(T);
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(DataTypeToEnum<T>::v(),
-                                            TensorShape({scratchpad_size_}),
-                                            scratchpad_tensor_.get()));
-      scratchpad_mem_ =
-          dnnl::memory(matmul_pd.scratchpad_desc(), dnnl_engine_,
-                       GetTensorBuffer<T>(scratchpad_tensor_.get()));
+      void* scratchpad_data = nullptr;
+      OP_REQUIRES_OK(context, AllocateScratchpad<T>(context, scratchpad_size_,
+                                                    scratchpad_tensor_.get(),
+                                                    &scratchpad_data));
+      scratchpad_mem_ = dnnl::memory(matmul_pd.scratchpad_desc(), dnnl_engine_,
+                                     scratchpad_data);
 
       matmul_primitive_ = dnnl::matmul(matmul_pd);
       src_mem_ = CreateDnnlMemory(src_md, dnnl_engine_,
@@ -613,6 +659,19 @@ class MatMulOp : public OpKernel {
       if (post_op_util_.HasBias()) {
         fwd_primitive_args_.emplace(DNNL_ARG_BIAS, bias_mem_);
       }
+
+      binary_mem_.clear();
+      for (int i = 0; i < post_op_util_.GetBinaryNum(); ++i) {
+        const Tensor& binary_tensor = context->input(binary_start_index_ + i);
+        binary_mem_.push_back(
+            CreateDnnlMemory(binary_md_list[i], dnnl_engine_,
+                             GetTensorBuffer<Tpost>(&binary_tensor)));
+        fwd_primitive_args_.emplace(
+            DNNL_ARG_ATTR_MULTIPLE_POST_OP(
+                post_op_util_.GetBinaryPostOpIndex(i)) |
+                DNNL_ARG_SRC_1,
+            binary_mem_[i]);
+      }
       is_init_ = true;
     } catch (dnnl::error& e) {
       string error_msg = "Status: " + std::to_string(e.status) +
@@ -635,6 +694,7 @@ class MatMulOp : public OpKernel {
 #else
     dnnl_stream_ = CreateDnnlStream(*context, dnnl_engine_);
 #endif
+    ScratchpadArena::Scope scratchpad_scope;
     scratchpad_tensor_ = std::make_shared<Tensor>();
     InitOrSetMemory(context);
 
@@ -659,6 +719,7 @@ class MatMulOp : public OpKernel {
   bool is_input_zero_ = false;
   static const int kSrcIndex_ = 0, kDstIndex_ = 0, kWeightIndex_ = 1,
                    kBiasIndex_ = 2, kAddIndex_ = 3, kUnsuccess_ = -1;
+  int binary_start_index_ = kBiasIndex_;
   OneDnnShape weights_onednn_shape_;
 
   // Fusion util.
@@ -676,6 +737,7 @@ class MatMulOp : public OpKernel {
   std::unordered_map<int, memory> fwd_primitive_args_;
   memory src_mem_, weights_mem_, weights_mem_input_, dst_mem_, bias_mem_,
       add_mem_, fuse_add_src_mem_, fuse_add_dst_mem_, scratchpad_mem_;
+  std::vector<memory> binary_mem_;
   dnnl::matmul matmul_primitive_;
   Tensor* dst_tensor_;
   const Tensor* add_tensor_;
@@ -15,6 +15,12 @@ limitations under the License.
 
 #include "itex/core/kernels/common/transpose_functor.h"
 
+#if defined(INTEL_CPU_ONLY) && defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
 #include "itex/core/utils/gtl/array_slice.h"
 #include "itex/core/utils/gtl/inlined_vector.h"
 #include "itex/core/utils/plugin_tensor.h"
@@ -52,31 +58,296 @@ namespace internal {
                                            out);                            \
   }
 
+#ifdef INTEL_CPU_ONLY
+// Transposes a kSize x kSize tile: dst[c * ldd + r] = src[r * lds + c].
+// Elements are only moved, so the kernels are picked by element size.
+template <typename T>
+struct TileTranspose {
+  static constexpr int kSize = 8;
+  static inline void Run(const T* src, int64 lds, T* dst, int64 ldd) {
+    for (int r = 0; r < kSize; ++r) {
+      for (int c = 0; c < kSize; ++c) dst[c * ldd + r] = src[r * lds + c];
+    }
+  }
+};
+
+#if defined(__AVX512F__)
+template <>
+struct TileTranspose<uint32> {
+  static constexpr int kSize = 16;
+  static inline void Run(const uint32* src, int64 lds, uint32* dst,
+                         int64 ldd) {
+    const float* in = reinterpret_cast<const float*>(src);
+    float* out = reinterpret_cast<float*>(dst);
+    __m512 r[16], t[16];
+    for (int i = 0; i < 16; ++i) r[i] = _mm512_loadu_ps(in + i * lds);
+    for (int i = 0; i < 16; i += 2) {
+      t[i] = _mm512_unpacklo_ps(r[i], r[i + 1]);
+      t[i + 1] = _mm512_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 16; i += 4) {
+      r[i] = _mm512_shuffle_ps(t[i], t[i + 2], 0x44);
+      r[i + 1] = _mm512_shuffle_ps(t[i], t[i + 2], 0xee);
+      r[i + 2] = _mm512_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+      r[i + 3] = _mm512_shuffle_ps(t[i + 1], t[i + 3], 0xee);
+    }
+    for (int h = 0; h < 16; h += 8) {
+      for (int i = h; i < h + 4; ++i) {
+        t[i] = _mm512_shuffle_f32x4(r[i], r[i + 4], 0x88);
+        t[i + 4] = _mm512_shuffle_f32x4(r[i], r[i + 4], 0xdd);
+      }
+    }
+    for (int i = 0; i < 8; ++i) {
+      r[i] = _mm512_shuffle_f32x4(t[i], t[i + 8], 0x88);
+      r[i + 8] = _mm512_shuffle_f32x4(t[i], t[i + 8], 0xdd);
+    }
+    for (int i = 0; i < 16; ++i) _mm512_storeu_ps(out + i * ldd, r[i]);
+  }
+};
+#elif defined(__AVX2__)
+template <>
+struct TileTranspose<uint32> {
+  static constexpr int kSize = 8;
+  static inline void Run(const uint32* src, int64 lds, uint32* dst,
+                         int64 ldd) {
+    const float* in = reinterpret_cast<const float*>(src);
+    float* out = reinterpret_cast<float*>(dst);
+    __m256 r[8], t[8];
+    for (int i = 0; i < 8; ++i) r[i] = _mm256_loadu_ps(in + i * lds);
+    for (int i = 0; i < 8; i += 2) {
+      t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+      t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+      r[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+      r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xee);
+      r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+      r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xee);
+    }
+    for (int i = 0; i < 4; ++i) {
+      t[i] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x20);
+      t[i + 4] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x31);
+    }
+    for (int i = 0; i < 8; ++i) _mm256_storeu_ps(out + i * ldd, t[i]);
+  }
+};
+#endif  // __AVX512F__
+
+#ifdef __AVX2__
+template <>
+struct TileTranspose<uint64> {
+  static constexpr int kSize = 4;
+  static inline void Run(const uint64* src, int64 lds, uint64* dst,
+                         int64 ldd) {
+    const double* in = reinterpret_cast<const double*>(src);
+    double* out = reinterpret_cast<double*>(dst);
+    __m256d r[4], t[4];
+    for (int i = 0; i < 4; ++i) r[i] = _mm256_loadu_pd(in + i * lds);
+    t[0] = _mm256_unpacklo_pd(r[0], r[1]);
+    t[1] = _mm256_unpackhi_pd(r[0], r[1]);
+    t[2] = _mm256_unpacklo_pd(r[2], r[3]);
+    t[3] = _mm256_unpackhi_pd(r[2], r[3]);
+    _mm256_storeu_pd(out, _mm256_permute2f128_pd(t[0], t[2], 0x20));
+    _mm256_storeu_pd(out + ldd, _mm256_permute2f128_pd(t[1], t[3], 0x20));
+    _mm256_storeu_pd(out + 2 * ldd, _mm256_permute2f128_pd(t[0], t[2], 0x31));
+    _mm256_storeu_pd(out + 3 * ldd, _mm256_permute2f128_pd(t[1], t[3], 0x31));
+  }
+};
+#endif  // __AVX2__
+
+#ifdef __SSE2__
+template <>
+struct TileTranspose<uint16> {
+  static constexpr int kSize = 8;
+  static inline void Run(const uint16* src, int64 lds, uint16* dst,
+                         int64 ldd) {
+    __m128i r[8], t[8];
+    for (int i = 0; i < 8; ++i) {
+      r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * lds));
+    }
+    for (int i = 0; i < 8; i += 2) {
+      t[i] = _mm_unpacklo_epi16(r[i], r[i + 1]);
+      t[i + 1] = _mm_unpackhi_epi16(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+      r[i] = _mm_unpacklo_epi32(t[i], t[i + 2]);
+      r[i + 1] = _mm_unpackhi_epi32(t[i], t[i + 2]);
+      r[i + 2] = _mm_unpacklo_epi32(t[i + 1], t[i + 3]);
+      r[i + 3] = _mm_unpackhi_epi32(t[i + 1], t[i + 3]);
+    }
+    for (int i = 0; i < 4; ++i) {
+      t[2 * i] = _mm_unpacklo_epi64(r[i], r[i + 4]);
+      t[2 * i + 1] = _mm_unpackhi_epi64(r[i], r[i + 4]);
+    }
+    for (int i = 0; i < 8; ++i) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * ldd), t[i]);
+    }
+  }
+};
+#endif  // __SSE2__
+
+// Rows and columns of the 2-D blocks handled by one task.
+constexpr int64 kTransposeBlock = 64;
+
+// dst[c * ldd + r] = src[r * lds + c] for r < rows, c < cols, walking
+// cache-sized blocks so both sides stay resident.
+template <typename T>
+void Transpose2D(const T* src, int64 lds, T* dst, int64 ldd, int64 rows,
+                 int64 cols) {
+  constexpr int kTile = TileTranspose<T>::kSize;
+  for (int64 c0 = 0; c0 < cols; c0 += kTransposeBlock) {
+    const int64 c1 = std::min(c0 + kTransposeBlock, cols);
+    int64 r = 0;
+    for (; r + kTile <= rows; r += kTile) {
+      int64 c = c0;
+      for (; c + kTile <= c1; c += kTile) {
+        TileTranspose<T>::Run(src + r * lds + c, lds, dst + c * ldd + r, ldd);
+      }
+      for (; c < c1; ++c) {
+        for (int i = 0; i < kTile; ++i) {
+          dst[c * ldd + r + i] = src[(r + i) * lds + c];
+        }
+      }
+    }
+    for (; r < rows; ++r) {
+      for (int64 c = c0; c < c1; ++c) dst[c * ldd + r] = src[r * lds + c];
+    }
+  }
+}
+
+// Transposes on CPU following a canonical plan. Copies are done with memcpy,
+// a kept innermost dim is copied row by row, and the rest goes through the
+// tiled 2-D kernel over the innermost dims of the input and output.
+template <typename T>
+void TransposeOnCpu(const CPUDevice& d, const T* in, const TransposePlan& plan,
+                    T* out) {
+  const int rank = plan.dims.size();
+  int64 num_elements = 1;
+  for (int64 dim : plan.dims) num_elements *= dim;
+  if (num_elements == 0) return;
+
+  if (rank < 2) {
+    d.parallelFor(num_elements,
+                  Eigen::TensorOpCost(sizeof(T), sizeof(T), 0),
+                  [in, out](int64 first, int64 last) {
+                    std::copy(in + first, in + last, out + first);
+                  });
+    return;
+  }
+
+  // Input strides, and the output stride of every input dim.
+  TransposeDimsVec in_strides(rank), out_strides(rank);
+  in_strides[rank - 1] = 1;
+  for (int i = rank - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * plan.dims[i + 1];
+  }
+  int64 stride = 1;
+  for (int i = rank - 1; i >= 0; --i) {
+    out_strides[plan.perm[i]] = stride;
+    stride *= plan.dims[plan.perm[i]];
+  }
+
+  if (plan.perm[rank - 1] == rank - 1) {
+    // Rows of the innermost dim are copied whole, in output order.
+    const int64 row = plan.dims[rank - 1];
+    d.parallelFor(
+        num_elements / row,
+        Eigen::TensorOpCost(row * sizeof(T), row * sizeof(T), 0),
+        [&](int64 first, int64 last) {
+          for (int64 r = first; r < last; ++r) {
+            int64 index = r, in_offset = 0;
+            for (int i = rank - 2; i >= 0; --i) {
+              const int64 dim = plan.dims[plan.perm[i]];
+              in_offset += (index % dim) * in_strides[plan.perm[i]];
+              index /= dim;
+            }
+            std::copy(in + in_offset, in + in_offset + row, out + r * row);
+          }
+        });
+    return;
+  }
+
+  // The output innermost dim `p` and the input innermost dim form planes
+  // transposed by tiles. Tasks are row blocks of the planes.
+  const int p = plan.perm[rank - 1];
+  const int64 rows = plan.dims[p];
+  const int64 cols = plan.dims[rank - 1];
+  const int64 lds = in_strides[p];
+  const int64 ldd = out_strides[rank - 1];
+  const int64 row_blocks = (rows + kTransposeBlock - 1) / kTransposeBlock;
+  const int64 num_planes = num_elements / (rows * cols);
+  const int64 block_bytes = kTransposeBlock * cols * sizeof(T);
+  d.parallelFor(
+      num_planes * row_blocks, Eigen::TensorOpCost(block_bytes, block_bytes, 0),
+      [&](int64 first, int64 last) {
+        for (int64 task = first; task < last; ++task) {
+          int64 plane = task / row_blocks;
+          const int64 r0 = (task % row_blocks) * kTransposeBlock;
+          int64 in_offset = r0 * lds, out_offset = r0;
+          for (int i = rank - 2; i >= 0; --i) {
+            if (i == p) continue;
+            in_offset += (plane % plan.dims[i]) * in_strides[i];
+            out_offset += (plane % plan.dims[i]) * out_strides[i];
+            plane /= plan.dims[i];
+          }
+          Transpose2D(in + in_offset, lds, out + out_offset, ldd,
+                      std::min(kTransposeBlock, rows - r0), cols);
+        }
+      });
+}
+#endif  // INTEL_CPU_ONLY
+
 template <typename Device, typename T>
 void TransposeOnDevice(const Device& d, const Tensor& in,
                        const gtl::ArraySlice<int32> perm, bool conjugate,
                        Tensor* out) {
-  switch (in.dims()) {
+  TransposePlan plan = PlanTranspose(in.shape(), perm);
+  if (plan.dims.empty()) {
+    plan.dims.push_back(1);
+    plan.perm.push_back(0);
+  }
+  const T* src = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* dst = reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data()));
+
+#ifdef INTEL_CPU_ONLY
+  if (!conjugate) {
+    TransposeOnCpu<T>(d, src, plan, dst);
+    return;
+  }
+#endif  // INTEL_CPU_ONLY
+
+  switch (plan.dims.size()) {
+    case 1:
+      TransposeUsingEigen<Device, T, 1>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
+      break;
     case 2:
-      TransposeUsingEigen<Device, T, 2>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 2>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     case 3:
-      TransposeUsingEigen<Device, T, 3>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 3>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     case 4:
-      TransposeUsingEigen<Device, T, 4>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 4>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     case 5:
-      TransposeUsingEigen<Device, T, 5>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 5>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     case 6:
-      TransposeUsingEigen<Device, T, 6>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 6>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     case 7:
-      TransposeUsingEigen<Device, T, 7>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 7>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     case 8:
-      TransposeUsingEigen<Device, T, 8>(d, in, perm, conjugate, out);
+      TransposeUsingEigen<Device, T, 8>(d, src, plan.dims, plan.perm,
+                                        conjugate, dst);
       break;
     default:
       ITEX_CHECK(false);
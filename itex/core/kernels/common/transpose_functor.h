@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ITEX_CORE_KERNELS_COMMON_TRANSPOSE_FUNCTOR_H_
 #define ITEX_CORE_KERNELS_COMMON_TRANSPOSE_FUNCTOR_H_
 
+#include <algorithm>
 #include <numeric>
 #include <string>
 #include <utility>
@@ -95,6 +96,57 @@ inline bool NonSingletonDimensionsAlign(const TensorShape& input_shape,
   return true;
 }
 
+// Canonical form of a transpose. Dims of size 1 are dropped and runs of input
+// dims that stay adjacent and in order in the output are merged, so e.g. an
+// NHWC -> NCHW transpose becomes [N, HW, C] with perm [0, 2, 1]. `dims` are
+// the merged input dims, `perm` permutes them. A rank below 2 means the
+// transpose is a plain copy.
+struct TransposePlan {
+  TransposeDimsVec dims;
+  TransposePermsVec perm;
+};
+
+inline TransposePlan PlanTranspose(const TensorShape& in_shape,
+                                   const gtl::ArraySlice<int32> perm) {
+  const int rank = in_shape.dims();
+  TransposeDimsVec dims;
+  gtl::InlinedVector<int, 8> squeezed(rank, -1);
+  for (int i = 0; i < rank; ++i) {
+    if (in_shape.dim_size(i) == 1) continue;
+    squeezed[i] = dims.size();
+    dims.push_back(in_shape.dim_size(i));
+  }
+
+  // Runs of consecutive input dims in output order, as [first, last].
+  gtl::InlinedVector<std::pair<int, int>, 8> runs;
+  for (int i = 0; i < rank; ++i) {
+    const int d = squeezed[perm[i]];
+    if (d < 0) continue;
+    if (!runs.empty() && runs.back().second + 1 == d) {
+      runs.back().second = d;
+    } else {
+      runs.push_back({d, d});
+    }
+  }
+
+  // Merged dims are numbered by the input order of their runs.
+  gtl::InlinedVector<int, 8> order(runs.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&runs](int a, int b) {
+    return runs[a].first < runs[b].first;
+  });
+  TransposePlan plan;
+  plan.perm.resize(runs.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    const auto& run = runs[order[i]];
+    int64 size = 1;
+    for (int d = run.first; d <= run.second; ++d) size *= dims[d];
+    plan.dims.push_back(size);
+    plan.perm[order[i]] = i;
+  }
+  return plan;
+}
+
 // Uses Eigen to transpose.
 template <typename Device, typename T, int NDIMS>
 void TransposeUsingEigen(const Device& d, const Tensor& in,
@@ -115,6 +167,28 @@ void TransposeUsingEigen(const Device& d, const Tensor& in,
   }
 }
 
+// Uses Eigen to transpose raw buffers with `in_dims` by `perm`.
+template <typename Device, typename T, int NDIMS>
+void TransposeUsingEigen(const Device& d, const T* in,
+                         const TransposeDimsVec& in_dims,
+                         const TransposePermsVec& perm, bool conjugate,
+                         T* out) {
+  Eigen::array<int, NDIMS> p;
+  Eigen::DSizes<Eigen::DenseIndex, NDIMS> in_sizes, out_sizes;
+  for (int i = 0; i < NDIMS; ++i) {
+    p[i] = perm[i];
+    in_sizes[i] = in_dims[i];
+    out_sizes[i] = in_dims[perm[i]];
+  }
+  auto x = typename TTypes<T, NDIMS>::ConstTensor(in, in_sizes);
+  auto y = typename TTypes<T, NDIMS>::Tensor(out, out_sizes);
+  if (conjugate) {
+    y.device(d) = x.conjugate().shuffle(p);
+  } else {
+    y.device(d) = x.shuffle(p);
+  }
+}
+
 template <typename Device>
 Status DoTransposeImpl(const Device& d, const Tensor& in,
                        const gtl::ArraySlice<int32> perm, bool conjugate,
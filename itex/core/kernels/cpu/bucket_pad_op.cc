@@ -0,0 +1,235 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+constexpr int kMaxBucketDims = 6;
+
+// Returns the smallest bucket that fits `size`, or the next multiple of the
+// largest bucket. Sizes 0 and 1 are kept, since they may be broadcast.
+int64 BucketSize(const std::vector<int64>& buckets, int64 size) {
+  if (size <= 1) return size;
+  for (int64 bucket : buckets) {
+    if (bucket >= size) return bucket;
+  }
+  const int64 largest = buckets.back();
+  return (size + largest - 1) / largest * largest;
+}
+
+Status ValidateAxes(const std::vector<int64>& axes, int dims) {
+  if (dims > kMaxBucketDims) {
+    return errors::Unimplemented("Inputs of rank ", dims,
+                                 " are not supported, at most ",
+                                 kMaxBucketDims);
+  }
+  for (int64 axis : axes) {
+    if (axis < 0 || axis >= dims) {
+      return errors::InvalidArgument("Axis ", axis,
+                                     " is out of range for rank ", dims);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+// Pads `axes` of the input up to their bucket, so that the ops reading the
+// result only ever see a few distinct shapes.
+template <typename Device, typename T>
+class BucketPadOp : public OpKernel {
+ public:
+  explicit BucketPadOp(OpKernelConstruction* context) : OpKernel(context) {
+    string padding;
+    OP_REQUIRES_OK(context, context->GetAttr("axes", &axes_));
+    OP_REQUIRES_OK(context, context->GetAttr("buckets", &buckets_));
+    OP_REQUIRES_OK(context, context->GetAttr("padding", &padding));
+    OP_REQUIRES(context, !buckets_.empty(),
+                errors::InvalidArgument("buckets must not be empty"));
+    std::sort(buckets_.begin(), buckets_.end());
+    OP_REQUIRES(context, buckets_.front() > 0,
+                errors::InvalidArgument("buckets must be positive, got ",
+                                        buckets_.front()));
+    pad_value_ = padding == "lowest" ? Eigen::NumTraits<T>::lowest() : T(0);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    OP_REQUIRES_OK(context, ValidateAxes(axes_, input.dims()));
+
+    TensorShape output_shape = input.shape();
+    bool padded = false;
+    for (int64 axis : axes_) {
+      const int64 size = input.dim_size(axis);
+      const int64 bucket = BucketSize(buckets_, size);
+      if (bucket == size) continue;
+      output_shape.set_dim(axis, bucket);
+      padded = true;
+    }
+    if (!padded) {
+      context->set_output(0, input);
+      return;
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    switch (input.dims()) {
+#define BUCKET_PAD_CASE(NDIMS)              \
+  case NDIMS:                               \
+    Pad<NDIMS>(context, input, output);     \
+    break;
+      BUCKET_PAD_CASE(1);
+      BUCKET_PAD_CASE(2);
+      BUCKET_PAD_CASE(3);
+      BUCKET_PAD_CASE(4);
+      BUCKET_PAD_CASE(5);
+      BUCKET_PAD_CASE(6);
+#undef BUCKET_PAD_CASE
+      default:
+        break;
+    }
+  }
+
+ private:
+  template <int NDIMS>
+  void Pad(OpKernelContext* context, const Tensor& input, Tensor* output) {
+    Eigen::array<Eigen::IndexPair<int64>, NDIMS> paddings;
+    for (int i = 0; i < NDIMS; ++i) {
+      paddings[i] = {0, output->dim_size(i) - input.dim_size(i)};
+    }
+    output->tensor<T, NDIMS>().device(context->eigen_device<Device>()) =
+        input.tensor<T, NDIMS>().pad(paddings, pad_value_);
+  }
+
+  std::vector<int64> axes_;
+  std::vector<int64> buckets_;
+  T pad_value_;
+};
+
+// Slices the result of an op that read bucket-padded inputs back to the sizes
+// of the original inputs.
+template <typename Device, typename T>
+class BucketSliceOp : public OpKernel {
+ public:
+  explicit BucketSliceOp(OpKernelConstruction* context) : OpKernel(context) {
+    int num_likes = 0;
+    OP_REQUIRES_OK(context, context->GetAttr("N", &num_likes));
+    OP_REQUIRES_OK(context, context->GetAttr("axes", &axes_));
+    OP_REQUIRES_OK(context, context->GetAttr("like_axes", &like_axes_));
+    OP_REQUIRES(context,
+                axes_.size() == static_cast<size_t>(num_likes) &&
+                    like_axes_.size() == axes_.size(),
+                errors::InvalidArgument(
+                    "axes and like_axes must have one entry per like, got ",
+                    axes_.size(), " and ", like_axes_.size(), " for ",
+                    num_likes, " likes"));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    OP_REQUIRES_OK(context, ValidateAxes(axes_, input.dims()));
+
+    TensorShape output_shape = input.shape();
+    bool sliced = false;
+    for (size_t i = 0; i < axes_.size(); ++i) {
+      const Tensor& like = context->input(i + 1);
+      OP_REQUIRES(context, like_axes_[i] >= 0 && like_axes_[i] < like.dims(),
+                  errors::InvalidArgument("Like axis ", like_axes_[i],
+                                          " is out of range for rank ",
+                                          like.dims()));
+      const int64 size = like.dim_size(like_axes_[i]);
+      const int64 padded_size = input.dim_size(axes_[i]);
+      OP_REQUIRES(context, size <= padded_size,
+                  errors::InvalidArgument("Cannot slice axis ", axes_[i],
+                                          " of size ", padded_size, " to ",
+                                          size));
+      if (size == padded_size) continue;
+      output_shape.set_dim(axes_[i], size);
+      sliced = true;
+    }
+    if (!sliced) {
+      context->set_output(0, input);
+      return;
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output_shape.num_elements() == 0) return;
+    switch (input.dims()) {
+#define BUCKET_SLICE_CASE(NDIMS)            \
+  case NDIMS:                               \
+    Slice<NDIMS>(context, input, output);   \
+    break;
+      BUCKET_SLICE_CASE(1);
+      BUCKET_SLICE_CASE(2);
+      BUCKET_SLICE_CASE(3);
+      BUCKET_SLICE_CASE(4);
+      BUCKET_SLICE_CASE(5);
+      BUCKET_SLICE_CASE(6);
+#undef BUCKET_SLICE_CASE
+      default:
+        break;
+    }
+  }
+
+ private:
+  template <int NDIMS>
+  void Slice(OpKernelContext* context, const Tensor& input, Tensor* output) {
+    Eigen::DSizes<Eigen::DenseIndex, NDIMS> offsets;
+    Eigen::DSizes<Eigen::DenseIndex, NDIMS> sizes;
+    for (int i = 0; i < NDIMS; ++i) {
+      offsets[i] = 0;
+      sizes[i] = output->dim_size(i);
+    }
+    output->tensor<T, NDIMS>().device(context->eigen_device<Device>()) =
+        input.tensor<T, NDIMS>().slice(offsets, sizes);
+  }
+
+  std::vector<int64> axes_;
+  std::vector<int64> like_axes_;
+};
+
+#define REGISTER_BUCKET_KERNELS(TYPE)                                         \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_ITEXBucketPad").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"),   \
+      BucketPadOp<CPUDevice, TYPE>);                                          \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_ITEXBucketSlice").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"), \
+      BucketSliceOp<CPUDevice, TYPE>);
+
+TF_CALL_float(REGISTER_BUCKET_KERNELS);
+TF_CALL_bfloat16(REGISTER_BUCKET_KERNELS);
+TF_CALL_half(REGISTER_BUCKET_KERNELS);
+#undef REGISTER_BUCKET_KERNELS
+
+}  // namespace itex
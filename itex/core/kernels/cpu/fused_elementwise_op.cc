@@ -0,0 +1,467 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/gtl/inlined_vector.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class ElementwiseOp {
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kSquaredDifference,
+  kGreater,
+  kGreaterEqual,
+  kLess,
+  kLessEqual,
+  kEqual,
+  kNotEqual,
+  kLogicalAnd,
+  kLogicalOr,
+  kAbs,
+  kCast,
+  kExp,
+  kLog,
+  kLogicalNot,
+  kNeg,
+  kReciprocal,
+  kRelu,
+  kRelu6,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+};
+
+struct ElementwiseOpInfo {
+  const char* name;
+  ElementwiseOp op;
+  int arity;
+};
+
+// Ops accepted in `fused_ops`. Must be kept in sync with the remapper's
+// `IsFusableElementwise`.
+constexpr ElementwiseOpInfo kElementwiseOps[] = {
+    {"Add", ElementwiseOp::kAdd, 2},
+    {"AddV2", ElementwiseOp::kAdd, 2},
+    {"Sub", ElementwiseOp::kSub, 2},
+    {"Mul", ElementwiseOp::kMul, 2},
+    {"RealDiv", ElementwiseOp::kDiv, 2},
+    {"Maximum", ElementwiseOp::kMaximum, 2},
+    {"Minimum", ElementwiseOp::kMinimum, 2},
+    {"SquaredDifference", ElementwiseOp::kSquaredDifference, 2},
+    {"Greater", ElementwiseOp::kGreater, 2},
+    {"GreaterEqual", ElementwiseOp::kGreaterEqual, 2},
+    {"Less", ElementwiseOp::kLess, 2},
+    {"LessEqual", ElementwiseOp::kLessEqual, 2},
+    {"Equal", ElementwiseOp::kEqual, 2},
+    {"NotEqual", ElementwiseOp::kNotEqual, 2},
+    {"_ITEXGreaterWithCast", ElementwiseOp::kGreater, 2},
+    {"_ITEXGreaterEqualWithCast", ElementwiseOp::kGreaterEqual, 2},
+    {"_ITEXLessWithCast", ElementwiseOp::kLess, 2},
+    {"_ITEXLessEqualWithCast", ElementwiseOp::kLessEqual, 2},
+    {"_ITEXEqualWithCast", ElementwiseOp::kEqual, 2},
+    {"_ITEXNotEqualWithCast", ElementwiseOp::kNotEqual, 2},
+    {"LogicalAnd", ElementwiseOp::kLogicalAnd, 2},
+    {"LogicalOr", ElementwiseOp::kLogicalOr, 2},
+    {"Abs", ElementwiseOp::kAbs, 1},
+    {"Cast", ElementwiseOp::kCast, 1},
+    {"Exp", ElementwiseOp::kExp, 1},
+    {"Log", ElementwiseOp::kLog, 1},
+    {"LogicalNot", ElementwiseOp::kLogicalNot, 1},
+    {"Neg", ElementwiseOp::kNeg, 1},
+    {"Reciprocal", ElementwiseOp::kReciprocal, 1},
+    {"Relu", ElementwiseOp::kRelu, 1},
+    {"Relu6", ElementwiseOp::kRelu6, 1},
+    {"Rsqrt", ElementwiseOp::kRsqrt, 1},
+    {"Sigmoid", ElementwiseOp::kSigmoid, 1},
+    {"Sqrt", ElementwiseOp::kSqrt, 1},
+    {"Square", ElementwiseOp::kSquare, 1},
+    {"Tanh", ElementwiseOp::kTanh, 1},
+};
+
+// One step of the fused program. Operands `< num_args` refer to op inputs,
+// the others to the result of step `operand - num_args`.
+struct Instruction {
+  ElementwiseOp op;
+  int lhs;
+  int rhs;
+};
+
+using Array = Eigen::Array<float, Eigen::Dynamic, 1>;
+using ArrayMap = Eigen::Map<Array>;
+using ConstArrayMap = Eigen::Map<const Array>;
+
+// Evaluates one instruction on a tile. Booleans are carried as 0/1, so the
+// only supported Cast (bool or T to T) is an identity.
+void EvalInstruction(const Instruction& inst, const float* lhs,
+                     const float* rhs, int64 len, float* dst) {
+  ConstArrayMap x(lhs, len);
+  ArrayMap y(dst, len);
+  switch (inst.op) {
+    case ElementwiseOp::kAbs:
+      y = x.abs();
+      return;
+    case ElementwiseOp::kCast:
+      y = x;
+      return;
+    case ElementwiseOp::kExp:
+      y = x.exp();
+      return;
+    case ElementwiseOp::kLog:
+      y = x.log();
+      return;
+    case ElementwiseOp::kLogicalNot:
+      y = (x == 0.0f).cast<float>();
+      return;
+    case ElementwiseOp::kNeg:
+      y = -x;
+      return;
+    case ElementwiseOp::kReciprocal:
+      y = x.inverse();
+      return;
+    case ElementwiseOp::kRelu:
+      y = x.max(0.0f);
+      return;
+    case ElementwiseOp::kRelu6:
+      y = x.max(0.0f).min(6.0f);
+      return;
+    case ElementwiseOp::kRsqrt:
+      y = x.rsqrt();
+      return;
+    case ElementwiseOp::kSigmoid:
+      y = ((-x).exp() + 1.0f).inverse();
+      return;
+    case ElementwiseOp::kSqrt:
+      y = x.sqrt();
+      return;
+    case ElementwiseOp::kSquare:
+      y = x.square();
+      return;
+    case ElementwiseOp::kTanh:
+      y = x.tanh();
+      return;
+    default:
+      break;
+  }
+
+  ConstArrayMap z(rhs, len);
+  switch (inst.op) {
+    case ElementwiseOp::kAdd:
+      y = x + z;
+      break;
+    case ElementwiseOp::kSub:
+      y = x - z;
+      break;
+    case ElementwiseOp::kMul:
+      y = x * z;
+      break;
+    case ElementwiseOp::kDiv:
+      y = x / z;
+      break;
+    case ElementwiseOp::kMaximum:
+      y = x.max(z);
+      break;
+    case ElementwiseOp::kMinimum:
+      y = x.min(z);
+      break;
+    case ElementwiseOp::kSquaredDifference:
+      y = (x - z).square();
+      break;
+    case ElementwiseOp::kGreater:
+      y = (x > z).cast<float>();
+      break;
+    case ElementwiseOp::kGreaterEqual:
+      y = (x >= z).cast<float>();
+      break;
+    case ElementwiseOp::kLess:
+      y = (x < z).cast<float>();
+      break;
+    case ElementwiseOp::kLessEqual:
+      y = (x <= z).cast<float>();
+      break;
+    case ElementwiseOp::kEqual:
+      y = (x == z).cast<float>();
+      break;
+    case ElementwiseOp::kNotEqual:
+      y = (x != z).cast<float>();
+      break;
+    case ElementwiseOp::kLogicalAnd:
+      y = ((x != 0.0f) && (z != 0.0f)).cast<float>();
+      break;
+    case ElementwiseOp::kLogicalOr:
+      y = ((x != 0.0f) || (z != 0.0f)).cast<float>();
+      break;
+    default:
+      ITEX_LOG(FATAL) << "Unexpected fused elementwise op.";
+  }
+}
+
+// An input viewed in the (collapsed) output shape: broadcast dimensions have
+// stride 0.
+template <typename T>
+struct BroadcastOperand {
+  const T* data;
+  gtl::InlinedVector<int64, 8> strides;
+  bool contiguous;
+  bool scalar;
+};
+
+// Converts output elements [start, start + len) of `operand` to float.
+template <typename T>
+void LoadTile(const BroadcastOperand<T>& operand,
+              const gtl::InlinedVector<int64, 8>& dims, int64 start,
+              int64 len, float* dst) {
+  if (operand.scalar) {
+    std::fill_n(dst, len, static_cast<float>(operand.data[0]));
+    return;
+  }
+  if (operand.contiguous) {
+    const T* src = operand.data + start;
+    for (int64 i = 0; i < len; ++i) dst[i] = static_cast<float>(src[i]);
+    return;
+  }
+  // Walk the output index space row by row, starting from the coordinate of
+  // `start`.
+  const int ndims = dims.size();
+  gtl::InlinedVector<int64, 8> coord(ndims);
+  int64 offset = 0;
+  int64 rest = start;
+  for (int d = ndims - 1; d >= 0; --d) {
+    coord[d] = rest % dims[d];
+    rest /= dims[d];
+    offset += coord[d] * operand.strides[d];
+  }
+  const int64 inner_dim = dims[ndims - 1];
+  const int64 inner_stride = operand.strides[ndims - 1];
+  int64 done = 0;
+  while (done < len) {
+    const int64 count = std::min(len - done, inner_dim - coord[ndims - 1]);
+    const T* src = operand.data + offset;
+    if (inner_stride == 0) {
+      std::fill_n(dst + done, count, static_cast<float>(src[0]));
+    } else {
+      for (int64 i = 0; i < count; ++i) {
+        dst[done + i] = static_cast<float>(src[i]);
+      }
+    }
+    done += count;
+    if (done == len) break;
+    // Rewind to the start of the row and carry into the outer dimensions.
+    offset -= coord[ndims - 1] * inner_stride;
+    coord[ndims - 1] = 0;
+    for (int d = ndims - 2; d >= 0; --d) {
+      offset += operand.strides[d];
+      if (++coord[d] < dims[d]) break;
+      offset -= dims[d] * operand.strides[d];
+      coord[d] = 0;
+    }
+  }
+}
+
+}  // namespace
+
+// Evaluates a DAG of elementwise ops, given as a topologically ordered
+// program in `fused_ops` and `operands`, in a single pass over memory. Inputs
+// are broadcast with NumPy semantics to the common output shape. The output
+// is split into tiles sized so that the intermediate values of a tile stay in
+// L1, and every instruction runs as a vectorized Eigen array expression on
+// the whole tile.
+template <typename Device, typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    std::vector<int> operands;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands));
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args_));
+    OP_REQUIRES(context,
+                !fused_ops.empty() && operands.size() == 2 * fused_ops.size(),
+                errors::InvalidArgument(
+                    "operands must hold 2 entries per fused op, got ",
+                    operands.size(), " for ", fused_ops.size(), " ops."));
+
+    for (size_t i = 0; i < fused_ops.size(); ++i) {
+      const ElementwiseOpInfo* info = nullptr;
+      for (const auto& candidate : kElementwiseOps) {
+        if (fused_ops[i] == candidate.name) info = &candidate;
+      }
+      OP_REQUIRES(context, info != nullptr,
+                  errors::Unimplemented("Unsupported fused elementwise op: ",
+                                        fused_ops[i]));
+      const int num_values = num_args_ + i;
+      const int lhs = operands[2 * i];
+      const int rhs = operands[2 * i + 1];
+      OP_REQUIRES(context,
+                  lhs >= 0 && lhs < num_values &&
+                      (info->arity == 1 ? rhs == -1
+                                        : rhs >= 0 && rhs < num_values),
+                  errors::InvalidArgument("Invalid operands for fused op ", i,
+                                          " (", fused_ops[i], "): ", lhs, ", ",
+                                          rhs));
+      program_.push_back({info->op, lhs, rhs});
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // Broadcast all the input shapes, aligned to the innermost dimension.
+    int out_rank = 0;
+    for (int i = 0; i < num_args_; ++i) {
+      out_rank = std::max(out_rank, context->input(i).dims());
+    }
+    gtl::InlinedVector<int64, 8> out_dims(out_rank, 1);
+    for (int i = 0; i < num_args_; ++i) {
+      const TensorShape& shape = context->input(i).shape();
+      const int offset = out_rank - shape.dims();
+      for (int d = 0; d < shape.dims(); ++d) {
+        const int64 dim = shape.dim_size(d);
+        int64& out_dim = out_dims[offset + d];
+        OP_REQUIRES(context, dim == out_dim || dim == 1 || out_dim == 1,
+                    errors::InvalidArgument(
+                        "Incompatible shapes for fused elementwise op: ",
+                        shape.DebugString(), " at input ", i));
+        if (out_dim == 1) out_dim = dim;
+      }
+    }
+    TensorShape output_shape;
+    for (int64 dim : out_dims) output_shape.AddDim(dim);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    const int64 num_elements = output_shape.num_elements();
+    if (num_elements == 0) return;
+
+    // Collapse adjacent dimensions that every input either fully covers or
+    // fully broadcasts, leaving the minimal index space for strided loads.
+    gtl::InlinedVector<int64, 8> dims;
+    gtl::InlinedVector<gtl::InlinedVector<bool, 8>, 4> bcast(num_args_);
+    for (int d = 0; d < out_rank; ++d) {
+      if (out_dims[d] == 1) continue;
+      gtl::InlinedVector<bool, 4> is_bcast(num_args_);
+      for (int i = 0; i < num_args_; ++i) {
+        const TensorShape& shape = context->input(i).shape();
+        const int in_d = d - (out_rank - shape.dims());
+        is_bcast[i] = in_d < 0 || shape.dim_size(in_d) == 1;
+      }
+      bool merge = !dims.empty();
+      for (int i = 0; merge && i < num_args_; ++i) {
+        merge = bcast[i].back() == is_bcast[i];
+      }
+      if (merge) {
+        dims.back() *= out_dims[d];
+      } else {
+        dims.push_back(out_dims[d]);
+        for (int i = 0; i < num_args_; ++i) bcast[i].push_back(is_bcast[i]);
+      }
+    }
+    if (dims.empty()) {
+      dims.push_back(1);
+      for (int i = 0; i < num_args_; ++i) bcast[i].push_back(true);
+    }
+
+    std::vector<BroadcastOperand<T>> operands(num_args_);
+    for (int i = 0; i < num_args_; ++i) {
+      const Tensor& input = context->input(i);
+      BroadcastOperand<T>& operand = operands[i];
+      operand.data = input.flat<T>().data();
+      operand.strides.resize(dims.size());
+      int64 stride = 1;
+      for (int d = dims.size() - 1; d >= 0; --d) {
+        operand.strides[d] = bcast[i][d] ? 0 : stride;
+        if (!bcast[i][d]) stride *= dims[d];
+      }
+      operand.scalar = input.NumElements() == 1;
+      operand.contiguous = input.NumElements() == num_elements;
+    }
+
+    // Every input and every intermediate result gets one float buffer per
+    // tile; size the tiles so that all of them fit in half of L1.
+    const int num_values = num_args_ + program_.size();
+    const int64 l1_floats =
+        static_cast<int64>(Eigen::l1CacheSize()) / 2 / sizeof(float);
+    const int64 tile_size =
+        std::max<int64>(64, l1_floats / num_values / 16 * 16);
+
+    const int64 num_tiles = (num_elements + tile_size - 1) / tile_size;
+    const std::vector<Instruction>& program = program_;
+    const int num_args = num_args_;
+    const gtl::InlinedVector<int64, 8>& tile_dims = dims;
+    T* out = output->flat<T>().data();
+
+    const Eigen::TensorOpCost cost(
+        num_args * tile_size * sizeof(T), tile_size * sizeof(T),
+        program.size() * tile_size * Eigen::TensorOpCost::AddCost<float>());
+    const Device& d = context->eigen_device<Device>();
+    d.parallelFor(num_tiles, cost, [&](Eigen::Index first, Eigen::Index last) {
+      std::vector<float> buffer(num_values * tile_size);
+      for (Eigen::Index tile = first; tile < last; ++tile) {
+        const int64 start = tile * tile_size;
+        const int64 len = std::min(tile_size, num_elements - start);
+        for (int i = 0; i < num_args; ++i) {
+          LoadTile(operands[i], tile_dims, start, len,
+                   buffer.data() + i * tile_size);
+        }
+        for (size_t k = 0; k < program.size(); ++k) {
+          const Instruction& inst = program[k];
+          const float* rhs =
+              inst.rhs < 0 ? nullptr : buffer.data() + inst.rhs * tile_size;
+          EvalInstruction(inst, buffer.data() + inst.lhs * tile_size, rhs, len,
+                          buffer.data() + (num_args + k) * tile_size);
+        }
+        const float* result = buffer.data() + (num_values - 1) * tile_size;
+        for (int64 i = 0; i < len; ++i) {
+          out[start + i] = static_cast<T>(result[i]);
+        }
+      }
+    });
+  }
+
+ private:
+  int num_args_;
+  std::vector<Instruction> program_;
+};
+
+#define REGISTER_FUSED_ELEMENTWISE_KERNELS(TYPE)          \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedElementwise")   \
+                              .Device(DEVICE_CPU)         \
+                              .TypeConstraint<TYPE>("T"), \
+                          FusedElementwiseOp<CPUDevice, TYPE>);
+
+TF_CALL_CPU_NUMBER_TYPES_WITHOUT_HALF(REGISTER_FUSED_ELEMENTWISE_KERNELS);
+#undef REGISTER_FUSED_ELEMENTWISE_KERNELS
+
+}  // namespace itex
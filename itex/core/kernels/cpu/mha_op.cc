@@ -15,21 +15,120 @@ limitations under the License.
 
 #include "itex/core/kernels/cpu/mha_op.h"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "itex/core/utils/env.h"
 #include "itex/core/utils/env_var.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/logging.h"
 #include "itex/core/utils/macros.h"
+#include "itex/core/utils/numbers.h"
 #include "itex/core/utils/op_kernel.h"
 #include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/parallel.h"
 #include "itex/core/utils/register_types.h"
+#include "itex/core/utils/str_util.h"
+#include "itex/core/utils/strcat.h"
 #include "itex/core/utils/tensor_shape.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
 namespace itex {
 
+namespace {
+// Candidates of the autotuner, all instantiated in `MHAOp::RunFmha`. The first
+// three are the ones picked by the default heuristic.
+constexpr FmhaBlockConfig kFmhaBlockConfigs[] = {
+    {32, 512}, {64, 512},  {256, 512}, {32, 256},
+    {64, 256}, {128, 256}, {64, 128},  {128, 128}};
+
+bool IsFmhaBlockConfigSupported(int64_t q_split_size, int64_t kv_split_size) {
+  for (const FmhaBlockConfig& config : kFmhaBlockConfigs) {
+    if (config.q_split_size == q_split_size &&
+        config.kv_split_size == kv_split_size)
+      return true;
+  }
+  return false;
+}
+
+FmhaBlockConfig DefaultFmhaBlockConfig(int64_t q_seq_len) {
+  if (q_seq_len >= 768) return kFmhaBlockConfigs[2];
+  if (q_seq_len >= 192) return kFmhaBlockConfigs[1];
+  return kFmhaBlockConfigs[0];
+}
+
+// Timed runs of every candidate, after one untimed warm-up run. The fastest
+// one counts, as the others only add noise from other work on the machine.
+constexpr int kFmhaTuningRuns = 3;
+}  // namespace
+
+FmhaTuningDatabase& FmhaTuningDatabase::Global() {
+  static FmhaTuningDatabase* database = new FmhaTuningDatabase();
+  return *database;
+}
+
+FmhaTuningDatabase::FmhaTuningDatabase() {
+  ITEX_CHECK_OK(ReadStringFromEnvVar("ITEX_CPU_MHA_TUNING_DB", "", &path_));
+  if (path_.empty()) return;
+
+  string content;
+  Env* env = Env::Default();
+  if (!env->FileExists(path_).ok() ||
+      !ReadFileToString(env, path_, &content).ok())
+    return;
+  // One entry per line: "<key> <q_split_size> <kv_split_size>".
+  for (const string& line : str_util::Split(content, "\n")) {
+    std::vector<string> fields = str_util::Split(line, " ");
+    int64 q_split_size, kv_split_size;
+    if (fields.size() != 3 ||
+        !strings::safe_strto64(fields[1], &q_split_size) ||
+        !strings::safe_strto64(fields[2], &kv_split_size) ||
+        !IsFmhaBlockConfigSupported(q_split_size, kv_split_size))
+      continue;
+    configs_[fields[0]] = {q_split_size, kv_split_size};
+  }
+  ITEX_VLOG(1) << "Loaded " << configs_.size() << " MHA tuning entries from "
+               << path_;
+}
+
+bool FmhaTuningDatabase::Lookup(const string& key, FmhaBlockConfig* config) {
+  mutex_lock lock(&mu_);
+  auto it = configs_.find(key);
+  if (it == configs_.end()) return false;
+  *config = it->second;
+  return true;
+}
+
+bool FmhaTuningDatabase::StartTuning(const string& key) {
+  mutex_lock lock(&mu_);
+  if (configs_.count(key)) return false;
+  return tuning_.insert(key).second;
+}
+
+void FmhaTuningDatabase::Insert(const string& key,
+                                const FmhaBlockConfig& config) {
+  mutex_lock lock(&mu_);
+  configs_[key] = config;
+  tuning_.erase(key);
+  if (path_.empty()) return;
+
+  std::unique_ptr<WritableFile> file;
+  Status status = Env::Default()->NewAppendableFile(path_, &file);
+  if (status.ok()) {
+    status = file->Append(strings::StrCat(key, " ", config.q_split_size, " ",
+                                          config.kv_split_size, "\n"));
+  }
+  if (status.ok()) status = file->Close();
+  if (!status.ok()) {
+    ITEX_LOG(WARNING) << "Failed to save MHA tuning result to " << path_
+                      << ": " << status.error_message();
+  }
+}
+
 template <typename T>
 class MHAOp : public OpKernel {
  public:
@@ -42,6 +141,8 @@ class MHAOp : public OpKernel {
       OP_REQUIRES_OK(context, context->GetAttr("use_causal", &use_causal));
     }
     OP_REQUIRES_OK(context, context->GetAttr("use_mask", &use_mask));
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar("ITEX_CPU_MHA_AUTOTUNE", true,
+                                               &autotune));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -65,19 +166,94 @@ class MHAOp : public OpKernel {
         context->allocate_output(
             0, {batch_size, q_seq_len, num_heads, head_size}, &output));
 
-#define CALL_FMHA_FUNC(T, qSplitSize, kvSplitSize)                            \
-  FmhaFunctor<T, qSplitSize, kvSplitSize>()(                                  \
-      query, key, value, batch_size, q_seq_len, num_heads, head_size,         \
-      k_seq_len, use_mask, use_causal, use_dropout, atten_mask, dropout_mask, \
-      dropout_prob, output)
-
-    if (q_seq_len >= 768) {
-      CALL_FMHA_FUNC(T, 256, 512);
-    } else if (q_seq_len >= 192) {
-      CALL_FMHA_FUNC(T, 64, 512);
-    } else {
-      CALL_FMHA_FUNC(T, 32, 512);
+    auto run = [&](const FmhaBlockConfig& config) {
+      RunFmha(config, query, key, value, batch_size, q_seq_len, num_heads,
+              head_size, k_seq_len, atten_mask, dropout_mask, output);
+    };
+    FmhaBlockConfig config = DefaultFmhaBlockConfig(q_seq_len);
+    if (!autotune) {
+      run(config);
+      return;
+    }
+
+    // The best block config depends on the problem size as well as on the
+    // number of threads sharing the caches.
+    const string signature = strings::StrCat(
+        DataTypeString(DataTypeToEnum<T>::v()), ",", batch_size, ",",
+        num_heads, ",", q_seq_len, ",", k_seq_len, ",", head_size, ",",
+        GetNumThreads());
+    FmhaTuningDatabase& database = FmhaTuningDatabase::Global();
+    if (database.Lookup(signature, &config) ||
+        !database.StartTuning(signature)) {
+      // Tuned already, or being tuned by a concurrent call, which then runs
+      // the default config rather than waiting.
+      run(config);
+      return;
+    }
+
+    // Time every candidate on the actual inputs. All of them compute the same
+    // output, so it's valid once tuning finishes.
+    uint64 best_time = std::numeric_limits<uint64>::max();
+    std::vector<FmhaBlockConfig> tried;
+    for (const FmhaBlockConfig& candidate : kFmhaBlockConfigs) {
+      // Block sizes are clamped to the sequence lengths, so skip candidates
+      // that behave like one already timed.
+      const int64_t q_split = std::min(candidate.q_split_size, q_seq_len);
+      const int64_t kv_split = std::min(candidate.kv_split_size, k_seq_len);
+      bool duplicated = false;
+      for (const FmhaBlockConfig& other : tried) {
+        duplicated |= std::min(other.q_split_size, q_seq_len) == q_split &&
+                      std::min(other.kv_split_size, k_seq_len) == kv_split;
+      }
+      if (duplicated) continue;
+      tried.push_back(candidate);
+
+      run(candidate);
+      uint64 candidate_time = std::numeric_limits<uint64>::max();
+      for (int i = 0; i < kFmhaTuningRuns; ++i) {
+        const uint64 start = Env::Default()->NowMicros();
+        run(candidate);
+        candidate_time =
+            std::min(candidate_time, Env::Default()->NowMicros() - start);
+      }
+      if (candidate_time < best_time) {
+        best_time = candidate_time;
+        config = candidate;
+      }
     }
+    database.Insert(signature, config);
+    ITEX_VLOG(1) << "Tuned MHA " << signature << ": qSplitSize "
+                 << config.q_split_size << ", kvSplitSize "
+                 << config.kv_split_size << ", " << best_time << " us";
+  }
+
+ private:
+  void RunFmha(const FmhaBlockConfig& config, const Tensor& query,
+               const Tensor& key, const Tensor& value, int64_t batch_size,
+               int64_t q_seq_len, int64_t num_heads, int64_t head_size,
+               int64_t k_seq_len, const Tensor& atten_mask,
+               const Tensor& dropout_mask, Tensor* output) {
+#define CALL_FMHA_FUNC(T, qSplitSize, kvSplitSize)                            \
+  if (config.q_split_size == qSplitSize &&                                    \
+      config.kv_split_size == kvSplitSize) {                                  \
+    FmhaFunctor<T, qSplitSize, kvSplitSize>()(                                \
+        query, key, value, batch_size, q_seq_len, num_heads, head_size,       \
+        k_seq_len, use_mask, use_causal, use_dropout, atten_mask,             \
+        dropout_mask, dropout_prob, output);                                  \
+    return;                                                                   \
+  }
+
+    CALL_FMHA_FUNC(T, 32, 512);
+    CALL_FMHA_FUNC(T, 64, 512);
+    CALL_FMHA_FUNC(T, 256, 512);
+    CALL_FMHA_FUNC(T, 32, 256);
+    CALL_FMHA_FUNC(T, 64, 256);
+    CALL_FMHA_FUNC(T, 128, 256);
+    CALL_FMHA_FUNC(T, 64, 128);
+    CALL_FMHA_FUNC(T, 128, 128);
+#undef CALL_FMHA_FUNC
+    ITEX_LOG(FATAL) << "Unsupported MHA block config: "
+                    << config.q_split_size << "x" << config.kv_split_size;
   }
 
  private:
@@ -86,6 +262,7 @@ class MHAOp : public OpKernel {
   bool use_causal = false;
   bool use_dropout = false;
   bool is_inference = false;
+  bool autotune = true;
 };
 
 #define REGISTER_MHA_INF_CPU(type)                                   \
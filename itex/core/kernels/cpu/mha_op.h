@@ -20,12 +20,14 @@ limitations under the License.
 #include <limits>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "itex/core/kernels/cpu/cpu_blas.h"
 #include "itex/core/utils/env_var.h"
 #include "itex/core/utils/errors.h"
 #include "itex/core/utils/macros.h"
+#include "itex/core/utils/mutex.h"
 #include "itex/core/utils/op_kernel.h"
 #include "itex/core/utils/op_requires.h"
 #include "itex/core/utils/parallel.h"
@@ -277,6 +279,36 @@ class FmhaFunctor {
         });
   }
 };
+
+// Block sizes of `FmhaFunctor`, i.e. its `qSplitSize` and `kvSplitSize`.
+struct FmhaBlockConfig {
+  int64_t q_split_size;
+  int64_t kv_split_size;
+};
+
+// Best block configs of the CPU fused attention, keyed by problem signature.
+// If env var `ITEX_CPU_MHA_TUNING_DB` names a file, entries are loaded from it
+// at startup and every new entry is appended to it, so tuning results are
+// shared across processes.
+class FmhaTuningDatabase {
+ public:
+  static FmhaTuningDatabase& Global();
+
+  // Returns true and sets `config` if `key` has been tuned.
+  bool Lookup(const string& key, FmhaBlockConfig* config);
+  // Returns true if the caller should tune `key`, i.e. it is neither tuned
+  // nor being tuned by another caller. Callers getting true must Insert() it.
+  bool StartTuning(const string& key);
+  void Insert(const string& key, const FmhaBlockConfig& config);
+
+ private:
+  FmhaTuningDatabase();
+
+  string path_;
+  mutex mu_;
+  std::unordered_map<string, FmhaBlockConfig> configs_ TF_GUARDED_BY(mu_);
+  std::unordered_set<string> tuning_ TF_GUARDED_BY(mu_);
+};
 }  // namespace itex
 
 #endif  // ITEX_CORE_KERNELS_CPU_MHA_OP_H_
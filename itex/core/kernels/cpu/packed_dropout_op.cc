@@ -0,0 +1,188 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/lib/random/guarded_philox_random.h"
+#include "itex/core/utils/lib/random/philox_random.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+// Every mask element consumes one 32-bit Philox output, so one invocation of
+// the 8-lane generator produces 32 elements, i.e. 4 bytes of packed mask.
+constexpr int kPhiloxLanes = 8;
+using PhiloxVec = random::PhiloxRandomVec<kPhiloxLanes>;
+constexpr int kGroupSize = PhiloxVec::kResultElementCount;
+constexpr int kGroupBytes = kGroupSize / 8;
+
+inline int64 PackedMaskBytes(int64 num_elements) {
+  return (num_elements + 7) / 8;
+}
+}  // namespace
+
+// Generates a dropout keep-mask with 1 bit per element: bit `i % 8` of byte
+// `i / 8` is set iff element `i` is kept, i.e. its 32-bit Philox sample is at
+// least `rate * 2^32`.
+template <typename Device, typename T>
+class FusedRandomBitMaskOp : public OpKernel {
+ public:
+  explicit FusedRandomBitMaskOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, generator_.Init(ctx));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& shape = ctx->input(0);
+    const Tensor& rate = ctx->input(1);
+    TensorShape tensor_shape;
+    OP_REQUIRES_OK(ctx, MakeShape(shape, &tensor_shape));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(rate.shape()),
+                errors::InvalidArgument("Dropout rate must be a scalar, got ",
+                                        rate.shape().DebugString()));
+
+    const int64 num_elements = tensor_shape.num_elements();
+    const int64 num_bytes = PackedMaskBytes(num_elements);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({num_bytes}),
+                                             &output));
+    if (num_bytes == 0) return;
+    uint8* mask = output->flat<uint8>().data();
+
+    const double drop_rate = static_cast<double>(rate.scalar<T>()());
+    if (drop_rate >= 1.0) {
+      std::memset(mask, 0, num_bytes);
+      return;
+    }
+    // Every 32-bit sample is uniform in [0, 2^32), so `sample >= rate * 2^32`
+    // keeps an element with probability `1 - rate` without converting it to a
+    // float. RandomUniform only uses the low 23 bits of a sample as the
+    // mantissa of its float, so the masks differ from the unfused graph but
+    // follow the same distribution.
+    const uint32 threshold =
+        drop_rate <= 0.0 ? 0
+                         : static_cast<uint32>(std::min(
+                               drop_rate * 4294967296.0, 4294967295.0));
+
+    const int64 num_groups = (num_bytes + kGroupBytes - 1) / kGroupBytes;
+    random::PhiloxRandom gen =
+        generator_.ReserveSamples128(num_groups * kPhiloxLanes);
+
+    const Device& d = ctx->eigen_device<Device>();
+    d.parallelFor(
+        num_groups,
+        Eigen::TensorOpCost(0, kGroupBytes,
+                            kGroupSize * random::PhiloxRandom::kElementCost),
+        [gen, mask, num_bytes, threshold](Eigen::Index first,
+                                          Eigen::Index last) {
+          PhiloxVec vec_gen(gen);
+          vec_gen.Skip(first * kPhiloxLanes);
+          alignas(64) uint32 samples[kGroupSize];
+          for (Eigen::Index group = first; group < last; ++group) {
+            vec_gen(samples);
+            uint8 bytes[kGroupBytes];
+            for (int b = 0; b < kGroupBytes; ++b) {
+              uint8 bits = 0;
+              for (int k = 0; k < 8; ++k) {
+                bits |= static_cast<uint8>(samples[b * 8 + k] >= threshold)
+                        << k;
+              }
+              bytes[b] = bits;
+            }
+            const int64 offset = group * kGroupBytes;
+            std::memcpy(mask + offset, bytes,
+                        std::min<int64>(kGroupBytes, num_bytes - offset));
+          }
+        });
+  }
+
+ private:
+  GuardedPhiloxRandom generator_;
+};
+
+// Applies a bit-packed keep-mask: `y = bit(mask, i) ? x : 0`. It's used for
+// both dropout forward and backward since they share the same mask.
+template <typename Device, typename T>
+class PackedDropoutOp : public OpKernel {
+ public:
+  explicit PackedDropoutOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& input = ctx->input(0);
+    const Tensor& mask = ctx->input(1);
+    const int64 num_elements = input.NumElements();
+    OP_REQUIRES(ctx,
+                mask.dims() == 1 &&
+                    mask.NumElements() == PackedMaskBytes(num_elements),
+                errors::InvalidArgument(
+                    "Packed dropout mask must have shape [",
+                    PackedMaskBytes(num_elements), "], got ",
+                    mask.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                            {0}, 0, input.shape(), &output));
+    if (num_elements == 0) return;
+
+    const T* src = input.flat<T>().data();
+    const uint8* bits = mask.flat<uint8>().data();
+    T* dst = output->flat<T>().data();
+
+    const Device& d = ctx->eigen_device<Device>();
+    d.parallelFor(PackedMaskBytes(num_elements),
+                  Eigen::TensorOpCost(8 * sizeof(T) + 1, 8 * sizeof(T), 8),
+                  [src, bits, dst, num_elements](Eigen::Index first,
+                                                 Eigen::Index last) {
+                    for (Eigen::Index b = first; b < last; ++b) {
+                      const int64 base = b * 8;
+                      const int len = std::min<int64>(8, num_elements - base);
+                      const uint8 byte = bits[b];
+                      for (int k = 0; k < len; ++k) {
+                        dst[base + k] =
+                            ((byte >> k) & 1) ? src[base + k] : T(0);
+                      }
+                    }
+                  });
+  }
+};
+
+#define REGISTER_RANDOM_BIT_MASK_KERNEL(SHAPE_TYPE, TYPE)         \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedRandomBitMask")         \
+                              .Device(DEVICE_CPU)                 \
+                              .HostMemory("shape")                \
+                              .TypeConstraint<SHAPE_TYPE>("T")    \
+                              .TypeConstraint<TYPE>("DstT"),      \
+                          FusedRandomBitMaskOp<CPUDevice, TYPE>);
+
+#define REGISTER_PACKED_DROPOUT_KERNEL(TYPE)                                   \
+  REGISTER_RANDOM_BIT_MASK_KERNEL(int32, TYPE)                                 \
+  REGISTER_RANDOM_BIT_MASK_KERNEL(int64, TYPE)                                 \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("_ITEXPackedDropout").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"), \
+      PackedDropoutOp<CPUDevice, TYPE>);
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_PACKED_DROPOUT_KERNEL);
+#undef REGISTER_PACKED_DROPOUT_KERNEL
+#undef REGISTER_RANDOM_BIT_MASK_KERNEL
+
+}  // namespace itex
@@ -0,0 +1,611 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/gtl/inlined_vector.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+enum class SegmentOp {
+  kMatMul,
+  kAdd,
+  kSub,
+  kMul,
+  kMaximum,
+  kMinimum,
+  kRelu,
+  kRelu6,
+  kSigmoid,
+  kTanh,
+  kExp,
+  kNeg,
+  kSquare,
+  kConcat,
+  kAlias,
+};
+
+struct SegmentOpInfo {
+  const char* name;
+  SegmentOp op;
+  // Number of operands, or -1 for any number.
+  int arity;
+};
+
+// Ops accepted in `segment_ops`. Must be kept in sync with the segment
+// fusion's `IsSegmentOp`. BiasAdd is an Add broadcasting its bias along the
+// innermost dimension, and Reshape and Identity are views of their operand.
+constexpr SegmentOpInfo kSegmentOps[] = {
+    {"MatMul", SegmentOp::kMatMul, 2},   {"BiasAdd", SegmentOp::kAdd, 2},
+    {"Add", SegmentOp::kAdd, 2},         {"AddV2", SegmentOp::kAdd, 2},
+    {"Sub", SegmentOp::kSub, 2},         {"Mul", SegmentOp::kMul, 2},
+    {"Maximum", SegmentOp::kMaximum, 2}, {"Minimum", SegmentOp::kMinimum, 2},
+    {"Relu", SegmentOp::kRelu, 1},       {"Relu6", SegmentOp::kRelu6, 1},
+    {"Sigmoid", SegmentOp::kSigmoid, 1}, {"Tanh", SegmentOp::kTanh, 1},
+    {"Exp", SegmentOp::kExp, 1},         {"Neg", SegmentOp::kNeg, 1},
+    {"Square", SegmentOp::kSquare, 1},   {"ConcatV2", SegmentOp::kConcat, -1},
+    {"Identity", SegmentOp::kAlias, 1},  {"Reshape", SegmentOp::kAlias, 1},
+};
+
+bool IsBinary(SegmentOp op) {
+  return op == SegmentOp::kAdd || op == SegmentOp::kSub ||
+         op == SegmentOp::kMul || op == SegmentOp::kMaximum ||
+         op == SegmentOp::kMinimum;
+}
+
+// How an operand of a binary op is read in the shape of the result.
+enum class Broadcast {
+  // Same number of elements as the result.
+  kNone,
+  // A single element.
+  kScalar,
+  // The innermost dimensions of the result, repeated along the outer ones,
+  // e.g. a bias.
+  kInner,
+  // Anything else. Expanded to the result's shape before the op runs.
+  kExpand,
+};
+
+// Buffers of the arena start at multiples of a cache line.
+constexpr int64 kArenaAlignment = 64 / sizeof(float);
+
+struct Step {
+  SegmentOp op;
+  gtl::InlinedVector<int, 4> operands;
+  int64 param = 0;
+  TensorShape shape;
+  // Offset of the result in the arena, or -1 when the result is written to
+  // the output or is a view of its operand.
+  int64 offset = -1;
+  // Binary ops only: how each operand is read, and the arena offset of its
+  // expanded copy for Broadcast::kExpand.
+  Broadcast broadcast[2] = {Broadcast::kNone, Broadcast::kNone};
+  int64 expand_offset[2] = {-1, -1};
+};
+
+using Array = Eigen::Array<float, Eigen::Dynamic, 1>;
+using ArrayMap = Eigen::Map<Array>;
+using ConstArrayMap = Eigen::Map<const Array>;
+
+bool IsBroadcastableTo(const TensorShape& shape, const TensorShape& to) {
+  if (shape.dims() > to.dims()) return false;
+  const int offset = to.dims() - shape.dims();
+  for (int d = 0; d < shape.dims(); ++d) {
+    const int64 dim = shape.dim_size(d);
+    if (dim != 1 && dim != to.dim_size(offset + d)) return false;
+  }
+  return true;
+}
+
+Broadcast GetBroadcast(const TensorShape& shape, const TensorShape& to) {
+  if (shape.num_elements() == to.num_elements()) return Broadcast::kNone;
+  if (shape.num_elements() == 1) return Broadcast::kScalar;
+  // Skip the leading ones; the rest must match the innermost dimensions.
+  int d = 0;
+  while (shape.dim_size(d) == 1) ++d;
+  const int offset = to.dims() - shape.dims();
+  for (; d < shape.dims(); ++d) {
+    if (shape.dim_size(d) != to.dim_size(offset + d)) return Broadcast::kExpand;
+  }
+  return Broadcast::kInner;
+}
+
+// Writes `src` of `shape` broadcast to `to` into `dst`.
+void Expand(const float* src, const TensorShape& shape, const TensorShape& to,
+            float* dst) {
+  const int rank = to.dims();
+  const int offset = rank - shape.dims();
+  gtl::InlinedVector<int64, 8> strides(rank, 0);
+  int64 stride = 1;
+  for (int d = shape.dims() - 1; d >= 0; --d) {
+    if (shape.dim_size(d) != 1) strides[offset + d] = stride;
+    stride *= shape.dim_size(d);
+  }
+  gtl::InlinedVector<int64, 8> coord(rank, 0);
+  const int64 num_elements = to.num_elements();
+  int64 src_index = 0;
+  for (int64 i = 0; i < num_elements; ++i) {
+    dst[i] = src[src_index];
+    for (int d = rank - 1; d >= 0; --d) {
+      src_index += strides[d];
+      if (++coord[d] < to.dim_size(d)) break;
+      src_index -= coord[d] * strides[d];
+      coord[d] = 0;
+    }
+  }
+}
+
+template <typename Lhs, typename Rhs>
+void EvalBinary(SegmentOp op, const Lhs& x, const Rhs& z, ArrayMap* y) {
+  switch (op) {
+    case SegmentOp::kAdd:
+      *y = x + z;
+      break;
+    case SegmentOp::kSub:
+      *y = x - z;
+      break;
+    case SegmentOp::kMul:
+      *y = x * z;
+      break;
+    case SegmentOp::kMaximum:
+      *y = x.max(z);
+      break;
+    case SegmentOp::kMinimum:
+      *y = x.min(z);
+      break;
+    default:
+      ITEX_LOG(FATAL) << "Unexpected segment binary op.";
+  }
+}
+
+void EvalUnary(SegmentOp op, const float* src, int64 len, float* dst) {
+  ConstArrayMap x(src, len);
+  ArrayMap y(dst, len);
+  switch (op) {
+    case SegmentOp::kRelu:
+      y = x.max(0.0f);
+      break;
+    case SegmentOp::kRelu6:
+      y = x.max(0.0f).min(6.0f);
+      break;
+    case SegmentOp::kSigmoid:
+      y = ((-x).exp() + 1.0f).inverse();
+      break;
+    case SegmentOp::kTanh:
+      y = x.tanh();
+      break;
+    case SegmentOp::kExp:
+      y = x.exp();
+      break;
+    case SegmentOp::kNeg:
+      y = -x;
+      break;
+    case SegmentOp::kSquare:
+      y = x.square();
+      break;
+    default:
+      ITEX_LOG(FATAL) << "Unexpected segment unary op.";
+  }
+}
+
+// Reads shapes encoded as the rank followed by the dimensions, starting at
+// `*cursor`.
+bool ReadShape(const std::vector<int64>& encoded, size_t* cursor,
+               TensorShape* shape) {
+  if (*cursor >= encoded.size()) return false;
+  const int64 rank = encoded[(*cursor)++];
+  if (rank < 0 || *cursor + rank > encoded.size()) return false;
+  *shape = TensorShape();
+  for (int64 d = 0; d < rank; ++d) {
+    const int64 dim = encoded[(*cursor)++];
+    if (dim < 0) return false;
+    shape->AddDim(dim);
+  }
+  return true;
+}
+
+}  // namespace
+
+// Runs a segment of small ops with static shapes, given as a topologically
+// sorted list in `segment_ops`, in a single kernel invocation. Everything
+// that depends only on the shapes is done once at construction: the ops are
+// validated, and the intermediate results are assigned to buffers of one
+// arena, reusing the buffer of a result once its last consumer ran. Compute
+// then only checks the input shapes, allocates the output and the arena, and
+// runs the ops back to back, which saves the executor and kernel dispatch
+// cost of every op on graphs whose tensors are small.
+template <typename Device, typename T>
+class SegmentExecutorOp : public OpKernel {
+ public:
+  explicit SegmentExecutorOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> segment_ops;
+    std::vector<int64> operands, params, shapes, input_shapes;
+    OP_REQUIRES_OK(context, context->GetAttr("N", &num_args_));
+    OP_REQUIRES_OK(context, context->GetAttr("segment_ops", &segment_ops));
+    OP_REQUIRES_OK(context, context->GetAttr("operands", &operands));
+    OP_REQUIRES_OK(context, context->GetAttr("params", &params));
+    OP_REQUIRES_OK(context, context->GetAttr("shapes", &shapes));
+    OP_REQUIRES_OK(context, context->GetAttr("input_shapes", &input_shapes));
+    OP_REQUIRES(context,
+                !segment_ops.empty() && params.size() == segment_ops.size(),
+                errors::InvalidArgument("params must hold 1 entry per op, got ",
+                                        params.size(), " for ",
+                                        segment_ops.size(), " ops."));
+
+    size_t cursor = 0;
+    value_shapes_.resize(num_args_);
+    for (int i = 0; i < num_args_; ++i) {
+      OP_REQUIRES(context, ReadShape(input_shapes, &cursor, &value_shapes_[i]),
+                  errors::InvalidArgument("Malformed input_shapes."));
+    }
+
+    size_t operand_cursor = 0, shape_cursor = 0;
+    for (size_t k = 0; k < segment_ops.size(); ++k) {
+      const SegmentOpInfo* info = nullptr;
+      for (const auto& candidate : kSegmentOps) {
+        if (segment_ops[k] == candidate.name) info = &candidate;
+      }
+      OP_REQUIRES(context, info != nullptr,
+                  errors::Unimplemented("Unsupported segment op: ",
+                                        segment_ops[k]));
+      Step step;
+      step.op = info->op;
+      step.param = params[k];
+      OP_REQUIRES(context, ReadShape(shapes, &shape_cursor, &step.shape),
+                  errors::InvalidArgument("Malformed shapes."));
+      OP_REQUIRES(
+          context, operand_cursor < operands.size(),
+          errors::InvalidArgument("Malformed operands for op ", k, "."));
+      const int64 num_operands = operands[operand_cursor++];
+      const int num_values = value_shapes_.size();
+      OP_REQUIRES(context,
+                  num_operands >= 1 &&
+                      operand_cursor + num_operands <= operands.size() &&
+                      (info->arity < 0 || info->arity == num_operands),
+                  errors::InvalidArgument("Invalid number of operands for op ",
+                                          k, " (", segment_ops[k], ")."));
+      for (int64 i = 0; i < num_operands; ++i) {
+        const int64 operand = operands[operand_cursor++];
+        OP_REQUIRES(context, operand >= 0 && operand < num_values,
+                    errors::InvalidArgument("Invalid operand ", operand,
+                                            " for op ", k, " (",
+                                            segment_ops[k], ")."));
+        step.operands.push_back(operand);
+      }
+      OP_REQUIRES_OK(context, ValidateStep(step, segment_ops[k]));
+      value_shapes_.push_back(step.shape);
+      steps_.push_back(std::move(step));
+    }
+    PlanArena();
+  }
+
+  void Compute(OpKernelContext* context) override {
+    for (int i = 0; i < num_args_; ++i) {
+      OP_REQUIRES(context, context->input(i).shape() == value_shapes_[i],
+                  errors::InvalidArgument(
+                      "Input ", i, " of the segment has shape ",
+                      context->input(i).shape().DebugString(),
+                      " but the segment was planned for ",
+                      value_shapes_[i].DebugString(), "."));
+    }
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, steps_.back().shape,
+                                                     &output));
+    Tensor arena;
+    float* arena_data = nullptr;
+    if (arena_size_ > 0) {
+      OP_REQUIRES_OK(context,
+                     context->allocate_temp(DataTypeToEnum<T>::value,
+                                            TensorShape({arena_size_}),
+                                            &arena));
+      arena_data = arena.flat<T>().data();
+    }
+
+    gtl::InlinedVector<const float*, 16> values(value_shapes_.size());
+    for (int i = 0; i < num_args_; ++i) {
+      values[i] = context->input(i).flat<T>().data();
+    }
+    const Device& d = context->eigen_device<Device>();
+    for (size_t k = 0; k < steps_.size(); ++k) {
+      const Step& step = steps_[k];
+      float* dst = k + 1 == steps_.size() ? output->flat<T>().data()
+                                          : arena_data + step.offset;
+      if (step.op == SegmentOp::kAlias) {
+        const float* src = values[step.operands[0]];
+        if (k + 1 < steps_.size()) {
+          values[num_args_ + k] = src;
+          continue;
+        }
+        std::memcpy(dst, src, step.shape.num_elements() * sizeof(float));
+      } else {
+        RunStep(d, step, values, arena_data, dst);
+      }
+      values[num_args_ + k] = dst;
+    }
+  }
+
+ private:
+  Status ValidateStep(const Step& step, const string& name) const {
+    const TensorShape& out = step.shape;
+    const auto invalid = [&](const TensorShape& shape) {
+      return errors::InvalidArgument("Invalid shapes for segment op ", name,
+                                     ": operand ", shape.DebugString(),
+                                     ", result ", out.DebugString(), ".");
+    };
+    const TensorShape& x = value_shapes_[step.operands[0]];
+    if (step.op == SegmentOp::kMatMul) {
+      const TensorShape& y = value_shapes_[step.operands[1]];
+      if (x.dims() != 2 || y.dims() != 2 || out.dims() != 2) return invalid(x);
+      const bool transpose_a = step.param & 1;
+      const bool transpose_b = step.param & 2;
+      if (x.dim_size(transpose_a ? 0 : 1) != y.dim_size(transpose_b ? 1 : 0) ||
+          out.dim_size(0) != x.dim_size(transpose_a ? 1 : 0) ||
+          out.dim_size(1) != y.dim_size(transpose_b ? 0 : 1)) {
+        return invalid(y);
+      }
+    } else if (IsBinary(step.op)) {
+      for (int operand : step.operands) {
+        const TensorShape& shape = value_shapes_[operand];
+        if (!IsBroadcastableTo(shape, out)) return invalid(shape);
+      }
+    } else if (step.op == SegmentOp::kConcat) {
+      const int64 axis = step.param;
+      if (axis < 0 || axis >= out.dims()) return invalid(out);
+      int64 concat_dim = 0;
+      for (int operand : step.operands) {
+        const TensorShape& shape = value_shapes_[operand];
+        if (shape.dims() != out.dims()) return invalid(shape);
+        for (int d = 0; d < out.dims(); ++d) {
+          if (d != axis && shape.dim_size(d) != out.dim_size(d)) {
+            return invalid(shape);
+          }
+        }
+        concat_dim += shape.dim_size(axis);
+      }
+      if (concat_dim != out.dim_size(axis)) return invalid(out);
+    } else if (x.num_elements() != out.num_elements()) {
+      return invalid(x);
+    }
+    return Status::OK();
+  }
+
+  // Assigns every result living in the arena to a buffer. A buffer is reused
+  // by the first later result that fits once the values it held are dead,
+  // preferring the smallest such buffer.
+  void PlanArena() {
+    const int num_values = value_shapes_.size();
+    const int num_steps = steps_.size();
+    // Views share the buffer of the value they alias.
+    std::vector<int> owner(num_values);
+    for (int v = 0; v < num_values; ++v) {
+      owner[v] = v;
+      if (v >= num_args_ && steps_[v - num_args_].op == SegmentOp::kAlias) {
+        owner[v] = owner[steps_[v - num_args_].operands[0]];
+      }
+    }
+    std::vector<int> last_use(num_values, -1);
+    for (int k = 0; k < num_steps; ++k) {
+      for (int operand : steps_[k].operands) last_use[owner[operand]] = k;
+    }
+
+    constexpr int kFree = -1;
+    constexpr int kExpanded = -2;
+    struct Buffer {
+      int64 size;
+      // The value in the buffer, kExpanded for an expanded operand, or kFree.
+      int value;
+    };
+    std::vector<Buffer> buffers;
+    std::vector<int> buffer_of(num_values, -1);
+    const auto acquire = [&](int64 size, int value) {
+      int best = -1;
+      for (int b = 0; b < static_cast<int>(buffers.size()); ++b) {
+        if (buffers[b].value != kFree || buffers[b].size < size) continue;
+        if (best < 0 || buffers[b].size < buffers[best].size) best = b;
+      }
+      if (best < 0) {
+        best = buffers.size();
+        buffers.push_back({size, kFree});
+      }
+      buffers[best].value = value;
+      return best;
+    };
+
+    // Expanded operands are only alive while their op runs.
+    std::vector<std::pair<int, int>> expand_buffers;
+    for (int k = 0; k < num_steps; ++k) {
+      for (auto& buffer : buffers) {
+        if (buffer.value >= 0 && last_use[buffer.value] < k) {
+          buffer.value = kFree;
+        }
+      }
+      Step& step = steps_[k];
+      const int64 num_elements = step.shape.num_elements();
+      int expanded[2] = {-1, -1};
+      if (IsBinary(step.op)) {
+        const Broadcast lhs =
+            GetBroadcast(value_shapes_[step.operands[0]], step.shape);
+        const Broadcast rhs =
+            GetBroadcast(value_shapes_[step.operands[1]], step.shape);
+        step.broadcast[0] = lhs;
+        step.broadcast[1] = rhs;
+        // An inner broadcast is only run in blocks against a full operand.
+        if (lhs == Broadcast::kInner && rhs != Broadcast::kNone) {
+          step.broadcast[0] = Broadcast::kExpand;
+        }
+        if (rhs == Broadcast::kInner && lhs != Broadcast::kNone) {
+          step.broadcast[1] = Broadcast::kExpand;
+        }
+        for (int i = 0; i < 2; ++i) {
+          if (step.broadcast[i] != Broadcast::kExpand) continue;
+          expanded[i] = acquire(num_elements, kExpanded);
+        }
+      }
+      if (k + 1 < num_steps && step.op != SegmentOp::kAlias) {
+        buffer_of[num_args_ + k] = acquire(num_elements, num_args_ + k);
+      }
+      for (int i = 0; i < 2; ++i) {
+        if (expanded[i] < 0) continue;
+        expand_buffers.emplace_back(k * 2 + i, expanded[i]);
+        buffers[expanded[i]].value = kFree;
+      }
+    }
+
+    std::vector<int64> offsets(buffers.size());
+    arena_size_ = 0;
+    for (size_t b = 0; b < buffers.size(); ++b) {
+      offsets[b] = arena_size_;
+      arena_size_ += (buffers[b].size + kArenaAlignment - 1) /
+                     kArenaAlignment * kArenaAlignment;
+    }
+    for (int k = 0; k < num_steps; ++k) {
+      if (buffer_of[num_args_ + k] >= 0) {
+        steps_[k].offset = offsets[buffer_of[num_args_ + k]];
+      }
+    }
+    for (const auto& expand : expand_buffers) {
+      steps_[expand.first / 2].expand_offset[expand.first % 2] =
+          offsets[expand.second];
+    }
+  }
+
+  void RunStep(const Device& d, const Step& step,
+               const gtl::InlinedVector<const float*, 16>& values,
+               float* arena_data, float* dst) const {
+    const int64 num_elements = step.shape.num_elements();
+    if (num_elements == 0) return;
+    switch (step.op) {
+      case SegmentOp::kMatMul: {
+        const TensorShape& a_shape = value_shapes_[step.operands[0]];
+        const TensorShape& b_shape = value_shapes_[step.operands[1]];
+        typename TTypes<T>::ConstMatrix a(values[step.operands[0]],
+                                          a_shape.dim_size(0),
+                                          a_shape.dim_size(1));
+        typename TTypes<T>::ConstMatrix b(values[step.operands[1]],
+                                          b_shape.dim_size(0),
+                                          b_shape.dim_size(1));
+        typename TTypes<T>::Matrix out(dst, step.shape.dim_size(0),
+                                       step.shape.dim_size(1));
+        Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_dims;
+        contract_dims[0].first = (step.param & 1) ? 0 : 1;
+        contract_dims[0].second = (step.param & 2) ? 1 : 0;
+        out.device(d) = a.contract(b, contract_dims);
+        return;
+      }
+      case SegmentOp::kConcat: {
+        const int64 axis = step.param;
+        int64 outer = 1;
+        for (int i = 0; i < axis; ++i) outer *= step.shape.dim_size(i);
+        const int64 out_inner = num_elements / outer;
+        int64 start = 0;
+        for (int operand : step.operands) {
+          const int64 inner = value_shapes_[operand].num_elements() / outer;
+          const float* src = values[operand];
+          for (int64 o = 0; o < outer; ++o) {
+            std::copy_n(src + o * inner, inner, dst + o * out_inner + start);
+          }
+          start += inner;
+        }
+        return;
+      }
+      default:
+        break;
+    }
+    if (!IsBinary(step.op)) {
+      EvalUnary(step.op, values[step.operands[0]], num_elements, dst);
+      return;
+    }
+
+    const float* src[2];
+    for (int i = 0; i < 2; ++i) {
+      src[i] = values[step.operands[i]];
+      if (step.broadcast[i] == Broadcast::kExpand) {
+        float* expanded = arena_data + step.expand_offset[i];
+        Expand(src[i], value_shapes_[step.operands[i]], step.shape, expanded);
+        src[i] = expanded;
+      }
+    }
+    const auto is_full = [&](int i) {
+      return step.broadcast[i] == Broadcast::kNone ||
+             step.broadcast[i] == Broadcast::kExpand;
+    };
+    if (is_full(0) && is_full(1)) {
+      ArrayMap y(dst, num_elements);
+      EvalBinary(step.op, ConstArrayMap(src[0], num_elements),
+                 ConstArrayMap(src[1], num_elements), &y);
+    } else if (step.broadcast[1] == Broadcast::kScalar && is_full(0)) {
+      ArrayMap y(dst, num_elements);
+      EvalBinary(step.op, ConstArrayMap(src[0], num_elements),
+                 Array::Constant(num_elements, src[1][0]), &y);
+    } else if (step.broadcast[0] == Broadcast::kScalar && is_full(1)) {
+      ArrayMap y(dst, num_elements);
+      EvalBinary(step.op, Array::Constant(num_elements, src[0][0]),
+                 ConstArrayMap(src[1], num_elements), &y);
+    } else if (step.broadcast[0] == Broadcast::kScalar) {
+      // Both scalars.
+      ArrayMap y(dst, num_elements);
+      EvalBinary(step.op, Array::Constant(num_elements, src[0][0]),
+                 Array::Constant(num_elements, src[1][0]), &y);
+    } else {
+      // One operand repeats along the outer dimensions of the other.
+      const int inner = step.broadcast[0] == Broadcast::kInner ? 0 : 1;
+      const int64 block = value_shapes_[step.operands[inner]].num_elements();
+      ConstArrayMap repeated(src[inner], block);
+      for (int64 start = 0; start < num_elements; start += block) {
+        ArrayMap y(dst + start, block);
+        ConstArrayMap full(src[1 - inner] + start, block);
+        if (inner == 1) {
+          EvalBinary(step.op, full, repeated, &y);
+        } else {
+          EvalBinary(step.op, repeated, full, &y);
+        }
+      }
+    }
+  }
+
+  int num_args_;
+  std::vector<Step> steps_;
+  // Shapes of the inputs followed by the results of the steps.
+  std::vector<TensorShape> value_shapes_;
+  int64 arena_size_ = 0;
+};
+
+#define REGISTER_SEGMENT_EXECUTOR_KERNELS(TYPE)           \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXSegmentExecutor")    \
+                              .Device(DEVICE_CPU)         \
+                              .TypeConstraint<TYPE>("T"), \
+                          SegmentExecutorOp<CPUDevice, TYPE>);
+
+TF_CALL_float(REGISTER_SEGMENT_EXECUTOR_KERNELS);
+#undef REGISTER_SEGMENT_EXECUTOR_KERNELS
+
+}  // namespace itex
@@ -15,10 +15,36 @@ limitations under the License.
 
 #include "itex/core/kernels/common/slice_functor.h"
 
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "itex/core/utils/mutex.h"
+
 using dnnl::memory;
 
 namespace itex {
 
+namespace {
+// Returns true iff the slice is one contiguous range of the input, i.e. all
+// dims before some dim `k` have size 1, dim `k` is any range and all dims
+// after `k` are taken whole.
+bool IsContiguousSlice(const TensorShape& src_tf_shape,
+                       const gtl::InlinedVector<int64, 4>& begin,
+                       const gtl::InlinedVector<int64, 4>& size) {
+  const int dims = src_tf_shape.dims();
+  int k = 0;
+  while (k < dims - 1 && size[k] == 1) ++k;
+  for (int i = k + 1; i < dims; ++i) {
+    if (begin[i] != 0 || size[i] != src_tf_shape.dim_size(i)) return false;
+  }
+  return true;
+}
+
+void DeleteSliceHolder(void* data, size_t len, void* arg) {
+  delete static_cast<Tensor*>(arg);
+}
+}  // namespace
+
 template <typename T>
 static void SharedSliceCommonCases(OpKernelContext* context,
                                    const Tensor& input,
@@ -45,6 +71,37 @@ static void SharedSliceCommonCases(OpKernelContext* context,
     *done = true;
     return;
   }
+
+  if (dst_tf_shape->num_elements() == 0) {
+    Tensor* dst_tensor = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(kDstIndex, *dst_tf_shape,
+                                                     &dst_tensor));
+    *done = true;
+    return;
+  }
+
+  // A contiguous range, e.g. a batch split or a KV cache window, is returned
+  // as a view of the input buffer. The view holds a reference to the input, so
+  // the buffer outlives it. Only aligned views are created, since the runtime
+  // would copy unaligned ones anyway.
+  if (!slice_dim0 && !IsContiguousSlice(src_tf_shape, *begin, *size)) return;
+  int64 offset = 0;
+  for (int i = 0; i < src_tf_shape.dims(); ++i) {
+    offset = offset * src_tf_shape.dim_size(i) + (*begin)[i];
+  }
+  T* data = const_cast<T*>(input.flat<T>().data()) + offset;
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) return;
+
+  ITEX_VLOG(2) << "Slice contiguous range without copy";
+  Tensor* holder = new Tensor(input);
+  const auto& dims = dst_tf_shape->dim_sizes();
+  TF_Tensor* view = TF_NewTensor(
+      static_cast<TF_DataType>(DataTypeToEnum<T>::v()), dims.data(),
+      dims.size(), data, dst_tf_shape->num_elements() * sizeof(T),
+      &DeleteSliceHolder, holder);
+  context->set_output(kDstIndex,
+                      Tensor(DataTypeToEnum<T>::v(), *dst_tf_shape, view));
+  *done = true;
 }
 
 template <typename Device, typename T>
@@ -71,45 +128,69 @@ class SliceOp : public OpKernel {
     try {
       auto onednn_engine = CreateDnnlEngine<Device>(*context);
 
-      memory::dims src_dims = TFShapeToOneDnnDims(src_tensor.shape());
-      memory::dims begin_dims = memory::dims(begin.begin(), begin.end());
-      memory::dims size_dims = memory::dims(size.begin(), size.end());
-
-      memory::desc src_md = CreatePlainMemDescWithFormatTag<T>(src_dims);
-      memory::desc dst_md = CreatePlainMemDescWithFormatTag<T>(size_dims);
-
-      memory::desc src_sub_md = src_md.submemory_desc(size_dims, begin_dims);
-      dnnl::reorder::primitive_desc reorder_pd(onednn_engine, src_sub_md,
-                                               onednn_engine, dst_md);
-      dnnl::reorder reorder_prim(reorder_pd);
+      // Reuse the reorder primitive of a previous call with the same input
+      // shape and slice.
+      std::vector<int64> key(src_tf_shape.dim_sizes().begin(),
+                             src_tf_shape.dim_sizes().end());
+      key.insert(key.end(), begin.begin(), begin.end());
+      key.insert(key.end(), size.begin(), size.end());
+      ReorderCacheEntry entry;
+      bool cached = false;
+      {
+        mutex_lock lock(&mu_);
+        auto it = reorder_cache_.find(key);
+        if (it != reorder_cache_.end()) {
+          entry = it->second;
+          cached = true;
+        }
+      }
+
+      if (!cached) {
+        memory::dims src_dims = TFShapeToOneDnnDims(src_tensor.shape());
+        memory::dims begin_dims = memory::dims(begin.begin(), begin.end());
+        memory::dims size_dims = memory::dims(size.begin(), size.end());
+
+        entry.src_md = CreatePlainMemDescWithFormatTag<T>(src_dims);
+        entry.dst_md = CreatePlainMemDescWithFormatTag<T>(size_dims);
+
+        memory::desc src_sub_md =
+            entry.src_md.submemory_desc(size_dims, begin_dims);
+        entry.reorder_pd = dnnl::reorder::primitive_desc(
+            onednn_engine, src_sub_md, onednn_engine, entry.dst_md);
+        entry.reorder_prim = dnnl::reorder(entry.reorder_pd);
+
+        mutex_lock lock(&mu_);
+        if (reorder_cache_.size() >= kMaxCachedReorders) reorder_cache_.clear();
+        reorder_cache_.emplace(std::move(key), entry);
+      }
 
       Tensor* dst_tensor = nullptr;
       OP_REQUIRES_OK(context, context->allocate_output(kDstIndex, dst_tf_shape,
                                                        &dst_tensor));
 
       // Create src memory
-      dnnl::memory src_mem = CreateDnnlMemory(src_md, onednn_engine,
+      dnnl::memory src_mem = CreateDnnlMemory(entry.src_md, onednn_engine,
                                               GetTensorBuffer<T>(&src_tensor));
       // Create dst memory
-      dnnl::memory dst_mem = CreateDnnlMemory(dst_md, onednn_engine,
+      dnnl::memory dst_mem = CreateDnnlMemory(entry.dst_md, onednn_engine,
                                               GetTensorBuffer<T>(dst_tensor));
       // Create scratch pad
       Tensor scratchpad_tensor;
       int64 scratchpad_size =
-          reorder_pd.scratchpad_desc().get_size() / sizeof(T);
+          entry.reorder_pd.scratchpad_desc().get_size() / sizeof(T);
       OP_REQUIRES_OK(context,
                      context->allocate_temp(DataTypeToEnum<T>::v(),
                                             TensorShape({scratchpad_size}),
                                             &scratchpad_tensor));
       auto scratchpad_mem =
-          dnnl::memory(reorder_pd.scratchpad_desc(), onednn_engine,
+          dnnl::memory(entry.reorder_pd.scratchpad_desc(), onednn_engine,
                        GetTensorBuffer<T>(&scratchpad_tensor));
       auto onednn_stream = CreateDnnlStream(*context, onednn_engine);
       std::unordered_map<int, memory> reorder_primitive_args = {
           {DNNL_ARG_SRC, src_mem},
           {DNNL_ARG_DST, dst_mem},
           {DNNL_ARG_SCRATCHPAD, scratchpad_mem}};
-      reorder_prim.execute(onednn_stream, reorder_primitive_args);
+      entry.reorder_prim.execute(onednn_stream, reorder_primitive_args);
     } catch (dnnl::error& e) {
       string error_msg = "Status:" + std::to_string(e.status) +
                          ", message: " + string(e.message) + ". in file " +
@@ -124,6 +205,18 @@ class SliceOp : public OpKernel {
   const int kBeginIndex = 1;
   const int kSizeIndex = 2;
   const int kDstIndex = 0;
+
+  struct ReorderCacheEntry {
+    memory::desc src_md;
+    memory::desc dst_md;
+    dnnl::reorder::primitive_desc reorder_pd;
+    dnnl::reorder reorder_prim;
+  };
+  // Bound of `reorder_cache_`, which is simply reset once it's full.
+  static constexpr size_t kMaxCachedReorders = 64;
+  mutex mu_;
+  absl::flat_hash_map<std::vector<int64>, ReorderCacheEntry> reorder_cache_
+      TF_GUARDED_BY(mu_);
 };
 
 #define REGISTER_KERNEL(TYPE)                                          \
@@ -57,6 +57,7 @@ class OneDnnLayerNormOp : public OpKernel {
   }
 
   void Compute(OpKernelContext* context) override {
+    ScratchpadArena::Scope scratchpad_scope;
     try {
       auto onednn_engine = CreateDnnlEngine<Device>(*context);
 
@@ -251,14 +252,13 @@ class OneDnnLayerNormOp : public OpKernel {
       bool is_src_reordered = (src_md != ln_fwd_pd.src_desc());
       if (is_src_reordered) {
         int64 src_reorder_size = ln_fwd_pd.src_desc().get_size() / sizeof(T);
-        OP_REQUIRES_OK(context,
-                       context->allocate_temp(DataTypeToEnum<T>::v(),
-                                              TensorShape({src_reorder_size}),
-                                              &src_reorder_tensor));
+        void* src_reorder_data = nullptr;
+        OP_REQUIRES_OK(context, AllocateScratchpad<T>(
+                                    context, src_reorder_size,
+                                    &src_reorder_tensor, &src_reorder_data));
 
-        src_reorder_mem =
-            CreateDnnlMemory(ln_fwd_pd.src_desc(), onednn_engine,
-                             GetTensorBuffer<T>(&src_reorder_tensor));
+        src_reorder_mem = CreateDnnlMemory(ln_fwd_pd.src_desc(), onednn_engine,
+                                           src_reorder_data);
         ReorderMemory(*context, &src_mem, &src_reorder_mem, onednn_engine);
       }
 
@@ -281,13 +281,12 @@ class OneDnnLayerNormOp : public OpKernel {
       Tensor scratchpad_tensor;
       int64 scratchpad_size =
           ln_fwd_pd.scratchpad_desc().get_size() / sizeof(U);
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(DataTypeToEnum<U>::v(),
-                                            TensorShape({scratchpad_size}),
-                                            &scratchpad_tensor));
-      auto scratchpad_mem =
-          dnnl::memory(ln_fwd_pd.scratchpad_desc(), onednn_engine,
-                       GetTensorBuffer<U>(&scratchpad_tensor));
+      void* scratchpad_data = nullptr;
+      OP_REQUIRES_OK(context, AllocateScratchpad<U>(context, scratchpad_size,
+                                                    &scratchpad_tensor,
+                                                    &scratchpad_data));
+      auto scratchpad_mem = dnnl::memory(ln_fwd_pd.scratchpad_desc(),
+                                         onednn_engine, scratchpad_data);
       args.insert({DNNL_ARG_SCRATCHPAD, scratchpad_mem});
 
       ln_fwd_primitive.execute(onednn_stream, args);
@@ -23,6 +23,7 @@ limitations under the License.
 #include "itex/core/devices/device_backend_util.h"
 #include "itex/core/devices/xpu_device_util.h"
 #include "itex/core/kernels/common.h"
+#include "itex/core/utils/metrics.h"
 #ifndef INTEL_CPU_ONLY
 #include "itex/core/kernels/gpu/gpu_kernel_init.h"
 #ifdef USING_NEXTPLUGGABLE_DEVICE
@@ -81,6 +82,9 @@ void TF_InitKernel() {
   RegisterCPUKernels(itex::DEVICE_CPU);
 #endif  // INTEL_CPU_ONLY
 
+  // Export runtime metrics if ITEX_METRICS_FILE or ITEX_METRICS_PORT is set.
+  itex::metrics::StartExporter();
+
 #ifndef CC_BUILD
   bool ops_override = false;
   ITEX_CHECK_OK(
@@ -48,3 +48,48 @@ void Register_ITEXFusedDequantizeWithReshapeOp() {
         << "_ITEXFusedDequantizeWithReshape op registration failed: ";
   }
 }
+
+void Register_ITEXBucketPadOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXBucketPad");
+    TF_OpDefinitionBuilderAddInput(op_builder, "input: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    // Each of `axes` is padded at the end up to the smallest of the sorted
+    // `buckets` that fits it, or to a multiple of the largest bucket. Axes of
+    // size 0 or 1 are left as they are, since they may be broadcast.
+    TF_OpDefinitionBuilderAddAttr(op_builder, "axes: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "buckets: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "padding: {'zero', 'lowest'} = 'zero'");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXBucketPad op registration failed: ";
+  }
+}
+
+void Register_ITEXBucketSliceOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXBucketSlice");
+    TF_OpDefinitionBuilderAddInput(op_builder, "input: T");
+    // Only the shapes of `likes` are read: axis `axes[i]` of the output takes
+    // the size of axis `like_axes[i]` of `likes[i]`.
+    TF_OpDefinitionBuilderAddInput(op_builder, "likes: N * T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "N: int >= 1");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "axes: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "like_axes: list(int)");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXBucketSlice op registration failed: ";
+  }
+}
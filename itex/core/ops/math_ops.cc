@@ -178,6 +178,47 @@ void Register_ITEXFusedRandomOP() {
   }
 }
 
+void Register_ITEXPackedDropoutOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFusedRandomBitMask");
+    TF_OpDefinitionBuilderAddInput(op_builder, "shape: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "rate: DstT");
+
+    // 1 bit per element of `shape`, packed in little-endian bit order.
+    TF_OpDefinitionBuilderAddOutput(op_builder, "mask: uint8");
+
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {int32, int64}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "DstT: {half,bfloat16,float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "fused_ops: list(string) = []");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "seed: int = 0");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "seed2: int = 0");
+    TF_OpDefinitionBuilderSetIsStateful(op_builder, true);
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFusedRandomBitMask op registration failed.";
+  }
+
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXPackedDropout");
+    TF_OpDefinitionBuilderAddInput(op_builder, "x: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "mask: uint8");
+
+    TF_OpDefinitionBuilderAddOutput(op_builder, "y: T");
+
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {half,bfloat16,float}");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unchanged_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXPackedDropout op registration failed.";
+  }
+}
+
 void Register_ITEXRandomUniformOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -217,3 +258,57 @@ void Register_ITEXFusedBinaryOp() {
         << "_ITEXFusedBinary op registration failed: ";
   }
 }
+
+void Register_ITEXFusedElementwiseOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFusedElementwise");
+
+    TF_OpDefinitionBuilderAddInput(op_builder, "args: num_args * T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16,float}");
+    // `fused_ops` is a topologically sorted program; the operands of op `i`
+    // are `operands[2 * i]` and `operands[2 * i + 1]` (-1 for unary ops),
+    // where values below `num_args` are inputs and the others are the results
+    // of previous ops. The last op produces the output.
+    TF_OpDefinitionBuilderAddAttr(op_builder, "fused_ops: list(string)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "operands: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "num_args: int >= 1");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFusedElementwise op registration failed: ";
+  }
+}
+
+void Register_ITEXSegmentExecutorOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXSegmentExecutor");
+
+    TF_OpDefinitionBuilderAddInput(op_builder, "args: N * T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "N: int >= 1");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {float}");
+    // `segment_ops` is a topologically sorted list of ops; the last one
+    // produces the output. For op `i`, `operands` holds the operand count
+    // followed by the operands, where values below `N` are inputs and the
+    // others are the results of previous ops, `params` holds the transpose
+    // bits of MatMul (bit 0 for a, bit 1 for b) or the axis of ConcatV2, and
+    // `shapes` holds the rank followed by the dimensions of its result.
+    // `input_shapes` holds the shapes of the inputs in the same encoding.
+    TF_OpDefinitionBuilderAddAttr(op_builder, "segment_ops: list(string)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "operands: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "params: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "shapes: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "input_shapes: list(int)");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXSegmentExecutor op registration failed: ";
+  }
+}
@@ -365,6 +365,11 @@ void Register_ITEXFusedMatMulOp() {
     TF_OpDefinitionBuilderAddAttr(op_builder, "fused_ops: list(string) = []");
     TF_OpDefinitionBuilderAddAttr(op_builder, "leakyrelu_alpha: float = 0.2");
     TF_OpDefinitionBuilderAddAttr(op_builder, "epsilon: float = 0.0001");
+    // Per op alpha/beta aligned with `fused_ops`, NaN for the default.
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "post_op_alphas: list(float) = []");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "post_op_betas: list(float) = []");
     TF_OpDefinitionBuilderAddAttr(op_builder, "is_filter_const: bool = false");
     TF_OpDefinitionBuilderAddAttr(op_builder, "meta: tensor");
     // TODO(itex): Implement matmul_shape_fn in the future
@@ -2599,7 +2604,7 @@ void Register_ITEXSwishOp() {
     TF_OpDefinitionBuilderAddOutput(op_builder, "activations: T");
 
     TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
-                                                    &unknown_shape_fn);
+                                                    &unchanged_shape_fn);
     TF_RegisterOpDefinition(op_builder, status.get());
     ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
         << "_ITEXSwish op registration failed: ";
@@ -2634,7 +2639,7 @@ void Register_ITEXMishOp() {
                                   "T: {bfloat16, half, float} = DT_FLOAT");
     TF_OpDefinitionBuilderAddOutput(op_builder, "activations: T");
     TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
-                                                    &unknown_shape_fn);
+                                                    &unchanged_shape_fn);
     TF_RegisterOpDefinition(op_builder, status.get());
     ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
         << "_ITEXMish op registration failed: ";
@@ -105,6 +105,8 @@ void RegisterOps() {
   Register_ITEXTensorArrayClose();
   Register_GeluOp();
   Register_GeluGradOp();
+  Register_ITEXBucketPadOp();
+  Register_ITEXBucketSliceOp();
   Register_ITEXConv2DBackpropFilterWithBiasOp();
   Register_ITEXConv2DBackpropInputWithSliceOp();
   Register_ITEXConv3DBackpropFilterWithBiasOp();
@@ -127,6 +129,8 @@ void RegisterOps() {
   Register_ITEXFusedQuantizedConv2DWithCastOp();
   Register_ITEXFusedRandomOP();
   Register_ITEXFusedBinaryOp();
+  Register_ITEXFusedElementwiseOp();
+  Register_ITEXSegmentExecutorOp();
   Register_ITEXGreaterEqualWithCastOp();
   Register_ITEXGreaterWithCastOp();
   Register_ITEXInstanceNormOp();
@@ -134,6 +138,7 @@ void RegisterOps() {
   Register_ITEXLessWithCastOp();
   Register_ITEXMishOp();
   Register_ITEXNotEqualWithCastOp();
+  Register_ITEXPackedDropoutOp();
   Register_ITEXPadWithConv2DOp();
   Register_ITEXPadWithConv3DOp();
   Register_ITEXPadWithDepthwiseConv2dNativeOp();
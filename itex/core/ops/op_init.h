@@ -60,6 +60,8 @@ void Register_GeluGradOp();
 void Register_QKRotaryPositionalEmbeddingOp();
 // There are similar ops called "_FusedConv2D" or in "_FusedMatMul" TF-Proper.
 // We use such custom ops in ITEX to enable more features.
+void Register_ITEXBucketPadOp();
+void Register_ITEXBucketSliceOp();
 void Register_ITEXConv2DBackpropFilterWithBiasOp();
 void Register_ITEXConv2DBackpropInputWithSliceOp();
 void Register_ITEXConv3DBackpropFilterWithBiasOp();
@@ -82,6 +84,8 @@ void Register_ITEXFusedQuantizedConv2DWithDequantizeOp();
 void Register_ITEXFusedQuantizedConv2DWithCastOp();
 void Register_ITEXFusedRandomOP();
 void Register_ITEXFusedBinaryOp();
+void Register_ITEXFusedElementwiseOp();
+void Register_ITEXSegmentExecutorOp();
 void Register_ITEXGreaterEqualWithCastOp();
 void Register_ITEXGreaterWithCastOp();
 void Register_ITEXRandomUniformOp();
@@ -91,6 +95,7 @@ void Register_ITEXLessEqualWithCastOp();
 void Register_ITEXLessWithCastOp();
 void Register_ITEXMishOp();
 void Register_ITEXNotEqualWithCastOp();
+void Register_ITEXPackedDropoutOp();
 void Register_ITEXPadWithConv2DOp();
 void Register_ITEXPadWithConv3DOp();
 void Register_ITEXPadWithDepthwiseConv2dNativeOp();
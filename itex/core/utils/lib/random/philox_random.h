@@ -95,6 +95,9 @@ class Array {
 // NOTE:
 // 1. PhiloxRandom is trivially copyable.
 // 2. PhiloxRandom is compilable by gcc and nvcc.
+template <int Lanes>
+class PhiloxRandomVec;
+
 class PhiloxRandom {
  public:
   using ResultType = Array<uint32, 4>;
@@ -247,10 +250,82 @@ class PhiloxRandom {
   }
 
  private:
+  template <int Lanes>
+  friend class PhiloxRandomVec;
+
   ResultType counter_;
   Key key_;
 };
 
+// Evaluates `Lanes` consecutive PhiloxRandom samples at once on CPU. The
+// rounds are written lane-major over plain arrays with 64-bit products, so the
+// compiler can keep every lane in one SIMD register instead of running the
+// 4x32 state through scalar code. The produced stream is bit-identical to
+// calling PhiloxRandom::operator() `Lanes` times.
+//
+// For example, to fill 32 uint32 with 8 lanes:
+//
+//   PhiloxRandomVec<8> vec_gen(gen);
+//   uint32 samples[PhiloxRandomVec<8>::kResultElementCount];
+//   vec_gen(samples);  // samples[4 * l + i] == i-th value of the l-th sample
+template <int Lanes>
+class PhiloxRandomVec {
+ public:
+  static constexpr int kLanes = Lanes;
+  // The number of uint32 written by each invocation.
+  static constexpr int kResultElementCount =
+      Lanes * PhiloxRandom::kResultElementCount;
+
+  explicit PhiloxRandomVec(const PhiloxRandom& gen) : gen_(gen) {}
+
+  // Skip the specified number of samples of 128-bits in the current stream.
+  void Skip(uint64 count) const { gen_.Skip(count); }
+
+  void operator()(uint32* output) const {
+    alignas(64) uint32 c0[Lanes];
+    alignas(64) uint32 c1[Lanes];
+    alignas(64) uint32 c2[Lanes];
+    alignas(64) uint32 c3[Lanes];
+    for (int l = 0; l < Lanes; ++l) {
+      c0[l] = gen_.counter_[0];
+      c1[l] = gen_.counter_[1];
+      c2[l] = gen_.counter_[2];
+      c3[l] = gen_.counter_[3];
+      gen_.SkipOne();
+    }
+
+    uint32 k0 = gen_.key_[0];
+    uint32 k1 = gen_.key_[1];
+    for (int round = 0; round < 10; ++round) {
+#pragma omp simd
+      for (int l = 0; l < Lanes; ++l) {
+        const uint64 p0 =
+            static_cast<uint64>(PhiloxRandom::kPhiloxM4x32A) * c0[l];
+        const uint64 p1 =
+            static_cast<uint64>(PhiloxRandom::kPhiloxM4x32B) * c2[l];
+        const uint32 n0 = static_cast<uint32>(p1 >> 32) ^ c1[l] ^ k0;
+        const uint32 n2 = static_cast<uint32>(p0 >> 32) ^ c3[l] ^ k1;
+        c1[l] = static_cast<uint32>(p1);
+        c3[l] = static_cast<uint32>(p0);
+        c0[l] = n0;
+        c2[l] = n2;
+      }
+      k0 += PhiloxRandom::kPhiloxW32A;
+      k1 += PhiloxRandom::kPhiloxW32B;
+    }
+
+    for (int l = 0; l < Lanes; ++l) {
+      output[4 * l] = c0[l];
+      output[4 * l + 1] = c1[l];
+      output[4 * l + 2] = c2[l];
+      output[4 * l + 3] = c3[l];
+    }
+  }
+
+ private:
+  PhiloxRandom gen_;
+};
+
 class PCGRandom {
  public:
   // The number of elements that will be returned.
@@ -0,0 +1,189 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/utils/metrics.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/gauge.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/prometheus_exporter.h"
+#include "itex/core/utils/strcat.h"
+#ifndef INTEL_CPU_ONLY
+#include "itex/core/devices/gpu/gpu_pool_allocator.h"
+#endif  // INTEL_CPU_ONLY
+
+namespace itex {
+namespace metrics {
+namespace {
+
+struct ExporterConfig {
+  string file;
+  int64 port = 0;
+  int64 interval_secs = 10;
+};
+
+const ExporterConfig& GetExporterConfig() {
+  static const ExporterConfig config = []() {
+    ExporterConfig config;
+    ITEX_CHECK_OK(ReadStringFromEnvVar("ITEX_METRICS_FILE", "", &config.file));
+    ITEX_CHECK_OK(ReadInt64FromEnvVar("ITEX_METRICS_PORT", 0, &config.port));
+    ITEX_CHECK_OK(ReadInt64FromEnvVar("ITEX_METRICS_INTERVAL_SECS", 10,
+                                      &config.interval_secs));
+    if (config.interval_secs <= 0) config.interval_secs = 10;
+    return config;
+  }();
+  return config;
+}
+
+auto* primitive_cache_lookups = monitoring::Counter<2>::New(
+    "/itex/onednn/primitive_cache_lookups",
+    "Lookups of the oneDNN primitive cached by kernels.", "kernel", "result");
+
+auto* graph_pass_time = monitoring::Counter<1>::New(
+    "/itex/graph/pass_time_us",
+    "Total time spent in each graph optimizer pass, in microseconds.", "pass");
+
+auto* graph_pass_runs = monitoring::Counter<1>::New(
+    "/itex/graph/pass_runs", "Number of runs of each graph optimizer pass.",
+    "pass");
+
+auto* op_executions = monitoring::Counter<1>::New(
+    "/itex/kernel/executions", "Number of executions of each kernel.", "op");
+
+auto* weight_cache_bytes =
+    monitoring::Gauge<std::function<int64_t()>, 1>::New(
+        "/itex/onednn/weight_cache_bytes",
+        "Bytes of weights cached in oneDNN formats by kernels.", "kind");
+
+std::atomic<int64> private_weight_bytes{0};
+std::atomic<int64> shared_weight_bytes{0};
+
+auto* scratchpad_bytes = monitoring::Gauge<std::function<int64_t()>, 1>::New(
+    "/itex/scratchpad/bytes",
+    "Bytes reserved by the scratchpad arenas of all threads, and the max "
+    "borrowed at once from one of them.",
+    "kind");
+
+std::atomic<int64> scratchpad_reserved_bytes{0};
+std::atomic<int64> scratchpad_high_water_mark{0};
+
+#ifndef INTEL_CPU_ONLY
+auto* allocator_bytes_in_use =
+    monitoring::Gauge<std::function<int64_t()>, 1>::New(
+        "/itex/allocator/bytes_in_use",
+        "Bytes allocated by the BFC allocator of each device.", "device");
+
+auto* allocator_peak_bytes_in_use =
+    monitoring::Gauge<std::function<int64_t()>, 1>::New(
+        "/itex/allocator/peak_bytes_in_use",
+        "Peak bytes allocated by the BFC allocator of each device.", "device");
+
+// Polls the allocators of all devices whenever metrics are collected.
+void RegisterAllocatorGauges() {
+  int device_count = 0;
+  ITEX_GPUGetDeviceCount(&device_count);
+  for (int i = 0; i < device_count; ++i) {
+    ITEX_GPUDevice* device = nullptr;
+    std::shared_ptr<BFCAllocator> alloc;
+    if (ITEX_GPUGetDevice(&device, i) != ITEX_GPU_SUCCESS ||
+        ITEX_GPUGetAllocator(device, &alloc) != ITEX_GPU_SUCCESS) {
+      continue;
+    }
+    const string label = strings::StrCat("XPU:", i);
+    allocator_bytes_in_use->GetCell(label)->Set(
+        [alloc]() { return alloc->BytesInUse(); });
+    allocator_peak_bytes_in_use->GetCell(label)->Set(
+        [alloc]() { return alloc->PeakBytesInUse(); });
+  }
+}
+#endif  // INTEL_CPU_ONLY
+
+}  // namespace
+
+bool IsEnabled() {
+  static const bool enabled = !GetExporterConfig().file.empty() ||
+                              GetExporterConfig().port > 0;
+  return enabled;
+}
+
+void StartExporter() {
+  static std::once_flag once;
+  std::call_once(once, []() {
+    if (!IsEnabled()) return;
+    weight_cache_bytes->GetCell("private")->Set(
+        []() { return private_weight_bytes.load(); });
+    weight_cache_bytes->GetCell("shared")->Set(
+        []() { return shared_weight_bytes.load(); });
+    scratchpad_bytes->GetCell("reserved")->Set(
+        []() { return scratchpad_reserved_bytes.load(); });
+    scratchpad_bytes->GetCell("high_water_mark")->Set(
+        []() { return scratchpad_high_water_mark.load(); });
+#ifndef INTEL_CPU_ONLY
+    RegisterAllocatorGauges();
+#endif  // INTEL_CPU_ONLY
+
+    const ExporterConfig& config = GetExporterConfig();
+    // The exporter lives as long as the process.
+    auto* exporter = new monitoring::PrometheusExporter(
+        config.file, static_cast<int>(config.port), config.interval_secs);
+    exporter->PeriodicallyExportMetrics();
+  });
+}
+
+void RecordPrimitiveCacheLookup(const string& kernel, bool hit) {
+  if (!IsEnabled()) return;
+  primitive_cache_lookups->GetCell(kernel, hit ? "hit" : "miss")
+      ->IncrementBy(1);
+}
+
+void UpdateWeightCacheBytes(const string& kind, int64 delta) {
+  if (!IsEnabled()) return;
+  if (kind == "shared") {
+    shared_weight_bytes += delta;
+  } else {
+    private_weight_bytes += delta;
+  }
+}
+
+void UpdateScratchpadBytes(int64 delta) {
+  if (!IsEnabled()) return;
+  scratchpad_reserved_bytes += delta;
+}
+
+void RecordScratchpadHighWaterMark(int64 bytes) {
+  if (!IsEnabled()) return;
+  int64 current = scratchpad_high_water_mark.load();
+  while (current < bytes &&
+         !scratchpad_high_water_mark.compare_exchange_weak(current, bytes)) {
+  }
+}
+
+void RecordGraphPassTime(const string& pass, uint64 micros) {
+  if (!IsEnabled()) return;
+  graph_pass_time->GetCell(pass)->IncrementBy(micros);
+  graph_pass_runs->GetCell(pass)->IncrementBy(1);
+}
+
+monitoring::CounterCell* GetOpExecutionCounter(const string& op_type) {
+  return op_executions->GetCell(op_type);
+}
+
+}  // namespace metrics
+}  // namespace itex
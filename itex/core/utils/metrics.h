@@ -0,0 +1,62 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_UTILS_METRICS_H_
+#define ITEX_CORE_UTILS_METRICS_H_
+
+#include <string>
+
+#include "itex/core/utils/counter.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+namespace metrics {
+
+// Runtime metrics of ITEX, registered in the default CollectionRegistry.
+// They're only recorded when an exporter is configured, through
+// ITEX_METRICS_FILE or ITEX_METRICS_PORT, so that hot paths pay a single
+// branch otherwise.
+
+// Returns true if metrics are recorded in this process.
+bool IsEnabled();
+
+// Starts the exporter configured by the environment, if any. It's safe to call
+// this more than once.
+void StartExporter();
+
+// Records a lookup of the cached oneDNN primitive of `kernel`. Kernels check
+// IsEnabled() first, so that they don't build the label on every run.
+void RecordPrimitiveCacheLookup(const string& kernel, bool hit);
+
+// Adds `delta` bytes to the weights cached by oneDNN kernels, either in
+// "private" buffers of a kernel or in the "shared" prepacked weight store.
+void UpdateWeightCacheBytes(const string& kind, int64 delta);
+
+// Adds `delta` bytes to the memory reserved by scratchpad arenas.
+void UpdateScratchpadBytes(int64 delta);
+
+// Records `bytes` borrowed at once from a scratchpad arena.
+void RecordScratchpadHighWaterMark(int64 bytes);
+
+// Records a run of the graph optimizer pass `pass` which took `micros`.
+void RecordGraphPassTime(const string& pass, uint64 micros);
+
+// Returns the cell counting the executions of kernels of `op_type`.
+monitoring::CounterCell* GetOpExecutionCounter(const string& op_type);
+
+}  // namespace metrics
+}  // namespace itex
+
+#endif  // ITEX_CORE_UTILS_METRICS_H_
@@ -29,6 +29,9 @@ const std::vector<PostOpInfo>& PostOpUtil::GetAllPostOpInfo() {
   const float kAlphaOne = 1;
   const float kBetaZero = 0;
   const float kBetaSix = 6;
+  // Same defaults as `tf.keras.activations.hard_sigmoid`.
+  const float kHardSigmoidAlpha = 0.2;
+  const float kHardSigmoidBeta = 0.5;
 
   // TODO(itex): Try map container to replace vector here.
   static std::vector<PostOpInfo> info_vec = {
@@ -36,6 +39,10 @@ const std::vector<PostOpInfo>& PostOpUtil::GetAllPostOpInfo() {
       {"Add", kind::sum, algorithm::undef, kAlphaOne, kBetaZero},
 
       /* Kind: eltwise */
+      // `Clip` has no meaningful default, its bounds are always passed by
+      // `SetPostOpParams`.
+      {"Clip", kind::eltwise, algorithm::eltwise_clip_v2, kAlphaZero,
+       kBetaZero},
       {"Elu", kind::eltwise, algorithm::eltwise_elu, kAlphaOne, kBetaZero},
       // Here `Gelu` is a placeholder for activation check, it will be
       // converted to `"GeluExact` or `"GeluApproximate` after remapper.
@@ -45,6 +52,8 @@ const std::vector<PostOpInfo>& PostOpUtil::GetAllPostOpInfo() {
        kBetaZero},
       {"GeluApproximate", kind::eltwise, algorithm::eltwise_gelu_tanh,
        kAlphaZero, kBetaZero},
+      {"HardSigmoid", kind::eltwise, algorithm::eltwise_hardsigmoid,
+       kHardSigmoidAlpha, kHardSigmoidBeta},
       {"HardSwish", kind::eltwise, algorithm::eltwise_hardswish, kAlphaZero,
        kBetaZero},
       {"LeakyRelu", kind::eltwise, algorithm::eltwise_relu, kAlphaZero,
@@ -56,6 +65,8 @@ const std::vector<PostOpInfo>& PostOpUtil::GetAllPostOpInfo() {
       {"Relu", kind::eltwise, algorithm::eltwise_relu, kAlphaZero, kBetaZero},
       {"Relu6", kind::eltwise, algorithm::eltwise_clip_v2, kAlphaZero,
        kBetaSix},
+      {"Round", kind::eltwise, algorithm::eltwise_round, kAlphaZero,
+       kBetaZero},
       {"Sigmoid", kind::eltwise, algorithm::eltwise_logistic, kAlphaOne,
        kBetaZero},
       {"_ITEXSwish", kind::eltwise, algorithm::eltwise_swish, kAlphaOne,
@@ -65,6 +76,10 @@ const std::vector<PostOpInfo>& PostOpUtil::GetAllPostOpInfo() {
       /* Kind: binary */
       {"BinaryAdd", kind::binary, algorithm::binary_add, kAlphaOne, kBetaZero},
       {"BinaryMul", kind::binary, algorithm::binary_mul, kAlphaOne, kBetaZero},
+      {"BinarySub", kind::binary, algorithm::binary_sub, kAlphaOne, kBetaZero},
+      {"BinaryDiv", kind::binary, algorithm::binary_div, kAlphaOne, kBetaZero},
+      {"BinaryMax", kind::binary, algorithm::binary_max, kAlphaOne, kBetaZero},
+      {"BinaryMin", kind::binary, algorithm::binary_min, kAlphaOne, kBetaZero},
   };
 
   return info_vec;
@@ -73,6 +88,9 @@ const std::vector<PostOpInfo>& PostOpUtil::GetAllPostOpInfo() {
 bool PostOpUtil::AddOps(const std::vector<string>& fused_ops) {
   for (string name : fused_ops) {
     const PostOpInfo* info = GetPostOpInfoByName(name);
+    // Position of this op in `postop_scale_list_`, or -1 if it's not a post op.
+    fused_op_positions_.push_back(
+        info != nullptr ? static_cast<int>(postop_scale_list_.size()) : -1);
     if (info != nullptr) {
       kind op_kind = info->kind;
       // Default `scale` is 1 if no runtime value is passed.
@@ -93,6 +111,7 @@ bool PostOpUtil::AddOps(const std::vector<string>& fused_ops) {
         // TODO(itex): Scale for binary is useless now, but it can be supported
         //             in future once oneDNN supports it.
         postop_scale_list_.push_back(std::make_pair(name, scale_default));
+        binary_positions_.push_back(postop_scale_list_.size() - 1);
       } else {
         // TODO(itex): Support `depthwise` in future.
         ITEX_VLOG(3) << "PostOpUtil: unsupported post op fusion: " << name;
@@ -193,6 +212,24 @@ void PostOpUtil::SetLinearAlphaBeta(float alpha, float beta) {
   this->linear_beta_ = beta;
 }
 
+bool PostOpUtil::SetPostOpParams(const std::vector<float>& alphas,
+                                 const std::vector<float>& betas) {
+  if (alphas.size() != fused_op_positions_.size() ||
+      betas.size() != fused_op_positions_.size()) {
+    ITEX_VLOG(3) << "PostOpUtil: expect " << fused_op_positions_.size()
+                 << " post op params, but got " << alphas.size() << " alphas"
+                 << " and " << betas.size() << " betas";
+    return false;
+  }
+
+  postop_params_.assign(postop_scale_list_.size(), {NAN, NAN});
+  for (size_t i = 0; i < fused_op_positions_.size(); ++i) {
+    if (fused_op_positions_[i] < 0) continue;
+    postop_params_[fused_op_positions_[i]] = {alphas[i], betas[i]};
+  }
+  return true;
+}
+
 void PostOpUtil::SetPostOpScale(const absl::string_view name, float scale) {
   bool is_find = false;
   for (auto& postop_data : postop_scale_list_) {
@@ -237,9 +274,9 @@ bool PostOpUtil::IsSupportedActivation(const absl::string_view op_name) {
 void PostOpUtil::SetPostOp(dnnl::post_ops* post_ops,
                            const std::vector<memory::desc>& md_list) {
   auto it = md_list.begin();
-  for (const auto& postop_data : postop_scale_list_) {
-    const absl::string_view name = postop_data.first;
-    float scale = postop_data.second;
+  for (size_t i = 0; i < postop_scale_list_.size(); ++i) {
+    const absl::string_view name = postop_scale_list_[i].first;
+    float scale = postop_scale_list_[i].second;
 
     const PostOpInfo* info = GetPostOpInfoByName(name);
     ITEX_CHECK(info != nullptr);
@@ -248,12 +285,20 @@ void PostOpUtil::SetPostOp(dnnl::post_ops* post_ops,
     if (op_kind == kind::eltwise) {
       float alpha = info->alpha;
       float beta = info->beta;
-      if (this->has_leaky_relu_) {
+      // Per op params take precedence, NaN means keep the default.
+      bool has_alpha = false;
+      if (i < postop_params_.size()) {
+        has_alpha = !std::isnan(postop_params_[i].first);
+        if (has_alpha) alpha = postop_params_[i].first;
+        if (!std::isnan(postop_params_[i].second))
+          beta = postop_params_[i].second;
+      }
+      if (name == "LeakyRelu" && !has_alpha) {
         alpha = this->leaky_relu_alpha_;
         ITEX_CHECK(!std::isnan(alpha))
             << "PostOpUtil: LeakyRelu alpha is never set";
       }
-      if (this->has_linear_) {
+      if (name == "Linear" && !has_alpha) {
         alpha = this->linear_alpha_;
         ITEX_CHECK(!std::isnan(alpha))
             << "PostOpUtil: Linear alpha is never set";
@@ -90,6 +90,13 @@ class PostOpUtil {
   // Will report error if no `Linear` in post ops.
   void SetLinearAlphaBeta(float alpha, float beta);
 
+  // Set per op `alpha`/`beta`, both aligned with the `fused_ops` passed to
+  // `AddOps`, e.g. the bounds of `Clip`. NaN keeps the default of the op, and
+  // entries of ops which are not post ops, such as `BiasAdd`, are ignored.
+  // Return `false` if the sizes mismatch.
+  bool SetPostOpParams(const std::vector<float>& alphas,
+                       const std::vector<float>& betas);
+
   // Set scale for post op. Sometimes the scale is only available during node
   // execution, so we need to set scale to the post op which is created in node
   // construction
@@ -140,6 +147,13 @@ class PostOpUtil {
   // Record op number to support multiple Binary post op fusion.
   inline int GetBinaryNum() { return binary_num_; }
 
+  // Index of the `binary_idx`-th Binary op in the post op chain, which is
+  // needed by `DNNL_ARG_ATTR_MULTIPLE_POST_OP` when eltwise ops are
+  // interleaved with Binary ops.
+  inline int GetBinaryPostOpIndex(int binary_idx) {
+    return binary_positions_[binary_idx];
+  }
+
  private:
   // Return the read-only table contains supported `PostOpInfo`.
   // This table is converted from oneDNN.
@@ -160,6 +174,12 @@ class PostOpUtil {
   // Save the post op and its corresponding scale factor
   // The first element is post op name, second element is corresponding scale
   std::vector<std::pair<string, float>> postop_scale_list_;
+  // Per op alpha/beta, aligned with `postop_scale_list_`.
+  std::vector<std::pair<float, float>> postop_params_;
+  // Position in `postop_scale_list_` of each fused op, -1 if not a post op.
+  std::vector<int> fused_op_positions_;
+  // Position in `postop_scale_list_` of each Binary op.
+  std::vector<int> binary_positions_;
 
   // Member to save the output scale parameter
   OutputScaleParam output_scale_param_;
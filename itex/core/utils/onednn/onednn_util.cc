@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "itex/core/utils/onednn/prepacked_weight_store.h"
 #include "itex/core/utils/register_types.h"
 
 namespace itex {
@@ -49,7 +50,8 @@ bool WeightCacheManager<T>::IsEmpty() TF_LOCKS_EXCLUDED(mu_) {
   tf_shared_lock lock(&mu_);
   // TODO(itex): investigate why weight_cached_data_.NumElements() == 1
   // instead of 0,  while weight_cached_data_.IsInitialized() == True
-  return (!weight_cached_data_.IsInitialized());
+  return (!weight_cached_data_.IsInitialized() &&
+          weight_shared_data_ == nullptr);
 }
 
 template <typename T>
@@ -59,7 +61,7 @@ void WeightCacheManager<T>::SetCache(
     const dnnl::engine& onednn_engine) TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock lock(&mu_);
 
-  if (weight_cached_data_.IsInitialized()) {
+  if (weight_cached_data_.IsInitialized() || weight_shared_data_ != nullptr) {
     return;
   }
 
@@ -67,6 +69,38 @@ void WeightCacheManager<T>::SetCache(
   dnnl::memory weight_mem =
       CreateDnnlMemory(weight_original_md, onednn_engine, weight_data);
 
+  // Share the reordered weight with the other processes through the store.
+  PrepackedWeightStore* store = PrepackedWeightStore::Global();
+  if (store != nullptr &&
+      onednn_engine.get_kind() == dnnl::engine::kind::cpu) {
+    const size_t size = weight_expected_md.get_size();
+    const PrepackedWeightStore::Key key = PrepackedWeightStore::Fingerprint(
+        weight_original_md, weight_data, weight_expected_md);
+    const void* shared_data = store->Lookup(key, size);
+    if (shared_data == nullptr) {
+      Tensor weight_reorder_tensor;
+      OP_REQUIRES_OK(context, context->allocate_temp(
+                                  DataTypeToEnum<ShortDT>::value,
+                                  TensorShape({static_cast<int64_t>(size)}),
+                                  &weight_reorder_tensor));
+      dnnl::memory weight_reorder_mem = CreateDnnlMemory(
+          weight_expected_md, onednn_engine,
+          weight_reorder_tensor.flat<ShortDT>().data());
+      ReorderMemory(*context, &weight_mem, &weight_reorder_mem, onednn_engine);
+      shared_data = store->Insert(
+          key, weight_reorder_tensor.flat<ShortDT>().data(), size);
+    }
+    // Fall back to the private cache if the store can't be used.
+    if (shared_data != nullptr) {
+      weight_shared_data_ = static_cast<const T*>(shared_data);
+      weight_shared_md_ = weight_expected_md;
+      cached_bytes_ = size;
+      cached_kind_ = "shared";
+      metrics::UpdateWeightCacheBytes(cached_kind_, cached_bytes_);
+      return;
+    }
+  }
+
   // Create cached weight buffer
   Tensor* weight_cached_tensor = nullptr;
   size_t weight_size = weight_expected_md.get_size();
@@ -84,6 +118,9 @@ void WeightCacheManager<T>::SetCache(
 
   // Execute reorder
   ReorderMemory(*context, &weight_mem, &weight_reorder_mem, onednn_engine);
+  cached_bytes_ = weight_size;
+  cached_kind_ = "private";
+  metrics::UpdateWeightCacheBytes(cached_kind_, cached_bytes_);
 
   // Cache the memory descriptor
   Tensor* weight_md_cached_tensor = nullptr;
@@ -107,6 +144,12 @@ T* WeightCacheManager<T>::GetCache(OpKernelContext* context,
                                    const dnnl::memory::desc& expected_md)
     TF_LOCKS_EXCLUDED(mu_) {
   tf_shared_lock lock(&mu_);
+  // oneDNN primitives only read weights, so the read-only mapping of the
+  // store can be handed out.
+  if (weight_shared_data_ != nullptr) {
+    if (weight_shared_md_ != expected_md) return nullptr;
+    return const_cast<T*>(weight_shared_data_);
+  }
   const Tensor* weight_cached_data = weight_cached_data_.AccessTensor(context);
   const Tensor* weight_cached_md = weight_cached_md_.AccessTensor(context);
 
@@ -30,9 +30,11 @@ limitations under the License.
 #endif                    // INTEL_CPU_ONLY
 
 #include "itex/core/utils/logging.h"
+#include "itex/core/utils/metrics.h"
 #include "itex/core/utils/onednn/mkl_threadpool.h"
 #include "itex/core/utils/op_kernel.h"
 #include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/scratchpad_arena.h"
 #include "itex/core/utils/status.h"
 #include "itex/core/utils/strcat.h"
 #include "itex/core/utils/tensor_format.h"
@@ -512,6 +514,24 @@ inline void* GetTensorBuffer(const Tensor* tensor) {
   return const_cast<void*>(static_cast<const void*>(tensor->flat<T>().data()));
 }
 
+// Returns `num_elements` of T for the scratchpad of a oneDNN primitive, or a
+// transient reorder buffer, valid until the ScratchpadArena::Scope opened by
+// the kernel exits. On CPU they're borrowed from the arena of the calling
+// thread. On GPU `tensor` is allocated as a temporary instead, since the
+// device allocator already reuses memory in stream order.
+template <typename T>
+inline Status AllocateScratchpad(OpKernelContext* context, int64 num_elements,
+                                 Tensor* tensor, void** data) {
+#ifdef INTEL_CPU_ONLY
+  *data = ScratchpadArena::ThreadLocal()->Allocate(num_elements * sizeof(T));
+#else
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DataTypeToEnum<T>::v(), TensorShape({num_elements}), tensor));
+  *data = GetTensorBuffer<T>(tensor);
+#endif  // INTEL_CPU_ONLY
+  return Status::OK();
+}
+
 // Create memory desc with format tag, it is the equivalent way to create memory
 // desc with strides in CreateBlockedMemDesc
 template <typename T>
@@ -574,11 +594,15 @@ template <typename T>
 class WeightCacheManager {
  public:
   WeightCacheManager() = default;
-  ~WeightCacheManager() = default;
+  ~WeightCacheManager() {
+    metrics::UpdateWeightCacheBytes(cached_kind_, -cached_bytes_);
+  }
 
   bool IsEmpty() TF_LOCKS_EXCLUDED(mu_);
 
-  // Cache the reordered weight buffer & weight md as persistent tensors.
+  // Cache the reordered weight buffer & weight md as persistent tensors. On
+  // CPU, the buffer is shared with other processes instead if the prepacked
+  // weight store is enabled.
   // Only one thread can execute this method at any given time.
   void SetCache(OpKernelContext* context,
                 const dnnl::memory::desc& weight_original_md,
@@ -595,6 +619,12 @@ class WeightCacheManager {
   mutex mu_;
   PersistentTensor weight_cached_data_ TF_GUARDED_BY(mu_);
   PersistentTensor weight_cached_md_ TF_GUARDED_BY(mu_);
+  // Read-only weight buffer mapped from the prepacked weight store.
+  const T* weight_shared_data_ TF_GUARDED_BY(mu_) = nullptr;
+  dnnl::memory::desc weight_shared_md_ TF_GUARDED_BY(mu_);
+  // Size and kind of the cached weight, as reported to the metrics.
+  int64 cached_bytes_ = 0;
+  string cached_kind_;
 };
 
 // Bias cache is used to avoid scale the bias tensor repetitively in INT8
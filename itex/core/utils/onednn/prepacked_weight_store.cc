@@ -0,0 +1,199 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/utils/onednn/prepacked_weight_store.h"
+
+#include <cstring>
+#include <utility>
+
+#include "itex/core/utils/env.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/fingerprint.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/path.h"
+#include "itex/core/utils/strcat.h"
+
+namespace itex {
+namespace {
+
+constexpr char kMagic[8] = {'I', 'T', 'E', 'X', 'P', 'W', 'S', '\0'};
+
+// Header of a store file. It's followed by the layouts of the key, padded to
+// a multiple of 64 bytes so that the packed data following them is aligned as
+// well as oneDNN buffers.
+struct FileHeader {
+  char magic[8];
+  uint32 version;
+  uint32 layouts_size;
+  uint64 id;
+  uint64 size;
+  uint64 data_fp_low64;
+  uint64 data_fp_high64;
+  char padding[16];
+};
+static_assert(sizeof(FileHeader) == 64, "Unexpected store file header size");
+
+// Offset of the packed data in the file of a key with `layouts`.
+size_t DataOffset(const string& layouts) {
+  constexpr size_t kAlignment = sizeof(FileHeader);
+  return sizeof(FileHeader) +
+         (layouts.size() + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Appends the layout described by `md` to `out`.
+void AppendLayout(const dnnl::memory::desc& md, string* out) {
+  strings::StrAppend(out, static_cast<int>(md.get_data_type()), ":",
+                     static_cast<int>(md.get_format_kind()), ":");
+  for (auto dim : md.get_dims()) strings::StrAppend(out, dim, ",");
+  strings::StrAppend(out, ":");
+  if (md.get_format_kind() != dnnl::memory::format_kind::blocked) return;
+  for (auto stride : md.get_strides()) strings::StrAppend(out, stride, ",");
+  strings::StrAppend(out, ":");
+  for (auto blk : md.get_inner_blks()) strings::StrAppend(out, blk, ",");
+  strings::StrAppend(out, ":");
+  for (auto idx : md.get_inner_idxs()) strings::StrAppend(out, idx, ",");
+  strings::StrAppend(out, ";");
+}
+
+}  // namespace
+
+PrepackedWeightStore* PrepackedWeightStore::Global() {
+  static PrepackedWeightStore* store = []() -> PrepackedWeightStore* {
+    string dir;
+    ITEX_CHECK_OK(ReadStringFromEnvVar("ITEX_WEIGHT_STORE_DIR", "", &dir));
+    if (dir.empty()) return nullptr;
+    Status status = Env::Default()->RecursivelyCreateDir(dir);
+    if (!status.ok()) {
+      ITEX_LOG(WARNING) << "Prepacked weight store is disabled: "
+                        << status.ToString();
+      return nullptr;
+    }
+    ITEX_VLOG(1) << "Prepacked weight store in " << dir;
+    return new PrepackedWeightStore(dir);
+  }();
+  return store;
+}
+
+PrepackedWeightStore::Key PrepackedWeightStore::Fingerprint(
+    const dnnl::memory::desc& plain_md, const void* data,
+    const dnnl::memory::desc& packed_md) {
+  Key key;
+  AppendLayout(plain_md, &key.layouts);
+  AppendLayout(packed_md, &key.layouts);
+  key.data_fp = Fingerprint128(
+      StringPiece(static_cast<const char*>(data), plain_md.get_size()));
+  key.id = FingerprintCat64(Fingerprint64(key.layouts), key.data_fp.low64);
+  return key;
+}
+
+string PrepackedWeightStore::FilePath(uint64 id) const {
+  const string name = strings::StrCat(strings::Hex(id, strings::kZeroPad16),
+                                      ".v", kVersion, ".itexw");
+  return io::JoinPath(dir_, name);
+}
+
+const void* PrepackedWeightStore::Lookup(const Key& key, size_t size) {
+  mutex_lock lock(&mu_);
+  return MapLocked(key, size);
+}
+
+const void* PrepackedWeightStore::Insert(const Key& key, const void* data,
+                                         size_t size) {
+  mutex_lock lock(&mu_);
+  // Another process may have stored the same weight meanwhile.
+  const void* shared = MapLocked(key, size);
+  if (shared != nullptr) return shared;
+  // The file holds another weight whose name collides; keep it for that one.
+  if (Env::Default()->FileExists(FilePath(key.id)).ok()) return nullptr;
+
+  Status status = WriteFile(key, data, size);
+  if (!status.ok()) {
+    ITEX_LOG(WARNING) << "Failed to store prepacked weight: "
+                      << status.ToString();
+    return nullptr;
+  }
+  return MapLocked(key, size);
+}
+
+const void* PrepackedWeightStore::MapLocked(const Key& key, size_t size) {
+  auto it = regions_.find(key.id);
+  if (it == regions_.end()) {
+    const string path = FilePath(key.id);
+    if (!Env::Default()->FileExists(path).ok()) return nullptr;
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status status =
+        Env::Default()->NewReadOnlyMemoryRegionFromFile(path, &region);
+    if (!status.ok()) {
+      ITEX_LOG(WARNING) << "Failed to map prepacked weight: "
+                        << status.ToString();
+      return nullptr;
+    }
+    it = regions_.emplace(key.id, std::move(region)).first;
+  }
+
+  ReadOnlyMemoryRegion* region = it->second.get();
+  const char* file_data = static_cast<const char*>(region->data());
+  const FileHeader* header = reinterpret_cast<const FileHeader*>(file_data);
+  const size_t data_offset = DataOffset(key.layouts);
+  if (region->length() != data_offset + size ||
+      std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+      header->version != kVersion || header->id != key.id ||
+      header->size != size || header->data_fp_low64 != key.data_fp.low64 ||
+      header->data_fp_high64 != key.data_fp.high64 ||
+      header->layouts_size != key.layouts.size() ||
+      std::memcmp(file_data + sizeof(FileHeader), key.layouts.data(),
+                  key.layouts.size()) != 0) {
+    ITEX_LOG(WARNING) << "Ignoring invalid prepacked weight file "
+                      << FilePath(key.id);
+    regions_.erase(it);
+    return nullptr;
+  }
+  return file_data + data_offset;
+}
+
+Status PrepackedWeightStore::WriteFile(const Key& key, const void* data,
+                                       size_t size) const {
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.layouts_size = key.layouts.size();
+  header.id = key.id;
+  header.size = size;
+  header.data_fp_low64 = key.data_fp.low64;
+  header.data_fp_high64 = key.data_fp.high64;
+  string layouts = key.layouts;
+  layouts.resize(DataOffset(key.layouts) - sizeof(FileHeader), '\0');
+
+  // Write to a file private to this process first, then publish it at once,
+  // so that other processes never map a partial file.
+  Env* env = Env::Default();
+  const string path = FilePath(key.id);
+  const string tmp_path = strings::StrCat(path, ".tmp", env->GetProcessId());
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(tmp_path, &file));
+  Status status = file->Append(
+      StringPiece(reinterpret_cast<const char*>(&header), sizeof(header)));
+  if (status.ok()) status = file->Append(layouts);
+  if (status.ok()) {
+    status = file->Append(StringPiece(static_cast<const char*>(data), size));
+  }
+  if (status.ok()) status = file->Close();
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) env->DeleteFile(tmp_path).IgnoreError();
+  return status;
+}
+
+}  // namespace itex
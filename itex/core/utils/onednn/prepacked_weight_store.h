@@ -0,0 +1,92 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_UTILS_ONEDNN_PREPACKED_WEIGHT_STORE_H_
+#define ITEX_CORE_UTILS_ONEDNN_PREPACKED_WEIGHT_STORE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "dnnl.hpp"  // NOLINT(build/include_subdir)
+#include "itex/core/utils/file_system.h"
+#include "itex/core/utils/fingerprint.h"
+#include "itex/core/utils/mutex.h"
+#include "itex/core/utils/status.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+// Store of weights prepacked into oneDNN blocked formats, shared by all the
+// processes on a host. It's enabled by setting ITEX_WEIGHT_STORE_DIR to a
+// directory on a local file system.
+//
+// Every packed weight is written once into its own file, named after the
+// fingerprint of the plain weight and of its packed layout, so replicas of a
+// model find the weights packed by the first one. The file also records the
+// layouts and a 128-bit fingerprint of the plain weight, which are checked
+// when it's mapped, so a collision of the 64-bit file names is never served.
+// Files are mapped read-only, hence all processes share one physical copy
+// through the page cache.
+class PrepackedWeightStore {
+ public:
+  // Version of the file format, bumped on incompatible changes.
+  static constexpr uint32 kVersion = 2;
+
+  // Identifies a plain weight once packed into a given layout.
+  struct Key {
+    // Names the file of the weight.
+    uint64 id;
+    // Plain and packed layouts.
+    string layouts;
+    // Fingerprint of the plain data.
+    Fprint128 data_fp;
+  };
+
+  // Returns the store of this process, or nullptr if it's disabled.
+  static PrepackedWeightStore* Global();
+
+  // Returns the key of `data`, described by `plain_md`, once packed as
+  // `packed_md`.
+  static Key Fingerprint(const dnnl::memory::desc& plain_md, const void* data,
+                         const dnnl::memory::desc& packed_md);
+
+  // Returns the packed weight stored under `key`, or nullptr if there's no
+  // valid one of `size` bytes.
+  const void* Lookup(const Key& key, size_t size) TF_LOCKS_EXCLUDED(mu_);
+
+  // Stores `size` bytes of packed `data` under `key`, and returns the shared
+  // copy of them, or nullptr if they couldn't be written.
+  const void* Insert(const Key& key, const void* data, size_t size)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  explicit PrepackedWeightStore(const string& dir) : dir_(dir) {}
+
+  string FilePath(uint64 id) const;
+  // Maps the file of `key` if it's valid. Returns nullptr otherwise.
+  const void* MapLocked(const Key& key, size_t size)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status WriteFile(const Key& key, const void* data, size_t size) const;
+
+  const string dir_;
+  mutex mu_;
+  absl::flat_hash_map<uint64, std::unique_ptr<ReadOnlyMemoryRegion>> regions_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace itex
+
+#endif  // ITEX_CORE_UTILS_ONEDNN_PREPACKED_WEIGHT_STORE_H_
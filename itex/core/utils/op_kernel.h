@@ -33,6 +33,7 @@ limitations under the License.
 #include "itex/core/utils/env_var.h"
 #include "itex/core/utils/kernel_def_util.h"
 #include "itex/core/utils/logging.h"
+#include "itex/core/utils/metrics.h"
 #include "itex/core/utils/mutex.h"
 #include "itex/core/utils/notification.h"
 #include "itex/core/utils/plugin_tensor.h"
@@ -653,7 +654,18 @@ class OpKernel {
 
   const absl::string_view type() const { return op_type; }
 
-  void set_type(absl::string_view type) { op_type = type; }
+  void set_type(absl::string_view type) {
+    op_type = type;
+    if (metrics::IsEnabled()) {
+      execution_counter_ = metrics::GetOpExecutionCounter(string(type));
+    }
+  }
+
+  // Returns the counter of executions of this kernel, or nullptr if metrics
+  // are disabled.
+  monitoring::CounterCell* execution_counter() const {
+    return execution_counter_;
+  }
 
   std::string ShapeTraceString(const OpKernelContext& ctx) const;
 
@@ -673,6 +685,7 @@ class OpKernel {
  private:
   absl::string_view op_name;
   absl::string_view op_type;
+  monitoring::CounterCell* execution_counter_ = nullptr;
 #ifdef USING_NEXTPLUGGABLE_DEVICE
   gtl::InlinedVector<TensorShape, OUTPUT_SIZE> output_shape_in_first_step_;
   gtl::InlinedVector<std::shared_ptr<ITEX_PJRT_Buffer>, OUTPUT_SIZE>
@@ -859,6 +872,10 @@ inline void RunWithSyncHandler(
 inline void RunOrWaitUntilFinish(
     OpKernelContext* context, OpKernel* op,
     AsyncOpKernel::DoneCallback* callback = nullptr) {
+  if (op->execution_counter() != nullptr) {
+    op->execution_counter()->IncrementBy(1);
+  }
+
 #ifdef USING_NEXTPLUGGABLE_DEVICE
   auto& npdConfig = ITEXNpdConfig::getNpdConfig();
   if (npdConfig.ifUsingNextPluggableDevice()) {
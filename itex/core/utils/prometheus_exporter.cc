@@ -0,0 +1,203 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/utils/prometheus_exporter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/strcat.h"
+
+namespace itex {
+namespace monitoring {
+namespace {
+
+// Time a client gets to send its request, so that an idle connection doesn't
+// hold up the clients after it.
+constexpr int kRequestTimeoutSecs = 2;
+
+// Turns a path-like metric name, e.g. "/itex/kernel/executions", into a valid
+// Prometheus one, e.g. "itex_kernel_executions".
+string SanitizeName(const string& name) {
+  string result;
+  for (char c : name) {
+    if (isalnum(static_cast<unsigned char>(c)) || c == '_') {
+      result.push_back(c);
+    } else if (!result.empty()) {
+      result.push_back('_');
+    }
+  }
+  return result;
+}
+
+string EscapeLabelValue(const string& value) {
+  string result;
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      result.push_back('\\');
+      result.push_back(c);
+    } else if (c == '\n') {
+      result.append("\\n");
+    } else {
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+bool WriteAll(int fd, const string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    if (n <= 0) return false;
+    written += n;
+  }
+  return true;
+}
+
+}  // namespace
+
+PrometheusExporter::PrometheusExporter(const string& file, int port,
+                                       int64 interval_secs)
+    : file_(file), port_(port), interval_secs_(interval_secs) {}
+
+void PrometheusExporter::PeriodicallyExportMetrics() {
+  Env* env = Env::Default();
+  if (!file_.empty() && file_thread_ == nullptr) {
+    file_thread_.reset(
+        env->StartThread(ThreadOptions(), "itex_metrics_file", [this, env]() {
+          while (true) {
+            ExportMetrics();
+            env->SleepForMicroseconds(interval_secs_ *
+                                      EnvTime::kSecondsToMicros);
+          }
+        }));
+  }
+  if (port_ > 0 && server_thread_ == nullptr) {
+    server_thread_.reset(env->StartThread(ThreadOptions(), "itex_metrics_http",
+                                          [this]() { Serve(); }));
+  }
+}
+
+void PrometheusExporter::ExportMetrics() {
+  if (file_.empty()) return;
+  const string text = Format(
+      *CollectionRegistry::Default()->CollectMetrics({}));
+  // Readers never see a partial file, since renaming replaces it at once.
+  Env* env = Env::Default();
+  const string tmp_file = strings::StrCat(file_, ".tmp");
+  Status status = WriteStringToFile(env, tmp_file, text);
+  if (status.ok()) status = env->RenameFile(tmp_file, file_);
+  if (!status.ok()) {
+    ITEX_LOG(WARNING) << "Failed to export metrics: " << status.ToString();
+  }
+}
+
+// static
+string PrometheusExporter::Format(const CollectedMetrics& metrics) {
+  string text;
+  for (const auto& it : metrics.metric_descriptor_map) {
+    const MetricDescriptor& descriptor = *it.second;
+    auto point_set = metrics.point_set_map.find(it.first);
+    if (point_set == metrics.point_set_map.end()) continue;
+
+    const bool is_counter = descriptor.metric_kind == MetricKind::kCumulative;
+    const string name = SanitizeName(descriptor.name);
+    strings::StrAppend(&text, "# HELP ", name, " ", descriptor.description,
+                       "\n# TYPE ", name, " ",
+                       is_counter ? "counter" : "gauge", "\n");
+    for (const auto& point : point_set->second->points) {
+      // Only numeric values can be exported.
+      string value;
+      if (point->value_type == ValueType::kInt64) {
+        value = strings::StrCat(point->int64_value);
+      } else if (point->value_type == ValueType::kBool) {
+        value = point->bool_value ? "1" : "0";
+      } else {
+        continue;
+      }
+      strings::StrAppend(&text, name);
+      if (!point->labels.empty()) {
+        text.push_back('{');
+        for (size_t i = 0; i < point->labels.size(); ++i) {
+          strings::StrAppend(&text, i == 0 ? "" : ",", point->labels[i].name,
+                             "=\"", EscapeLabelValue(point->labels[i].value),
+                             "\"");
+        }
+        text.push_back('}');
+      }
+      strings::StrAppend(&text, " ", value, "\n");
+    }
+  }
+  return text;
+}
+
+void PrometheusExporter::Serve() {
+  int server = socket(AF_INET, SOCK_STREAM, 0);
+  if (server < 0) {
+    ITEX_LOG(WARNING) << "Failed to create metrics socket: " << strerror(errno);
+    return;
+  }
+  int reuse = 1;
+  setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  // Metrics are only served locally.
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port_);
+  if (bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) <
+          0 ||
+      listen(server, 4) < 0) {
+    ITEX_LOG(WARNING) << "Failed to serve metrics on port " << port_ << ": "
+                      << strerror(errno);
+    close(server);
+    return;
+  }
+  ITEX_VLOG(1) << "Serving metrics on 127.0.0.1:" << port_;
+
+  while (true) {
+    int client = accept(server, nullptr, nullptr);
+    if (client < 0) continue;
+    timeval timeout;
+    timeout.tv_sec = kRequestTimeoutSecs;
+    timeout.tv_usec = 0;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    // Every request gets the metrics, so its content doesn't matter.
+    char request[1024];
+    if (read(client, request, sizeof(request)) >= 0) {
+      const string body =
+          Format(*CollectionRegistry::Default()->CollectMetrics({}));
+      WriteAll(client, strings::StrCat(
+                           "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: ",
+                           body.size(), "\r\n\r\n", body));
+    }
+    close(client);
+  }
+}
+
+}  // namespace monitoring
+}  // namespace itex
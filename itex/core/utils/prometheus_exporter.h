@@ -0,0 +1,61 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_UTILS_PROMETHEUS_EXPORTER_H_
+#define ITEX_CORE_UTILS_PROMETHEUS_EXPORTER_H_
+
+#include <memory>
+#include <string>
+
+#include "itex/core/utils/collected_metrics.h"
+#include "itex/core/utils/collection_registry.h"
+#include "itex/core/utils/env.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+namespace monitoring {
+
+// Exports the metrics of the default CollectionRegistry in the Prometheus text
+// exposition format, by rewriting `file` every `interval_secs` and/or by
+// serving them over HTTP on 127.0.0.1:`port`. An empty `file` or a
+// non-positive `port` disables the corresponding output.
+class PrometheusExporter : public Exporter {
+ public:
+  PrometheusExporter(const string& file, int port, int64 interval_secs);
+
+  // Starts the background threads of the exporter.
+  void PeriodicallyExportMetrics() override;
+
+  // Writes the current metrics to the file once.
+  void ExportMetrics() override;
+
+  // Returns `metrics` in the Prometheus text exposition format.
+  static string Format(const CollectedMetrics& metrics);
+
+ private:
+  // Answers every HTTP request received on `port_` with the current metrics.
+  void Serve();
+
+  const string file_;
+  const int port_;
+  const int64 interval_secs_;
+  std::unique_ptr<Thread> file_thread_;
+  std::unique_ptr<Thread> server_thread_;
+};
+
+}  // namespace monitoring
+}  // namespace itex
+
+#endif  // ITEX_CORE_UTILS_PROMETHEUS_EXPORTER_H_
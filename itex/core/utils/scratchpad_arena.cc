@@ -0,0 +1,180 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/utils/scratchpad_arena.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/container/flat_hash_set.h"
+#include "itex/core/utils/env.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/mem.h"
+#include "itex/core/utils/metrics.h"
+
+namespace itex {
+namespace {
+
+// Smallest block, so that tiny scratchpads don't each grow the arena.
+constexpr size_t kMinBlockSize = 64 * 1024;
+
+size_t RoundUp(size_t size) {
+  return (size + ScratchpadArena::kAlignment - 1) /
+         ScratchpadArena::kAlignment * ScratchpadArena::kAlignment;
+}
+
+}  // namespace
+
+// Arenas of all threads, whose idle memory is released by a background
+// thread.
+class ScratchpadArenaRegistry {
+ public:
+  static ScratchpadArenaRegistry* Global() {
+    static ScratchpadArenaRegistry* registry = new ScratchpadArenaRegistry();
+    return registry;
+  }
+
+  void Register(ScratchpadArena* arena) {
+    mutex_lock lock(&mu_);
+    arenas_.insert(arena);
+    if (idle_micros_ > 0 && release_thread_ == nullptr) {
+      release_thread_.reset(Env::Default()->StartThread(
+          ThreadOptions(), "itex_scratchpad_release", [this]() {
+            while (true) {
+              Env::Default()->SleepForMicroseconds(idle_micros_ / 2);
+              ReleaseIdle();
+            }
+          }));
+    }
+  }
+
+  void Unregister(ScratchpadArena* arena) {
+    mutex_lock lock(&mu_);
+    arenas_.erase(arena);
+  }
+
+ private:
+  ScratchpadArenaRegistry() {
+    int64 idle_secs = 0;
+    ITEX_CHECK_OK(
+        ReadInt64FromEnvVar("ITEX_SCRATCHPAD_IDLE_SECS", 60, &idle_secs));
+    idle_micros_ = idle_secs > 0 ? idle_secs * 1000000 : 0;
+  }
+
+  void ReleaseIdle() {
+    const uint64 now = Env::Default()->NowMicros();
+    mutex_lock lock(&mu_);
+    for (ScratchpadArena* arena : arenas_) {
+      arena->ReleaseIfIdle(now, idle_micros_);
+    }
+  }
+
+  uint64 idle_micros_;
+  mutex mu_;
+  absl::flat_hash_set<ScratchpadArena*> arenas_ TF_GUARDED_BY(mu_);
+  // Lives as long as the process.
+  std::unique_ptr<Thread> release_thread_ TF_GUARDED_BY(mu_);
+};
+
+ScratchpadArena::Scope::Scope() : arena_(ScratchpadArena::ThreadLocal()) {
+  if (arena_->depth_++ == 0) arena_->mu_.lock();
+}
+
+ScratchpadArena::Scope::~Scope() {
+  if (--arena_->depth_ == 0) {
+    arena_->Reset();
+    arena_->mu_.unlock();
+  }
+}
+
+ScratchpadArena* ScratchpadArena::ThreadLocal() {
+  thread_local std::unique_ptr<ScratchpadArena> arena(new ScratchpadArena());
+  return arena.get();
+}
+
+ScratchpadArena::ScratchpadArena() {
+  ScratchpadArenaRegistry::Global()->Register(this);
+}
+
+ScratchpadArena::~ScratchpadArena() {
+  ScratchpadArenaRegistry::Global()->Unregister(this);
+  mutex_lock lock(&mu_);
+  FreeBlocks();
+}
+
+void* ScratchpadArena::Allocate(size_t size) {
+  ITEX_DCHECK_GT(depth_, 0) << "Scratchpad allocated out of any scope";
+  size = RoundUp(size);
+  if (size == 0) return nullptr;
+
+  if (blocks_.empty() || offset_ + size > blocks_.back().size) {
+    size_t block_size = std::max({size, reserve_, kMinBlockSize});
+    if (!blocks_.empty()) {
+      block_size = std::max(block_size, 2 * blocks_.back().size);
+    }
+    void* data = port::AlignedMalloc(block_size, kAlignment);
+    ITEX_CHECK(data != nullptr)
+        << "Failed to allocate " << block_size << " bytes of scratchpad";
+    blocks_.push_back({static_cast<char*>(data), block_size});
+    offset_ = 0;
+    metrics::UpdateScratchpadBytes(block_size);
+  }
+
+  void* data = blocks_.back().data + offset_;
+  offset_ += size;
+  in_use_ += size;
+  if (in_use_ > high_water_mark_) {
+    high_water_mark_ = in_use_;
+    metrics::RecordScratchpadHighWaterMark(high_water_mark_);
+    ITEX_VLOG(2) << "Scratchpad high-water mark of this thread: "
+                 << high_water_mark_ << " bytes";
+  }
+  return data;
+}
+
+void ScratchpadArena::Reset() {
+  // Merge the blocks grown during this scope into one large enough for all.
+  if (blocks_.size() > 1) {
+    FreeBlocks();
+    reserve_ = high_water_mark_;
+  }
+  offset_ = 0;
+  in_use_ = 0;
+  last_used_micros_ = Env::Default()->NowMicros();
+}
+
+void ScratchpadArena::FreeBlocks() {
+  for (const Block& block : blocks_) {
+    port::AlignedFree(block.data);
+    metrics::UpdateScratchpadBytes(-static_cast<int64>(block.size));
+  }
+  blocks_.clear();
+  offset_ = 0;
+}
+
+void ScratchpadArena::ReleaseIfIdle(uint64 now_micros, uint64 idle_micros) {
+  // The owner thread is running a kernel, so it's not idle.
+  if (!mu_.try_lock()) return;
+  if (!blocks_.empty() && now_micros > last_used_micros_ + idle_micros) {
+    ITEX_VLOG(2) << "Releasing idle scratchpad of " << blocks_.back().size
+                 << " bytes";
+    FreeBlocks();
+    reserve_ = 0;
+  }
+  mu_.unlock();
+}
+
+}  // namespace itex
@@ -0,0 +1,98 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_UTILS_SCRATCHPAD_ARENA_H_
+#define ITEX_CORE_UTILS_SCRATCHPAD_ARENA_H_
+
+#include <vector>
+
+#include "itex/core/utils/mutex.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+// Grow-only host memory of a thread, from which kernels borrow scratchpads of
+// oneDNN primitives and transient reorder buffers instead of allocating
+// temporary tensors on every Compute.
+//
+// Memory is borrowed within a Scope, usually opened for the whole Compute,
+// and is given back at once when the outermost Scope of the thread exits. If
+// a Compute needed more than one block, the blocks are merged into one of the
+// high-water mark afterwards, so that a steady workload stops allocating
+// after its first step. Memory of arenas idle for ITEX_SCRATCHPAD_IDLE_SECS
+// is released to the system.
+class ScratchpadArena {
+ public:
+  static constexpr size_t kAlignment = 64;
+
+  // Borrowing scope of the arena of the calling thread. Scopes may nest, e.g.
+  // for kernels running other kernels; memory is given back by the outermost.
+  class Scope {
+   public:
+    Scope();
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    void operator=(const Scope&) = delete;
+
+   private:
+    ScratchpadArena* arena_;
+  };
+
+  // Returns the arena of the calling thread.
+  static ScratchpadArena* ThreadLocal();
+
+  ~ScratchpadArena();
+
+  // Returns `size` bytes aligned to kAlignment, valid until the outermost
+  // Scope of this thread exits. It must be called within a Scope.
+  void* Allocate(size_t size);
+
+  // Returns the max number of bytes borrowed at once from this arena.
+  size_t high_water_mark() const { return high_water_mark_; }
+
+ private:
+  struct Block {
+    char* data;
+    size_t size;
+  };
+
+  ScratchpadArena();
+
+  // Gives back all the borrowed memory when the outermost Scope exits.
+  void Reset();
+  void FreeBlocks();
+  // Releases the memory of this arena if it's unused since `idle_micros`.
+  void ReleaseIfIdle(uint64 now_micros, uint64 idle_micros);
+
+  // Held by the owner thread while any Scope is open, and by the registry
+  // while releasing idle memory. The members below are only accessed with it
+  // held.
+  mutex mu_;
+  int depth_ = 0;
+  std::vector<Block> blocks_;
+  size_t offset_ = 0;
+  size_t in_use_ = 0;
+  // Size of the first block allocated after a reset.
+  size_t reserve_ = 0;
+  size_t high_water_mark_ = 0;
+  uint64 last_used_micros_ = 0;
+
+  friend class ScratchpadArenaRegistry;
+};
+
+}  // namespace itex
+
+#endif  // ITEX_CORE_UTILS_SCRATCHPAD_ARENA_H_
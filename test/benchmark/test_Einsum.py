@@ -0,0 +1,59 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+import tensorflow as tf
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import constant_op
+from tensorflow.python.ops import special_math_ops
+from utils import multi_run, add_profiling, flush_cache
+
+try:
+    from intel_extension_for_tensorflow.python.test_func import test
+except ImportError:
+    from tensorflow.python.platform import test
+
+FLOAT_COMPUTE_TYPE = [dtypes.float32, dtypes.bfloat16]
+ITERATION = 5
+
+# Attention-style equations; the permuted ones need a transpose of an operand
+# or of the result unless the contraction is done with strided descriptors.
+CASES = [
+    ("bhqd,bhkd->bhqk", [16, 16, 512, 64], [16, 16, 512, 64]),
+    ("bhqk,bhkd->bhqd", [16, 16, 512, 512], [16, 16, 512, 64]),
+    ("bqhd,bkhd->bhqk", [16, 512, 16, 64], [16, 512, 16, 64]),
+    ("bhqk,bkhd->bqhd", [16, 16, 512, 512], [16, 512, 16, 64]),
+    ("abc,cd->abd", [64, 512, 1024], [1024, 1024]),
+]
+
+
+class EinsumTest(test.TestCase):
+    def _test_impl(self, equation, x_size, y_size, dtype):
+        x = constant_op.constant(np.random.normal(size=x_size), dtype=dtype)
+        y = constant_op.constant(np.random.normal(size=y_size), dtype=dtype)
+        flush_cache()
+        out_gpu = special_math_ops.einsum(equation, x, y)
+
+    @add_profiling
+    @multi_run(ITERATION)
+    def testEinsum(self):
+        for dtype in FLOAT_COMPUTE_TYPE:
+            for equation, x_size, y_size in CASES:
+                self._test_impl(equation, x_size, y_size, dtype)
+
+
+if __name__ == "__main__":
+    test.main()
@@ -54,5 +54,19 @@ class SliceTest(test.TestCase):
             for case in case_list:
                 self._test_impl(case[0], case[1], case[2], dtype)
 
+    @add_profiling
+    @multi_run(ITERATION)
+    def testSliceOuterDim(self):
+        # Contiguous ranges: batch splits and KV cache windows behind a
+        # batch of 1, which don't need a copy.
+        case_list = [[[64, 1024, 1024], [0, 0, 0], [32, 1024, 1024]],
+                     [[64, 1024, 1024], [32, 0, 0], [32, 1024, 1024]],
+                     [[256, 4096], [64, 0], [128, 4096]],
+                     [[1, 4096, 16, 64], [0, 1024, 0, 0], [1, 2048, 16, 64]],
+                     [[1, 1, 4096, 128], [0, 0, 512, 0], [1, 1, 1024, 128]]]
+        for dtype in FLOAT_COMPUTE_TYPE:
+            for case in case_list:
+                self._test_impl(case[0], case[1], case[2], dtype)
+
 if __name__ == '__main__':
     test.main()
@@ -31,10 +31,10 @@ ITERATION = 5
 
 
 class TransposeTest(test.TestCase):
-    def _test_impl(self, size, dtype):
+    def _test_impl(self, size, dtype, perm=(1, 0)):
         in_array = np.random.normal(size=size)
         in_array = constant_op.constant(in_array, dtype=dtype)
-        perm = constant_op.constant([1, 0], dtype=dtypes.int32)
+        perm = constant_op.constant(perm, dtype=dtypes.int32)
         flush_cache()
         out_gpu = array_ops.transpose(in_array, perm)
 
@@ -44,6 +44,22 @@ class TransposeTest(test.TestCase):
         for dtype in FLOAT_COMPUTE_TYPE:
             self._test_impl(np.array([8192, 8192]), dtype)
 
+    @add_profiling
+    @multi_run(ITERATION)
+    def testTransposeHeads(self):
+        # Attention head split [B, S, H, D] -> [B, H, S, D] and merge back.
+        for dtype in FLOAT_COMPUTE_TYPE:
+            self._test_impl(np.array([8, 512, 16, 64]), dtype, (0, 2, 1, 3))
+            self._test_impl(np.array([8, 16, 512, 64]), dtype, (0, 2, 1, 3))
+
+    @add_profiling
+    @multi_run(ITERATION)
+    def testTransposeLayout(self):
+        # NHWC -> NCHW and NCHW -> NHWC.
+        for dtype in FLOAT_COMPUTE_TYPE:
+            self._test_impl(np.array([32, 56, 56, 64]), dtype, (0, 3, 1, 2))
+            self._test_impl(np.array([32, 64, 56, 56]), dtype, (0, 2, 3, 1))
+
 
 if __name__ == "__main__":
     test.main()
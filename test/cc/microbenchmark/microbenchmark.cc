@@ -0,0 +1,516 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks of ITEX kernels and graph passes, driven through the TF C++
+// API without any Python in the loop.
+//
+// Every case builds a small graph over a grid of shapes and thread counts. The
+// first run of a fresh session includes the graph optimization, ITEX remapper
+// and layout passes among others, and is reported as `first_run_us`. Later
+// runs measure the kernels alone. Graph pass cases instead call the ITEX
+// graph optimizer, as registered by TF_InitGraph, on the serialized GraphDef
+// of the case, and time that call alone. Results are written in the JSON
+// format of Google Benchmark, so that tools/compare.py can diff two runs.
+//
+// Usage:
+//   microbenchmark [--threads=1,4] [--benchmark_filter=<regex>]
+//                  [--benchmark_min_time=<seconds>]
+//                  [--benchmark_out=<file>] [--name_suffix=<suffix>]
+//
+// `--name_suffix` is appended to the names of the results, to tell runs with
+// different ITEX_* settings apart in one report.
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <regex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/c/c_api_experimental.h"
+#include "tensorflow/c/experimental/grappler/grappler.h"
+#include "tensorflow/cc/client/client_session.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace {
+
+using namespace tensorflow;       // NOLINT(build/namespaces)
+using namespace tensorflow::ops;  // NOLINT(build/namespaces)
+
+using Dims = std::vector<int64_t>;
+using Clock = std::chrono::steady_clock;
+
+// Builds the graph of a case for `dims` in `root`, fills the tensors to feed,
+// and returns the output to fetch.
+using BuildFn = std::function<Output(const Scope& root, const Dims& dims,
+                                     ClientSession::FeedType* feeds)>;
+
+struct Case {
+  std::string name;
+  std::vector<Dims> grid;
+  BuildFn build;
+  // Graph pass cases time the ITEX graph optimizer instead of the kernels.
+  bool graph_pass = false;
+};
+
+struct Result {
+  std::string name;
+  int threads;
+  int64_t iterations;
+  double mean_us;
+  double min_us;
+  double first_run_us;
+};
+
+Tensor RandomTensor(const Dims& dims) {
+  TensorShape shape;
+  for (int64_t dim : dims) shape.AddDim(dim);
+  Tensor tensor(DT_FLOAT, shape);
+  tensor.flat<float>().setRandom();
+  return tensor;
+}
+
+// Returns a placeholder of `dims`, fed with random data.
+Output RandomInput(const Scope& root, const Dims& dims,
+                   ClientSession::FeedType* feeds) {
+  auto input = Placeholder(root, DT_FLOAT,
+                           Placeholder::Shape(PartialTensorShape(dims)));
+  feeds->emplace(input, RandomTensor(dims));
+  return input;
+}
+
+// Returns a constant of `dims`, as for the weights of a model.
+Output RandomWeight(const Scope& root, const Dims& dims) {
+  return Const(root, Input::Initializer(RandomTensor(dims)));
+}
+
+// dims: {m, k, n}
+Output BuildMatMulBiasRelu(const Scope& root, const Dims& dims,
+                           ClientSession::FeedType* feeds) {
+  auto x = RandomInput(root, {dims[0], dims[1]}, feeds);
+  auto y = MatMul(root, x, RandomWeight(root, {dims[1], dims[2]}));
+  return Relu(root, BiasAdd(root, y, RandomWeight(root, {dims[2]})));
+}
+
+// dims: {batch, height, width, in_channels, out_channels}, 3x3 filter.
+Output BuildConvBiasRelu(const Scope& root, const Dims& dims,
+                         ClientSession::FeedType* feeds) {
+  auto x = RandomInput(root, {dims[0], dims[1], dims[2], dims[3]}, feeds);
+  auto y = Conv2D(root, x, RandomWeight(root, {3, 3, dims[3], dims[4]}),
+                  {1, 1, 1, 1}, "SAME");
+  return Relu(root, BiasAdd(root, y, RandomWeight(root, {dims[4]})));
+}
+
+// dims: {batch, heads, sequence, head_size}, matched by the MHA fusion.
+Output BuildFmha(const Scope& root, const Dims& dims,
+                 ClientSession::FeedType* feeds) {
+  auto q = RandomInput(root, dims, feeds);
+  auto k = RandomInput(root, dims, feeds);
+  auto v = RandomInput(root, dims, feeds);
+  auto mask = RandomInput(root, {dims[0], 1, 1, dims[2]}, feeds);
+  auto score = BatchMatMulV2(root, q, k, BatchMatMulV2::AdjY(true));
+  auto scaled = Mul(root, score,
+                    Const(root, 1.0f / std::sqrt(static_cast<float>(dims[3]))));
+  auto prob = Softmax(root, AddV2(root, mask, scaled));
+  auto context = BatchMatMulV2(root, prob, v);
+  return Transpose(root, context, {0, 2, 1, 3});
+}
+
+// dims: {rows, cols}, normalized over the last dimension.
+Output BuildLayerNorm(const Scope& root, const Dims& dims,
+                      ClientSession::FeedType* feeds) {
+  auto x = RandomInput(root, dims, feeds);
+  auto axis = Const(root, {-1});
+  auto mean = Mean(root, x, axis, Mean::KeepDims(true));
+  auto variance = Mean(root, SquaredDifference(root, x, mean), axis,
+                       Mean::KeepDims(true));
+  auto inv = Rsqrt(root, AddV2(root, variance, Const(root, 1e-5f)));
+  auto norm = Mul(root, Sub(root, x, mean), inv);
+  return AddV2(root, Mul(root, norm, RandomWeight(root, {dims[1]})),
+               RandomWeight(root, {dims[1]}));
+}
+
+// dims: {rows, cols}, a chain of binary ops fused by the remapper.
+Output BuildFusedBinary(const Scope& root, const Dims& dims,
+                        ClientSession::FeedType* feeds) {
+  auto x = RandomInput(root, dims, feeds);
+  auto y = Mul(root, x, RandomWeight(root, {dims[1]}));
+  y = AddV2(root, y, RandomInput(root, dims, feeds));
+  return Sub(root, y, RandomWeight(root, {dims[1]}));
+}
+
+// dims: 4D shape, transposed from NHWC to NCHW.
+Output BuildTranspose(const Scope& root, const Dims& dims,
+                      ClientSession::FeedType* feeds) {
+  return Transpose(root, RandomInput(root, dims, feeds), {0, 3, 1, 2});
+}
+
+// dims: {rows, cols}, the inner half of both dimensions is kept.
+Output BuildSlice(const Scope& root, const Dims& dims,
+                  ClientSession::FeedType* feeds) {
+  auto x = RandomInput(root, dims, feeds);
+  const int begin_rows = dims[0] / 4, begin_cols = dims[1] / 4;
+  const int rows = dims[0] / 2, cols = dims[1] / 2;
+  return Slice(root, x, {begin_rows, begin_cols}, {rows, cols});
+}
+
+// dims: {m, k, n}, an INT8 MatMul as produced by quantization tools.
+Output BuildQuantizedMatMul(const Scope& root, const Dims& dims,
+                            ClientSession::FeedType* feeds) {
+  auto min_range = Const(root, -1.0f);
+  auto max_range = Const(root, 1.0f);
+  auto x = RandomInput(root, {dims[0], dims[1]}, feeds);
+  auto qx = QuantizeV2(root, x, min_range, max_range, DT_QINT8);
+  auto dqx = Dequantize(root, qx.output, qx.output_min, qx.output_max);
+  auto w = RandomWeight(root, {dims[1], dims[2]});
+  auto qw = QuantizeV2(root, w, min_range, max_range, DT_QINT8);
+  auto dqw = Dequantize(root, qw.output, qw.output_min, qw.output_max);
+  auto y = MatMul(root, dqx, dqw);
+  return Relu(root, BiasAdd(root, y, RandomWeight(root, {dims[2]})));
+}
+
+// dims: {blocks, width}, a deep MLP to time the graph optimizer with.
+Output BuildMlp(const Scope& root, const Dims& dims,
+                ClientSession::FeedType* feeds) {
+  Output x = RandomInput(root, {8, dims[1]}, feeds);
+  for (int64_t i = 0; i < dims[0]; ++i) {
+    auto y = MatMul(root, x, RandomWeight(root, {dims[1], dims[1]}));
+    x = Relu(root, BiasAdd(root, y, RandomWeight(root, {dims[1]})));
+  }
+  return x;
+}
+
+// dims: {batch, dense_features, sparse_fields, embedding_size}, the model of
+// Wide & Deep at serving batch sizes. Every op is small, so that the per-op
+// dispatch cost dominates, which ITEX_SEGMENT_FUSION batches away.
+Output BuildWideAndDeep(const Scope& root, const Dims& dims,
+                        ClientSession::FeedType* feeds) {
+  constexpr int64_t kVocabulary = 1000;
+  const int64_t batch = dims[0], fields = dims[2], embedding = dims[3];
+  std::vector<Output> features = {RandomInput(root, {batch, dims[1]}, feeds)};
+  for (int64_t i = 0; i < fields; ++i) {
+    auto ids = Placeholder(root, DT_INT32,
+                           Placeholder::Shape(PartialTensorShape({batch})));
+    Tensor ids_value(DT_INT32, TensorShape({batch}));
+    for (int64_t j = 0; j < batch; ++j) {
+      ids_value.flat<int32>()(j) = (i * batch + j) % kVocabulary;
+    }
+    feeds->emplace(ids, ids_value);
+    auto table = RandomWeight(root, {kVocabulary, embedding});
+    features.push_back(GatherV2(root, table, ids, Const(root, 0)));
+  }
+
+  Output deep = ConcatV2(root, features, Const(root, 1));
+  int64_t width = dims[1] + fields * embedding;
+  for (int64_t units : {256, 128, 64}) {
+    auto y = MatMul(root, deep, RandomWeight(root, {width, units}));
+    deep = Relu(root, BiasAdd(root, y, RandomWeight(root, {units})));
+    width = units;
+  }
+  deep = BiasAdd(root, MatMul(root, deep, RandomWeight(root, {width, 1})),
+                 RandomWeight(root, {1}));
+
+  auto crosses = RandomInput(root, {batch, dims[1] + fields}, feeds);
+  auto wide =
+      MatMul(root, crosses, RandomWeight(root, {dims[1] + fields, 1}));
+  return Sigmoid(root, AddV2(root, deep, wide));
+}
+
+std::vector<Case> AllCases() {
+  return {
+      {"MatMul_BiasAdd_Relu",
+       {{64, 1024, 1024}, {512, 1024, 4096}, {2048, 4096, 1024}},
+       BuildMatMulBiasRelu},
+      {"Conv2D_BiasAdd_Relu",
+       {{1, 56, 56, 64, 64}, {32, 56, 56, 64, 64}, {32, 14, 14, 256, 256}},
+       BuildConvBiasRelu},
+      {"FMHA", {{1, 16, 384, 64}, {8, 16, 384, 64}}, BuildFmha},
+      {"LayerNorm", {{512, 1024}, {4096, 4096}}, BuildLayerNorm},
+      {"FusedBinary", {{512, 1024}, {4096, 4096}}, BuildFusedBinary},
+      {"Transpose", {{32, 56, 56, 64}, {32, 14, 14, 512}}, BuildTranspose},
+      {"Slice", {{1024, 1024}, {8192, 4096}}, BuildSlice},
+      {"QuantizedMatMul",
+       {{64, 1024, 1024}, {512, 1024, 4096}},
+       BuildQuantizedMatMul},
+      {"Optimizer_MLP", {{16, 256}, {128, 256}}, BuildMlp, true},
+      {"WideAndDeep",
+       {{1, 13, 26, 16}, {32, 13, 26, 16}, {256, 13, 26, 16}},
+       BuildWideAndDeep},
+  };
+}
+
+std::string CaseName(const Case& c, const Dims& dims, int threads) {
+  std::ostringstream name;
+  name << c.name << "/";
+  for (size_t i = 0; i < dims.size(); ++i) {
+    name << (i == 0 ? "" : "x") << dims[i];
+  }
+  name << "/threads:" << threads;
+  return name.str();
+}
+
+double MicrosSince(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+      .count();
+}
+
+#ifdef ITEX_CPU_CC
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+#else
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:XPU:0";
+#endif
+
+// The graph optimizer of ITEX, as registered with TF by TF_InitGraph.
+struct GraphOptimizer {
+  TP_OptimizerConfigs configs{TP_OPTIMIZER_CONFIGS_STRUCT_SIZE};
+  TP_Optimizer optimizer{TP_OPTIMIZER_STRUCT_SIZE};
+  TP_OptimizerRegistrationParams params{
+      TP_OPTIMIZER_REGISTRATION_PARAMS_STRUCT_SIZE};
+
+  GraphOptimizer() {
+    params.major_version = GO_MAJOR;
+    params.minor_version = GO_MINOR;
+    params.patch_version = GO_PATCH;
+    params.optimizer_configs = &configs;
+    params.optimizer = &optimizer;
+  }
+};
+
+// Calls TF_InitGraph of the loaded ITEX library, the entry point TF itself
+// uses to register the ITEX graph optimizer.
+void InitGraphOptimizer(const std::string& xpu_lib_path,
+                        GraphOptimizer* graph_optimizer) {
+  void* handle = dlopen(xpu_lib_path.c_str(), RTLD_NOW | RTLD_NOLOAD);
+  if (handle == nullptr) {
+    LOG(FATAL) << "Could not find " << xpu_lib_path << ": " << dlerror();
+  }
+  using InitGraphFn = void (*)(TP_OptimizerRegistrationParams*, TF_Status*);
+  auto init_graph =
+      reinterpret_cast<InitGraphFn>(dlsym(handle, "TF_InitGraph"));
+  if (init_graph == nullptr) {
+    LOG(FATAL) << "Could not find TF_InitGraph in " << xpu_lib_path;
+  }
+  TF_Status* status = TF_NewStatus();
+  init_graph(&graph_optimizer->params, status);
+  CHECK_EQ(TF_GetCode(status), TF_OK) << TF_Message(status);
+  TF_DeleteStatus(status);
+}
+
+// Times `optimizer.optimize_func` on the GraphDef of the case, placed on the
+// device of the optimizer as TF would have placed it before grappler.
+Result RunGraphPassCase(const Case& c, const Dims& dims, int threads,
+                        double min_time, const std::string& name_suffix,
+                        const GraphOptimizer& graph_optimizer) {
+  Result result;
+  result.name = CaseName(c, dims, threads) + name_suffix;
+  result.threads = threads;
+  result.iterations = 0;
+  result.min_us = 0;
+
+  Scope root = Scope::NewRootScope();
+  ClientSession::FeedType feeds;
+  Output fetch = c.build(root, dims, &feeds);
+  grappler::GrapplerItem item;
+  item.id = result.name;
+  TF_CHECK_OK(root.ToGraphDef(&item.graph));
+  for (NodeDef& node : *item.graph.mutable_node()) node.set_device(kDevice);
+  for (const auto& feed : feeds) {
+    item.feed.emplace_back(feed.first.node()->name(), feed.second.tensor);
+  }
+  item.fetch.push_back(fetch.node()->name());
+
+  const TP_Optimizer& optimizer = graph_optimizer.optimizer;
+  void* instance = optimizer.create_func();
+  const std::string serialized = item.graph.SerializeAsString();
+  TF_Buffer* graph_buf =
+      TF_NewBufferFromString(serialized.data(), serialized.size());
+  const auto* tf_item = reinterpret_cast<const TF_GrapplerItem*>(&item);
+  TF_Status* status = TF_NewStatus();
+
+  double total_us = 0;
+  const auto start = Clock::now();
+  do {
+    TF_Buffer* optimized_buf = TF_NewBuffer();
+    const auto run_start = Clock::now();
+    optimizer.optimize_func(instance, graph_buf, tf_item, optimized_buf,
+                            status);
+    const double run_us = MicrosSince(run_start);
+    CHECK_EQ(TF_GetCode(status), TF_OK) << TF_Message(status);
+    TF_DeleteBuffer(optimized_buf);
+
+    if (result.iterations == 0) result.first_run_us = run_us;
+    result.min_us =
+        result.iterations == 0 ? run_us : std::min(result.min_us, run_us);
+    total_us += run_us;
+    ++result.iterations;
+  } while (MicrosSince(start) < min_time * 1e6);
+
+  TF_DeleteStatus(status);
+  TF_DeleteBuffer(graph_buf);
+  optimizer.destroy_func(instance);
+  result.mean_us = total_us / result.iterations;
+  return result;
+}
+
+Result RunCase(const Case& c, const Dims& dims, int threads, double min_time,
+               const std::string& name_suffix) {
+  SessionOptions options;
+  options.config.set_intra_op_parallelism_threads(threads);
+
+  Result result;
+  result.name = CaseName(c, dims, threads) + name_suffix;
+  result.threads = threads;
+  result.iterations = 0;
+  result.min_us = 0;
+
+  std::vector<Tensor> outputs;
+  Scope root = Scope::NewRootScope();
+  ClientSession::FeedType feeds;
+  Output fetch = c.build(root, dims, &feeds);
+  ClientSession session(root, options);
+
+  auto run_start = Clock::now();
+  TF_CHECK_OK(session.Run(feeds, {fetch}, &outputs));
+  result.first_run_us = MicrosSince(run_start);
+
+  // Warm up the primitive caches before timing the kernels.
+  TF_CHECK_OK(session.Run(feeds, {fetch}, &outputs));
+  double total_us = 0;
+  const auto start = Clock::now();
+  while (MicrosSince(start) < min_time * 1e6 || result.iterations == 0) {
+    run_start = Clock::now();
+    TF_CHECK_OK(session.Run(feeds, {fetch}, &outputs));
+    const double run_us = MicrosSince(run_start);
+    result.min_us =
+        result.iterations == 0 ? run_us : std::min(result.min_us, run_us);
+    total_us += run_us;
+    ++result.iterations;
+  }
+
+  result.mean_us = total_us / result.iterations;
+  return result;
+}
+
+void WriteJson(const std::vector<Result>& results, std::ostream* out) {
+  *out << "{\n  \"context\": {\n"
+       << "    \"library\": \"intel_extension_for_tensorflow\",\n"
+       << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n"
+       << "  },\n  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result& r = results[i];
+    *out << (i == 0 ? "" : ",") << "\n    {\n"
+         << "      \"name\": \"" << r.name << "\",\n"
+         << "      \"run_name\": \"" << r.name << "\",\n"
+         << "      \"run_type\": \"iteration\",\n"
+         << "      \"threads\": " << r.threads << ",\n"
+         << "      \"iterations\": " << r.iterations << ",\n"
+         << "      \"real_time\": " << r.mean_us << ",\n"
+         << "      \"cpu_time\": " << r.mean_us << ",\n"
+         << "      \"min_time\": " << r.min_us << ",\n"
+         << "      \"first_run_us\": " << r.first_run_us << ",\n"
+         << "      \"time_unit\": \"us\"\n    }";
+  }
+  *out << "\n  ]\n}\n";
+}
+
+bool ParseFlag(const std::string& arg, const std::string& flag,
+               std::string* value) {
+  const std::string prefix = "--" + flag + "=";
+  if (arg.compare(0, prefix.size(), prefix) != 0) return false;
+  *value = arg.substr(prefix.size());
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<int> threads;
+  std::string filter = ".*", out_file, name_suffix, value;
+  double min_time = 0.5;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (ParseFlag(arg, "threads", &value)) {
+      std::stringstream list(value);
+      std::string item;
+      while (std::getline(list, item, ',')) threads.push_back(std::stoi(item));
+    } else if (ParseFlag(arg, "benchmark_filter", &value)) {
+      filter = value;
+    } else if (ParseFlag(arg, "benchmark_min_time", &value)) {
+      min_time = std::stod(value);
+    } else if (ParseFlag(arg, "benchmark_out", &value)) {
+      out_file = value;
+    } else if (ParseFlag(arg, "name_suffix", &value)) {
+      name_suffix = value;
+    } else {
+      LOG(FATAL) << "Unknown argument " << arg;
+    }
+  }
+  if (threads.empty()) {
+    threads.push_back(std::thread::hardware_concurrency());
+  }
+
+  TF_Status* status = TF_NewStatus();
+#ifdef ITEX_CPU_CC
+  std::string xpu_lib_path = "libitex_cpu_cc.so";
+#else
+  std::string xpu_lib_path = "libitex_gpu_cc.so";
+#endif
+  TF_LoadPluggableDeviceLibrary(xpu_lib_path.c_str(), status);
+  if (TF_GetCode(status) != TF_OK) {
+    LOG(FATAL)
+        << "Could not load intel-extension-for-tensorflow, please check! "
+        << TF_Message(status);
+  }
+  TF_DeleteStatus(status);
+
+  GraphOptimizer graph_optimizer;
+  InitGraphOptimizer(xpu_lib_path, &graph_optimizer);
+
+  const std::regex filter_regex(filter);
+  std::vector<Result> results;
+  for (const Case& c : AllCases()) {
+    for (const Dims& dims : c.grid) {
+      for (int n : threads) {
+        if (!std::regex_search(CaseName(c, dims, n), filter_regex)) continue;
+        results.push_back(
+            c.graph_pass ? RunGraphPassCase(c, dims, n, min_time, name_suffix,
+                                            graph_optimizer)
+                         : RunCase(c, dims, n, min_time, name_suffix));
+        const Result& r = results.back();
+        std::cout << r.name << "\t" << r.mean_us << " us\t(min " << r.min_us
+                  << " us, first run " << r.first_run_us << " us, "
+                  << r.iterations << " iterations)" << std::endl;
+      }
+    }
+  }
+
+  if (out_file.empty()) {
+    WriteJson(results, &std::cout);
+  } else {
+    std::ofstream out(out_file);
+    WriteJson(results, &out);
+  }
+  return 0;
+}
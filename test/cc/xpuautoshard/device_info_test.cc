@@ -0,0 +1,92 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "test_util.h"
+#include "xpuautoshard/common/device_info.h"
+
+using as::Device;
+using as::DeviceId;
+using as::DeviceInfo;
+using Groups = std::vector<std::vector<size_t>>;
+
+namespace {
+
+// Devices 1..n, device i on NUMA node `numa_nodes[i - 1]`.
+DeviceInfo MakeDevices(const std::vector<int>& numa_nodes) {
+  DeviceInfo device_info;
+  for (size_t i = 0; i < numa_nodes.size(); i++) {
+    Device device(static_cast<DeviceId>(i + 1), "CPU", 1.0f);
+    device.setNumaNode(numa_nodes[i]);
+    device_info.addDevice(device);
+  }
+  return device_info;
+}
+
+void TestGroupsShardsOfEachNode() {
+  // Four CPU shards on a two socket host, as pinned by i % #nodes.
+  DeviceInfo device_info = MakeDevices({0, 1, 0, 1});
+  AS_EXPECT_EQ(device_info.groupByNumaNode({1, 2, 3, 4}),
+               (Groups{{0, 2}, {1, 3}}));
+}
+
+void TestFirstGroupHoldsFirstDevice() {
+  // The final reduce runs on the first device, so its node comes first.
+  DeviceInfo device_info = MakeDevices({1, 0, 1});
+  AS_EXPECT_EQ(device_info.groupByNumaNode({1, 2, 3}),
+               (Groups{{0, 2}, {1}}));
+  AS_EXPECT_EQ(device_info.groupByNumaNode({2, 1, 3}),
+               (Groups{{0}, {1, 2}}));
+}
+
+void TestDevicesWithoutAffinityAreNotGrouped() {
+  const int kNone = Device::NO_NUMA_AFFINITY;
+  DeviceInfo device_info = MakeDevices({0, kNone, 0, kNone});
+  AS_EXPECT_EQ(device_info.groupByNumaNode({1, 2, 3, 4}),
+               (Groups{{0, 2}, {1}, {3}}));
+
+  // E.g. GPUs, or CPU shards without ITEX_SHARDING_CPU_NUMA: one group per
+  // shard, which keeps the plain reduce on the first device.
+  DeviceInfo unpinned = MakeDevices({kNone, kNone, kNone});
+  AS_EXPECT_EQ(unpinned.groupByNumaNode({1, 2, 3}),
+               (Groups{{0}, {1}, {2}}));
+}
+
+void TestOneShardPerNode() {
+  // As many shards as nodes: nothing to reduce locally.
+  DeviceInfo device_info = MakeDevices({0, 1});
+  Groups groups = device_info.groupByNumaNode({1, 2});
+  AS_EXPECT_EQ(groups.size(), 2u);
+  AS_EXPECT_EQ(groups, (Groups{{0}, {1}}));
+}
+
+void TestUnknownDevice() {
+  DeviceInfo device_info = MakeDevices({0});
+  AS_EXPECT_EQ(device_info.groupByNumaNode({1, 7, 1}),
+               (Groups{{0, 2}, {1}}));
+  AS_EXPECT_TRUE(device_info.groupByNumaNode({}).empty());
+}
+
+}  // namespace
+
+int main() {
+  TestGroupsShardsOfEachNode();
+  TestFirstGroupHoldsFirstDevice();
+  TestDevicesWithoutAffinityAreNotGrouped();
+  TestOneShardPerNode();
+  TestUnknownDevice();
+  return as_test::Finish("device_info_test");
+}
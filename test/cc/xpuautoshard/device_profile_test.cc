@@ -0,0 +1,191 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test_util.h"
+#include "xpuautoshard/common/device_profile.h"
+
+using as::DeviceProfile;
+using as::DeviceProfileMap;
+using as::ProfiledOpKind;
+using Samples = std::vector<std::pair<float, float>>;
+
+namespace {
+
+const ProfiledOpKind kAllKinds[] = {
+    ProfiledOpKind::MATMUL, ProfiledOpKind::CONV, ProfiledOpKind::ELEMENTWISE,
+    ProfiledOpKind::REDUCTION};
+
+DeviceProfile MakeProfile(float scale) {
+  DeviceProfile profile;
+  float i = 1.0f;
+  for (auto kind : kAllKinds) {
+    // Values without an exact short decimal form.
+    profile.setCoefficients(kind, {scale * i / 3.0f, 1e-6f * i / 7.0f});
+    i += 1.0f;
+  }
+  return profile;
+}
+
+std::string TempPath(const char* name) {
+  return std::string("/tmp/xpuautoshard_") + name + ".profile";
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+  std::ofstream out(path);
+  out << content;
+}
+
+void TestFitRecoversLinearModel() {
+  // time = 2e-5 + work / 1e9
+  Samples samples;
+  for (float work : {1e6f, 4e6f, 1.6e7f, 6.4e7f}) {
+    samples.emplace_back(work, 2e-5f + work / 1e9f);
+  }
+  auto coefficients = as::fitCoefficients(samples);
+  AS_EXPECT_NEAR(coefficients.throughput, 1e9, 1e6);
+  AS_EXPECT_NEAR(coefficients.overhead, 2e-5, 1e-7);
+}
+
+void TestFitClampsNegativeOverhead() {
+  // A line through the samples crosses below the origin.
+  Samples samples = {{1e6f, 0.5e-3f}, {2e6f, 1.5e-3f}};
+  auto coefficients = as::fitCoefficients(samples);
+  AS_EXPECT_NEAR(coefficients.throughput, 1e9, 1e6);
+  AS_EXPECT_EQ(coefficients.overhead, 0.0f);
+}
+
+void TestFitFallsBackToBestRate() {
+  // Larger work ran faster, no fixed cost is observable.
+  Samples samples = {{1e6f, 2e-3f}, {2e6f, 1e-3f}};
+  auto coefficients = as::fitCoefficients(samples);
+  AS_EXPECT_NEAR(coefficients.throughput, 2e9, 1e6);
+  AS_EXPECT_EQ(coefficients.overhead, 0.0f);
+
+  // A single size gives no slope either.
+  coefficients = as::fitCoefficients({{1e6f, 1e-3f}});
+  AS_EXPECT_NEAR(coefficients.throughput, 1e9, 1e6);
+  AS_EXPECT_EQ(coefficients.overhead, 0.0f);
+}
+
+void TestIsCalibrated() {
+  DeviceProfile profile;
+  AS_EXPECT_TRUE(!profile.isCalibrated());
+  profile = MakeProfile(1e9f);
+  AS_EXPECT_TRUE(profile.isCalibrated());
+  profile.setCoefficients(ProfiledOpKind::REDUCTION, {0.0f, 0.0f});
+  AS_EXPECT_TRUE(!profile.isCalibrated());
+}
+
+void TestGetTime() {
+  DeviceProfile profile;
+  profile.setCoefficients(ProfiledOpKind::MATMUL, {1e9f, 1e-5f});
+  AS_EXPECT_NEAR(profile.getTime(ProfiledOpKind::MATMUL, 1e6f), 1.01e-3,
+                 1e-9);
+}
+
+void TestSaveLoadRoundTrip() {
+  DeviceProfileMap profiles = {{"CPU", MakeProfile(1e9f)},
+                               {"XPU", MakeProfile(1e11f)}};
+  std::string path = TempPath("round_trip");
+  AS_EXPECT_TRUE(as::saveDeviceProfiles(path, profiles));
+  DeviceProfileMap loaded;
+  AS_EXPECT_TRUE(as::loadDeviceProfiles(path, &loaded));
+  AS_EXPECT_EQ(loaded.size(), 2u);
+  AS_EXPECT_TRUE(loaded["CPU"] == profiles["CPU"]);
+  AS_EXPECT_TRUE(loaded["XPU"] == profiles["XPU"]);
+  std::remove(path.c_str());
+}
+
+void TestLoadMergesIntoExistingProfiles() {
+  // A hand written file with comments, supplying the XPU profile only.
+  std::string path = TempPath("merge");
+  WriteFile(path,
+            "# <device type> <op kind> <throughput> <overhead seconds>\n"
+            "\n"
+            "XPU matmul 1e11 1e-5\n"
+            "XPU conv 5e10 1e-5\n"
+            "XPU elementwise 4e11 5e-6\n"
+            "XPU reduction 2e11 5e-6\n");
+  DeviceProfileMap profiles = {{"CPU", MakeProfile(1e9f)}};
+  AS_EXPECT_TRUE(as::loadDeviceProfiles(path, &profiles));
+  AS_EXPECT_TRUE(profiles["CPU"] == MakeProfile(1e9f));
+  AS_EXPECT_TRUE(profiles["XPU"].isCalibrated());
+  AS_EXPECT_NEAR(
+      profiles["XPU"].getCoefficients(ProfiledOpKind::CONV).throughput, 5e10,
+      1e4);
+  std::remove(path.c_str());
+}
+
+void TestLoadRejectsMalformedFiles() {
+  DeviceProfileMap profiles;
+  AS_EXPECT_TRUE(!as::loadDeviceProfiles(TempPath("missing"), &profiles));
+
+  std::string path = TempPath("malformed");
+  WriteFile(path, "CPU matmul 1e9\n");
+  AS_EXPECT_TRUE(!as::loadDeviceProfiles(path, &profiles));
+  WriteFile(path, "CPU softmax 1e9 1e-5\n");
+  AS_EXPECT_TRUE(!as::loadDeviceProfiles(path, &profiles));
+  WriteFile(path, "CPU matmul fast 1e-5\n");
+  AS_EXPECT_TRUE(!as::loadDeviceProfiles(path, &profiles));
+  std::remove(path.c_str());
+}
+
+void TestCalibrateCpuProfile() {
+  // Kernels doing work proportional to their flops, so the fit is positive.
+  volatile float sink = 0.0f;
+  auto spin = [&sink](size_t iterations) {
+    return [&sink, iterations]() {
+      float sum = 0.0f;
+      for (size_t i = 0; i < iterations; i++) sum += 1.0f;
+      sink = sum;
+    };
+  };
+  as::CalibrationKernels kernels;
+  std::vector<size_t> matmul_sizes, conv_sizes;
+  kernels.matmul = [&](size_t n) {
+    matmul_sizes.push_back(n);
+    return std::function<void()>(spin(n * n * n / 64));
+  };
+  kernels.conv = [&](size_t hw, size_t channels) {
+    conv_sizes.push_back(hw * channels);
+    return std::function<void()>(spin(hw * hw * channels * channels / 16));
+  };
+  DeviceProfile profile = as::calibrateCpuProfile(kernels, 2);
+  AS_EXPECT_TRUE(profile.isCalibrated());
+  AS_EXPECT_EQ(matmul_sizes.size(), 5u);
+  AS_EXPECT_EQ(conv_sizes.size(), 5u);
+}
+
+}  // namespace
+
+int main() {
+  TestFitRecoversLinearModel();
+  TestFitClampsNegativeOverhead();
+  TestFitFallsBackToBestRate();
+  TestIsCalibrated();
+  TestGetTime();
+  TestSaveLoadRoundTrip();
+  TestLoadMergesIntoExistingProfiles();
+  TestLoadRejectsMalformedFiles();
+  TestCalibrateCpuProfile();
+  return as_test::Finish("device_profile_test");
+}
@@ -0,0 +1,241 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <vector>
+
+#include "test_util.h"
+#include "xpuautoshard/common/split_ratio_hsp_tuner.h"
+
+using as::DeviceInfo;
+using as::FloatScore;
+using as::HspAnnotationRef;
+using as::ScoreRef;
+
+namespace {
+
+// An annotation made with the split ratio `weights`.
+struct WeightsAnnotation : public as::HspAnnotation {
+  explicit WeightsAnnotation(const std::vector<float>& weights)
+      : weights(weights) {}
+  std::vector<float> weights;
+};
+
+class WeightsAnnotator : public as::HspAnnotator {
+ public:
+  explicit WeightsAnnotator(const std::vector<float>& weights)
+      : weights_(weights) {}
+
+  HspAnnotationRef annotate(as::GraphRef graph) override {
+    return as::makeRef<WeightsAnnotation, as::HspAnnotation>(weights_);
+  }
+
+ private:
+  std::vector<float> weights_;
+};
+
+// Scores a unit of work split by the weights of the annotation over devices
+// running at `speeds`, by the time of the slowest device.
+class MakespanEvaluator : public as::HspCostEvaluator {
+ public:
+  MakespanEvaluator(const std::vector<float>& speeds, bool prune)
+      : speeds_(speeds), prune_(prune) {}
+
+  ScoreRef lowestScore() override {
+    return as::makeRef<FloatScore, as::Score>();
+  }
+
+  ScoreRef evaluate(as::GraphRef graph,
+                    HspAnnotationRef annotation = nullptr) override {
+    return as::makeRef<FloatScore, as::Score>(-makespan(annotation));
+  }
+
+  ScoreRef evaluateWithBound(as::GraphRef graph, HspAnnotationRef annotation,
+                             const ScoreRef& bound) override {
+    ScoreRef score = evaluate(graph, annotation);
+    if (prune_ && *score < *bound) {
+      // Give up with a score lower than the bound but not the exact one.
+      num_pruned_++;
+      return lowestScore();
+    }
+    return score;
+  }
+
+  const std::vector<std::vector<float>>& getEvaluated() const {
+    return evaluated_;
+  }
+
+  int getNumPruned() const { return num_pruned_; }
+
+ private:
+  float makespan(const HspAnnotationRef& annotation) {
+    auto&& weights = as::downcastRef<WeightsAnnotation>(annotation)->weights;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      evaluated_.push_back(weights);
+    }
+    float total = 0.0f;
+    for (float weight : weights) total += weight;
+    float makespan = 0.0f;
+    for (size_t i = 0; i < weights.size(); i++) {
+      makespan = std::max(makespan, weights[i] / total / speeds_[i]);
+    }
+    return makespan;
+  }
+
+  std::vector<float> speeds_;
+  bool prune_;
+  std::mutex mutex_;
+  std::vector<std::vector<float>> evaluated_;
+  std::atomic<int> num_pruned_{0};
+};
+
+class TestTuner : public as::SplitRatioHspTuner {
+ public:
+  TestTuner(const DeviceInfo& device_info,
+            const as::ShardingConfig& sharding_config,
+            as::Ref<MakespanEvaluator> evaluator)
+      : as::SplitRatioHspTuner(device_info, sharding_config),
+        evaluator_(evaluator) {}
+
+  as::HspCostEvaluatorRef getCostModel() override { return evaluator_; }
+
+  bool isAnnotatorThreadSafe() override { return true; }
+
+  as::HspAnnotatorRef createAnnotator(
+      as::TuningStateRef tuning_state = nullptr) override {
+    auto&& state = as::downcastRef<as::SplitRatioTuningState>(tuning_state);
+    std::vector<float> weights(device_info_.getNumDevices(), 1.0f);
+    if (state) {
+      weights = state->split_ratio_weights;
+    }
+    return as::makeRef<WeightsAnnotator, as::HspAnnotator>(weights);
+  }
+
+ private:
+  as::Ref<MakespanEvaluator> evaluator_;
+};
+
+DeviceInfo MakeDevices(size_t num_devices, bool profiled = true) {
+  as::DeviceProfile profile;
+  for (auto kind : {as::ProfiledOpKind::MATMUL, as::ProfiledOpKind::CONV,
+                    as::ProfiledOpKind::ELEMENTWISE,
+                    as::ProfiledOpKind::REDUCTION}) {
+    profile.setCoefficients(kind, {1e9f, 0.0f});
+  }
+  DeviceInfo device_info;
+  for (size_t i = 0; i < num_devices; i++) {
+    as::Device device(static_cast<as::DeviceId>(i + 1), "CPU", 1.0f);
+    if (profiled) device.setProfile(profile);
+    device_info.addDevice(device);
+  }
+  return device_info;
+}
+
+as::ShardingConfig MakeConfig(size_t num_threads) {
+  as::ShardingConfig sharding_config;
+  sharding_config.setStrategyKind(as::StrategyKind::HEURISTIC);
+  sharding_config.setTuningNumThreads(num_threads);
+  return sharding_config;
+}
+
+struct TuneResult {
+  std::vector<float> weights;
+  as::Ref<MakespanEvaluator> evaluator;
+};
+
+TuneResult Tune(const std::vector<float>& speeds, size_t num_threads,
+                bool prune) {
+  auto evaluator = as::makeRef<MakespanEvaluator>(speeds, prune);
+  TestTuner tuner(MakeDevices(speeds.size()), MakeConfig(num_threads),
+                  evaluator);
+  auto&& annotation =
+      as::downcastRef<WeightsAnnotation>(tuner.tune(/*graph=*/nullptr));
+  return {annotation->weights, evaluator};
+}
+
+void TestSearchFindsBestSplit() {
+  // The makespan is lowest when the work is split 1:3.
+  auto result = Tune({1.0f, 3.0f}, 1, /*prune=*/false);
+  AS_EXPECT_EQ(result.weights.size(), 2u);
+  AS_EXPECT_NEAR(result.weights[1] / result.weights[0], 3.0, 0.15);
+}
+
+void TestCandidatesEvaluatedOnce() {
+  auto result = Tune({1.0f, 2.0f, 1.5f}, 1, /*prune=*/false);
+  auto&& evaluated = result.evaluator->getEvaluated();
+  std::set<std::vector<float>> distinct(evaluated.begin(), evaluated.end());
+  AS_EXPECT_EQ(distinct.size(), evaluated.size());
+  // The initial weights, then at most 8 rounds of 2 candidates per device.
+  AS_EXPECT_TRUE(evaluated.size() <= 1 + 8 * 2 * 3);
+  AS_EXPECT_EQ(evaluated.front(), (std::vector<float>{1.0f, 1.0f, 1.0f}));
+}
+
+void TestNotTunedWithoutProfiles() {
+  auto evaluator = as::makeRef<MakespanEvaluator>(
+      std::vector<float>{1.0f, 3.0f}, /*prune=*/false);
+  TestTuner tuner(MakeDevices(2, /*profiled=*/false), MakeConfig(1),
+                  evaluator);
+  AS_EXPECT_TRUE(!tuner.isTunable());
+  auto&& annotation =
+      as::downcastRef<WeightsAnnotation>(tuner.tune(/*graph=*/nullptr));
+  AS_EXPECT_EQ(annotation->weights, (std::vector<float>{1.0f, 1.0f}));
+  AS_EXPECT_EQ(evaluator->getEvaluated().size(), 1u);
+
+  // Only the heuristic strategy has split ratio weights to search.
+  as::ShardingConfig sharding_config = MakeConfig(1);
+  sharding_config.setStrategyKind(as::StrategyKind::CPU_HOST);
+  TestTuner cpu_host_tuner(MakeDevices(2), sharding_config, evaluator);
+  AS_EXPECT_TRUE(!cpu_host_tuner.isTunable());
+}
+
+void TestPruningKeepsBestSplit() {
+  for (auto&& speeds : std::vector<std::vector<float>>{
+           {1.0f, 3.0f}, {2.0f, 1.0f, 1.5f}, {1.0f, 1.0f, 4.0f, 2.0f}}) {
+    auto exact = Tune(speeds, 1, /*prune=*/false);
+    auto pruned = Tune(speeds, 1, /*prune=*/true);
+    AS_EXPECT_EQ(pruned.weights, exact.weights);
+    AS_EXPECT_TRUE(pruned.evaluator->getNumPruned() > 0);
+  }
+}
+
+void TestParallelTuneMatchesSerial() {
+  for (auto&& speeds : std::vector<std::vector<float>>{
+           {1.0f, 3.0f}, {2.0f, 1.0f, 1.5f}, {1.0f, 1.0f, 4.0f, 2.0f}}) {
+    for (bool prune : {false, true}) {
+      auto serial = Tune(speeds, 1, prune);
+      for (size_t num_threads : {2, 4, 8}) {
+        auto parallel = Tune(speeds, num_threads, prune);
+        AS_EXPECT_EQ(parallel.weights, serial.weights);
+        AS_EXPECT_EQ(parallel.evaluator->getEvaluated().size(),
+                     serial.evaluator->getEvaluated().size());
+      }
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestSearchFindsBestSplit();
+  TestCandidatesEvaluatedOnce();
+  TestNotTunedWithoutProfiles();
+  TestPruningKeepsBestSplit();
+  TestParallelTuneMatchesSerial();
+  return as_test::Finish("hsp_tuner_test");
+}
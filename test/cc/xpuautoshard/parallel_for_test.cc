@@ -0,0 +1,87 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+#include "xpuautoshard/common/parallel_for.h"
+
+namespace {
+
+void TestCoversRangeOnce() {
+  for (size_t num_threads : {1, 3, 8, 100}) {
+    std::vector<std::atomic<int>> visits(37);
+    as::parallelFor(num_threads, visits.size(), [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) visits[i]++;
+    });
+    for (auto&& count : visits) {
+      AS_EXPECT_EQ(count.load(), 1);
+    }
+  }
+  bool called = false;
+  as::parallelFor(4, 0, [&](size_t begin, size_t end) {
+    called |= begin < end;
+  });
+  AS_EXPECT_TRUE(!called);
+}
+
+// Runs blocks of one element on 4 threads, throwing in the `throwing` ones.
+std::string RunThrowing(const std::vector<size_t>& throwing,
+                        std::atomic<int>* num_done) {
+  try {
+    as::parallelFor(4, 4, [&](size_t begin, size_t end) {
+      for (size_t i : throwing) {
+        if (i == begin) throw std::runtime_error(std::to_string(i));
+      }
+      (*num_done)++;
+    });
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+  return "";
+}
+
+void TestRethrowsFromWorkers() {
+  std::atomic<int> num_done(0);
+  AS_EXPECT_EQ(RunThrowing({2}, &num_done), "2");
+  // The other blocks still ran before the exception got out.
+  AS_EXPECT_EQ(num_done.load(), 3);
+}
+
+void TestRethrowsFromCallingThread() {
+  std::atomic<int> num_done(0);
+  AS_EXPECT_EQ(RunThrowing({0}, &num_done), "0");
+  AS_EXPECT_EQ(num_done.load(), 3);
+}
+
+void TestRethrowsOneOfMany() {
+  std::atomic<int> num_done(0);
+  std::string what = RunThrowing({0, 1, 2, 3}, &num_done);
+  AS_EXPECT_TRUE(what == "0" || what == "1" || what == "2" || what == "3");
+  AS_EXPECT_EQ(num_done.load(), 0);
+}
+
+}  // namespace
+
+int main() {
+  TestCoversRangeOnce();
+  TestRethrowsFromWorkers();
+  TestRethrowsFromCallingThread();
+  TestRethrowsOneOfMany();
+  return as_test::Finish("parallel_for_test");
+}
@@ -0,0 +1,327 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <any>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdlib>
+#include <future>  // NOLINT(build/c++11)
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test_util.h"
+#include "xpuautoshard/common/pipeline_scheduler.h"
+
+using as::PipelinePhase;
+using as::PipelineSchedule;
+using as::PipelineScheduler;
+using as::PipelineStage;
+using as::PipelineStep;
+
+namespace {
+
+constexpr auto F = PipelinePhase::FORWARD;
+constexpr auto B = PipelinePhase::BACKWARD;
+
+bool SameSteps(const std::vector<PipelineStep>& lhs,
+               const std::vector<PipelineStep>& rhs) {
+  if (lhs.size() != rhs.size()) return false;
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].phase != rhs[i].phase ||
+        lhs[i].micro_batch != rhs[i].micro_batch) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t NumLeadingForwards(const std::vector<PipelineStep>& steps) {
+  size_t n = 0;
+  while (n < steps.size() && steps[n].phase == F) n++;
+  return n;
+}
+
+// Run the schedule step by step with queues of `capacity` between stages like
+// the scheduler does. Returns false if no stage can make progress.
+bool Simulate(const PipelineSchedule& schedule, size_t capacity) {
+  size_t num_stages = schedule.size();
+  std::vector<size_t> next(num_stages, 0);
+  // Activations and gradients waiting in the queue into each stage.
+  std::vector<std::vector<size_t>> forward_queues(num_stages);
+  std::vector<std::vector<size_t>> backward_queues(num_stages);
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (size_t s = 0; s < num_stages; s++) {
+      if (next[s] == schedule[s].size()) continue;
+      auto&& step = schedule[s][next[s]];
+      bool is_last = s + 1 == num_stages;
+      if (step.phase == F) {
+        auto&& in = forward_queues[s];
+        if (s > 0 && (in.empty() || in.front() != step.micro_batch)) continue;
+        if (!is_last && forward_queues[s + 1].size() >= capacity) continue;
+        if (s > 0) in.erase(in.begin());
+        if (!is_last) forward_queues[s + 1].push_back(step.micro_batch);
+      } else {
+        auto&& in = backward_queues[s];
+        if (!is_last && (in.empty() || in.front() != step.micro_batch)) {
+          continue;
+        }
+        if (s > 0 && backward_queues[s - 1].size() >= capacity) continue;
+        if (!is_last) in.erase(in.begin());
+        if (s > 0) backward_queues[s - 1].push_back(step.micro_batch);
+      }
+      next[s]++;
+      progress = true;
+    }
+  }
+  for (size_t s = 0; s < num_stages; s++) {
+    if (next[s] != schedule[s].size()) return false;
+  }
+  return true;
+}
+
+void TestInferenceSchedule() {
+  auto&& schedule = as::buildPipelineSchedule(3, 4, /*training=*/false);
+  AS_EXPECT_EQ(schedule.size(), 3u);
+  for (auto&& steps : schedule) {
+    AS_EXPECT_TRUE(SameSteps(steps, {{F, 0}, {F, 1}, {F, 2}, {F, 3}}));
+  }
+}
+
+void TestTrainingScheduleIs1F1B() {
+  auto&& schedule = as::buildPipelineSchedule(4, 6, /*training=*/true);
+  AS_EXPECT_TRUE(SameSteps(schedule[0], {{F, 0}, {F, 1}, {F, 2},
+                                         {F, 3}, {B, 0}, {F, 4}, {B, 1},
+                                         {F, 5}, {B, 2},
+                                         {B, 3}, {B, 4}, {B, 5}}));
+  AS_EXPECT_TRUE(SameSteps(schedule[2], {{F, 0},
+                                         {F, 1}, {B, 0}, {F, 2}, {B, 1},
+                                         {F, 3}, {B, 2}, {F, 4}, {B, 3},
+                                         {F, 5}, {B, 4},
+                                         {B, 5}}));
+  AS_EXPECT_TRUE(SameSteps(schedule[3], {{F, 0}, {B, 0}, {F, 1}, {B, 1},
+                                         {F, 2}, {B, 2}, {F, 3}, {B, 3},
+                                         {F, 4}, {B, 4}, {F, 5}, {B, 5}}));
+  for (size_t s = 0; s < schedule.size(); s++) {
+    // Warm-up forwards, then one more forward before the first backward.
+    AS_EXPECT_EQ(NumLeadingForwards(schedule[s]), 4 - s);
+    // At most #stages - s activations are in flight.
+    size_t in_flight = 0;
+    for (auto&& step : schedule[s]) {
+      in_flight = step.phase == F ? in_flight + 1 : in_flight - 1;
+      AS_EXPECT_TRUE(in_flight <= 4 - s);
+    }
+    AS_EXPECT_EQ(in_flight, 0u);
+  }
+}
+
+void TestTrainingScheduleWithFewMicroBatches() {
+  // Fewer micro-batches than stages cap the warm-up.
+  auto&& schedule = as::buildPipelineSchedule(4, 2, /*training=*/true);
+  AS_EXPECT_TRUE(SameSteps(schedule[0], {{F, 0}, {F, 1}, {B, 0}, {B, 1}}));
+  AS_EXPECT_TRUE(SameSteps(schedule[1], {{F, 0}, {F, 1}, {B, 0}, {B, 1}}));
+  AS_EXPECT_TRUE(SameSteps(schedule[2], {{F, 0}, {F, 1}, {B, 0}, {B, 1}}));
+  AS_EXPECT_TRUE(SameSteps(schedule[3], {{F, 0}, {B, 0}, {F, 1}, {B, 1}}));
+
+  schedule = as::buildPipelineSchedule(3, 1, /*training=*/true);
+  for (auto&& steps : schedule) {
+    AS_EXPECT_TRUE(SameSteps(steps, {{F, 0}, {B, 0}}));
+  }
+
+  schedule = as::buildPipelineSchedule(3, 0, /*training=*/true);
+  for (auto&& steps : schedule) {
+    AS_EXPECT_TRUE(steps.empty());
+  }
+}
+
+void TestScheduleDeadlockFree() {
+  for (size_t num_stages : {1, 2, 3, 4, 8}) {
+    for (size_t num_micro_batches : {1, 2, 3, 7, 16}) {
+      for (bool training : {false, true}) {
+        auto&& schedule =
+            as::buildPipelineSchedule(num_stages, num_micro_batches, training);
+        // The default queue capacity of the scheduler.
+        AS_EXPECT_TRUE(Simulate(schedule, num_stages));
+      }
+    }
+  }
+}
+
+// Stage s adds s + 1 forward and doubles the gradient backward, recording the
+// steps it ran.
+struct RecordingPipeline {
+  explicit RecordingPipeline(size_t num_stages) : steps(num_stages) {
+    for (size_t s = 0; s < num_stages; s++) {
+      PipelineStage stage;
+      stage.forward = [this, s](size_t micro_batch, std::any input) {
+        steps[s].push_back({F, micro_batch});
+        return std::any(std::any_cast<int>(input) + static_cast<int>(s) + 1);
+      };
+      stage.backward = [this, s](size_t micro_batch, std::any grad) {
+        steps[s].push_back({B, micro_batch});
+        return std::any(std::any_cast<int>(grad) * 2);
+      };
+      stages.push_back(stage);
+    }
+  }
+
+  std::vector<PipelineStage> stages;
+  // Each stage only appends to its own steps from its worker thread.
+  std::vector<std::vector<PipelineStep>> steps;
+};
+
+std::vector<std::any> Inputs(size_t num_micro_batches) {
+  std::vector<std::any> inputs;
+  for (size_t mb = 0; mb < num_micro_batches; mb++) {
+    inputs.emplace_back(static_cast<int>(mb * 100));
+  }
+  return inputs;
+}
+
+// Fails the test binary instead of hanging on a deadlock.
+template <typename Fn>
+void WithTimeout(const char* name, Fn fn) {
+  auto done = std::async(std::launch::async, fn);
+  if (done.wait_for(std::chrono::seconds(60)) != std::future_status::ready) {
+    std::cout << name << " timed out" << std::endl;
+    std::_Exit(1);
+  }
+  done.get();
+}
+
+void TestRunInference() {
+  WithTimeout("TestRunInference", []() {
+    for (size_t capacity : {0, 1, 2}) {
+      RecordingPipeline pipeline(3);
+      PipelineScheduler scheduler(pipeline.stages, capacity);
+      auto&& outputs = scheduler.run(Inputs(16));
+      AS_EXPECT_EQ(outputs.size(), 16u);
+      for (size_t mb = 0; mb < outputs.size(); mb++) {
+        // 1 + 2 + 3 added by the stages.
+        AS_EXPECT_EQ(std::any_cast<int>(outputs[mb]),
+                     static_cast<int>(mb * 100 + 6));
+      }
+      auto&& schedule = as::buildPipelineSchedule(3, 16, false);
+      for (size_t s = 0; s < 3; s++) {
+        AS_EXPECT_TRUE(SameSteps(pipeline.steps[s], schedule[s]));
+        AS_EXPECT_EQ(scheduler.getStats().stages[s].num_steps, 16u);
+      }
+    }
+  });
+}
+
+void TestRunTraining() {
+  WithTimeout("TestRunTraining", []() {
+    for (size_t num_micro_batches : {2, 4, 32}) {
+      RecordingPipeline pipeline(4);
+      PipelineScheduler scheduler(pipeline.stages);
+      auto&& outputs = scheduler.run(Inputs(num_micro_batches), true);
+      AS_EXPECT_EQ(outputs.size(), num_micro_batches);
+      for (size_t mb = 0; mb < outputs.size(); mb++) {
+        // The last forward output, doubled by the 4 backwards.
+        AS_EXPECT_EQ(std::any_cast<int>(outputs[mb]),
+                     static_cast<int>((mb * 100 + 10) * 16));
+      }
+      auto&& schedule =
+          as::buildPipelineSchedule(4, num_micro_batches, true);
+      auto&& stats = scheduler.getStats();
+      for (size_t s = 0; s < 4; s++) {
+        AS_EXPECT_TRUE(SameSteps(pipeline.steps[s], schedule[s]));
+        AS_EXPECT_EQ(stats.stages[s].num_steps, 2 * num_micro_batches);
+      }
+      AS_EXPECT_TRUE(stats.getBubbleRatio() >= 0.0f);
+      AS_EXPECT_TRUE(stats.getBubbleRatio() <= 1.0f);
+    }
+  });
+}
+
+void TestRunWithoutStages() {
+  PipelineScheduler scheduler({});
+  auto&& outputs = scheduler.run(Inputs(3));
+  AS_EXPECT_EQ(outputs.size(), 3u);
+  AS_EXPECT_EQ(std::any_cast<int>(outputs[2]), 200);
+}
+
+// Runs 4 stages where `stage` throws at `micro_batch` in `phase`, returning
+// the message of the exception rethrown by the scheduler.
+std::string RunFailing(size_t stage, size_t micro_batch, PipelinePhase phase,
+                       bool training) {
+  RecordingPipeline pipeline(4);
+  auto&& failing = pipeline.stages[stage];
+  auto throw_at = [=](auto fn) {
+    return [=](size_t mb, std::any value) {
+      if (mb == micro_batch) {
+        throw std::runtime_error("stage " + std::to_string(stage));
+      }
+      return fn(mb, std::move(value));
+    };
+  };
+  if (phase == F) {
+    failing.forward = throw_at(failing.forward);
+  } else {
+    failing.backward = throw_at(failing.backward);
+  }
+  PipelineScheduler scheduler(pipeline.stages);
+  try {
+    scheduler.run(Inputs(16), training);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+  return "";
+}
+
+void TestRunPropagatesExceptions() {
+  WithTimeout("TestRunPropagatesExceptions", []() {
+    // The other stages give up waiting for the failed one.
+    AS_EXPECT_EQ(RunFailing(0, 0, F, false), "stage 0");
+    AS_EXPECT_EQ(RunFailing(2, 5, F, false), "stage 2");
+    AS_EXPECT_EQ(RunFailing(3, 15, F, false), "stage 3");
+    AS_EXPECT_EQ(RunFailing(1, 3, F, true), "stage 1");
+    AS_EXPECT_EQ(RunFailing(3, 0, B, true), "stage 3");
+    AS_EXPECT_EQ(RunFailing(0, 7, B, true), "stage 0");
+
+    // The scheduler runs again after a failure.
+    RecordingPipeline pipeline(2);
+    PipelineScheduler scheduler(pipeline.stages);
+    auto failing = pipeline.stages;
+    failing[1].forward = [](size_t, std::any) -> std::any {
+      throw std::runtime_error("failed");
+    };
+    bool thrown = false;
+    try {
+      PipelineScheduler(failing).run(Inputs(4));
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    AS_EXPECT_TRUE(thrown);
+    AS_EXPECT_EQ(scheduler.run(Inputs(4)).size(), 4u);
+  });
+}
+
+}  // namespace
+
+int main() {
+  TestInferenceSchedule();
+  TestTrainingScheduleIs1F1B();
+  TestTrainingScheduleWithFewMicroBatches();
+  TestScheduleDeadlockFree();
+  TestRunInference();
+  TestRunTraining();
+  TestRunWithoutStages();
+  TestRunPropagatesExceptions();
+  return as_test::Finish("pipeline_scheduler_test");
+}
@@ -0,0 +1,235 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "test_util.h"
+#include "xpuautoshard/common/parallel_for.h"
+#include "xpuautoshard/common/profiled_hsp_cost_evaluator.h"
+
+using as::DeviceId;
+using as::DeviceInfo;
+using as::FloatScore;
+using as::ShardingProperty;
+using as::ShardingPropertyRef;
+using as::SplitSpec;
+
+namespace {
+
+// An op doing `work` units.
+struct WorkCharacteristics : public as::ComputeCharacteristics {
+  explicit WorkCharacteristics(float work) : work(work) {}
+  float work;
+};
+
+// A device doing `speed` units of work per second.
+class CountingCostModel : public as::CostModel {
+ public:
+  explicit CountingCostModel(float speed) : speed_(speed) {}
+
+  as::ComputeCharacterizerRef createComputeCharacterizer() override {
+    return nullptr;
+  }
+
+  TimeCost evaluateTime(as::ComputeCharacteristicsRef comp_ch) override {
+    num_calls_++;
+    return as::downcastRef<WorkCharacteristics>(comp_ch)->work / speed_;
+  }
+
+  int getNumCalls() const { return num_calls_; }
+
+ private:
+  float speed_;
+  std::atomic<int> num_calls_{0};
+};
+
+// The result HSP of each op.
+struct HspsAnnotation : public as::HspAnnotation {
+  explicit HspsAnnotation(const std::vector<ShardingPropertyRef>& hsps)
+      : hsps(hsps) {}
+  std::vector<ShardingPropertyRef> hsps;
+};
+
+class TestEvaluator : public as::ProfiledHspCostEvaluator {
+ public:
+  TestEvaluator(const std::map<DeviceId, as::CostModelRef>& cost_models,
+                const std::vector<float>& works)
+      : as::ProfiledHspCostEvaluator(cost_models) {
+    for (float work : works) {
+      addOp(as::makeRef<WorkCharacteristics, as::ComputeCharacteristics>(work));
+    }
+  }
+
+  int getNumLookups() const { return num_lookups_; }
+
+ protected:
+  ShardingPropertyRef getResultHsp(size_t op_index,
+                                   as::HspAnnotationRef annotation) override {
+    num_lookups_++;
+    return as::downcastRef<HspsAnnotation>(annotation)->hsps[op_index];
+  }
+
+ private:
+  std::atomic<int> num_lookups_{0};
+};
+
+class EvaluatorTest {
+ public:
+  // Two devices with speeds 1 and 3.
+  explicit EvaluatorTest(const std::vector<float>& works) {
+    for (DeviceId id : {1, 2}) {
+      device_info_.addDevice(as::Device(id, "CPU", 1.0f));
+    }
+    cpu1_ = std::make_shared<CountingCostModel>(1.0f);
+    cpu2_ = std::make_shared<CountingCostModel>(3.0f);
+    evaluator_ =
+        std::make_shared<TestEvaluator>(std::map<DeviceId, as::CostModelRef>{
+                                            {1, cpu1_}, {2, cpu2_}},
+                                        works);
+  }
+
+  // An HSP of a 1D tensor split by `ratios` over the two devices.
+  ShardingPropertyRef Split(const std::vector<float>& ratios) {
+    auto hsp = as::makeRef<ShardingProperty>(device_info_, as::FLOAT32, 1,
+                                             std::vector<int64_t>{-1});
+    hsp->splitAt(0, SplitSpec::buildFromRatios(*hsp, 0, ratios));
+    return hsp;
+  }
+
+  // An HSP of a 1D tensor replicated on the two devices.
+  ShardingPropertyRef Replicate() {
+    auto hsp = as::makeRef<ShardingProperty>(device_info_, as::FLOAT32, 1,
+                                             std::vector<int64_t>{-1});
+    hsp->splitSingleAt(0);
+    return hsp;
+  }
+
+  float Evaluate(const std::vector<ShardingPropertyRef>& hsps,
+                 float bound = std::numeric_limits<float>::lowest()) {
+    auto&& score = evaluator_->evaluateWithBound(
+        /*graph=*/nullptr,
+        as::makeRef<HspsAnnotation, as::HspAnnotation>(hsps),
+        as::makeRef<FloatScore, as::Score>(bound));
+    return as::downcastRef<FloatScore>(score)->getValue();
+  }
+
+  int NumCostModelCalls() const {
+    return cpu1_->getNumCalls() + cpu2_->getNumCalls();
+  }
+
+  TestEvaluator& evaluator() { return *evaluator_; }
+
+ private:
+  DeviceInfo device_info_;
+  std::shared_ptr<CountingCostModel> cpu1_;
+  std::shared_ptr<CountingCostModel> cpu2_;
+  std::shared_ptr<TestEvaluator> evaluator_;
+};
+
+void TestScoreIsSlowestDevice() {
+  EvaluatorTest test({4.0f, 8.0f, 3.0f});
+  // Device 1 runs 2 + 4 + 3 units at speed 1, device 2 runs 2 + 4 + 3 units at
+  // speed 3. Ops without an HSP on devices are not counted.
+  AS_EXPECT_NEAR(test.Evaluate({test.Split({0.5f, 0.5f}),
+                                test.Split({0.5f, 0.5f}), test.Replicate()}),
+                 -9.0, 1e-5);
+  AS_EXPECT_NEAR(test.Evaluate({test.Split({0.25f, 0.75f}),
+                                test.Split({0.25f, 0.75f}), nullptr}),
+                 -3.0, 1e-5);
+  auto&& lowest =
+      as::downcastRef<FloatScore>(test.evaluator().lowestScore());
+  AS_EXPECT_TRUE(lowest->getValue() <
+                 test.Evaluate({test.Replicate(), nullptr, nullptr}));
+}
+
+void TestDeviceTimesMemoised() {
+  EvaluatorTest test({4.0f, 8.0f});
+  auto split = test.Split({0.5f, 0.5f});
+  auto replicated = test.Replicate();
+  float score = test.Evaluate({split, replicated});
+  // Each op on each device.
+  AS_EXPECT_EQ(test.NumCostModelCalls(), 4);
+
+  // The same and equal HSPs are not scored again.
+  AS_EXPECT_EQ(test.Evaluate({split, replicated}), score);
+  AS_EXPECT_EQ(test.Evaluate({test.Split({0.5f, 0.5f}), test.Replicate()}),
+               score);
+  AS_EXPECT_EQ(test.NumCostModelCalls(), 4);
+
+  // Only the op with a new HSP is.
+  test.Evaluate({split, test.Split({0.25f, 0.75f})});
+  AS_EXPECT_EQ(test.NumCostModelCalls(), 6);
+  // The HSP of one op is not reused for another.
+  test.Evaluate({replicated, replicated});
+  AS_EXPECT_EQ(test.NumCostModelCalls(), 8);
+}
+
+void TestPruning() {
+  std::vector<float> works(10, 1.0f);
+  EvaluatorTest test(works);
+  std::vector<ShardingPropertyRef> even(10, test.Split({0.5f, 0.5f}));
+  std::vector<ShardingPropertyRef> best(10, test.Split({0.25f, 0.75f}));
+  float exact = test.Evaluate(even);
+  AS_EXPECT_NEAR(exact, -5.0, 1e-5);
+  AS_EXPECT_EQ(test.evaluator().getNumLookups(), 10);
+
+  // Device 1 exceeds the makespan of the best split after 6 ops.
+  float best_score = test.Evaluate(best);
+  float pruned = test.Evaluate(even, best_score);
+  AS_EXPECT_TRUE(pruned < best_score);
+  AS_EXPECT_EQ(test.evaluator().getNumLookups(), 10 + 10 + 6);
+
+  // A bound below the exact score does not prune.
+  AS_EXPECT_EQ(test.Evaluate(even, exact - 1.0f), exact);
+  AS_EXPECT_EQ(test.Evaluate(even, exact), exact);
+}
+
+void TestConcurrentEvaluations() {
+  std::vector<float> works = {1.0f, 2.0f, 3.0f, 4.0f};
+  EvaluatorTest test(works);
+  std::vector<std::vector<ShardingPropertyRef>> annotations;
+  for (float ratio : {0.1f, 0.25f, 0.5f, 0.75f}) {
+    annotations.push_back(
+        std::vector<ShardingPropertyRef>(4, test.Split({ratio, 1 - ratio})));
+  }
+  EvaluatorTest serial_test(works);
+  std::vector<float> expected;
+  for (auto&& annotation : annotations) {
+    expected.push_back(serial_test.Evaluate(annotation));
+  }
+  std::vector<float> scores(64);
+  as::parallelFor(8, scores.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      scores[i] = test.Evaluate(annotations[i % annotations.size()]);
+    }
+  });
+  for (size_t i = 0; i < scores.size(); i++) {
+    AS_EXPECT_EQ(scores[i], expected[i % expected.size()]);
+  }
+}
+
+}  // namespace
+
+int main() {
+  TestScoreIsSlowestDevice();
+  TestDeviceTimesMemoised();
+  TestPruning();
+  TestConcurrentEvaluations();
+  return as_test::Finish("profiled_hsp_cost_evaluator_test");
+}
@@ -0,0 +1,71 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TEST_CC_XPUAUTOSHARD_TEST_UTIL_H_
+#define TEST_CC_XPUAUTOSHARD_TEST_UTIL_H_
+
+#include <iostream>
+
+// Minimal checks for the XPUAutoShard tests, which build without the
+// framework. A failed check is reported and fails the test binary, but the
+// remaining checks still run.
+namespace as_test {
+
+inline int& NumFailures() {
+  static int num_failures = 0;
+  return num_failures;
+}
+
+inline int Finish(const char* name) {
+  if (NumFailures() > 0) {
+    std::cout << name << " [Failed] " << NumFailures() << " check(s)"
+              << std::endl;
+    return 1;
+  }
+  std::cout << name << " [Passed]" << std::endl;
+  return 0;
+}
+
+}  // namespace as_test
+
+#define AS_EXPECT_TRUE(cond)                                                   \
+  do {                                                                         \
+    if (!(cond)) {                                                             \
+      std::cout << __FILE__ << ":" << __LINE__ << ": expected " #cond          \
+                << std::endl;                                                  \
+      ++as_test::NumFailures();                                                \
+    }                                                                          \
+  } while (0)
+
+#define AS_EXPECT_EQ(a, b)                                                     \
+  do {                                                                         \
+    if (!((a) == (b))) {                                                       \
+      std::cout << __FILE__ << ":" << __LINE__ << ": expected " #a " == " #b   \
+                << std::endl;                                                  \
+      ++as_test::NumFailures();                                                \
+    }                                                                          \
+  } while (0)
+
+#define AS_EXPECT_NEAR(a, b, tol)                                              \
+  do {                                                                         \
+    double as_diff_ = static_cast<double>(a) - static_cast<double>(b);         \
+    if (!(as_diff_ <= (tol) && -as_diff_ <= (tol))) {                          \
+      std::cout << __FILE__ << ":" << __LINE__ << ": expected " #a " near "    \
+                << #b << ", got " << (a) << " vs " << (b) << std::endl;        \
+      ++as_test::NumFailures();                                                \
+    }                                                                          \
+  } while (0)
+
+#endif  // TEST_CC_XPUAUTOSHARD_TEST_UTIL_H_
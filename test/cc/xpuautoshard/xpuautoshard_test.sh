@@ -0,0 +1,46 @@
+#!/bin/bash
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+# Unit tests of the framework independent parts of XPUAutoShard. They only
+# need a C++17 compiler, not a build of TensorFlow* or the plugin.
+
+function test_case_build {
+    make clean >& /dev/null
+    make >& build.log
+    if [ $? -eq 0 ]; then
+        echo "XPUAutoShard C++ tests are built successfully!"
+    else
+        echo "XPUAutoShard C++ tests are built failed! please check build.log!"
+        exit 1
+    fi
+}
+
+function run_test_case {
+    make run >& xpuautoshard_test.log
+    result=$?
+    cat xpuautoshard_test.log
+    if [ $result -eq 0 ]; then
+        echo "XPUAutoShard C++ tests [Passed]"
+    else
+        echo "XPUAutoShard C++ tests [Failed]"
+        exit 1
+    fi
+}
+
+cd "$(dirname "$0")"
+test_case_build
+run_test_case
+exit 0
@@ -0,0 +1,65 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Functional tests for ops translated to oneDNN Graph after contractions."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import numpy as np
+
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import clip_ops
+from tensorflow.python.ops import math_ops
+
+import os
+
+os.environ["ITEX_ONEDNN_GRAPH"] = "1"
+os.environ["_ITEX_ONEDNN_GRAPH_ALL_TYPE"] = "1"
+
+
+class ElementwiseOpsTest(test.TestCase):
+
+  @test_util.run_deprecated_v1
+  def testMatMulWithElementwiseOps(self):
+    x_np = np.random.uniform(low=-1.0, high=1.0, size=(4, 8)).astype(np.float32)
+    w_np = np.random.uniform(low=-1.0, high=1.0, size=(8, 6)).astype(np.float32)
+    with ops.name_scope("test"):
+      x = constant_op.constant(x_np)
+      w = constant_op.constant(w_np)
+      t = math_ops.matmul(x, w)
+      t = math_ops.realdiv(t, constant_op.constant(2.0))
+      t = math_ops.maximum(t, constant_op.constant(-0.5))
+      t = math_ops.minimum(t, constant_op.constant(0.5))
+      t = clip_ops.clip_by_value(t, -0.25, 0.25)
+      t = math_ops.exp(t)
+      t = math_ops.pow(t, constant_op.constant(2.0))
+      t = math_ops.log(t)
+      t = array_ops.expand_dims(t, 0)
+      t = array_ops.squeeze(t, [0])
+      output = array_ops.identity(t)
+
+      res = self.evaluate(output)
+
+    expected = np.clip(np.matmul(x_np, w_np) / 2.0, -0.25, 0.25) * 2.0
+    self.assertAllClose(expected, res, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,110 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the slice kernel against numpy.
+
+On CPU, _ITEXSlice returns aligned contiguous ranges as views of the input,
+and copies the other slices with reorders cached per shape and slice.
+"""
+
+import numpy as np
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import tensorflow as tf
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import array_ops
+
+
+class SliceOpTest(test_util.TensorFlowTestCase):
+  """test slice op"""
+
+  def _random(self, *shape):
+    return np.random.uniform(-10, 10, size=shape).astype(np.float32)
+
+  def _expected(self, x, begin, size):
+    return x[tuple(slice(b, b + s) for b, s in zip(begin, size))]
+
+  def _testSlice(self, x, begin, size):
+    with self.session(use_gpu=True):
+      p = array_ops.placeholder(dtypes.float32, shape=x.shape)
+      result = array_ops.slice(p, begin, size).eval(feed_dict={p: x})
+    self.assertAllEqual(result, self._expected(x, begin, size))
+
+  @test_util.run_deprecated_v1
+  def testContiguous(self):
+    # Aligned: the window starts 512 bytes into the input.
+    self._testSlice(self._random(8, 32), [4, 0], [3, 32])
+    # Unaligned: the window starts 12 bytes into the input, so it's copied.
+    self._testSlice(self._random(8, 3), [1, 0], [5, 3])
+    self._testSlice(self._random(9, 5, 7), [2, 0, 0], [7, 5, 7])
+
+  @test_util.run_deprecated_v1
+  def testLeadingSizeOneWindows(self):
+    # Dims before the sliced one have size 1, dims after it are whole.
+    x = self._random(4, 10, 16)
+    self._testSlice(x, [2, 3, 0], [1, 5, 16])
+    self._testSlice(x, [3, 0, 0], [1, 10, 16])
+    self._testSlice(x, [1, 7, 5], [1, 1, 11])
+    self._testSlice(self._random(3, 4, 6, 8), [1, 2, 1, 0], [1, 1, 4, 8])
+
+  @test_util.run_deprecated_v1
+  def testNonContiguous(self):
+    x = self._random(16, 33)
+    self._testSlice(x, [2, 5], [6, 7])
+    self._testSlice(x, [0, 1], [16, 32])
+    self._testSlice(self._random(5, 6, 7), [1, 2, 3], [3, 3, 3])
+
+  @test_util.run_deprecated_v1
+  def testEmpty(self):
+    self._testSlice(self._random(8, 16), [3, 0], [0, 16])
+    self._testSlice(self._random(8, 16), [3, 4], [2, 0])
+
+  @test_util.run_deprecated_v1
+  def testReorderCache(self):
+    # One kernel instance sees repeated slices, which reuse their reorder,
+    # and slices of other shapes and windows, which must not.
+    with self.session(use_gpu=True) as sess:
+      p = array_ops.placeholder(dtypes.float32, shape=None)
+      begin = array_ops.placeholder(dtypes.int32, shape=[2])
+      size = array_ops.placeholder(dtypes.int32, shape=[2])
+      y = array_ops.slice(p, begin, size)
+      a = self._random(16, 33)
+      other = self._random(17, 31)
+      for x, b, s in [(a, [2, 5], [6, 7]), (a, [2, 5], [6, 7]),
+                      (a, [3, 5], [6, 7]), (a, [2, 5], [7, 6]),
+                      (other, [2, 5], [6, 7]), (a, [2, 5], [6, 7])]:
+        result = sess.run(y, feed_dict={p: x, begin: b, size: s})
+        self.assertAllEqual(result, self._expected(x, b, s))
+
+  @test_util.run_deprecated_v1
+  def testWriteDoesNotCorruptSource(self):
+    # The aligned window is a view of `x`, consumers that write in place must
+    # not reach the buffer of `x`.
+    x = self._random(8, 32)
+    with self.session(use_gpu=True) as sess:
+      p = array_ops.placeholder(dtypes.float32, shape=x.shape)
+      source = array_ops.identity(p)
+      window = array_ops.slice(source, [4, 0], [4, 32])
+      written = tf.nn.relu(tf.math.add(window, 100.0))
+      with tf.control_dependencies([written]):
+        after = array_ops.identity(source)
+      written_val, after_val = sess.run([written, after], feed_dict={p: x})
+    self.assertAllEqual(written_val, np.maximum(x[4:] + 100.0, 0))
+    self.assertAllEqual(after_val, x)
+
+
+if __name__ == '__main__':
+  test.main()
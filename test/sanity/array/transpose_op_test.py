@@ -0,0 +1,114 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the transpose kernels against np.transpose.
+
+On CPU, float types run through _ITEXTranspose and int8 through
+_ITEXQuantizedTranspose. Both coalesce the dims, then copy, copy rows of a
+kept innermost dim, or transpose 2-D planes with tiles picked by element size.
+There is no ITEX CPU transpose kernel for 8-byte types, so those stay with TF.
+"""
+
+import numpy as np
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+from intel_extension_for_tensorflow.python.ops.load_ops_library import load_ops_library
+
+import tensorflow as tf
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import array_ops
+
+# One float type per element size moved by the tile kernels.
+_FLOAT_TYPES = [dtypes.bfloat16, dtypes.float16, dtypes.float32]
+
+# 2-D shapes off the 4, 8 and 16 element tiles and the 64 element blocks.
+_PLANE_SHAPES = [(1, 9), (3, 5), (17, 33), (37, 53), (70, 150), (130, 67)]
+
+# (shape, perm) of the paths of the planner.
+_CASES = [
+    # Collapses to a plain copy.
+    ((1, 45), (1, 0)),
+    ((3, 1, 5), (1, 0, 2)),
+    ((7, 1, 1, 9), (0, 2, 1, 3)),
+    # Keeps the innermost dim, copied row by row.
+    ((6, 11, 19), (1, 0, 2)),
+    ((5, 7, 9, 13), (2, 0, 1, 3)),
+    # NHWC <-> NCHW.
+    ((2, 13, 17, 35), (0, 3, 1, 2)),
+    ((2, 35, 13, 17), (0, 2, 3, 1)),
+    ((3, 5, 7, 11, 19), (0, 4, 1, 2, 3)),
+    # Attention heads split and merged.
+    ((2, 19, 3, 24), (0, 2, 1, 3)),
+    ((2, 3, 19, 24), (0, 2, 1, 3)),
+    ((2, 3, 19, 24), (0, 1, 3, 2)),
+    # Mixed rank 3 permutation.
+    ((9, 10, 11), (2, 0, 1)),
+]
+
+
+class TransposeOpTest(test_util.TensorFlowTestCase):
+  """test transpose op"""
+
+  def _testTranspose(self, x, perm, dtype):
+    with self.session(use_gpu=True):
+      p = array_ops.placeholder(dtype, shape=x.shape)
+      result = array_ops.transpose(p, perm).eval(feed_dict={p: x})
+    self.assertAllEqual(result, np.transpose(x, perm))
+
+  def _testQuantizedTranspose(self, x, perm):
+    with self.session(use_gpu=True) as sess:
+      p = array_ops.placeholder(dtypes.float32, shape=x.shape)
+      x_min = tf.math.reduce_min(p)
+      x_max = tf.math.reduce_max(p)
+      q, q_min, q_max = array_ops.quantize(
+          p, x_min, x_max, T=dtypes.qint8, mode="SCALED",
+          round_mode="HALF_TO_EVEN", narrow_range=True)
+      t, t_min, t_max = load_ops_library._QuantizedTranspose(
+          x=q, perm=perm, min_x=q_min, max_x=q_max)
+      # Both sides share the scale, so dequantized values compare exactly.
+      dq = array_ops.dequantize(q, q_min, q_max, mode="SCALED",
+                                narrow_range=True)
+      dt = array_ops.dequantize(t, t_min, t_max, mode="SCALED",
+                                narrow_range=True)
+      before, after = sess.run([dq, dt], feed_dict={p: x})
+    self.assertAllEqual(after, np.transpose(before, perm))
+
+  def _random(self, shape, dtype):
+    x = np.random.uniform(-10, 10, size=shape).astype(np.float32)
+    return x.astype(dtype.as_numpy_dtype)
+
+  @test_util.run_deprecated_v1
+  def testPlanes(self):
+    for dtype in _FLOAT_TYPES:
+      for shape in _PLANE_SHAPES:
+        self._testTranspose(self._random(shape, dtype), (1, 0), dtype)
+
+  @test_util.run_deprecated_v1
+  def testPlannerPaths(self):
+    for dtype in _FLOAT_TYPES:
+      for shape, perm in _CASES:
+        self._testTranspose(self._random(shape, dtype), perm, dtype)
+
+  @test_util.run_deprecated_v1
+  def testQuantizedINT8(self):
+    for shape in _PLANE_SHAPES:
+      self._testQuantizedTranspose(self._random(shape, dtypes.float32),
+                                   (1, 0))
+    for shape, perm in _CASES:
+      self._testQuantizedTranspose(self._random(shape, dtypes.float32), perm)
+
+
+if __name__ == '__main__':
+  test.main()
@@ -111,6 +111,18 @@ class EinsumOpTest(test.TestCase):
     # Based on https://github.com/google/jax/issues/37#issuecomment-448572187
     self._check('sa,shb->shab', (2, 1), (2, 3, 4))
 
+  def testStridedContraction(self):
+    # Contracted by a single matmul reading the operands through strides.
+    self._check('bhqd,bhkd->bhqk', (2, 3, 5, 8), (2, 3, 7, 8))
+    self._check('bqhd,bkhd->bhqk', (2, 5, 3, 8), (2, 7, 3, 8))
+    self._check('bhqk,bkhd->bqhd', (2, 3, 5, 7), (2, 7, 3, 8))
+    self._check('ij,jk->ki', (3, 4), (4, 5))
+    self._check('abcd,cde->abe', (2, 3, 4, 5), (4, 5, 6))
+    self._check('abcd,dce->abe', (2, 3, 4, 5), (5, 4, 6))
+    # Groups that are not contiguous in every tensor take the transpose path.
+    self._check('acbd,cd->ab', (2, 3, 4, 5), (3, 5))
+    self._check('abc,acd->dbc', (2, 3, 4), (2, 4, 5))
+
   def testReducedIndices(self):
     self._check('ba,b->', (3, 2), (3,))
     self._check('ab,ab->', (3, 4), (3, 4))
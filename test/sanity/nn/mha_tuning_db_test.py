@@ -0,0 +1,149 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests the tuning database of the CPU fused attention.
+
+ITEX_CPU_MHA_TUNING_DB is read once per process, so every run of the kernel
+happens in a child process running this file with `_WORKER_ENV` set.
+"""
+
+import os
+import subprocess
+import sys
+
+import numpy as np
+
+# Candidates of the autotuner, as kFmhaBlockConfigs in mha_op.cc.
+_BLOCK_CONFIGS = [(32, 512), (64, 512), (256, 512), (32, 256), (64, 256),
+                  (128, 256), (64, 128), (128, 128)]
+_WORKER_ENV = 'ITEX_TEST_MHA_TUNING_DB_WORKER'
+
+
+def _run_worker():
+  """Checks the fused attention against the reference on CPU."""
+  import tensorflow as tf
+  from intel_extension_for_tensorflow.python.ops.multi_head_attention import (
+      scaled_dot_product_attention)
+
+  np.random.seed(0)
+  # Longer than every q_split_size, so that all candidates are distinct.
+  shape = [1, 2, 300, 64]
+  q = tf.constant(np.random.normal(size=shape).astype(np.float32))
+  k = tf.constant(np.random.normal(size=shape).astype(np.float32))
+  v = tf.constant(np.random.normal(size=shape).astype(np.float32))
+  mask = tf.constant(np.where(np.random.uniform(size=[1, 1, 300, 300]) > 0.5,
+                              0.0, -1e4).astype(np.float32))
+  with tf.device('/cpu:0'):
+    outputs = [
+        scaled_dot_product_attention(q, k, v, mask, 0.0, (0, 1),
+                                     use_fast_attention=use_fast_attention,
+                                     is_training=False)
+        for use_fast_attention in (False, True)]
+  np.testing.assert_allclose(outputs[1], outputs[0], rtol=1e-4, atol=1e-4)
+
+
+if os.environ.get(_WORKER_ENV) == '1':
+  _run_worker()
+  sys.exit(0)
+
+# pylint: disable=wrong-import-position
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+
+class MhaTuningDbTest(test_util.TensorFlowTestCase):
+  """test the MHA tuning database"""
+
+  def _db_path(self, name):
+    path = os.path.join(self.get_temp_dir(), name)
+    if os.path.exists(path):
+      os.remove(path)
+    return path
+
+  def _run(self, db_path):
+    env = dict(os.environ)
+    env[_WORKER_ENV] = '1'
+    env['ITEX_CPU_MHA_TUNING_DB'] = db_path
+    env['ITEX_CPU_MHA_AUTOTUNE'] = '1'
+    result = subprocess.run([sys.executable, os.path.abspath(__file__)],
+                            env=env, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, check=False)
+    self.assertEqual(result.returncode, 0, result.stdout.decode())
+
+  def _read(self, db_path):
+    with open(db_path) as f:
+      return f.read()
+
+  def _assertEntry(self, line):
+    fields = line.split(' ')
+    self.assertEqual(len(fields), 3, line)
+    self.assertIn((int(fields[1]), int(fields[2])), _BLOCK_CONFIGS)
+    return fields[0]
+
+  def _tunedKey(self):
+    db_path = self._db_path('tuned.txt')
+    self._run(db_path)
+    return self._assertEntry(self._read(db_path).strip())
+
+  def testRecordsAndReusesEntry(self):
+    db_path = self._db_path('reuse.txt')
+    self._run(db_path)
+    content = self._read(db_path)
+    lines = content.splitlines()
+    self.assertEqual(len(lines), 1)
+    self._assertEntry(lines[0])
+
+    # The loaded entry is used as is, so nothing is tuned or appended.
+    self._run(db_path)
+    self.assertEqual(self._read(db_path), content)
+
+  def testEveryBlockConfig(self):
+    # An entry in the file picks the block config, which must give the same
+    # result as the reference for every candidate.
+    key = self._tunedKey()
+    db_path = self._db_path('configs.txt')
+    for q_split_size, kv_split_size in _BLOCK_CONFIGS:
+      content = '%s %d %d\n' % (key, q_split_size, kv_split_size)
+      with open(db_path, 'w') as f:
+        f.write(content)
+      self._run(db_path)
+      self.assertEqual(self._read(db_path), content)
+
+  def testMalformedFileIgnored(self):
+    key = self._tunedKey()
+    db_path = self._db_path('malformed.txt')
+    malformed = '\n'.join([
+        'garbage',
+        '%s 64' % key,
+        '%s 64 512 1' % key,
+        '%s a b' % key,
+        # Not an instantiated block config.
+        '%s 48 96' % key,
+        '',
+    ])
+    with open(db_path, 'w') as f:
+      f.write(malformed)
+
+    # None of the lines is loaded, so the kernel is tuned again and appends
+    # a valid entry.
+    self._run(db_path)
+    content = self._read(db_path)
+    self.assertTrue(content.startswith(malformed))
+    lines = content[len(malformed):].splitlines()
+    self.assertEqual(len(lines), 1)
+    self.assertEqual(self._assertEntry(lines[0]), key)
+
+
+if __name__ == '__main__':
+  test.main()
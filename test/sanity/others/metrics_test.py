@@ -0,0 +1,131 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the runtime metrics and their Prometheus exporter."""
+
+import os
+import re
+import socket
+import tempfile
+import time
+import urllib.request
+
+
+def _free_port():
+  with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as s:
+    s.bind(('127.0.0.1', 0))
+    return s.getsockname()[1]
+
+
+# The exporter is configured when ITEX is loaded.
+_METRICS_FILE = os.path.join(tempfile.mkdtemp(), 'itex_metrics.prom')
+_METRICS_PORT = _free_port()
+os.environ['ITEX_METRICS_FILE'] = _METRICS_FILE
+os.environ['ITEX_METRICS_PORT'] = str(_METRICS_PORT)
+os.environ['ITEX_METRICS_INTERVAL_SECS'] = '1'
+os.environ['ITEX_CACHE_ONEDNN_OBJECT'] = '1'
+
+import numpy as np
+
+import tensorflow as tf
+
+from intel_extension_for_tensorflow.python.test_func import test
+
+_SAMPLE = re.compile(r'^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{[^}]*\})? (-?\d+)$')
+_LABEL = re.compile(r'([a-zA-Z_][a-zA-Z0-9_]*)="((?:[^"\\]|\\.)*)"')
+
+
+def _parse(text):
+  """Returns {(name, labels): value}, checking the exposition format."""
+  samples = {}
+  types = {}
+  for line in text.splitlines():
+    if line.startswith('# TYPE '):
+      _, _, name, kind = line.split(' ')
+      types[name] = kind
+      continue
+    if line.startswith('# HELP '):
+      continue
+    match = _SAMPLE.match(line)
+    assert match is not None, 'Malformed sample: %r' % line
+    name = match.group(1)
+    assert name in types, 'Sample without TYPE: %r' % line
+    labels = tuple(_LABEL.findall(match.group(2) or ''))
+    samples[(name, labels)] = int(match.group(3))
+  return samples, types
+
+
+class MetricsTest(test.TestCase):
+
+  @classmethod
+  def setUpClass(cls):
+    super(MetricsTest, cls).setUpClass()
+    x = tf.constant(np.random.rand(16, 32).astype(np.float32))
+    y = tf.constant(np.random.rand(32, 8).astype(np.float32))
+
+    @tf.function
+    def matmul(a, b):
+      return tf.matmul(a, b)
+
+    with tf.device('/cpu:0'):
+      for _ in range(3):
+        matmul(x, y).numpy()
+
+  def _read_file(self):
+    # The file is rewritten every second, wait for the runs above.
+    deadline = time.time() + 30
+    while True:
+      if os.path.exists(_METRICS_FILE):
+        with open(_METRICS_FILE) as f:
+          text = f.read()
+        if 'itex_onednn_primitive_cache_lookups' in text:
+          return text
+      self.assertLess(time.time(), deadline, 'Metrics file not written')
+      time.sleep(0.5)
+
+  def testCounters(self):
+    samples, types = _parse(self._read_file())
+    self.assertEqual(types['itex_kernel_executions'], 'counter')
+    self.assertEqual(types['itex_onednn_primitive_cache_lookups'], 'counter')
+    self.assertEqual(types['itex_onednn_weight_cache_bytes'], 'gauge')
+
+    lookups = {}
+    for (name, labels), value in samples.items():
+      if name == 'itex_onednn_primitive_cache_lookups':
+        labels = dict(labels)
+        self.assertIn(labels['result'], ('hit', 'miss'))
+        lookups[labels['result']] = lookups.get(labels['result'], 0) + value
+    # The first run creates the primitive, the later ones reuse it.
+    self.assertGreaterEqual(lookups.get('miss', 0), 1)
+    self.assertGreaterEqual(lookups.get('hit', 0), 2)
+
+    executions = sum(value for (name, _), value in samples.items()
+                     if name == 'itex_kernel_executions')
+    self.assertGreaterEqual(executions, 3)
+
+  def testHttp(self):
+    self._read_file()
+    # A client that never sends its request must not block the others.
+    with socket.create_connection(('127.0.0.1', _METRICS_PORT)):
+      response = urllib.request.urlopen(
+          'http://127.0.0.1:%d/metrics' % _METRICS_PORT, timeout=30)
+      self.assertEqual(response.status, 200)
+      self.assertIn('text/plain', response.headers['Content-Type'])
+      samples, _ = _parse(response.read().decode('utf-8'))
+    self.assertTrue(any(name == 'itex_onednn_primitive_cache_lookups'
+                        for name, _ in samples))
+
+
+if __name__ == '__main__':
+  test.main()
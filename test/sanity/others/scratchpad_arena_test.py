@@ -0,0 +1,120 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the per-thread scratchpad arenas of oneDNN kernels on CPU."""
+
+import os
+import re
+import tempfile
+import threading
+import time
+
+# The arena bytes are only tracked when metrics are exported, which is
+# configured when ITEX is loaded.
+_METRICS_FILE = os.path.join(tempfile.mkdtemp(), 'itex_metrics.prom')
+_IDLE_SECS = 3
+os.environ['ITEX_METRICS_FILE'] = _METRICS_FILE
+os.environ['ITEX_METRICS_INTERVAL_SECS'] = '1'
+os.environ['ITEX_SCRATCHPAD_IDLE_SECS'] = str(_IDLE_SECS)
+
+import numpy as np
+
+import tensorflow as tf
+
+from intel_extension_for_tensorflow.python.test_func import test
+
+_SCRATCHPAD = re.compile(r'^itex_scratchpad_bytes\{kind="(\w+)"\} (\d+)$',
+                         re.MULTILINE)
+
+
+def _step(x, w, v):
+  # Kernels which borrow their scratchpads from the arena.
+  y = tf.nn.conv2d(x, w, strides=1, padding='SAME')
+  return tf.matmul(tf.reshape(y, [-1, 64]), v)
+
+
+class ScratchpadArenaTest(test.TestCase):
+
+  def _inputs(self, seed):
+    rng = np.random.RandomState(seed)
+    x = rng.uniform(-1, 1, size=(4, 28, 28, 32)).astype(np.float32)
+    w = rng.uniform(-1, 1, size=(3, 3, 32, 64)).astype(np.float32)
+    v = rng.uniform(-1, 1, size=(64, 128)).astype(np.float32)
+    return tf.constant(x), tf.constant(w), tf.constant(v)
+
+  def _read_bytes(self):
+    """Returns {kind: bytes} exported after this call."""
+    start = time.time()
+    deadline = start + 30
+    while True:
+      if (os.path.exists(_METRICS_FILE) and
+          os.path.getmtime(_METRICS_FILE) > start + 0.1):
+        with open(_METRICS_FILE) as f:
+          samples = dict(_SCRATCHPAD.findall(f.read()))
+        if samples:
+          return {kind: int(value) for kind, value in samples.items()}
+      self.assertLess(time.time(), deadline, 'Metrics file not written')
+      time.sleep(0.2)
+
+  def testReuseAndRelease(self):
+    inputs = self._inputs(0)
+    with tf.device('/cpu:0'):
+      for _ in range(3):
+        _step(*inputs).numpy()
+      warm = self._read_bytes()
+      if warm['reserved'] == 0:
+        self.skipTest('No kernel needed a scratchpad on this machine')
+      self.assertGreater(warm['high_water_mark'], 0)
+
+      # A steady workload reuses the memory reserved by its first steps.
+      for _ in range(20):
+        _step(*inputs).numpy()
+      steady = self._read_bytes()
+    self.assertEqual(steady['reserved'], warm['reserved'])
+    self.assertEqual(steady['high_water_mark'], warm['high_water_mark'])
+
+    # Arenas unused for ITEX_SCRATCHPAD_IDLE_SECS give their memory back.
+    time.sleep(2 * _IDLE_SECS)
+    self.assertEqual(self._read_bytes()['reserved'], 0)
+
+  def testThreadIsolation(self):
+    num_threads = 4
+    inputs = [self._inputs(seed) for seed in range(num_threads)]
+    with tf.device('/cpu:0'):
+      expected = [_step(*args).numpy() for args in inputs]
+
+    # Each thread borrows from its own arena, so kernels running at once must
+    # not overwrite the scratchpads of the others.
+    errors = []
+
+    def run(index):
+      try:
+        with tf.device('/cpu:0'):
+          for _ in range(20):
+            np.testing.assert_allclose(_step(*inputs[index]).numpy(),
+                                       expected[index], rtol=1e-5, atol=1e-5)
+      except Exception as e:  # pylint: disable=broad-except
+        errors.append(e)
+
+    threads = [threading.Thread(target=run, args=(i,))
+               for i in range(num_threads)]
+    for thread in threads:
+      thread.start()
+    for thread in threads:
+      thread.join()
+    self.assertEqual(errors, [])
+
+
+if __name__ == '__main__':
+  test.main()
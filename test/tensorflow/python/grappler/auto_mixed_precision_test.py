@@ -564,6 +564,33 @@ class AutoMixedPrecisionTest(test.TestCase, parameterized.TestCase):
     tol = 5e-3 if mode == 'bfloat16' else 1e-3
     self.assertAllClose(output_val_ref, output_val, atol=tol, rtol=tol)
 
+  @parameterized.parameters(['bfloat16'])
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def test_min_cut_pool_matmul(self, mode):
+    """Test the cast is moved after pooling, where the tensor is smaller."""
+    self._maybe_skip(mode)
+    os.environ['ITEX_AUTO_MIXED_PRECISION_MIN_CUT'] = '1'
+    try:
+      with ops.device(_get_device()):
+        random_seed.set_random_seed(0)
+        x = _input([2, 16, 16, 4])
+        x = _max_pool_2x2(x)
+        x = array_ops.reshape(x, [2, 256])
+        output = math_ops.matmul(x, _weight([256, 8]))
+
+      output_val_ref, output_val, cost_graph = self._run(mode, output)
+    finally:
+      del os.environ['ITEX_AUTO_MIXED_PRECISION_MIN_CUT']
+    node_map = _build_node_map(cost_graph.node)
+
+    self.assertEqual(node_map['MaxPool'].output_info[0].dtype,
+                     types_pb2.DT_FLOAT)
+    self._assert_output_f16(mode, node_map, 'Reshape')
+    self._assert_output_f16(mode, node_map, 'MatMul')
+    tol = 1e-2
+    self.assertAllClose(output_val_ref, output_val, atol=tol, rtol=tol)
+
   @parameterized.parameters(['bfloat16'])
   @test_util.run_v1_only('b/138749235')
   @test_util.disable_xla('This test does not pass with XLA')
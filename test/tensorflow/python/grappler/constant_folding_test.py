@@ -0,0 +1,182 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import os
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+
+os.environ['ITEX_CONSTANT_FOLDING'] = '1'
+# Only the folding of ITEX is tested.
+os.environ['ITEX_TF_CONSTANT_FOLDING'] = '0'
+
+_AFFINE_OPS = ('FusedBatchNorm', 'FusedBatchNormV2', 'FusedBatchNormV3', 'Mul',
+               'Add', 'AddV2')
+
+
+def _uniform(*shape):
+  return np.random.uniform(-1, 1, size=shape).astype(np.float32)
+
+
+class ConstantFoldingTest(test_lib.TestCase):
+
+  def _run(self, build, x_np, params, fold):
+    """Runs `build` with `params` as constants if `fold`, else as inputs."""
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with tf.Graph().as_default():
+      with tf.device('/cpu:0'):
+        x = tf.placeholder(tf.as_dtype(x_np.dtype), shape=x_np.shape)
+        feed_dict = {x: x_np}
+        tensors = {}
+        for name, value in params.items():
+          if fold:
+            tensors[name] = tf.constant(value)
+          else:
+            # Placeholders aren't constants, so nothing is folded.
+            tensors[name] = tf.placeholder(tf.as_dtype(value.dtype),
+                                           shape=value.shape)
+            feed_dict[tensors[name]] = value
+        y = tf.identity(build(x, tensors))
+      with self.session(use_gpu=False) as sess:
+        output = sess.run(y, options=run_options, run_metadata=metadata,
+                          feed_dict=feed_dict)
+    return output, metadata.partition_graphs[0]
+
+  def _assertAffineFolded(self, graph):
+    for node in graph.node:
+      self.assertNotIn(node.op, _AFFINE_OPS, node.name)
+      if 'fused_ops' in node.attr:
+        for fused_op in node.attr['fused_ops'].list.s:
+          self.assertNotIn(fused_op.decode(), _AFFINE_OPS, node.name)
+
+  def _testFoldAffine(self, build, x_np, params):
+    expected, _ = self._run(build, x_np, params, fold=False)
+    output, graph = self._run(build, x_np, params, fold=True)
+    self._assertAffineFolded(graph)
+    self.assertAllClose(output, expected, rtol=1e-4, atol=1e-4)
+
+  def testConv2DWithBatchNorm(self):
+    channels = 8
+    params = {
+        'w': _uniform(3, 3, 4, channels),
+        'scale': _uniform(channels),
+        'offset': _uniform(channels),
+        'mean': _uniform(channels),
+        'variance': np.random.uniform(0.5, 1.5, channels).astype(np.float32),
+    }
+
+    def build(x, p):
+      y = tf.nn.conv2d(x, p['w'], strides=1, padding='SAME')
+      return tf.nn.fused_batch_norm(y, p['scale'], p['offset'], p['mean'],
+                                    p['variance'], is_training=False)[0]
+
+    self._testFoldAffine(build, _uniform(2, 8, 8, 4), params)
+
+  def testDepthwiseConv2DWithMul(self):
+    params = {
+        'w': _uniform(3, 3, 4, 2),
+        'scale': _uniform(8),
+    }
+
+    def build(x, p):
+      y = tf.nn.depthwise_conv2d(x, p['w'], strides=[1, 1, 1, 1],
+                                 padding='SAME')
+      return y * p['scale']
+
+    self._testFoldAffine(build, _uniform(2, 8, 8, 4), params)
+
+  def testMatMulWithBiasAddAndAdd(self):
+    params = {
+        'w': _uniform(16, 8),
+        'bias': _uniform(8),
+        'offset': _uniform(1, 8),
+    }
+
+    def build(x, p):
+      y = tf.nn.bias_add(tf.matmul(x, p['w']), p['bias'])
+      return y + p['offset']
+
+    self._testFoldAffine(build, _uniform(4, 16), params)
+
+  def testMulOfHigherRankNotFolded(self):
+    params = {
+        'w': _uniform(3, 3, 4, 8),
+        'scale': _uniform(1, 1, 1, 1, 8),
+    }
+
+    def build(x, p):
+      y = tf.nn.conv2d(x, p['w'], strides=1, padding='SAME')
+      # Broadcasts the output to rank 5, so it can't go into the weights.
+      return y * p['scale']
+
+    x_np = _uniform(2, 8, 8, 4)
+    expected, _ = self._run(build, x_np, params, fold=False)
+    output, _ = self._run(build, x_np, params, fold=True)
+    self.assertEqual(output.shape, (1, 2, 8, 8, 8))
+    self.assertAllClose(output, expected, rtol=1e-4, atol=1e-4)
+
+  def testIntegerOverflowWrapsAround(self):
+    for dtype in (np.int32, np.int64):
+      big = np.array(np.iinfo(dtype).max // 2 + 1, dtype=dtype)
+      params = {'a': big, 'b': np.array(4, dtype=dtype),
+                'c': np.array(-1, dtype=dtype)}
+
+      def build(x, p):
+        # Folded into a constant, since a, b and c are all constants.
+        folded = tf.identity(p['a'] * p['b'] + p['c'], name='folded')
+        return x + folded
+
+      x_np = np.arange(4, dtype=dtype)
+      expected, _ = self._run(build, x_np, params, fold=False)
+      output, graph = self._run(build, x_np, params, fold=True)
+      ops = {node.name: node.op for node in graph.node}
+      if 'folded' in ops:
+        self.assertEqual(ops['folded'], 'Const')
+      with np.errstate(over='ignore'):
+        wrapped = x_np + (big * dtype(4) + dtype(-1))
+      self.assertAllEqual(expected, wrapped)
+      self.assertAllEqual(output, wrapped)
+
+  def testStringNotFolded(self):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with tf.Graph().as_default():
+      with tf.device('/cpu:0'):
+        strings = tf.constant([b'ab', b'cd', b'ef'])
+        # Strings are not plain bytes, so these are left to the kernels.
+        y = tf.identity(strings, name='string_identity')
+        y = tf.reshape(y, [3, 1], name='string_reshape')
+        y = tf.identity(y)
+      with self.session(use_gpu=False) as sess:
+        output = sess.run(y, options=run_options, run_metadata=metadata)
+
+    ops = {node.name: node.op for node in metadata.partition_graphs[0].node}
+    # TF may still remove the Identity, but it must not become a Const.
+    self.assertNotEqual(ops.get('string_identity'), 'Const')
+    self.assertEqual(ops.get('string_reshape'), 'Reshape')
+    self.assertAllEqual(output, [[b'ab'], [b'cd'], [b'ef']])
+
+
+if __name__ == '__main__':
+  test_lib.main()
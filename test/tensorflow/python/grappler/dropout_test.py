@@ -62,6 +62,42 @@ class DropoutTest(test_lib.TestCase):
       if test_util.is_gpu_available() or dtype != tf.half:
         self.assertTrue(existing_pattern)
 
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def testPackedMaskOnCpu(self):
+    if test_util.is_gpu_available():
+      self.skipTest("Bit-packed dropout mask is only generated on CPU.")
+
+    shape = (4, 8, 33, 17)
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    in_array = np.random.uniform(1.0, 2.0, size=shape).astype(np.float32)
+    in_x = tf.placeholder(tf.float32, shape=shape)
+
+    for dtype in [tf.float32, tf.half, tf.bfloat16]:
+      in_x_d = tf.cast(in_x, dtype=dtype)
+      y = tf.nn.dropout(in_x_d, rate=0.3, seed=1)
+      out = tf.identity(y)
+      grad = tf.gradients(out, in_x_d, grad_ys=tf.ones_like(out))[0]
+
+      with self.session(use_gpu=False) as sess:
+        out_val, grad_val = sess.run(
+            [tf.cast(out, tf.float32), tf.cast(grad, tf.float32)],
+            options=run_options, run_metadata=metadata,
+            feed_dict={in_x: in_array})
+        graph = metadata.partition_graphs[0]
+
+      found_ops = set(node.op for node in graph.node)
+      self.assertIn('_ITEXFusedRandomBitMask', found_ops)
+      self.assertIn('_ITEXPackedDropout', found_ops)
+
+      # Forward and backward must see the same mask, and the kept ratio
+      # follows the dropout rate.
+      kept = out_val != 0
+      self.assertAllEqual(kept, grad_val != 0)
+      self.assertNear(np.mean(kept), 0.7, 0.05)
+
 
 if __name__ == "__main__":
   test_lib.main()
@@ -27,6 +27,9 @@ from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
 from tensorflow.core.protobuf import config_pb2
 
+# Binary chains are fused into _ITEXFusedElementwise on CPU.
+FUSED_BINARY_OPS = ('_ITEXFusedBinary', '_ITEXFusedElementwise')
+
 
 class FusedBinaryTest(test_lib.TestCase):
 
@@ -57,7 +60,7 @@ class FusedBinaryTest(test_lib.TestCase):
 
       existing_pattern = False
       for node in graph.node:
-        if 'ITEXFusedBinary' in node.op:
+        if node.op in FUSED_BINARY_OPS:
           existing_pattern = True
           break
       self.assertTrue(existing_pattern)
@@ -102,7 +105,7 @@ class FusedBinaryTest(test_lib.TestCase):
 
       existing_pattern = False
       for node in graph.node:
-        if 'ITEXFusedBinary' in node.op:
+        if node.op in FUSED_BINARY_OPS:
           existing_pattern = True
           break
       self.assertTrue(existing_pattern)
@@ -156,13 +159,56 @@ class FusedBinaryTest(test_lib.TestCase):
         existing_pattern = False
         if os.getenv('ITEX_REMAPPER') == '1':
           for node in graph.node:
-            if 'ITEXFusedBinary' in node.op:
+            if node.op in FUSED_BINARY_OPS:
               existing_pattern = True
               break
           self.assertTrue(existing_pattern)
 
         self.assertTrue(output_val.shape == shape)
 
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def testElementwiseDagOnCpu(self):
+    if test_util.is_gpu_available():
+      self.skipTest("Elementwise clusters are only fused on CPU.")
+
+    shape = (8, 33, 64)
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    x_array = np.random.uniform(-1.0, 1.0, size=shape).astype(np.float32)
+    # Keep away from the threshold so that bfloat16 rounding can't flip it.
+    x_array[np.abs(x_array - 0.25) < 0.05] = 0.0
+    b_array = np.random.uniform(-1.0, 1.0, size=shape[-1:]).astype(np.float32)
+    in_x = tf.placeholder(tf.float32, shape=shape)
+    in_b = tf.placeholder(tf.float32, shape=shape[-1:])
+
+    for dtype in [tf.float32, tf.bfloat16]:
+      x = tf.cast(in_x, dtype=dtype)
+      b = tf.cast(in_b, dtype=dtype)
+      # Broadcast bias, scalar, activations and a comparison in one DAG.
+      z = tf.nn.relu(x * 2.0 + b)
+      mask = tf.cast(tf.greater(x, 0.25), dtype=dtype)
+      y = tf.tanh(z) * mask + tf.sigmoid(x)
+      y = array_ops.identity(y)
+
+      with self.session(use_gpu=False) as sess:
+        output_val = sess.run(tf.cast(y, tf.float32), options=run_options,
+                              run_metadata=metadata,
+                              feed_dict={in_x: x_array, in_b: b_array})
+        graph = metadata.partition_graphs[0]
+
+      fused = [node for node in graph.node
+               if node.op == '_ITEXFusedElementwise']
+      self.assertEqual(len(fused), 1)
+      self.assertIn(b'_ITEXGreaterWithCast', fused[0].attr['fused_ops'].list.s)
+
+      z_ref = np.maximum(x_array * 2.0 + b_array, 0)
+      y_ref = (np.tanh(z_ref) * (x_array > 0.25) +
+               1 / (1 + np.exp(-x_array)))
+      y_atol = 1e-5 if dtype is tf.float32 else 5e-2
+      self.assertAllClose(output_val, y_ref, atol=y_atol)
+
 
 if __name__ == "__main__":
   test_lib.main()
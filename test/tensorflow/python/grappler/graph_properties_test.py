@@ -0,0 +1,75 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import os
+import re
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.framework import attr_value_pb2
+from tensorflow.python.framework import op_def_registry
+
+_GRAPH_PROPERTIES_CC = os.path.join(
+    os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', '..',
+    'itex', 'core', 'graph', 'utils', 'graph_properties.cc')
+
+
+def _unchanged_shape_ops():
+  """Returns the ops listed in UnchangedShapeOps() of graph_properties.cc."""
+  with open(_GRAPH_PROPERTIES_CC) as f:
+    source = f.read()
+  body = re.search(r'UnchangedShapeOps\(\) \{(.*?)return ops;', source,
+                   re.DOTALL)
+  return re.findall(r'"(\w+)"', body.group(1))
+
+
+class GraphPropertiesTest(test_lib.TestCase):
+
+  def testUnchangedShapeOpsKeepInputShape(self):
+    # GraphProperties::Refresh() gives these ops the properties of their first
+    # input, which is only right if their registered shape function does too.
+    if not os.path.exists(_GRAPH_PROPERTIES_CC):
+      self.skipTest('ITEX sources are not available')
+    op_types = _unchanged_shape_ops()
+    self.assertNotEmpty(op_types)
+
+    for op_type in op_types:
+      op_def = op_def_registry.get(op_type)
+      self.assertIsNotNone(op_def, op_type)
+      with tf.Graph().as_default() as graph:
+        inputs, attrs = [], {}
+        for arg in op_def.input_arg:
+          if arg.type_attr:
+            attrs[arg.type_attr] = attr_value_pb2.AttrValue(
+                type=tf.float32.as_datatype_enum)
+            dtype = tf.float32
+          else:
+            dtype = tf.as_dtype(arg.type)
+          # Only input 0 has a known shape, so that is where the output shape
+          # has to come from.
+          shape = None if inputs else (2, 3, 5)
+          inputs.append(tf.placeholder(dtype, shape=shape))
+        op = graph.create_op(op_type, inputs, attrs=attrs)
+        self.assertEqual(op.outputs[0].shape.as_list(), [2, 3, 5], op_type)
+        self.assertEqual(op.outputs[0].dtype, inputs[0].dtype, op_type)
+
+
+if __name__ == '__main__':
+  test_lib.main()
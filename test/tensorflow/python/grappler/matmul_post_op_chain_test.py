@@ -0,0 +1,102 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+
+
+class MatMulPostOpChainTest(test_lib.TestCase):
+
+  def testMatMulWithBroadcastBinaryChain(self):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    m, k, n = 8, 16, 32
+    x_np = np.random.uniform(-1, 1, size=(m, k)).astype(np.float32)
+    w_np = np.random.uniform(-1, 1, size=(k, n)).astype(np.float32)
+    b_np = np.random.uniform(-1, 1, size=(n,)).astype(np.float32)
+    s_np = np.random.uniform(-1, 1, size=(n,)).astype(np.float32)
+
+    x = tf.placeholder(tf.float32, shape=(m, k))
+    y = tf.matmul(x, tf.constant(w_np))
+    y = tf.nn.bias_add(y, tf.constant(b_np))
+    y = tf.math.subtract(y, tf.constant(s_np))
+    y = tf.math.realdiv(y, tf.constant(2.0))
+    y = tf.math.maximum(y, tf.constant(-1.0))
+    # tf.clip_by_value is lowered to Minimum and Maximum.
+    y = tf.raw_ops.ClipByValue(t=y, clip_value_min=tf.constant(-0.5),
+                               clip_value_max=tf.constant(0.5))
+    y = tf.math.multiply(y, tf.constant(s_np))
+    y = tf.identity(y)
+
+    with self.session(use_gpu=True) as sess:
+      output_val = sess.run(y, options=run_options, run_metadata=metadata,
+                            feed_dict={x: x_np})
+      graph = metadata.partition_graphs[0]
+
+    fused_ops = []
+    for node in graph.node:
+      if node.op == '_ITEXFusedMatMul':
+        fused_ops = [op.decode() for op in node.attr['fused_ops'].list.s]
+        break
+    self.assertEqual(fused_ops, ['BiasAdd', 'BinarySub', 'BinaryDiv',
+                                 'BinaryMax', 'Clip', 'BinaryMul'])
+
+    expected = (np.matmul(x_np, w_np) + b_np - s_np) / 2.0
+    expected = np.clip(np.maximum(expected, -1.0), -0.5, 0.5) * s_np
+    self.assertAllClose(output_val, expected, rtol=1e-5, atol=1e-5)
+
+  def testMatMulWithoutChainFusesCast(self):
+    # Only a non-empty post op chain blocks the fusion of a following Cast.
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    m, k, n = 8, 16, 32
+    x_np = np.random.uniform(-1, 1, size=(m, k)).astype(np.float32)
+    w_np = np.random.uniform(-1, 1, size=(k, n)).astype(np.float32)
+    b_np = np.random.uniform(-1, 1, size=(n,)).astype(np.float32)
+
+    x = tf.placeholder(tf.float32, shape=(m, k))
+    y = tf.matmul(tf.cast(x, tf.bfloat16),
+                  tf.cast(tf.constant(w_np), tf.bfloat16))
+    y = tf.nn.bias_add(y, tf.cast(tf.constant(b_np), tf.bfloat16))
+    y = tf.cast(y, tf.float32)
+    y = tf.identity(y)
+
+    with self.session(use_gpu=True) as sess:
+      output_val = sess.run(y, options=run_options, run_metadata=metadata,
+                            feed_dict={x: x_np})
+      graph = metadata.partition_graphs[0]
+
+    ops = [node.op for node in graph.node]
+    self.assertIn('_ITEXFusedAccMatMul', ops)
+    for node in graph.node:
+      if node.op == '_ITEXFusedAccMatMul':
+        self.assertEmpty(node.attr['post_op_alphas'].list.f)
+
+    expected = np.matmul(x_np, w_np) + b_np
+    self.assertAllClose(output_val, expected, rtol=5e-2, atol=5e-2)
+
+
+if __name__ == '__main__':
+  test_lib.main()
@@ -0,0 +1,135 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import os
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+
+os.environ['ITEX_LAYOUT_OPT'] = '1'
+# Keep Conv2D and Relu apart, so that the rewrite rules see the plain ops.
+os.environ['ITEX_REMAPPER'] = '0'
+
+
+class OneDnnLayoutCostModelTest(test_lib.TestCase):
+
+  def _uniform(self, *shape):
+    return np.random.uniform(-1, 1, size=shape).astype(np.float32)
+
+  def _run(self, build, feeds, cost_model=True):
+    """Returns the output and the optimized graph of `build(*placeholders)`.
+
+    `feeds` are (placeholder shape, value) pairs.
+    """
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    old_value = os.environ.get('ITEX_ONEDNN_LAYOUT_COST_MODEL')
+    os.environ['ITEX_ONEDNN_LAYOUT_COST_MODEL'] = '1' if cost_model else '0'
+    try:
+      with tf.Graph().as_default() as graph:
+        with tf.device('/cpu:0'):
+          inputs = [tf.placeholder(tf.float32, shape=shape)
+                    for shape, _ in feeds]
+          y = tf.identity(build(*inputs))
+        with self.session(graph=graph, use_gpu=False) as sess:
+          output_val = sess.run(
+              y, options=run_options, run_metadata=metadata,
+              feed_dict={x: value for x, (_, value) in zip(inputs, feeds)})
+    finally:
+      if old_value is None:
+        del os.environ['ITEX_ONEDNN_LAYOUT_COST_MODEL']
+      else:
+        os.environ['ITEX_ONEDNN_LAYOUT_COST_MODEL'] = old_value
+    return output_val, metadata.partition_graphs[0]
+
+  def _ops(self, graph):
+    return [node.op for node in graph.node]
+
+  def _conv_relu(self, x):
+    w = tf.constant(self._uniform(3, 3, 8, 8))
+    return tf.nn.relu(tf.nn.conv2d(x, w, strides=1, padding='SAME'))
+
+  def testIsolatedConvStaysPlain(self):
+    # The conversion back to plain costs as much as the blocked result saves.
+    feeds = [((2, 16, 16, 8), self._uniform(2, 16, 16, 8))]
+    output_val, graph = self._run(self._conv_relu, feeds)
+    ops = self._ops(graph)
+    self.assertNotIn('_OneDnnConv2D', ops)
+    self.assertNotIn('_OneDnnToTf', ops)
+
+    # Without the cost model the old rewrite is back.
+    expected, graph = self._run(self._conv_relu, feeds, cost_model=False)
+    ops = self._ops(graph)
+    self.assertIn('_OneDnnConv2D', ops)
+    self.assertIn('_OneDnnToTf', ops)
+    self.assertAllClose(output_val, expected, rtol=1e-5, atol=1e-5)
+
+  def testConvPoolConvChain(self):
+    def build(x):
+      w1 = tf.constant(self._uniform(3, 3, 16, 16))
+      w2 = tf.constant(self._uniform(3, 3, 16, 16))
+      y = tf.nn.conv2d(x, w1, strides=1, padding='SAME')
+      y = tf.nn.max_pool2d(y, ksize=2, strides=2, padding='VALID')
+      y = tf.nn.conv2d(y, w2, strides=1, padding='SAME')
+      return tf.nn.relu(y)
+
+    feeds = [((2, 32, 32, 16), self._uniform(2, 32, 32, 16))]
+    output_val, graph = self._run(build, feeds)
+    ops = self._ops(graph)
+    self.assertEqual(ops.count('_OneDnnConv2D'), 2)
+    self.assertIn('_OneDnnMaxPool', ops)
+    # Blocked tensors only go back to plain at the boundary of the island.
+    self.assertEqual(ops.count('_OneDnnToTf'), 1)
+    ops_by_name = {node.name: node.op for node in graph.node}
+    for node in graph.node:
+      if node.op == '_OneDnnToTf':
+        producer = node.input[0].split(':')[0]
+        self.assertEqual(ops_by_name[producer], '_OneDnnRelu')
+
+    expected, _ = self._run(build, feeds, cost_model=False)
+    self.assertAllClose(output_val, expected, rtol=1e-5, atol=1e-5)
+
+  def testUnknownSizeIslandKept(self):
+    feeds = [((None, 16, 16, 8), self._uniform(2, 16, 16, 8))]
+    _, graph = self._run(self._conv_relu, feeds)
+    self.assertIn('_OneDnnConv2D', self._ops(graph))
+
+  def testAlwaysRewriteIslandKept(self):
+    # Tiny tensors would not pay for the conversion, but AvgPoolGrad is
+    # always rewritten and takes its island along.
+    def build(x):
+      w = tf.constant(self._uniform(3, 3, 4, 4))
+      y = tf.nn.conv2d(x, w, strides=1, padding='SAME')
+      return tf.raw_ops.AvgPoolGrad(
+          orig_input_shape=tf.constant([1, 8, 8, 4]), grad=y,
+          ksize=[1, 2, 2, 1], strides=[1, 2, 2, 1], padding='VALID')
+
+    feeds = [((1, 4, 4, 4), self._uniform(1, 4, 4, 4))]
+    _, graph = self._run(build, feeds)
+    ops = self._ops(graph)
+    self.assertIn('_OneDnnAvgPoolGrad', ops)
+    self.assertIn('_OneDnnConv2D', ops)
+
+
+if __name__ == '__main__':
+  test_lib.main()
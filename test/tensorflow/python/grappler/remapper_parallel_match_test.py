@@ -0,0 +1,119 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests the parallel pattern matching of the remapper on large graphs."""
+
+import os
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+
+# Fusions and Find* matchers skipped by the match cache are checked against
+# the serial matcher, and the pass fails on any difference.
+os.environ['ITEX_REMAPPER_VERIFY_MATCH_CACHE'] = '1'
+
+# Each block adds about 5 nodes, so the graph is above the 4096 nodes from
+# which the remapper matches in parallel.
+_NUM_BLOCKS = 1000
+_HIDDEN = 16
+
+
+class RemapperParallelMatchTest(test_lib.TestCase):
+
+  def _run(self, build, parallel_match, x_np):
+    """Returns the output and the nodes of the optimized `build(x)`."""
+    os.environ['ITEX_REMAPPER_PARALLEL_MATCH'] = '1' if parallel_match else '0'
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    with tf.Graph().as_default() as graph:
+      with tf.device('/cpu:0'):
+        x = tf.placeholder(tf.float32, shape=x_np.shape)
+        y = tf.identity(build(x))
+
+      with self.session(graph=graph, use_gpu=False) as sess:
+        output = sess.run(y, options=run_options, run_metadata=metadata,
+                          feed_dict={x: x_np})
+
+    nodes = set()
+    for partition_graph in metadata.partition_graphs:
+      for node in partition_graph.node:
+        nodes.add((node.name, node.op, tuple(node.input)))
+    return output, nodes
+
+  def _testSameGraphAsSerialMatch(self, build, x_np):
+    serial_output, serial_nodes = self._run(build, False, x_np)
+    parallel_output, parallel_nodes = self._run(build, True, x_np)
+
+    self.assertGreater(len(serial_nodes), 0)
+    self.assertTrue(any('Fused' in op for _, op, _ in serial_nodes))
+    self.assertSetEqual(serial_nodes, parallel_nodes)
+    self.assertAllClose(serial_output, parallel_output)
+    return serial_nodes
+
+  def testSameGraphAsSerialMatch(self):
+    def build(x):
+      h = x
+      for i in range(_NUM_BLOCKS):
+        w = tf.constant(np.eye(_HIDDEN, dtype=np.float32))
+        b = tf.constant(np.full(_HIDDEN, 0.01, dtype=np.float32))
+        h = tf.nn.bias_add(tf.matmul(h, w), b)
+        # Mix fused and unfused activations.
+        if i % 3 == 0:
+          h = tf.nn.relu(h)
+        elif i % 3 == 1:
+          h = tf.nn.elu(h)
+      return h
+
+    x_np = np.random.uniform(-1, 1, size=(8, _HIDDEN)).astype(np.float32)
+    self._testSameGraphAsSerialMatch(build, x_np)
+
+  def testFindMatchersSameGraphAsSerialMatch(self):
+    # Patterns of the Find* matchers of the remapper loop rather than of
+    # registered fusions, mixed with MatMul blocks that are fused first and
+    # so change the graph next to them.
+    def build(x):
+      h = x
+      for i in range(_NUM_BLOCKS // 2):
+        w = tf.constant(np.eye(_HIDDEN, dtype=np.float32) * 0.5)
+        h = tf.matmul(h, w)
+        if i % 4 == 0:
+          # Gelu subgraph.
+          h = tf.nn.gelu(h, approximate=False)
+        elif i % 4 == 1:
+          # Mul+Maximum is a LeakyRelu.
+          h = tf.maximum(h, h * 0.2)
+        elif i % 4 == 2:
+          # AddN with 2 inputs is an AddV2.
+          h = tf.math.add_n([h, x])
+        else:
+          # Comparison+Cast.
+          h = h * tf.cast(tf.greater(h, 0.0), tf.float32)
+      return h
+
+    x_np = np.random.uniform(-1, 1, size=(8, _HIDDEN)).astype(np.float32)
+    nodes = self._testSameGraphAsSerialMatch(build, x_np)
+    self.assertTrue(any('Gelu' in op for _, op, _ in nodes))
+    self.assertFalse(any(op == 'Erf' for _, op, _ in nodes))
+
+
+if __name__ == '__main__':
+  test_lib.main()
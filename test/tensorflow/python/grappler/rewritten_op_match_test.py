@@ -0,0 +1,66 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests that fusions match ops created by earlier rewrites of remapper."""
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+
+
+class RewrittenOpMatchTest(test_lib.TestCase):
+
+  def testMatchFusedMatMulFromEarlierRewrite(self):
+    # MatMul + BiasAdd is first rewritten to _ITEXFusedMatMul. The pattern
+    # fusing it with the Casts around only matches if the node view of the
+    # rewritten node reports the new op type id.
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    m, k, n = 8, 16, 32
+    x_np = np.random.uniform(-1, 1, size=(m, k)).astype(np.float32)
+    w_np = np.random.uniform(-1, 1, size=(k, n)).astype(np.float32)
+    b_np = np.random.uniform(-1, 1, size=(n,)).astype(np.float32)
+
+    with tf.device('/cpu:0'):
+      # Placeholders keep the Casts out of constant folding.
+      x = tf.placeholder(tf.float32, shape=(m, k))
+      w = tf.placeholder(tf.float32, shape=(k, n))
+      b = tf.placeholder(tf.float32, shape=(n,))
+      y = tf.matmul(tf.cast(x, tf.bfloat16), tf.cast(w, tf.bfloat16))
+      y = tf.nn.bias_add(y, tf.cast(b, tf.bfloat16))
+      y = tf.identity(tf.cast(y, tf.float32))
+
+    with self.session(use_gpu=False) as sess:
+      output_val = sess.run(y, options=run_options, run_metadata=metadata,
+                            feed_dict={x: x_np, w: w_np, b: b_np})
+      graph = metadata.partition_graphs[0]
+
+    ops = [node.op for node in graph.node]
+    self.assertIn('_ITEXFusedAccMatMul', ops)
+    self.assertNotIn('_ITEXFusedMatMul', ops)
+    self.assertNotIn('Cast', ops)
+
+    expected = np.matmul(x_np, w_np) + b_np
+    self.assertAllClose(output_val, expected, rtol=5e-2, atol=5e-2)
+
+
+if __name__ == '__main__':
+  test_lib.main()
@@ -0,0 +1,81 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import os
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+
+os.environ['ITEX_SEGMENT_FUSION'] = '1'
+
+
+class SegmentFusionTest(test_lib.TestCase):
+
+  def testWideAndDeep(self):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    batch, dense, hidden = 4, 6, 16
+    def uniform(*shape):
+      return np.random.uniform(-1, 1, size=shape).astype(np.float32)
+    dense_np = uniform(batch, dense)
+    emb_np = uniform(batch, 8)
+    w1_np = uniform(dense + 8, hidden)
+    b1_np = uniform(hidden)
+    w2_np = uniform(hidden, 1)
+    ww_np = uniform(dense, 1)
+
+    with tf.device('/cpu:0'):
+      x = tf.placeholder(tf.float32, shape=(batch, dense))
+      emb = tf.placeholder(tf.float32, shape=(batch, 8))
+      deep = tf.concat([x, tf.reshape(emb, [batch, 8])], axis=-1)
+      deep = tf.nn.relu(tf.nn.bias_add(tf.matmul(deep, tf.constant(w1_np)),
+                                       tf.constant(b1_np)))
+      deep = tf.matmul(deep, tf.constant(w2_np))
+      wide = tf.matmul(x, tf.constant(ww_np))
+      y = tf.math.sigmoid(tf.math.add(deep, wide))
+
+    with self.session(use_gpu=False) as sess:
+      output_val = sess.run(y, options=run_options, run_metadata=metadata,
+                            feed_dict={x: dense_np, emb: emb_np})
+      graph = metadata.partition_graphs[0]
+
+    segment_ops = []
+    for node in graph.node:
+      if node.op == '_ITEXSegmentExecutor':
+        segment_ops = [op.decode() for op in node.attr['segment_ops'].list.s]
+        break
+    self.assertEqual(segment_ops[-1], 'Sigmoid')
+    self.assertIn('ConcatV2', segment_ops)
+    self.assertEqual(segment_ops.count('MatMul'), 3)
+
+    hidden_np = np.maximum(
+        np.matmul(np.concatenate([dense_np, emb_np], axis=-1), w1_np) + b1_np,
+        0)
+    logits = np.matmul(hidden_np, w2_np) + np.matmul(dense_np, ww_np)
+    expected = 1 / (1 + np.exp(-logits))
+    self.assertAllClose(output_val, expected, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == '__main__':
+  test_lib.main()
@@ -0,0 +1,210 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import os
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.core.protobuf import config_pb2
+from intel_extension_for_tensorflow.python.ops.multi_head_attention import (
+    scaled_dot_product_attention)
+
+os.environ['ITEX_SHAPE_BUCKETING'] = '1'
+os.environ['ITEX_SHAPE_BUCKETS'] = '8,16'
+
+
+class ShapeBucketingTest(test_lib.TestCase):
+
+  def testDynamicSequenceLength(self):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    batch, hidden = 2, 4
+    def uniform(*shape):
+      return np.random.uniform(-1, 1, size=shape).astype(np.float32)
+    w_np = uniform(hidden, hidden)
+    b_np = uniform(hidden)
+
+    with tf.device('/cpu:0'):
+      x = tf.placeholder(tf.float32, shape=(batch, None, hidden))
+      tokens = tf.reshape(x, [-1, hidden])
+      dense = tf.nn.bias_add(tf.matmul(tokens, tf.constant(w_np)),
+                             tf.constant(b_np))
+      dense = tf.reshape(dense, tf.shape(x))
+      scores = tf.matmul(dense, x, transpose_b=True)
+      y = tf.matmul(tf.nn.softmax(scores), x)
+
+    with self.session(use_gpu=False) as sess:
+      # Lengths below, within and above the buckets.
+      for seq_len in (3, 12, 21):
+        x_np = uniform(batch, seq_len, hidden)
+        output_val = sess.run(y, options=run_options, run_metadata=metadata,
+                              feed_dict={x: x_np})
+
+        dense_np = np.matmul(x_np, w_np) + b_np
+        scores_np = np.matmul(dense_np, np.transpose(x_np, (0, 2, 1)))
+        probs_np = np.exp(scores_np - scores_np.max(axis=-1, keepdims=True))
+        probs_np /= probs_np.sum(axis=-1, keepdims=True)
+        expected = np.matmul(probs_np, x_np)
+        self.assertAllClose(output_val, expected, rtol=1e-4, atol=1e-4)
+
+    graph = metadata.partition_graphs[0]
+    ops = [node.op for node in graph.node]
+    self.assertIn('_ITEXBucketPad', ops)
+    self.assertIn('_ITEXBucketSlice', ops)
+
+  def testBucketingAfterSplitSinking(self):
+    # Sinking the first transpose through the Split permutes the inputs of
+    # the Split and of the transposes after it, while their ops stay the
+    # same. The refreshed shapes must still show the dynamic rows of the
+    # matmuls, or they aren't bucketed.
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    hidden, units = 16, 4
+    def uniform(*shape):
+      return np.random.uniform(-1, 1, size=shape).astype(np.float32)
+    w0_np = uniform(hidden, units)
+    w1_np = uniform(hidden, units)
+
+    with tf.device('/cpu:0'):
+      x = tf.placeholder(tf.float32, shape=(None, 2 * hidden))
+      x0, x1 = tf.split(tf.transpose(x), 2, axis=0)
+      y0 = tf.matmul(tf.transpose(x0), tf.constant(w0_np))
+      y1 = tf.matmul(tf.transpose(x1), tf.constant(w1_np))
+      y = tf.identity(y0 - y1)
+
+    with self.session(use_gpu=False) as sess:
+      for rows in (3, 12, 21):
+        x_np = uniform(rows, 2 * hidden)
+        output_val = sess.run(y, options=run_options, run_metadata=metadata,
+                              feed_dict={x: x_np})
+        expected = (np.matmul(x_np[:, :hidden], w0_np) -
+                    np.matmul(x_np[:, hidden:], w1_np))
+        self.assertAllClose(output_val, expected, rtol=1e-4, atol=1e-4)
+
+    graph = metadata.partition_graphs[0]
+    ops = [node.op for node in graph.node]
+    self.assertNotIn('Transpose', ops)
+    self.assertIn('_ITEXBucketPad', ops)
+
+  def _testAttention(self, build_mask, pad_keys):
+    """Runs attention with the mask `build_mask(k, uniform)`.
+
+    `build_mask` returns the mask, and a function computing the feeds of the
+    mask and its value from the value of `k` and the query length. The keys
+    and values must be padded iff `pad_keys`.
+    """
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+
+    batch, heads, q_seq_len, head_size = 2, 2, 5, 4
+    def uniform(*shape):
+      return np.random.uniform(-1, 1, size=shape).astype(np.float32)
+
+    with tf.Graph().as_default() as graph:
+      with tf.device('/cpu:0'):
+        q = tf.placeholder(tf.float32, shape=(batch, heads, None, head_size))
+        k = tf.placeholder(tf.float32, shape=(batch, heads, None, head_size))
+        v = tf.placeholder(tf.float32, shape=(batch, heads, None, head_size))
+        mask, mask_feeds = build_mask(k, uniform)
+        y = tf.identity(scaled_dot_product_attention(
+            q, k, v, atten_mask=mask, use_fast_attention=True))
+
+      with self.session(graph=graph, use_gpu=False) as sess:
+        # Lengths below, within and above the buckets.
+        for k_seq_len in (3, 12, 21):
+          q_np = uniform(batch, heads, q_seq_len, head_size)
+          k_np = uniform(batch, heads, k_seq_len, head_size)
+          v_np = uniform(batch, heads, k_seq_len, head_size)
+          feed_dict, mask_np = mask_feeds(k_np, q_seq_len)
+          feed_dict.update({q: q_np, k: k_np, v: v_np})
+          output_val = sess.run(y, options=run_options,
+                                run_metadata=metadata, feed_dict=feed_dict)
+
+          scores_np = np.matmul(q_np, np.transpose(k_np, (0, 1, 3, 2)))
+          scores_np = scores_np / np.sqrt(head_size) + mask_np
+          probs_np = np.exp(scores_np -
+                            scores_np.max(axis=-1, keepdims=True))
+          probs_np /= probs_np.sum(axis=-1, keepdims=True)
+          expected = np.transpose(np.matmul(probs_np, v_np), (0, 2, 1, 3))
+          self.assertAllClose(output_val, expected, rtol=1e-4, atol=1e-4)
+
+    optimized = metadata.partition_graphs[0]
+    ops_by_name = {node.name: node.op for node in optimized.node}
+    attention = [node for node in optimized.node
+                 if 'ScaledDotProductAttention' in node.op]
+    self.assertEqual(len(attention), 1)
+    # Queries are dynamic in every case, so they are always padded.
+    input_ops = [ops_by_name[name.split(':')[0]]
+                 for name in attention[0].input[:3]]
+    self.assertEqual(input_ops[0], '_ITEXBucketPad')
+    for input_op in input_ops[1:]:
+      if pad_keys:
+        self.assertEqual(input_op, '_ITEXBucketPad')
+      else:
+        self.assertNotEqual(input_op, '_ITEXBucketPad')
+
+  def testAttentionWithMaskPerKey(self):
+    # The mask is computed from the keys, so its last dim is known to be the
+    # number of keys: padded keys get masked out along with them.
+    def build_mask(k, uniform):
+      del uniform
+      # ExpandDims, unlike StridedSlice, keeps the symbolic dims.
+      mask = tf.expand_dims(tf.expand_dims(tf.reduce_mean(k, axis=[1, 3]), 1),
+                            1)
+      def mask_feeds(k_np, q_seq_len):
+        del q_seq_len
+        return {}, k_np.mean(axis=(1, 3))[:, None, None, :]
+      return mask, mask_feeds
+
+    self._testAttention(build_mask, pad_keys=True)
+
+  def testAttentionWithUnrelatedMaskLength(self):
+    # The mask is as long as the keys at run time, but nothing in the graph
+    # says so, so its padding could not be aligned with the keys.
+    def build_mask(k, uniform):
+      del k
+      mask = tf.placeholder(tf.float32, shape=(2, 1, None, None))
+      def mask_feeds(k_np, q_seq_len):
+        mask_np = uniform(k_np.shape[0], 1, q_seq_len, k_np.shape[2])
+        return {mask: mask_np}, mask_np
+      return mask, mask_feeds
+
+    self._testAttention(build_mask, pad_keys=False)
+
+  def testAttentionWithMaskBroadcastAlongKeys(self):
+    # A mask of one column is broadcast to all the keys, so it cannot mask out
+    # padded keys: the keys must not be padded.
+    def build_mask(k, uniform):
+      del k
+      mask = tf.placeholder(tf.float32, shape=(2, 1, None, 1))
+      def mask_feeds(k_np, q_seq_len):
+        mask_np = uniform(k_np.shape[0], 1, q_seq_len, 1)
+        return {mask: mask_np}, mask_np
+      return mask, mask_feeds
+
+    self._testAttention(build_mask, pad_keys=False)
+
+
+if __name__ == '__main__':
+  test_lib.main()
@@ -0,0 +1,97 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+
+import tensorflow.compat.v1 as tf
+
+try:
+  from intel_extension_for_tensorflow.python.test_func import test as test_lib
+except ImportError:
+  from tensorflow.python.platform import test as test_lib
+from tensorflow.python.framework import test_util
+from tensorflow.core.protobuf import config_pb2
+
+
+class TransposeSinkingTest(test_lib.TestCase):
+
+  def _run(self, output, feed_dict):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with self.session(use_gpu=True) as sess:
+      output_val = sess.run(output, options=run_options,
+                            run_metadata=metadata, feed_dict=feed_dict)
+    num_transposes = 0
+    for graph in metadata.partition_graphs:
+      for node in graph.node:
+        if node.op == 'Transpose':
+          num_transposes += 1
+    return output_val, num_transposes
+
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def testCancelThroughElementwise(self):
+    in_array = np.random.normal(size=(2, 3, 8, 8)).astype(np.float32)
+    in_x = tf.placeholder(tf.float32, shape=in_array.shape)
+    # NCHW -> NHWC, layout-agnostic ops, NHWC -> NCHW.
+    x = tf.transpose(in_x, [0, 2, 3, 1])
+    x = tf.nn.relu(x) * 2.0
+    x = tf.math.exp(-x)
+    x = tf.transpose(x, [0, 3, 1, 2])
+    x = tf.identity(x)
+
+    output_val, num_transposes = self._run(x, {in_x: in_array})
+    self.assertEqual(num_transposes, 0)
+    self.assertAllClose(output_val, np.exp(-np.maximum(in_array, 0) * 2.0))
+
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def testSinkThroughConcatAndReduction(self):
+    a_array = np.random.normal(size=(2, 4, 5, 6)).astype(np.float32)
+    b_array = np.random.normal(size=(2, 4, 5, 6)).astype(np.float32)
+    in_a = tf.placeholder(tf.float32, shape=a_array.shape)
+    in_b = tf.placeholder(tf.float32, shape=b_array.shape)
+    perm = [0, 2, 3, 1]
+    x = tf.concat([tf.transpose(in_a, perm), tf.transpose(in_b, perm)], -1)
+    x = tf.math.reduce_sum(x, axis=[1, 2])
+    x = tf.identity(x)
+
+    output_val, num_transposes = self._run(x, {in_a: a_array, in_b: b_array})
+    # The reduction leaves [N, C] in order, so no transpose is needed.
+    self.assertEqual(num_transposes, 0)
+    expected = np.concatenate([a_array, b_array], 1).sum(axis=(2, 3))
+    self.assertAllClose(output_val, expected, rtol=1e-5, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def testMergeIntoSplitConsumers(self):
+    in_array = np.random.normal(size=(2, 4, 16)).astype(np.float32)
+    in_x = tf.placeholder(tf.float32, shape=in_array.shape)
+    x0, x1 = tf.split(tf.transpose(in_x, [2, 0, 1]), 2, axis=0)
+    # The Split now permutes its outputs, so the transposes after it get
+    # permutations which are not the inverse of the one before it.
+    y = tf.transpose(x0, [1, 0, 2]) * tf.transpose(x1, [1, 0, 2])
+    y = tf.identity(y)
+
+    output_val, num_transposes = self._run(y, {in_x: in_array})
+    self.assertEqual(num_transposes, 1)
+    expected = np.transpose(in_array[:, :, :8] * in_array[:, :, 8:],
+                            (0, 2, 1))
+    self.assertAllClose(output_val, expected, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == '__main__':
+  test_lib.main()